@@ -50,6 +50,11 @@ class alpha_filter : public util::clonable<token_stream, alpha_filter>
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the sequence
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -60,15 +65,20 @@ class alpha_filter : public util::clonable<token_stream, alpha_filter>
 
   private:
     /**
-     * Finds the next valid token for this filter.
+     * Finds the next valid token for this filter. This is done lazily,
+     * when the stream is next tested, so that the view returned by the
+     * previous call to next_view() is not invalidated early.
      */
-    void next_token();
+    void next_token() const;
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// The buffered token.
-    util::optional<std::string> token_;
+    /// The next buffered token, if it has been read from the source
+    mutable util::optional<util::string_view> token_;
+
+    /// Storage for buffered tokens whose text was changed by this filter
+    mutable std::string buffer_;
 };
 }
 }
@@ -52,6 +52,11 @@ class empty_sentence_filter
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the sequence
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -62,18 +67,22 @@ class empty_sentence_filter
 
   private:
     /**
-     * Finds the next valid token for this filter.
+     * Finds the next valid token for this filter. Called on demand, once
+     * the previous token has been returned.
      */
-    void next_token();
+    void next_token() const;
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
     /// Keeps track of the left hand side of a potentially empty sentence
-    util::optional<std::string> first_;
+    mutable util::optional<util::string_view> first_;
 
     /// Keeps track of the right hand side of a potentially empty sentence
-    util::optional<std::string> second_;
+    mutable util::optional<util::string_view> second_;
+
+    /// Storage for a pending token copied from another filter
+    std::string buffer_;
 };
 }
 }
@@ -9,8 +9,8 @@
 #ifndef META_ENGLISH_NORMALIZER_H_
 #define META_ENGLISH_NORMALIZER_H_
 
-#include <deque>
 #include <memory>
+#include <vector>
 #include "analyzers/token_stream.h"
 #include "util/clonable.h"
 #include "util/optional.h"
@@ -56,6 +56,12 @@ class english_normalizer
      */
     std::string next() override;
 
+    /**
+     * Obtains a view of the next token in the sequence. The pieces of a
+     * split token all point into a single copy of the source token.
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -69,14 +75,14 @@ class english_normalizer
      * Determines if the given token is a whitespace token.
      * @param token The given token
      */
-    bool is_whitespace(const std::string& token) const;
+    bool is_whitespace(util::string_view token) const;
 
     /**
      * Converts the given non-whitespace token into a series of tokens and
      * places them on the buffer.
      * @param token The given token
      */
-    void parse_token(const std::string& token);
+    void parse_token(util::string_view token);
 
     /**
      * Checks for starting quotes in the token, adding a normalized begin
@@ -84,7 +90,7 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t starting_quotes(uint64_t start, const std::string& token);
+    uint64_t starting_quotes(uint64_t start, util::string_view token);
 
     /**
      * Checks if the given character is a passable quote symbol.
@@ -97,7 +103,7 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t strip_dashes(uint64_t start, const std::string& token);
+    uint64_t strip_dashes(uint64_t start, util::string_view token);
 
     /**
      * Reads "word" characters (alpha numeric and dashes) starting at start
@@ -106,18 +112,24 @@ class english_normalizer
      * @param start The index to start searching at
      * @param token The given token
      */
-    uint64_t word(uint64_t start, const std::string& token);
+    uint64_t word(uint64_t start, util::string_view token);
 
     /**
      * @return the next buffered token.
      */
-    std::string current_token();
+    util::string_view current_token();
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// Buffered tokens to return
-    std::deque<std::string> tokens_;
+    /// The source token currently being split into buffered tokens
+    std::string current_;
+
+    /// Buffered tokens to return (pieces of current_, or literals)
+    std::vector<util::string_view> tokens_;
+
+    /// Index of the next buffered token to return
+    uint64_t next_idx_;
 };
 }
 }
@@ -62,6 +62,11 @@ class length_filter : public util::clonable<token_stream, length_filter>
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the sequence
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -72,15 +77,19 @@ class length_filter : public util::clonable<token_stream, length_filter>
 
   private:
     /**
-     * Advances internal state to the next valid token.
+     * Finds the next token of acceptable length. Only called once the
+     * previous token has been handed out (see alpha_filter).
      */
-    void next_token();
+    void next_token() const;
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// The next buffered token
-    util::optional<std::string> token_;
+    /// The next buffered token, if it has been read from the source
+    mutable util::optional<util::string_view> token_;
+
+    /// Storage for buffered tokens whose text was changed by this filter
+    mutable std::string buffer_;
 
     /// The minimum length of a token that can be emitted by this filter
     uint64_t min_length_;
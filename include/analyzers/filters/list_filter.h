@@ -75,6 +75,11 @@ class list_filter : public util::clonable<token_stream, list_filter>
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the sequence
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -85,15 +90,22 @@ class list_filter : public util::clonable<token_stream, list_filter>
 
   private:
     /**
-     * Advances internal state to the next valid token.
+     * Advances internal state to the next valid token. Called lazily from
+     * operator bool.
      */
-    void next_token();
+    void next_token() const;
 
     /// The source to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// The next buffered token
-    util::optional<std::string> token_;
+    /// The next buffered token, if it has been read from the source
+    mutable util::optional<util::string_view> token_;
+
+    /// Storage for buffered tokens copied from another list_filter
+    mutable std::string buffer_;
+
+    /// Reused key for looking tokens up in the list
+    mutable std::string lookup_;
 
     /// The set of tokens used for filtering
     std::unordered_set<std::string> list_;
@@ -50,6 +50,12 @@ class lowercase_filter : public util::clonable<token_stream, lowercase_filter>
      */
     std::string next() override;
 
+    /**
+     * Obtains a view of the next token in the sequence. Tokens that are
+     * already lowercase are passed through from the source untouched.
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines whether there are more tokens available in the stream.
      */
@@ -61,6 +67,9 @@ class lowercase_filter : public util::clonable<token_stream, lowercase_filter>
   private:
     /// The stream to read tokens from.
     std::unique_ptr<token_stream> source_;
+
+    /// Storage for the most recent token that had to be case-folded
+    std::string buffer_;
 };
 }
 }
@@ -52,6 +52,11 @@ class porter2_stemmer : public util::clonable<token_stream, porter2_stemmer>
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the sequence
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines if there are more tokens available in the stream.
      */
@@ -62,15 +67,18 @@ class porter2_stemmer : public util::clonable<token_stream, porter2_stemmer>
 
   private:
     /**
-     * Finds the next valid token for this filter.
+     * Reads and stems the next non-empty token, on demand.
      */
-    void next_token();
+    void next_token() const;
 
     /// The stream to read tokens from
     std::unique_ptr<token_stream> source_;
 
-    /// The buffered next token.
-    util::optional<std::string> token_;
+    /// The next buffered token, if it has been read from the source
+    mutable util::optional<util::string_view> token_;
+
+    /// Storage for buffered tokens whose text was changed by this filter
+    mutable std::string buffer_;
 };
 }
 }
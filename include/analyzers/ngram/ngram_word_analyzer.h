@@ -9,6 +9,9 @@
 #ifndef META_NGRAM_WORD_ANALYZER_H_
 #define META_NGRAM_WORD_ANALYZER_H_
 
+#include <string>
+#include <vector>
+
 #include "analyzers/analyzer_factory.h"
 #include "analyzers/ngram/ngram_analyzer.h"
 #include "util/clonable.h"
@@ -54,6 +57,12 @@ class ngram_word_analyzer
   private:
     /// The token stream to be used for extracting tokens
     std::unique_ptr<token_stream> stream_;
+
+    /// The last n tokens read, used as a ring buffer
+    std::vector<std::string> window_;
+
+    /// Reused storage for the ngram being counted
+    std::string ngram_;
 };
 
 /**
@@ -14,6 +14,8 @@
 #include <string>
 #include <stdexcept>
 
+#include "util/string_view.h"
+
 namespace meta
 {
 namespace analyzers
@@ -23,6 +25,12 @@ namespace analyzers
  * Base class that represents a stream of tokens that have been extracted
  * from a document. These tokens may be raw tokens (in the case of a
  * tokenizer class) or filtered tokens (from the filter classes).
+ *
+ * Tokens can be read either as owning strings with next() or as views
+ * with next_view(). Streams that override next_view() hand out views into
+ * their content buffer (or into a buffer of their own when they have
+ * changed the text), so reading a whole chain of them does not allocate
+ * per token.
  */
 class token_stream
 {
@@ -32,6 +40,19 @@ class token_stream
      */
     virtual std::string next() = 0;
 
+    /**
+     * Obtains the next token in the sequence without copying it. The view
+     * is only valid until the next call to next(), next_view(),
+     * set_content(), or operator bool on this stream.
+     *
+     * The default implementation buffers the result of next().
+     */
+    virtual util::string_view next_view()
+    {
+        view_buffer_ = next();
+        return view_buffer_;
+    }
+
     /**
      * Determines whether there are more tokens available in the
      * stream.
@@ -62,6 +83,10 @@ class token_stream
     {
         using std::runtime_error::runtime_error;
     };
+
+  private:
+    /// Storage for the token returned by the default next_view()
+    std::string view_buffer_;
 };
 
 }
@@ -52,6 +52,12 @@ class character_tokenizer
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the document, pointing into the
+     * tokenizer's content buffer
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines if there are more tokens in the document.
      */
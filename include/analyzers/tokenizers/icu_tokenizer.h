@@ -102,6 +102,12 @@ class icu_tokenizer : public util::clonable<token_stream, icu_tokenizer>
      */
     std::string next() override;
 
+    /**
+     * @return a view of the next token in the document, valid until the
+     * next token is read
+     */
+    util::string_view next_view() override;
+
     /**
      * Determines if there are more tokens in the document.
      */
@@ -0,0 +1,29 @@
+/**
+ * @file analyzer_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_ANALYZER_BENCH_H_
+#define META_BENCH_ANALYZER_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks analyzer throughput as each filter is added to a
+ * whitespace-tokenized chain.
+ * @param r The runner to time the benchmarks with
+ */
+void analyzer_benchmarks(runner& r);
+}
+}
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_H_
+#define META_BENCH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * The timings gathered for a single benchmark.
+ */
+struct result
+{
+    /// the name of the benchmark
+    std::string name;
+    /// the number of timed samples
+    uint64_t samples;
+    /// the number of operations performed by each sample
+    uint64_t ops;
+    /// the median time per operation, in nanoseconds
+    double p50_ns;
+    /// the 95th percentile time per operation, in nanoseconds
+    double p95_ns;
+    /// the 99th percentile time per operation, in nanoseconds
+    double p99_ns;
+    /// the number of bytes processed by each sample, or 0 if the
+    /// benchmark does not measure throughput
+    uint64_t bytes = 0;
+
+    /**
+     * @return the median number of operations per second
+     */
+    double ops_per_sec() const;
+
+    /**
+     * @return the median number of megabytes (10^6 bytes) processed per
+     * second, or 0 if the benchmark does not measure throughput
+     */
+    double mb_per_sec() const;
+};
+
+/**
+ * Times benchmarks and collects their results. A benchmark is a function
+ * that performs a fixed number of operations each time it is called; it
+ * is called a few times untimed to warm up, then once per sample, and
+ * each sample's time is divided by the number of operations.
+ */
+class runner
+{
+  public:
+    /**
+     * @param samples The default number of timed samples per benchmark
+     * @param warmup The number of untimed calls before sampling
+     */
+    runner(uint64_t samples = 30, uint64_t warmup = 3);
+
+    /**
+     * Times a benchmark.
+     * @param name The name of the benchmark
+     * @param ops The number of operations each call to func performs
+     * @param func The benchmark to run
+     * @param samples The number of samples to take, or 0 for the default
+     * @param bytes The number of bytes each call to func processes, for
+     * reporting its throughput
+     * @return the result, which is also kept in results()
+     */
+    template <class Function>
+    const result& run(const std::string& name, uint64_t ops, Function&& func,
+                      uint64_t samples = 0, uint64_t bytes = 0)
+    {
+        if (samples == 0)
+            samples = samples_;
+
+        for (uint64_t i = 0; i < warmup_; ++i)
+            func();
+
+        std::vector<double> times(samples);
+        for (auto& time : times)
+        {
+            auto start = std::chrono::steady_clock::now();
+            func();
+            auto end = std::chrono::steady_clock::now();
+            std::chrono::duration<double, std::nano> elapsed = end - start;
+            time = elapsed.count() / ops;
+        }
+        return record(name, ops, std::move(times), bytes);
+    }
+
+    /**
+     * Records a benchmark whose samples were timed elsewhere.
+     * @param name The name of the benchmark
+     * @param ops The number of operations in each sample
+     * @param times The time per operation of each sample, in nanoseconds
+     * @param bytes The number of bytes processed by each sample
+     * @return the result, which is also kept in results()
+     */
+    const result& record(const std::string& name, uint64_t ops,
+                         std::vector<double> times, uint64_t bytes = 0);
+
+    /**
+     * @return the results of every benchmark run so far
+     */
+    const std::vector<result>& results() const;
+
+  private:
+    /// the default number of samples
+    uint64_t samples_;
+    /// the number of untimed calls before sampling
+    uint64_t warmup_;
+    /// the results so far
+    std::vector<result> results_;
+};
+
+/**
+ * Writes results as tab-separated values with a header line, one
+ * benchmark per line.
+ * @param out The stream to write to
+ * @param results The results to write
+ */
+void write_results(std::ostream& out, const std::vector<result>& results);
+
+/**
+ * Reads results written by write_results.
+ * @param in The stream to read from
+ * @return the results
+ */
+std::vector<result> read_results(std::istream& in);
+
+/**
+ * Compares results against a baseline by their median time per operation
+ * and writes a report of the change in each benchmark.
+ * @param out The stream to write the report to
+ * @param baseline The results to compare against
+ * @param current The new results
+ * @param threshold The fractional slowdown (e.g. 0.1 for 10%) beyond
+ * which a benchmark counts as a regression
+ * @return the number of regressions
+ */
+uint64_t compare_results(std::ostream& out,
+                         const std::vector<result>& baseline,
+                         const std::vector<result>& current, double threshold);
+
+/**
+ * Prevents the compiler from optimizing away a value computed by a
+ * benchmark.
+ * @param value The (arithmetic) value to keep
+ */
+template <class T>
+void do_not_optimize(T value)
+{
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+}
+}
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file cache_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_CACHE_BENCH_H_
+#define META_BENCH_CACHE_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks get and put on dblru_cache, splay_cache and clock_cache under
+ * a skewed key distribution, and get from many threads at once.
+ * @param r The runner to time the benchmarks with
+ */
+void cache_benchmarks(runner& r);
+}
+}
+
+#endif
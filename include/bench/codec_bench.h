@@ -0,0 +1,29 @@
+/**
+ * @file codec_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_CODEC_BENCH_H_
+#define META_BENCH_CODEC_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks gamma coding and postings_data decoding with the gamma
+ * and block codecs.
+ * @param r The runner to time the benchmarks with
+ */
+void codec_benchmarks(runner& r);
+}
+}
+
+#endif
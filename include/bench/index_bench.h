@@ -0,0 +1,30 @@
+/**
+ * @file index_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_INDEX_BENCH_H_
+#define META_BENCH_INDEX_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks vocabulary_map and compact_vocabulary lookups, the latency
+ * of ranker::score with each query strategy, and batched query_engine
+ * throughput and latency on a synthetic inverted index.
+ * @param r The runner to time the benchmarks with
+ */
+void index_benchmarks(runner& r);
+}
+}
+
+#endif
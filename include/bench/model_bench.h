@@ -0,0 +1,29 @@
+/**
+ * @file model_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_MODEL_BENCH_H_
+#define META_BENCH_MODEL_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks the LDA Gibbs sampling rate and the SGD update rate on a
+ * synthetic forward index.
+ * @param r The runner to time the benchmarks with
+ */
+void model_benchmarks(runner& r);
+}
+}
+
+#endif
@@ -0,0 +1,28 @@
+/**
+ * @file parallel_bench.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_PARALLEL_BENCH_H_
+#define META_BENCH_PARALLEL_BENCH_H_
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Benchmarks the overhead of thread_pool tasks and parallel_for.
+ * @param r The runner to time the benchmarks with
+ */
+void parallel_benchmarks(runner& r);
+}
+}
+
+#endif
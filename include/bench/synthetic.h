@@ -0,0 +1,112 @@
+/**
+ * @file synthetic.h
+ * @author agent
+ *
+ * Reproducible synthetic data for the benchmarks, so that they do not
+ * depend on any downloaded dataset.
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BENCH_SYNTHETIC_H_
+#define META_BENCH_SYNTHETIC_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace meta
+{
+namespace bench
+{
+
+/**
+ * Draws ranks in [0, n) from a Zipf distribution, so that rank r is drawn
+ * with probability proportional to 1 / (r + 1)^s, which approximates the
+ * term frequencies of natural language text.
+ */
+class zipf_distribution
+{
+  public:
+    /**
+     * @param n The number of ranks
+     * @param s The exponent of the distribution
+     */
+    zipf_distribution(uint64_t n, double s = 1.0);
+
+    /**
+     * @param rng The random number generator to use
+     * @return a rank drawn from the distribution
+     */
+    template <class RandomEngine>
+    uint64_t operator()(RandomEngine& rng) const
+    {
+        std::uniform_real_distribution<double> dist{0, cdf_.back()};
+        auto it = std::upper_bound(cdf_.begin(), cdf_.end(), dist(rng));
+        return std::min<uint64_t>(
+            static_cast<uint64_t>(std::distance(cdf_.begin(), it)),
+            cdf_.size() - 1);
+    }
+
+  private:
+    /// the unnormalized cumulative distribution over the ranks
+    std::vector<double> cdf_;
+};
+
+/**
+ * @param rank A term rank
+ * @return a pronounceable lowercase pseudo-word unique to that rank
+ */
+std::string synthetic_word(uint64_t rank);
+
+/**
+ * The shape of a synthetic corpus.
+ */
+struct corpus_options
+{
+    /// the name of the dataset, which also names its files and indexes
+    std::string name = "synthetic";
+    /// the number of documents
+    uint64_t num_docs = 2000;
+    /// the number of distinct words documents are drawn from
+    uint64_t vocab_size = 20000;
+    /// the minimum number of words in a document
+    uint64_t min_length = 20;
+    /// the maximum number of words in a document
+    uint64_t max_length = 400;
+    /// the seed for the random number generator
+    uint64_t seed = 47;
+};
+
+/**
+ * Generates documents of Zipf-distributed pseudo-words with sentence
+ * capitalization and punctuation. Each document is labeled "pos" or
+ * "neg", and a small fraction of its words are drawn from a set of words
+ * specific to its label so that the labels can be learned.
+ * @param options The shape of the corpus
+ * @param labels Set to the label of each document
+ * @return the content of each document
+ */
+std::vector<std::string> synthetic_documents(const corpus_options& options,
+                                             std::vector<std::string>& labels);
+
+/**
+ * Writes a synthetic line corpus and a configuration file for it whose
+ * analyzer lowercases whitespace-delimited tokens.
+ * @param prefix The directory to write the corpus, configuration, and
+ * any indexes built from it to; it must already exist
+ * @param options The shape of the corpus
+ * @param codec The postings codec to configure the inverted index with
+ * @return the path to the configuration file
+ */
+std::string write_synthetic_corpus(const std::string& prefix,
+                                   const corpus_options& options = {},
+                                   const std::string& codec = "gamma");
+}
+}
+
+#endif
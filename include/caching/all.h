@@ -1,4 +1,7 @@
+#include "caching/cache_stats.h"
+#include "caching/clock_cache.h"
 #include "caching/dblru_cache.h"
+#include "caching/memory_budget.h"
 #include "caching/no_evict_cache.h"
 #include "caching/shard_cache.h"
 #include "caching/splay_cache.h"
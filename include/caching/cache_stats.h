@@ -0,0 +1,184 @@
+/**
+ * @file cache_stats.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CACHE_STATS_H_
+#define META_CACHE_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "caching/thread_stripe.h"
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * How well a cache has been doing since it was created.
+ */
+struct cache_stats
+{
+    /// the number of finds that found their key
+    uint64_t hits = 0;
+    /// the number of finds that did not find their key
+    uint64_t misses = 0;
+    /// the number of entries removed to make room for others
+    uint64_t evictions = 0;
+    /// the number of inserts the cache turned away
+    uint64_t rejections = 0;
+
+    /**
+     * @return the fraction of finds that found their key
+     */
+    double hit_rate() const
+    {
+        auto finds = hits + misses;
+        return finds == 0 ? 0.0 : static_cast<double>(hits) / finds;
+    }
+
+    /**
+     * Adds the counts of another cache, such as another shard.
+     * @param other The counts to add
+     * @return the current cache_stats
+     */
+    cache_stats& operator+=(const cache_stats& other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        rejections += other.rejections;
+        return *this;
+    }
+};
+
+/**
+ * The counters behind a cache's cache_stats, which may be incremented
+ * from several threads at once. Hits and misses, which are counted on
+ * every find, are spread over stripes on separate cache lines, so that
+ * threads finding at once rarely write to the same one.
+ */
+class cache_counters
+{
+  public:
+    /**
+     * Creates counters starting at zero.
+     */
+    cache_counters() = default;
+
+    /**
+     * Move constructs counters, which takes the current counts of other.
+     * @param other The counters to take the counts of
+     */
+    cache_counters(cache_counters&& other) : cache_counters{}
+    {
+        *this = std::move(other);
+    }
+
+    /**
+     * Move assigns counters, which takes the current counts of other.
+     * @param other The counters to take the counts of
+     * @return the current cache_counters
+     */
+    cache_counters& operator=(cache_counters&& other)
+    {
+        auto counts = other.stats();
+        for (auto& s : stripes_)
+        {
+            s.hits = 0;
+            s.misses = 0;
+        }
+        stripes_[0].hits = counts.hits;
+        stripes_[0].misses = counts.misses;
+        evictions_ = other.evictions_.load();
+        rejections_ = other.rejections_.load();
+        return *this;
+    }
+
+    /// Counts a find that found its key
+    void hit()
+    {
+        stripe().hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Counts a find that did not find its key
+    void miss()
+    {
+        stripe().misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Counts entries removed to make room for others.
+     * @param count The number of entries removed
+     */
+    void evict(uint64_t count = 1)
+    {
+        evictions_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Counts an insert the cache turned away
+    void reject()
+    {
+        rejections_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return the current counts
+     */
+    cache_stats stats() const
+    {
+        cache_stats stats;
+        for (const auto& s : stripes_)
+        {
+            stats.hits += s.hits.load(std::memory_order_relaxed);
+            stats.misses += s.misses.load(std::memory_order_relaxed);
+        }
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.rejections = rejections_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+  private:
+    /// the number of stripes hits and misses are spread over
+    const static constexpr uint64_t num_stripes = 16;
+
+    /**
+     * The hits and misses counted by some of the threads, padded to fill
+     * a cache line.
+     */
+    struct stripe_counts
+    {
+        /// the number of finds that found their key
+        std::atomic<uint64_t> hits{0};
+        /// the number of finds that did not find their key
+        std::atomic<uint64_t> misses{0};
+        /// keeps the next stripe off of this one's cache line
+        char padding[64 - 2 * sizeof(std::atomic<uint64_t>)];
+    };
+
+    /**
+     * @return the stripe the calling thread counts hits and misses in
+     */
+    stripe_counts& stripe()
+    {
+        return stripes_[thread_stripe() % num_stripes];
+    }
+
+    /// the hits and misses, spread over stripes
+    stripe_counts stripes_[num_stripes];
+    /// the number of entries removed to make room for others
+    std::atomic<uint64_t> evictions_{0};
+    /// the number of inserts the cache turned away
+    std::atomic<uint64_t> rejections_{0};
+};
+}
+}
+
+#endif
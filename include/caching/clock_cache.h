@@ -0,0 +1,273 @@
+/**
+ * @file clock_cache.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_CLOCK_CACHE_H_
+#define META_CLOCK_CACHE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caching/cache_stats.h"
+#include "caching/entry_size.h"
+#include "caching/frequency_sketch.h"
+#include "caching/memory_budget.h"
+#include "caching/thread_stripe.h"
+#include "util/optional.h"
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * A fixed-size cache for read-mostly workloads with many threads.
+ *
+ * The cache is split into sets of a few slots each, and every key maps to
+ * a single set. A find only reads the slots of its key's set and takes no
+ * lock. Apart from counting itself in a stripe of counters shared with a
+ * few other threads, it writes to memory only to mark a slot as
+ * referenced the first time it is found after being inserted or passed
+ * over for eviction. Inserts lock just the set they insert into.
+ *
+ * Entries replaced or evicted while finds may still be reading them are
+ * freed by epochs: each find announces the epoch it started in, and the
+ * replaced entries are freed in batches, after the epoch is advanced and
+ * every find that started in the old one has finished.
+ *
+ * A full set evicts with the CLOCK algorithm: a hand sweeps the set's
+ * slots, clearing the referenced marks it passes, and evicts the first
+ * slot whose mark is already clear. Entries found since the hand last
+ * passed them survive, which approximates LRU without the bookkeeping on
+ * every find.
+ *
+ * Every entry is charged for the memory its key and value use, as
+ * computed by entry_size. With a memory_budget, entries are also evicted
+ * from one set after another until the rest fit in the budget. Admission
+ * compares a key with the entry its set would evict when the set is full,
+ * and requires it to have been looked up before when its bytes would
+ * force evictions. Finds count their key in the admission sketch when
+ * they miss, or when they mark a slot as referenced, so finds of entries
+ * that are already marked leave the sketch alone.
+ */
+template <class Key, class Value>
+class clock_cache
+{
+  public:
+    /// The number of slots in each set of the cache
+    const static constexpr uint64_t set_size = 8;
+
+    /**
+     * @param max_size The number of entries the cache holds, at least;
+     * it is rounded up to a power of two number of sets
+     * @param budget The limit on the memory used by the entries
+     */
+    clock_cache(uint64_t max_size = 1 << 16,
+                memory_budget budget = memory_budget{});
+
+    /**
+     * clock_cache may not be copy-constructed.
+     */
+    clock_cache(const clock_cache&) = delete;
+
+    /**
+     * clock_cache may not be copy-assigned.
+     */
+    clock_cache& operator=(const clock_cache&) = delete;
+
+    /**
+     * Frees the entries.
+     */
+    ~clock_cache();
+
+    /**
+     * Inserts a (key, value) pair into the cache, replacing the value of
+     * the key if it is already in the cache.
+     * @param key
+     * @param value
+     */
+    void insert(const Key& key, const Value& value);
+
+    /**
+     * Finds a value in the cache. If it exists, the optional will be
+     * engaged, otherwise, it will be disengaged.
+     *
+     * @param key the key to find the corresponding value for
+     * @return an optional that may contain the value, if found
+     */
+    util::optional<Value> find(const Key& key) const;
+
+    /**
+     * @return the number of entries in the cache
+     */
+    uint64_t size() const;
+
+    /**
+     * @return the number of bytes used by the keys and values in the cache
+     */
+    uint64_t bytes_used() const;
+
+    /**
+     * @return the hits, misses, evictions and rejections of the cache
+     */
+    cache_stats stats() const;
+
+    /**
+     * Empties the cache.
+     */
+    void clear();
+
+  private:
+    /**
+     * A (key, value) pair in the cache, which is never modified once
+     * inserted.
+     */
+    struct entry
+    {
+        /// the key
+        Key key;
+        /// the value
+        Value value;
+        /// the number of bytes charged for the key and value
+        uint64_t bytes;
+    };
+
+    /**
+     * A place for an entry in the cache.
+     */
+    struct slot
+    {
+        /// the entry in the slot, or nullptr
+        std::atomic<const entry*> contents{nullptr};
+        /// whether the entry has been found since the hand last passed it
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    /**
+     * The number of finds in progress that started in each parity of
+     * epoch, for some of the threads, padded to fill a cache line.
+     */
+    struct reader_stripe
+    {
+        /// the finds in progress, by the parity of their epoch
+        std::atomic<uint64_t> active[2];
+        /// keeps the next stripe off of this one's cache line
+        char padding[64 - 2 * sizeof(std::atomic<uint64_t>)];
+    };
+
+    /**
+     * The slots that a range of keys map to.
+     */
+    struct set
+    {
+        /// the slots of the set
+        slot slots[set_size];
+        /// the slot the hand is at
+        uint64_t hand = 0;
+        /// guards changes to the set
+        mutable std::mutex mutex;
+    };
+
+    /**
+     * @param key A key
+     * @return the set the key maps to
+     */
+    set& set_for(const Key& key) const;
+
+    /**
+     * @param s A set
+     * @return the slot the hand of the set evicts next
+     */
+    slot& victim(set& s);
+
+    /**
+     * Evicts an entry from the next set that has one, for making room
+     * in the memory budget.
+     */
+    void evict_one();
+
+    /**
+     * @param key The key of an entry to be inserted
+     * @param victim The key of the entry it would evict, if known
+     * @return whether the admission policy lets the entry in
+     */
+    bool admit(const Key& key, const Key* victim) const;
+
+    /**
+     * Replaces the entry in a slot; must be called with the slot's set
+     * locked. The old entry is freed once no find can be reading it.
+     * @param sl A slot
+     * @param contents The entry to store in the slot, or nullptr
+     */
+    void store(slot& sl, const entry* contents);
+
+    /**
+     * Frees the replaced entries once every find that started before
+     * they were replaced has finished, if enough of them have built up.
+     * Must be called without any set locked.
+     * @param force Whether to free them however few there are
+     */
+    void reclaim(bool force = false);
+
+    /// the sets of the cache
+    std::unique_ptr<set[]> sets_;
+
+    /// the number of sets, minus one, for masking hashes
+    uint64_t mask_;
+
+    /// the number of entries in the cache
+    std::atomic<uint64_t> size_;
+
+    /// the number of bytes used by the keys and values in the cache
+    std::atomic<uint64_t> bytes_;
+
+    /// the limit on the memory used by the entries
+    memory_budget budget_;
+
+    /// the next set entries are evicted from to fit in the budget
+    std::atomic<uint64_t> evict_hand_;
+
+    /// how often keys are looked up, if inserts must pass admission
+    std::unique_ptr<frequency_sketch<Key>> sketch_;
+
+    /// the hits, misses, evictions and rejections of the cache
+    mutable cache_counters counters_;
+
+    /// the number of stripes finds announce their epochs in
+    const static constexpr uint64_t num_reader_stripes = 16;
+
+    /// the number of replaced entries that are freed at a time
+    const static constexpr uint64_t reclaim_batch = 64;
+
+    /// the epoch that finds starting now announce
+    mutable std::atomic<uint64_t> epoch_;
+
+    /// the finds in progress, by stripe and the parity of their epoch
+    std::unique_ptr<reader_stripe[]> readers_;
+
+    /// the entries that were replaced but may still be read by finds
+    std::vector<const entry*> retired_;
+
+    /// guards retired_
+    std::mutex retired_mutex_;
+
+    /// lets one thread at a time advance the epoch and free entries
+    std::mutex reclaim_mutex_;
+
+    /// the hash function used for determining which set a key belongs to
+    std::hash<Key> hasher_;
+};
+}
+}
+
+#include "caching/clock_cache.tcc"
+#endif
@@ -0,0 +1,289 @@
+/**
+ * @file clock_cache.tcc
+ * @author agent
+ */
+
+#include "caching/clock_cache.h"
+
+namespace meta
+{
+namespace caching
+{
+
+template <class Key, class Value>
+clock_cache<Key, Value>::clock_cache(uint64_t max_size, memory_budget budget)
+    : size_{0},
+      bytes_{0},
+      budget_(budget),
+      evict_hand_{0},
+      epoch_{0},
+      readers_{new reader_stripe[num_reader_stripes]}
+{
+    uint64_t num_sets = 1;
+    while (num_sets * set_size < max_size)
+        num_sets *= 2;
+    sets_.reset(new set[num_sets]);
+    mask_ = num_sets - 1;
+
+    for (uint64_t i = 0; i < num_reader_stripes; ++i)
+    {
+        readers_[i].active[0] = 0;
+        readers_[i].active[1] = 0;
+    }
+
+    if (budget_.admission)
+        sketch_.reset(new frequency_sketch<Key>{num_sets * set_size});
+}
+
+template <class Key, class Value>
+clock_cache<Key, Value>::~clock_cache()
+{
+    for (uint64_t i = 0; i <= mask_; ++i)
+    {
+        for (auto& sl : sets_[i].slots)
+            delete sl.contents.load();
+    }
+    for (auto contents : retired_)
+        delete contents;
+}
+
+template <class Key, class Value>
+void clock_cache<Key, Value>::insert(const Key& key, const Value& value)
+{
+    auto bytes = entry_size<Key>{}(key) + entry_size<Value>{}(value);
+    if (!budget_.fits(bytes, 0))
+    {
+        counters_.reject();
+        return;
+    }
+
+    {
+        auto& s = set_for(key);
+        std::lock_guard<std::mutex> lock{s.mutex};
+
+        // replace the key's value, or fill an empty slot, before evicting
+        slot* target = nullptr;
+        for (auto& sl : s.slots)
+        {
+            auto contents = sl.contents.load(std::memory_order_relaxed);
+            if (contents && contents->key == key)
+            {
+                target = &sl;
+                break;
+            }
+            if (!target && !contents)
+                target = &sl;
+        }
+
+        bool evicting = !target;
+        if (evicting)
+            target = &victim(s);
+
+        auto current = target->contents.load(std::memory_order_relaxed);
+        auto replaced = current ? current->bytes : 0;
+        const Key* evicted = evicting ? &current->key : nullptr;
+        if ((evicting || !budget_.fits(bytes, bytes_ - replaced))
+            && !admit(key, evicted))
+        {
+            counters_.reject();
+            return;
+        }
+
+        if (evicting)
+            counters_.evict();
+        if (!current)
+            ++size_;
+        bytes_ -= replaced;
+        bytes_ += bytes;
+
+        target->referenced.store(false, std::memory_order_relaxed);
+        store(*target, new entry{key, value, bytes});
+    }
+
+    // the set's lock is released first, since evicting locks other sets
+    while (!budget_.fits(0, bytes_))
+        evict_one();
+    reclaim();
+}
+
+template <class Key, class Value>
+util::optional<Value> clock_cache<Key, Value>::find(const Key& key) const
+{
+    // announce the epoch this find starts in; if the epoch advances in
+    // between, the finds of the old one may already have been waited for,
+    // so the new one is announced instead
+    auto& readers = readers_[thread_stripe() % num_reader_stripes];
+    uint64_t epoch;
+    while (true)
+    {
+        epoch = epoch_.load();
+        readers.active[epoch & 1].fetch_add(1);
+        if (epoch_.load() == epoch)
+            break;
+        readers.active[epoch & 1].fetch_sub(1);
+    }
+
+    util::optional<Value> result;
+    bool marked = false;
+    for (const auto& sl : set_for(key).slots)
+    {
+        auto contents = sl.contents.load(std::memory_order_acquire);
+        if (contents && contents->key == key)
+        {
+            result = contents->value;
+
+            // only write when the mark changes, so that threads finding
+            // the same hot entries don't fight over its cache line
+            if (!sl.referenced.load(std::memory_order_relaxed))
+            {
+                sl.referenced.store(true, std::memory_order_relaxed);
+                marked = true;
+            }
+            break;
+        }
+    }
+    readers.active[epoch & 1].fetch_sub(1, std::memory_order_release);
+
+    if (sketch_ && (marked || !result))
+        sketch_->increment(key);
+    if (result)
+        counters_.hit();
+    else
+        counters_.miss();
+    return result;
+}
+
+template <class Key, class Value>
+uint64_t clock_cache<Key, Value>::size() const
+{
+    return size_;
+}
+
+template <class Key, class Value>
+uint64_t clock_cache<Key, Value>::bytes_used() const
+{
+    return bytes_;
+}
+
+template <class Key, class Value>
+cache_stats clock_cache<Key, Value>::stats() const
+{
+    return counters_.stats();
+}
+
+template <class Key, class Value>
+void clock_cache<Key, Value>::clear()
+{
+    for (uint64_t i = 0; i <= mask_; ++i)
+    {
+        auto& s = sets_[i];
+        std::lock_guard<std::mutex> lock{s.mutex};
+        for (auto& sl : s.slots)
+        {
+            auto contents = sl.contents.load(std::memory_order_relaxed);
+            if (!contents)
+                continue;
+            --size_;
+            bytes_ -= contents->bytes;
+            store(sl, nullptr);
+        }
+    }
+    reclaim(true);
+}
+
+template <class Key, class Value>
+auto clock_cache<Key, Value>::set_for(const Key& key) const -> set &
+{
+    // std::hash is the identity for integers, so the hash is mixed to
+    // spread runs of keys across the sets
+    uint64_t hash = hasher_(key);
+    return sets_[((hash * 0x9e3779b97f4a7c15ULL) >> 32) & mask_];
+}
+
+template <class Key, class Value>
+auto clock_cache<Key, Value>::victim(set& s) -> slot &
+{
+    // every mark is clear by the time the hand has gone around once
+    while (true)
+    {
+        auto& sl = s.slots[s.hand];
+        s.hand = (s.hand + 1) % set_size;
+        if (!sl.referenced.exchange(false, std::memory_order_relaxed))
+            return sl;
+    }
+}
+
+template <class Key, class Value>
+void clock_cache<Key, Value>::evict_one()
+{
+    for (uint64_t i = 0; i <= mask_; ++i)
+    {
+        auto& s = sets_[evict_hand_.fetch_add(1) & mask_];
+        std::lock_guard<std::mutex> lock{s.mutex};
+
+        bool empty = true;
+        for (const auto& sl : s.slots)
+            empty = empty && !sl.contents.load(std::memory_order_relaxed);
+        if (empty)
+            continue;
+
+        // the hand may stop at empty slots, but not twice around the set
+        auto target = &victim(s);
+        while (!target->contents.load(std::memory_order_relaxed))
+            target = &victim(s);
+
+        --size_;
+        bytes_ -= target->contents.load(std::memory_order_relaxed)->bytes;
+        counters_.evict();
+        store(*target, nullptr);
+        return;
+    }
+}
+
+template <class Key, class Value>
+bool clock_cache<Key, Value>::admit(const Key& key, const Key* victim) const
+{
+    if (!sketch_)
+        return true;
+    if (victim)
+        return sketch_->frequency(key) > sketch_->frequency(*victim);
+    return sketch_->frequency(key) > 1;
+}
+
+template <class Key, class Value>
+void clock_cache<Key, Value>::store(slot& sl, const entry* contents)
+{
+    auto old = sl.contents.exchange(contents, std::memory_order_acq_rel);
+    if (old)
+    {
+        std::lock_guard<std::mutex> lock{retired_mutex_};
+        retired_.push_back(old);
+    }
+}
+
+template <class Key, class Value>
+void clock_cache<Key, Value>::reclaim(bool force)
+{
+    std::vector<const entry*> garbage;
+    {
+        std::lock_guard<std::mutex> lock{retired_mutex_};
+        if (retired_.empty() || (!force && retired_.size() < reclaim_batch))
+            return;
+        garbage.swap(retired_);
+    }
+
+    // finds starting from now on announce the next epoch and can't reach
+    // the garbage, so it is free once the finds of this epoch are done;
+    // those of the epoch before it were waited for by the last reclaim
+    std::lock_guard<std::mutex> lock{reclaim_mutex_};
+    auto epoch = epoch_.fetch_add(1);
+    for (uint64_t i = 0; i < num_reader_stripes; ++i)
+    {
+        while (readers_[i].active[epoch & 1].load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+    for (auto contents : garbage)
+        delete contents;
+}
+}
+}
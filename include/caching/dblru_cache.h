@@ -17,9 +17,14 @@
 #include "util/shim.h"
 #endif
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include "caching/cache_stats.h"
+#include "caching/entry_size.h"
+#include "caching/frequency_sketch.h"
 #include "caching/maps/locking_map.h"
+#include "caching/memory_budget.h"
 #include "util/optional.h"
 
 namespace meta
@@ -39,6 +44,12 @@ namespace caching
  * emptied and swapped with the primary. This ensures that things that have
  * been less recently used are dropped.
  *
+ * With a memory_budget, the primary is also swapped out once its entries
+ * use half of the budget, so that both maps together stay within it;
+ * entries larger than half of the budget are never inserted. The cache
+ * cannot tell which entries a swap will drop, so admission requires a
+ * key to have been looked up more than once before it is inserted.
+ *
  * It is assumed that the Maps are internally synchronized (i.e., they
  * contain a mutex or have some other way of guaranteeing concurrency
  * safety).
@@ -53,8 +64,9 @@ class dblru_cache
     /**
      * Constructs a dlbru_cache with a given fixed size.
      * @param max_size the maximum allowed size for this cache
+     * @param budget the limit on the memory used by the entries
      */
-    dblru_cache(uint64_t max_size);
+    dblru_cache(uint64_t max_size, memory_budget budget = memory_budget{});
 
     /**
      * dblru_cache may be move constructed.
@@ -104,15 +116,31 @@ class dblru_cache
      */
     util::optional<Value> find(const Key& key);
 
+    /**
+     * @return the hits, misses, evictions and rejections of the cache;
+     * the entries dropped with the secondary map count as evictions
+     */
+    cache_stats stats() const;
+
     /** Empties the cache. */
     void clear();
 
   private:
     /**
      * Helper function to ensure that the primary and secondary map
-     * swapping occurs at the correct moment.
+     * swapping occurs at the correct moment. It is called before an entry
+     * is inserted into the primary map, so that an entry which does not
+     * fit goes into the new primary map.
+     * @param bytes The number of bytes charged for the inserted entry
      */
-    void handle_insert();
+    void handle_insert(uint64_t bytes);
+
+    /**
+     * @param used The number of bytes used by the primary map
+     * @return whether the primary map uses more than its half of the
+     * memory budget
+     */
+    bool over_budget(uint64_t used) const;
 
     /**
      * Gets the primary map.
@@ -129,14 +157,22 @@ class dblru_cache
      */
     uint64_t max_size_;
 
+    /**
+     * The limit on the memory used by the entries.
+     */
+    memory_budget budget_;
+
 /**
- * The current size of the primary map.
+ * The current size of the primary map, and the bytes used by its entries.
  */
 #if META_HAS_STD_SHARED_PTR_ATOMICS
     /// the current size of the map
     std::atomic<uint64_t> current_size_;
+    /// the bytes used by the entries of the map
+    std::atomic<uint64_t> current_bytes_;
 #else
     uint64_t current_size_;
+    uint64_t current_bytes_;
     std::unique_ptr<std::mutex> mutables_{make_unique<std::mutex>()};
 #endif
 
@@ -149,6 +185,16 @@ class dblru_cache
      * The secondary map.
      */
     std::shared_ptr<Map<Key, Value>> secondary_;
+
+    /**
+     * How often keys are looked up, if inserts must pass admission.
+     */
+    std::unique_ptr<frequency_sketch<Key>> sketch_;
+
+    /**
+     * The hits, misses, evictions and rejections of the cache.
+     */
+    cache_counters counters_;
 };
 
 /**
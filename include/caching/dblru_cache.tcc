@@ -10,22 +10,30 @@ namespace caching
 {
 
 template <class Key, class Value, template <class, class> class Map>
-dblru_cache<Key, Value, Map>::dblru_cache(uint64_t max_size)
+dblru_cache<Key, Value, Map>::dblru_cache(uint64_t max_size,
+                                          memory_budget budget)
     : max_size_{max_size},
+      budget_(budget),
       current_size_{0},
+      current_bytes_{0},
       primary_{std::make_shared<Map<Key, Value>>()},
       secondary_{std::make_shared<Map<Key, Value>>()}
 {
-    /* nothing */
+    if (budget_.admission)
+        sketch_.reset(new frequency_sketch<Key>{max_size});
 }
 
 #if META_HAS_STD_SHARED_PTR_ATOMICS
 template <class Key, class Value, template <class, class> class Map>
 dblru_cache<Key, Value, Map>::dblru_cache(dblru_cache&& other)
     : max_size_{std::move(other.max_size_)},
+      budget_(other.budget_),
       current_size_{other.current_size_.load()},
+      current_bytes_{other.current_bytes_.load()},
       primary_{std::atomic_load(&other.primary_)},
-      secondary_{std::atomic_load(&other.secondary_)}
+      secondary_{std::atomic_load(&other.secondary_)},
+      sketch_{std::move(other.sketch_)},
+      counters_{std::move(other.counters_)}
 {
     /* nothing */
 }
@@ -33,7 +41,11 @@ dblru_cache<Key, Value, Map>::dblru_cache(dblru_cache&& other)
 template <class Key, class Value, template <class, class> class Map>
 dblru_cache<Key, Value, Map>::dblru_cache(dblru_cache&& other)
     : max_size_{std::move(other.max_size_)},
-      current_size_{std::move(other.current_size_)}
+      budget_(other.budget_),
+      current_size_{std::move(other.current_size_)},
+      current_bytes_{std::move(other.current_bytes_)},
+      sketch_{std::move(other.sketch_)},
+      counters_{std::move(other.counters_)}
 {
     std::lock_guard<std::mutex> lock{*other.mutables_};
     primary_ = std::move(other.primary_);
@@ -54,9 +66,13 @@ template <class Key, class Value, template <class, class> class Map>
 void dblru_cache<Key, Value, Map>::swap(dblru_cache& other)
 {
     std::swap(max_size_, other.max_size_);
+    std::swap(budget_, other.budget_);
     current_size_.store(other.current_size_.exchange(current_size_.load()));
+    current_bytes_.store(other.current_bytes_.exchange(current_bytes_.load()));
     std::atomic_exchange(&primary_, other.primary_);
     std::atomic_exchange(&secondary_, other.secondary_);
+    std::swap(sketch_, other.sketch_);
+    std::swap(counters_, other.counters_);
 }
 #else
 template <class Key, class Value, template <class, class> class Map>
@@ -65,9 +81,13 @@ void dblru_cache<Key, Value, Map>::swap(dblru_cache& other)
     std::lock_guard<std::mutex> other_lock{*other.mutables_};
     std::lock_guard<std::mutex> lock{*mutables_};
     std::swap(max_size_, other.max_size_);
+    std::swap(budget_, other.budget_);
     std::swap(current_size_, other.current_size_);
+    std::swap(current_bytes_, other.current_bytes_);
     std::swap(primary_, other.primary_);
     std::swap(secondary_, other.secondary_);
+    std::swap(sketch_, other.sketch_);
+    std::swap(counters_, other.counters_);
 }
 #endif
 
@@ -98,70 +118,113 @@ dblru_cache<Key, Value, Map>::get_secondary_map() const
 template <class Key, class Value, template <class, class> class Map>
 void dblru_cache<Key, Value, Map>::insert(const Key& key, const Value& value)
 {
+    auto bytes = entry_size<Key>{}(key) + entry_size<Value>{}(value);
+    if (over_budget(bytes) || (sketch_ && sketch_->frequency(key) <= 1))
+    {
+        counters_.reject();
+        return;
+    }
+
+    handle_insert(bytes);
     auto map = get_primary_map();
     map->insert(key, value);
-    handle_insert();
 }
 
 template <class Key, class Value, template <class, class> class Map>
 template <class... Args>
 void dblru_cache<Key, Value, Map>::emplace(Args&&... args)
 {
-    auto map = get_primary_map();
-    map->emplace(std::forward<Args...>(args...));
-    handle_insert();
+    // the pair is needed to charge the entry for its bytes
+    std::pair<Key, Value> kv(std::forward<Args>(args)...);
+    insert(kv.first, kv.second);
 }
 
 template <class Key, class Value, template <class, class> class Map>
 util::optional<Value> dblru_cache<Key, Value, Map>::find(const Key& key)
 {
+    if (sketch_)
+        sketch_->increment(key);
+
     auto primary = get_primary_map();
     auto opt = primary->find(key);
     if (opt)
+    {
+        counters_.hit();
         return opt;
+    }
     auto secondary = get_secondary_map();
     opt = secondary->find(key);
     if (opt)
     {
-        primary->insert(key, *opt);
-        handle_insert();
+        counters_.hit();
+        handle_insert(entry_size<Key>{}(key) + entry_size<Value>{}(*opt));
+        get_primary_map()->insert(key, *opt);
+    }
+    else
+    {
+        counters_.miss();
     }
     return opt;
 }
 
+template <class Key, class Value, template <class, class> class Map>
+cache_stats dblru_cache<Key, Value, Map>::stats() const
+{
+    return counters_.stats();
+}
+
+template <class Key, class Value, template <class, class> class Map>
+bool dblru_cache<Key, Value, Map>::over_budget(uint64_t used) const
+{
+    return budget_.max_bytes != 0 && used > budget_.max_bytes / 2;
+}
+
 #if META_HAS_STD_SHARED_PTR_ATOMICS
 template <class Key, class Value, template <class, class> class Map>
-void dblru_cache<Key, Value, Map>::handle_insert()
+void dblru_cache<Key, Value, Map>::handle_insert(uint64_t bytes)
 {
-    if (current_size_.fetch_add(1) == max_size_)
+    // only the insert that first crosses the budget swaps the maps
+    auto used = current_bytes_.fetch_add(bytes);
+    bool full = !over_budget(used) && over_budget(used + bytes);
+    if (current_size_.fetch_add(1) == max_size_ || full)
     {
         auto secondary = std::atomic_load(&secondary_);
         // leaves primary_ empty, with secondary_ containing what used to
         // be in primary_
         std::atomic_exchange(&secondary_, primary_);
         std::atomic_store(&primary_, std::make_shared<Map<Key, Value>>());
-        // reset counter
-        current_size_.store(0);
+        // reset counters, which now count the entry being inserted
+        current_size_.store(1);
+        current_bytes_.store(bytes);
+        counters_.evict(secondary->size());
     }
 }
 #else
 template <class Key, class Value, template <class, class> class Map>
-void dblru_cache<Key, Value, Map>::handle_insert()
+void dblru_cache<Key, Value, Map>::handle_insert(uint64_t bytes)
 {
     std::shared_ptr<Map<Key, Value>> old_secondary;
     {
         std::lock_guard<std::mutex> lock{*mutables_};
-        if (++current_size_ == max_size_)
+        if (++current_size_ > max_size_
+            || over_budget(current_bytes_ + bytes))
         {
             // leaves primary_ empty, with secondary_ containing what used to
             // be in primary_
             old_secondary = secondary_;
             std::swap(secondary_, primary_);
             primary_ = std::make_shared<Map<Key, Value>>();
-            // reset counter
-            current_size_ = 0;
+            // reset counters, which now count the entry being inserted
+            current_size_ = 1;
+            current_bytes_ = bytes;
+        }
+        else
+        {
+            current_bytes_ += bytes;
         }
     }
+    if (old_secondary)
+        counters_.evict(old_secondary->size());
 }
 #endif
 
@@ -174,6 +237,7 @@ void dblru_cache<Key, Value, Map>::clear()
     std::atomic_exchange(&secondary_, std::make_shared<Map<Key, Value>>());
     std::atomic_exchange(&primary_, std::make_shared<Map<Key, Value>>());
     current_size_.store(0);
+    current_bytes_.store(0);
 #else
     std::shared_ptr<Map<Key, Value>> primary;
     std::shared_ptr<Map<Key, Value>> secondary;
@@ -184,6 +248,7 @@ void dblru_cache<Key, Value, Map>::clear()
         primary_ = std::make_shared<Map<Key, Value>>();
         secondary_ = std::make_shared<Map<Key, Value>>();
         current_size_ = 0;
+        current_bytes_ = 0;
     }
 #endif
 }
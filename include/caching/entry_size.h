@@ -0,0 +1,98 @@
+/**
+ * @file entry_size.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_ENTRY_SIZE_H_
+#define META_ENTRY_SIZE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * Computes the number of bytes of memory a key or value held by a cache
+ * uses. The default is the size of the object itself; objects with a
+ * bytes_used() member function add what it returns, so that a cached
+ * postings_data is charged for its postings.
+ *
+ * Specialize this for other types that own memory outside of themselves.
+ */
+template <class T, class = void>
+struct entry_size
+{
+    /**
+     * @return the number of bytes used by the object
+     */
+    uint64_t operator()(const T&) const
+    {
+        return sizeof(T);
+    }
+};
+
+/**
+ * Charges objects with a bytes_used() member function for what it
+ * returns.
+ */
+template <class T>
+struct entry_size<T, decltype(void(std::declval<const T&>().bytes_used()))>
+{
+    /**
+     * @param obj The object to measure
+     * @return the number of bytes used by the object
+     */
+    uint64_t operator()(const T& obj) const
+    {
+        return sizeof(T) + obj.bytes_used();
+    }
+};
+
+/**
+ * Charges a std::shared_ptr for the object it points to.
+ */
+template <class T>
+struct entry_size<std::shared_ptr<T>>
+{
+    /**
+     * @param ptr The pointer to measure
+     * @return the number of bytes used by the pointer and its object
+     */
+    uint64_t operator()(const std::shared_ptr<T>& ptr) const
+    {
+        if (!ptr)
+            return sizeof(ptr);
+        return sizeof(ptr) + entry_size<typename std::remove_const<T>::type>{}(
+                                 *ptr);
+    }
+};
+
+/**
+ * Charges a std::string for its characters.
+ */
+template <>
+struct entry_size<std::string>
+{
+    /**
+     * @param str The string to measure
+     * @return the number of bytes used by the string
+     */
+    uint64_t operator()(const std::string& str) const
+    {
+        return sizeof(str) + str.capacity();
+    }
+};
+}
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file frequency_sketch.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_FREQUENCY_SKETCH_H_
+#define META_FREQUENCY_SKETCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * Estimates how often keys have been seen recently, in a fixed amount of
+ * memory, for the admission policy of caches with a memory_budget.
+ *
+ * This is a count-min sketch: every key increments one small saturating
+ * counter in each of a few rows, and its estimate is the smallest of
+ * them. Once ten times as many keys have been counted as there are
+ * counters in a row, every counter is halved, so keys that were popular
+ * long ago are forgotten (the TinyLFU reset).
+ *
+ * The sketch may be used from several threads at once; concurrent
+ * increments may occasionally be lost, which only makes the estimates a
+ * little less precise.
+ */
+template <class Key>
+class frequency_sketch
+{
+  public:
+    /// The number of rows of counters
+    const static constexpr uint64_t depth = 4;
+
+    /// The largest value a counter reaches
+    const static constexpr uint8_t max_count = 15;
+
+    /**
+     * @param expected_keys The number of distinct keys expected to be
+     * counted at once, such as the number of entries in the cache
+     */
+    frequency_sketch(uint64_t expected_keys);
+
+    /**
+     * Counts a key.
+     * @param key The key to count
+     */
+    void increment(const Key& key);
+
+    /**
+     * @param key The key to estimate the count of
+     * @return about how many times the key has been counted recently, at
+     * most max_count
+     */
+    uint64_t frequency(const Key& key) const;
+
+  private:
+    /**
+     * @param hash The hash of a key
+     * @param row A row of counters
+     * @return the position of the key's counter in the row
+     */
+    uint64_t index(uint64_t hash, uint64_t row) const;
+
+    /**
+     * Halves every counter.
+     */
+    void age();
+
+    /// the counters of every row, one row after another
+    std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+
+    /// the number of counters in a row, minus one, for masking hashes
+    uint64_t mask_;
+
+    /// the number of keys counted since the counters were last halved
+    std::atomic<uint64_t> additions_;
+
+    /// the number of keys counted between halvings
+    uint64_t sample_size_;
+
+    /// keeps the counters from being halved twice at once
+    std::mutex aging_mutex_;
+
+    /// the hash function for keys
+    std::hash<Key> hasher_;
+};
+}
+}
+
+#include "caching/frequency_sketch.tcc"
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file frequency_sketch.tcc
+ * @author agent
+ */
+
+#include <algorithm>
+
+#include "caching/frequency_sketch.h"
+
+namespace meta
+{
+namespace caching
+{
+
+template <class Key>
+frequency_sketch<Key>::frequency_sketch(uint64_t expected_keys)
+    : additions_{0}
+{
+    // small caches still see many distinct keys go by, so the rows are
+    // never so narrow that one-off keys collide with each other much
+    uint64_t width = 1024;
+    while (width < expected_keys)
+        width *= 2;
+    mask_ = width - 1;
+    sample_size_ = 10 * width;
+
+    counters_.reset(new std::atomic<uint8_t>[depth * width]);
+    for (uint64_t i = 0; i < depth * width; ++i)
+        counters_[i].store(0, std::memory_order_relaxed);
+}
+
+template <class Key>
+void frequency_sketch<Key>::increment(const Key& key)
+{
+    uint64_t hash = hasher_(key);
+    for (uint64_t row = 0; row < depth; ++row)
+    {
+        auto& counter = counters_[index(hash, row)];
+        auto count = counter.load(std::memory_order_relaxed);
+        if (count < max_count)
+            counter.store(count + 1, std::memory_order_relaxed);
+    }
+
+    if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 >= sample_size_)
+        age();
+}
+
+template <class Key>
+uint64_t frequency_sketch<Key>::frequency(const Key& key) const
+{
+    uint64_t hash = hasher_(key);
+    uint64_t count = max_count;
+    for (uint64_t row = 0; row < depth; ++row)
+    {
+        uint64_t row_count
+            = counters_[index(hash, row)].load(std::memory_order_relaxed);
+        count = std::min(count, row_count);
+    }
+    return count;
+}
+
+template <class Key>
+uint64_t frequency_sketch<Key>::index(uint64_t hash, uint64_t row) const
+{
+    // each row rehashes with the splitmix64 finalizer
+    uint64_t z = hash + (row + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return row * (mask_ + 1) + (z & mask_);
+}
+
+template <class Key>
+void frequency_sketch<Key>::age()
+{
+    std::unique_lock<std::mutex> lock{aging_mutex_, std::try_to_lock};
+    if (!lock || additions_.load() < sample_size_)
+        return;
+
+    for (uint64_t i = 0; i < depth * (mask_ + 1); ++i)
+    {
+        auto count = counters_[i].load(std::memory_order_relaxed);
+        counters_[i].store(count / 2, std::memory_order_relaxed);
+    }
+    additions_.store(0);
+}
+}
+}
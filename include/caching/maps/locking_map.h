@@ -75,6 +75,11 @@ class locking_map
      */
     util::optional<Value> find(const Key& key) const;
 
+    /**
+     * @return the number of (key, value) pairs in the map
+     */
+    uint64_t size() const;
+
     /// iterator type for locking_maps
     using iterator = typename std::unordered_map<Key, Value>::iterator;
     /// const_iterator type for locking_maps
@@ -53,6 +53,13 @@ util::optional<Value> locking_map<Key, Value>::find(const Key& key) const
     return {it->second};
 }
 
+template <class Key, class Value>
+uint64_t locking_map<Key, Value>::size() const
+{
+    std::lock_guard<std::mutex> lock{mutables_};
+    return map_.size();
+}
+
 template <class Key, class Value>
 auto locking_map<Key, Value>::begin() -> iterator
 {
@@ -0,0 +1,65 @@
+/**
+ * @file memory_budget.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_MEMORY_BUDGET_H_
+#define META_MEMORY_BUDGET_H_
+
+#include <cstdint>
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * Limits on the memory a cache may use, in addition to its limit on the
+ * number of entries. Entries are charged for their keys and values as
+ * computed by entry_size.
+ *
+ * With admission enabled, the cache counts how often every key is looked
+ * up in a frequency_sketch, and an insert that would evict an entry is
+ * only allowed when its key has been looked up more often than the key
+ * it would evict; caches that cannot tell which entry they would evict
+ * instead require the key to have been looked up more than once. A large
+ * value looked up just once then cannot push out small values that are
+ * looked up all the time.
+ */
+struct memory_budget
+{
+    /// the number of bytes the entries may use in total, or 0 for no limit
+    uint64_t max_bytes = 0;
+
+    /// whether inserts must pass the admission policy
+    bool admission = false;
+
+    /**
+     * @param bytes The number of bytes the entries may use in total, or 0
+     * for no limit
+     * @param admit Whether inserts must pass the admission policy
+     */
+    memory_budget(uint64_t bytes = 0, bool admit = false)
+        : max_bytes{bytes}, admission{admit}
+    {
+        // nothing
+    }
+
+    /**
+     * @param bytes The number of bytes charged for an entry
+     * @param used The number of bytes used by the other entries
+     * @return whether the entry fits in the budget with the others
+     */
+    bool fits(uint64_t bytes, uint64_t used) const
+    {
+        return max_bytes == 0 || used + bytes <= max_bytes;
+    }
+};
+}
+}
+
+#endif
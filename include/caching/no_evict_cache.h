@@ -14,6 +14,9 @@
 #include <memory>
 #include <mutex>
 
+#include "caching/cache_stats.h"
+#include "caching/entry_size.h"
+#include "caching/memory_budget.h"
 #include "meta.h"
 #include "util/optional.h"
 #include "util/shim.h"
@@ -27,6 +30,10 @@ namespace caching
  * An incredibly simple "cache" that simply keeps everything in memory.
  * Useful for when the dataset is small enough that we have enough RAM to
  * fit it in-core.
+ *
+ * With a memory_budget, inserts that would take the entries over the
+ * budget are turned away, since nothing is ever evicted to make room.
+ * The admission policy does not apply.
  */
 template <class Key, class Value>
 class no_evict_cache
@@ -36,6 +43,11 @@ class no_evict_cache
                    || std::is_base_of<util::numeric, Key>::value),
                   "Key for no_evict_cache must be a numeric type");
 
+    /**
+     * @param budget The limit on the memory used by the entries
+     */
+    no_evict_cache(memory_budget budget = memory_budget{});
+
     /**
      * Inserts the given key, value pair into the cache. May be slow
      * while the cache is initially populated as it needs to resize the
@@ -52,6 +64,16 @@ class no_evict_cache
      */
     util::optional<Value> find(const Key& key) const;
 
+    /**
+     * @return the number of bytes used by the keys and values in the cache
+     */
+    uint64_t bytes_used() const;
+
+    /**
+     * @return the hits, misses, evictions and rejections of the cache
+     */
+    cache_stats stats() const;
+
     /**
      * Clears the cache.
      */
@@ -67,6 +89,21 @@ class no_evict_cache
      * Contains all of the values inserted thus far. Never shrinks.
      */
     std::deque<util::optional<Value>> values_;
+
+    /**
+     * The number of bytes used by the keys and values in the cache.
+     */
+    uint64_t bytes_ = 0;
+
+    /**
+     * The limit on the memory used by the entries.
+     */
+    memory_budget budget_;
+
+    /**
+     * The hits, misses, evictions and rejections of the cache.
+     */
+    mutable cache_counters counters_;
 };
 }
 }
@@ -5,27 +5,63 @@ namespace meta
 namespace caching
 {
 
+template <class Key, class Value>
+no_evict_cache<Key, Value>::no_evict_cache(memory_budget budget)
+    : budget_(budget)
+{
+    /* nothing */
+}
+
 template <class Key, class Value>
 void no_evict_cache<Key, Value>::insert(const Key& key, const Value& value)
 {
+    auto bytes = entry_size<Key>{}(key) + entry_size<Value>{}(value);
     std::lock_guard<std::mutex> lock{*mutables_};
+    uint64_t replaced = 0;
+    if (key < values_.size() && values_[key])
+        replaced = entry_size<Key>{}(key) + entry_size<Value>{}(*values_[key]);
+    if (!budget_.fits(bytes, bytes_ - replaced))
+    {
+        counters_.reject();
+        return;
+    }
+
     if (key >= values_.size())
         values_.resize(key + 1);
     values_[key] = util::optional<Value>{value};
+    bytes_ -= replaced;
+    bytes_ += bytes;
 }
 
 template <class Key, class Value>
 util::optional<Value> no_evict_cache<Key, Value>::find(const Key& key) const
 {
-    if (key >= values_.size())
+    if (key >= values_.size() || !values_[key])
+    {
+        counters_.miss();
         return util::nullopt;
+    }
+    counters_.hit();
     return values_[key];
 }
 
+template <class Key, class Value>
+uint64_t no_evict_cache<Key, Value>::bytes_used() const
+{
+    return bytes_;
+}
+
+template <class Key, class Value>
+cache_stats no_evict_cache<Key, Value>::stats() const
+{
+    return counters_.stats();
+}
+
 template <class Key, class Value>
 void no_evict_cache<Key, Value>::clear()
 {
     values_.clear();
+    bytes_ = 0;
 }
 }
 }
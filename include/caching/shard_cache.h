@@ -13,6 +13,7 @@
 #include <mutex>
 #include <vector>
 
+#include "caching/cache_stats.h"
 #include "caching/dblru_cache.h"
 #include "caching/splay_cache.h"
 #include "util/optional.h"
@@ -27,6 +28,9 @@ namespace caching
  * cache. Wraps a given number of Maps, each used to contain a segment of
  * the keyspace. It is assumed that the Map class is self-synchronizing
  * (i.e., it has a mutex or other concurrency safety mechanism built in).
+ *
+ * Every shard gets the same constructor arguments, so a memory_budget
+ * passed to the shard cache limits each shard rather than all of them.
  */
 template <class Key, class Value, template <class, class> class Map>
 class generic_shard_cache
@@ -74,6 +78,17 @@ class generic_shard_cache
      */
     util::optional<Value> find(const Key& key);
 
+    /**
+     * @return the hits, misses, evictions and rejections of all of the
+     * shards together
+     */
+    cache_stats stats() const;
+
+    /**
+     * Empties every shard of the cache.
+     */
+    void clear();
+
   private:
     /**
      * The Map for each shard.
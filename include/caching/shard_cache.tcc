@@ -32,5 +32,21 @@ util::optional<Value> generic_shard_cache<Key, Value, Map>::find(const Key& key)
     auto shard = hasher_(key) % shards_.size();
     return shards_[shard].find(key);
 }
+
+template <class Key, class Value, template <class, class> class Map>
+cache_stats generic_shard_cache<Key, Value, Map>::stats() const
+{
+    cache_stats stats;
+    for (const auto& shard : shards_)
+        stats += shard.stats();
+    return stats;
+}
+
+template <class Key, class Value, template <class, class> class Map>
+void generic_shard_cache<Key, Value, Map>::clear()
+{
+    for (auto& shard : shards_)
+        shard.clear();
+}
 }
 }
@@ -10,10 +10,15 @@
 #ifndef META_SPLAY_CACHE_H_
 #define META_SPLAY_CACHE_H_
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <vector>
 
+#include "caching/cache_stats.h"
+#include "caching/entry_size.h"
+#include "caching/frequency_sketch.h"
+#include "caching/memory_budget.h"
 #include "meta.h"
 #include "util/optional.h"
 
@@ -24,6 +29,13 @@ namespace caching
 
 /**
  * A splay_cache is a fixed-size splay tree for cache operations.
+ *
+ * Once the tree is full, an insert replaces the leaf its search ends at,
+ * which has not been splayed toward the root in a while. With a
+ * memory_budget, leaves are also removed after an insert until the
+ * entries fit in the budget again. Admission compares a key with the key
+ * of the leaf it would replace, and requires it to have been looked up
+ * before when its bytes would force removals.
  */
 template <class Key, class Value>
 class splay_cache
@@ -35,8 +47,10 @@ class splay_cache
      *
      * @param max_size The maximum number of nodes that will be in the splay
      * tree
+     * @param budget The limit on the memory used by the entries
      */
-    splay_cache(uint64_t max_size = std::numeric_limits<uint64_t>::max());
+    splay_cache(uint64_t max_size = std::numeric_limits<uint64_t>::max(),
+                memory_budget budget = memory_budget{});
 
     /**
      * splay_cache can be move constructed
@@ -74,6 +88,16 @@ class splay_cache
      */
     uint64_t size() const;
 
+    /**
+     * @return the number of bytes used by the keys and values in the cache
+     */
+    uint64_t bytes_used() const;
+
+    /**
+     * @return the hits, misses, evictions and rejections of the cache
+     */
+    cache_stats stats() const;
+
     /**
      * Empties the cache.
      */
@@ -100,14 +124,21 @@ class splay_cache
         Key key;
         /// the value
         Value value;
+        /// the number of bytes charged for the key and value
+        uint64_t bytes;
 
         /**
          * Constructs a new leaf node with the given key and value pair
          * @param new_key The desired key
          * @param new_value The desired value
+         * @param new_bytes The number of bytes charged for the pair
          */
-        node(const Key& new_key, const Value& new_value)
-            : left(nullptr), right(nullptr), key(new_key), value(new_value)
+        node(const Key& new_key, const Value& new_value, uint64_t new_bytes)
+            : left(nullptr),
+              right(nullptr),
+              key(new_key),
+              value(new_value),
+              bytes(new_bytes)
         {
             /* nothing */
         }
@@ -117,10 +148,18 @@ class splay_cache
     uint64_t size_;
     /// the maximum allowed size for the cache
     uint64_t max_size_;
+    /// the number of bytes used by the keys and values in the cache
+    uint64_t bytes_;
+    /// the limit on the memory used by the entries
+    memory_budget budget_;
     /// the root of the tree
     node* root_;
     /// the mutex that synchronizes access to the cache
     mutable std::mutex mutables_;
+    /// how often keys are looked up, if inserts must pass admission
+    std::unique_ptr<frequency_sketch<Key>> sketch_;
+    /// the hits, misses, evictions and rejections of the cache
+    cache_counters counters_;
 
     /**
      * Deletes everything at this subroot and below.
@@ -134,18 +173,36 @@ class splay_cache
      * @param subroot The root of the subtree to insert into
      * @param key
      * @param value
+     * @param bytes The number of bytes charged for the key and value
      */
-    void insert(node*& subroot, const Key& key, const Value& value);
+    void insert(node*& subroot, const Key& key, const Value& value,
+                uint64_t bytes);
 
     /**
      * Replaces the key, value pair contained in the node pointed to by
-     * subroot with the given key, value pair.
+     * subroot with the given key, value pair, if the admission policy
+     * lets it in.
      *
      * @param subroot
      * @param key
      * @param value
+     * @param bytes The number of bytes charged for the key and value
+     */
+    void replace(node* subroot, const Key& key, const Value& value,
+                 uint64_t bytes);
+
+    /**
+     * Removes a leaf below the root, for making room in the memory budget.
+     * The walk down zigzags so that it ends at a deep leaf.
+     */
+    void remove_leaf();
+
+    /**
+     * @param key The key of an entry to be inserted
+     * @param victim The key of the entry it would replace, if known
+     * @return whether the admission policy lets the entry in
      */
-    void replace(node* subroot, const Key& key, const Value& value);
+    bool admit(const Key& key, const Key* victim) const;
 
     /**
      * "Finds" the given key in the tree rooted at subroot. This function
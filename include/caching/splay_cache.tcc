@@ -10,19 +10,27 @@ namespace caching
 {
 
 template <class Key, class Value>
-splay_cache<Key, Value>::splay_cache(uint64_t max_size)
-    : size_{0}, max_size_(max_size), root_(nullptr)
+splay_cache<Key, Value>::splay_cache(uint64_t max_size, memory_budget budget)
+    : size_{0}, max_size_(max_size), bytes_{0}, budget_(budget), root_(nullptr)
 {
-    /* nothing */
+    if (budget_.admission)
+        sketch_.reset(new frequency_sketch<Key>{
+            std::min<uint64_t>(max_size_, uint64_t{1} << 20)});
 }
 
 template <class Key, class Value>
 splay_cache<Key, Value>::splay_cache(splay_cache&& other)
     : size_{std::move(other.size_)},
       max_size_{std::move(other.max_size_)},
-      root_{std::move(other.root_)}
+      bytes_{std::move(other.bytes_)},
+      budget_(other.budget_),
+      root_{std::move(other.root_)},
+      sketch_{std::move(other.sketch_)},
+      counters_{std::move(other.counters_)}
 {
-    /* nothing */
+    other.root_ = nullptr;
+    other.size_ = 0;
+    other.bytes_ = 0;
 }
 
 template <class Key, class Value>
@@ -30,9 +38,17 @@ splay_cache<Key, Value>& splay_cache<Key, Value>::operator=(splay_cache&& rhs)
 {
     if (this != &rhs)
     {
+        clear(root_);
         size_ = std::move(rhs.size_);
         max_size_ = std::move(rhs.max_size_);
+        bytes_ = std::move(rhs.bytes_);
+        budget_ = rhs.budget_;
         root_ = std::move(rhs.root_);
+        sketch_ = std::move(rhs.sketch_);
+        counters_ = std::move(rhs.counters_);
+        rhs.root_ = nullptr;
+        rhs.size_ = 0;
+        rhs.bytes_ = 0;
     }
     return *this;
 }
@@ -46,28 +62,40 @@ splay_cache<Key, Value>::~splay_cache()
 template <class Key, class Value>
 void splay_cache<Key, Value>::insert(const Key& key, const Value& value)
 {
+    auto bytes = entry_size<Key>{}(key) + entry_size<Value>{}(value);
     std::lock_guard<std::mutex> lock{mutables_};
-    insert(root_, key, value);
+    if (!budget_.fits(bytes, 0)
+        || (!budget_.fits(bytes, bytes_) && !admit(key, nullptr)))
+    {
+        counters_.reject();
+        return;
+    }
+
+    insert(root_, key, value, bytes);
+    while (!budget_.fits(0, bytes_) && root_
+           && (root_->left || root_->right))
+        remove_leaf();
 }
 
 template <class Key, class Value>
-void splay_cache
-    <Key, Value>::insert(node*& subroot, const Key& key, const Value& value)
+void splay_cache<Key, Value>::insert(node*& subroot, const Key& key,
+                                     const Value& value, uint64_t bytes)
 {
     if (subroot == nullptr)
     {
-        subroot = new node{key, value};
+        subroot = new node{key, value, bytes};
         ++size_;
+        bytes_ += bytes;
     }
     else if (key < subroot->key)
     {
         if (size_ == max_size_ && !subroot->left)
         {
-            replace(subroot, key, value);
+            replace(subroot, key, value, bytes);
         }
         else
         {
-            insert(subroot->left, key, value);
+            insert(subroot->left, key, value, bytes);
             rotate_right(subroot);
         }
     }
@@ -75,38 +103,88 @@ void splay_cache
     {
         if (size_ == max_size_ && !subroot->right)
         {
-            replace(subroot, key, value);
+            replace(subroot, key, value, bytes);
         }
         else
         {
-            insert(subroot->right, key, value);
+            insert(subroot->right, key, value, bytes);
             rotate_left(subroot);
         }
     }
     else if (key == subroot->key)
     {
+        bytes_ -= subroot->bytes;
+        bytes_ += bytes;
         subroot->value = value;
+        subroot->bytes = bytes;
     }
 }
 
 template <class Key, class Value>
-void splay_cache
-    <Key, Value>::replace(node* subroot, const Key& key, const Value& value)
+void splay_cache<Key, Value>::replace(node* subroot, const Key& key,
+                                      const Value& value, uint64_t bytes)
 {
+    if (!admit(key, &subroot->key))
+    {
+        counters_.reject();
+        return;
+    }
+    counters_.evict();
+    bytes_ -= subroot->bytes;
+    bytes_ += bytes;
     subroot->key = key;
     subroot->value = value;
+    subroot->bytes = bytes;
+}
+
+template <class Key, class Value>
+void splay_cache<Key, Value>::remove_leaf()
+{
+    node** parent = &root_;
+    bool go_left = true;
+    while ((*parent)->left || (*parent)->right)
+    {
+        auto current = *parent;
+        if ((go_left && current->left) || !current->right)
+            parent = &current->left;
+        else
+            parent = &current->right;
+        go_left = !go_left;
+    }
+
+    --size_;
+    bytes_ -= (*parent)->bytes;
+    counters_.evict();
+    delete *parent;
+    *parent = nullptr;
+}
+
+template <class Key, class Value>
+bool splay_cache<Key, Value>::admit(const Key& key, const Key* victim) const
+{
+    if (!sketch_)
+        return true;
+    if (victim)
+        return sketch_->frequency(key) > sketch_->frequency(*victim);
+    return sketch_->frequency(key) > 1;
 }
 
 template <class Key, class Value>
 util::optional<Value> splay_cache<Key, Value>::find(const Key& key)
 {
     std::lock_guard<std::mutex> lock{mutables_};
+    if (sketch_)
+        sketch_->increment(key);
     if (root_ != nullptr)
     {
         find(root_, key);
         if (root_->key == key)
+        {
+            counters_.hit();
             return {root_->value};
+        }
     }
+    counters_.miss();
     return {util::nullopt};
 }
 
@@ -171,11 +249,25 @@ uint64_t splay_cache<Key, Value>::size() const
     return size_;
 }
 
+template <class Key, class Value>
+uint64_t splay_cache<Key, Value>::bytes_used() const
+{
+    return bytes_;
+}
+
+template <class Key, class Value>
+cache_stats splay_cache<Key, Value>::stats() const
+{
+    return counters_.stats();
+}
+
 template <class Key, class Value>
 void splay_cache<Key, Value>::clear()
 {
     std::lock_guard<std::mutex> lock{mutables_};
     clear(root_);
+    size_ = 0;
+    bytes_ = 0;
 }
 }
 }
@@ -0,0 +1,37 @@
+/**
+ * @file thread_stripe.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_THREAD_STRIPE_H_
+#define META_THREAD_STRIPE_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace meta
+{
+namespace caching
+{
+
+/**
+ * Numbers threads in the order they first call this, so that counters
+ * updated by many threads at once can be spread over several stripes,
+ * each written by only a few of the threads.
+ * @return the number of the calling thread
+ */
+inline uint64_t thread_stripe()
+{
+    static std::atomic<uint64_t> next{0};
+    static thread_local uint64_t stripe
+        = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+}
+}
+
+#endif
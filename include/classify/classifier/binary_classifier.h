@@ -63,6 +63,12 @@ class binary_classifier : public classifier
      */
     const class_label& negative_label() const;
 
+    /**
+     * @return the number of threads train() runs on, which is one unless
+     * the classifier parallelizes its own training
+     */
+    virtual size_t num_training_threads() const;
+
   private:
     /**
      * The label that marks positive examples
@@ -21,6 +21,11 @@ namespace classify
 /**
  * Generalizes binary classifiers to operate over multiclass types using the
  * one vs all method.
+ *
+ * Labels are trained in parallel, one thread each, unless the binary
+ * classifiers train on several threads of their own (such as sgd with
+ * Hogwild training), in which case labels are trained one at a time and
+ * each gets all of its classifier's threads.
  */
 class one_vs_all : public classifier
 {
@@ -24,6 +24,17 @@ namespace classify
  * Implements stochastic gradient descent for learning binary linear
  * classifiers. These may be extended to multiclass classification using
  * the one_vs_all or all_vs_all adapters.
+ *
+ * With more than one training thread, sgd trains Hogwild-style: threads
+ * take disjoint slices of each shuffled epoch and update the shared
+ * weights without any locking. L2 regularization is then applied lazily
+ * per feature, from the global step at which the feature was last
+ * touched, instead of through a global scale coefficient. one_vs_all
+ * trains such classifiers one label at a time; training that is run on
+ * some other thread_pool's thread stays on that thread and trains
+ * serially, so pools are never nested.
+ *
+ * @see https://papers.nips.cc/paper/4390-hogwild-a-lock-free-approach-to-parallelizing-stochastic-gradient-descent.pdf
  */
 class sgd : public binary_classifier
 {
@@ -38,6 +49,8 @@ class sgd : public binary_classifier
     const static constexpr double default_lambda = 0.0001;
     /// The default number of allowed iterations.
     const static constexpr size_t default_max_iter = 50;
+    /// The default number of training threads.
+    const static constexpr size_t default_threads = 1;
 
     /**
      * @param prefix The prefix for the model file
@@ -50,12 +63,15 @@ class sgd : public binary_classifier
      * @param bias \f$b\f$, the bias
      * @param lambda \f$\lambda\f$, the regularization constant
      * @param max_iter The maximum number of iterations for training.
+     * @param threads The number of threads to train with; more than one
+     *  selects lock-free (Hogwild) training
      */
     sgd(const std::string& prefix, std::shared_ptr<index::forward_index> idx,
         class_label positive, class_label negative,
         std::unique_ptr<loss::loss_function> loss, double alpha = default_alpha,
         double gamma = default_gamma, double bias = default_bias,
-        double lambda = default_lambda, size_t max_iter = default_max_iter);
+        double lambda = default_lambda, size_t max_iter = default_max_iter,
+        size_t threads = default_threads);
 
     /**
      * Returns the dot product with the current weight vector. Used
@@ -71,6 +87,8 @@ class sgd : public binary_classifier
 
     void reset() override;
 
+    size_t num_training_threads() const override;
+
     /**
      * The identifier for this classifier.
      */
@@ -101,6 +119,9 @@ class sgd : public binary_classifier
     /// The maximum number of iterations for training.
     const size_t max_iter_;
 
+    /// The number of threads used for training.
+    const size_t num_threads_;
+
     /// The loss function to be used for the update.
     std::unique_ptr<loss::loss_function> loss_;
 
@@ -117,6 +138,19 @@ class sgd : public binary_classifier
      * @return the dot product with the current weight vector
      */
     double predict(const counts_t& doc) const;
+
+    /**
+     * Trains on a single thread, regularizing through coeff_.
+     * @param docs The training documents
+     */
+    void train_serial(const std::vector<doc_id>& docs);
+
+    /**
+     * Trains on num_threads_ threads with racy, lock-free updates to the
+     * shared weights and lazy per-feature regularization.
+     * @param docs The training documents
+     */
+    void train_hogwild(const std::vector<doc_id>& docs);
 };
 
 /**
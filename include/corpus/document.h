@@ -12,6 +12,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "meta.h"
 #include "util/optional.h"
@@ -47,6 +48,22 @@ class document
      */
     void increment(const std::string& term, double amount);
 
+    /**
+     * Sets whether increment() records the position of each term it
+     * counts. The position of a term is the number of times increment()
+     * was called before it, so positions follow the order in which an
+     * analyzer produces terms.
+     * @param record Whether to record positions
+     */
+    void record_positions(bool record);
+
+    /**
+     * @return the positions, in increasing order, at which each term was
+     * counted while positions were being recorded
+     */
+    const std::unordered_map<std::string, std::vector<uint64_t>>&
+        positions() const;
+
     /**
      * @return the path to this document (the argument to the constructor)
      */
@@ -117,6 +134,12 @@ class document
      */
     doc_id id() const;
 
+    /**
+     * Sets the doc_id for this document.
+     * @param d_id The new doc_id for this document
+     */
+    void id(doc_id d_id);
+
     /**
      * @return whether this document contains its content internally
      */
@@ -147,6 +170,15 @@ class document
     /// Counts of how many times each token appears
     std::unordered_map<std::string, double> counts_;
 
+    /// Whether increment() records term positions
+    bool record_positions_;
+
+    /// The number of times increment() has been called
+    uint64_t num_increments_;
+
+    /// The positions of each token, if they are being recorded
+    std::unordered_map<std::string, std::vector<uint64_t>> positions_;
+
     /// What the document contains
     util::optional<std::string> content_;
 
@@ -12,6 +12,8 @@
 
 #include <memory>
 
+#include "caching/cache_stats.h"
+
 namespace cpptoml
 {
 class table;
@@ -25,6 +27,10 @@ namespace index
 /**
  * Decorator class for wrapping indexes with a cache. Like other indexes,
  * you shouldn't construct this directly, but rather use make_index().
+ *
+ * Postings cursors opened on a cached inverted_index, which rankers score
+ * with, walk the postings_data in the cache, so the cache serves ranking
+ * as well as search_primary().
  */
 template <class Index, template <class, class> class Cache>
 class cached_index : public Index
@@ -67,6 +73,25 @@ class cached_index : public Index
      */
     void clear_cache();
 
+    /**
+     * @return the hits, misses, evictions and rejections of the cache
+     */
+    caching::cache_stats cache_stats() const;
+
+    /**
+     * Deletes a document, and clears the cache so that postings cached
+     * before the deletion are not returned.
+     * @param d_id The document to delete
+     */
+    virtual void delete_doc(doc_id d_id) override;
+
+  protected:
+    /**
+     * @return true, so that readers of the postings, such as the cursors
+     * used for ranking, go through the cache too
+     */
+    virtual bool caches_postings() const override;
+
   private:
     /**
      * The internal cache object.
@@ -4,6 +4,7 @@
  */
 
 #include "index/cached_index.h"
+#include "index/postings_data.h"
 
 namespace meta
 {
@@ -35,5 +36,24 @@ void cached_index<Index, Cache>::clear_cache()
 {
     cache_.clear();
 }
+
+template <class Index, template <class, class> class Cache>
+caching::cache_stats cached_index<Index, Cache>::cache_stats() const
+{
+    return cache_.stats();
+}
+
+template <class Index, template <class, class> class Cache>
+bool cached_index<Index, Cache>::caches_postings() const
+{
+    return true;
+}
+
+template <class Index, template <class, class> class Cache>
+void cached_index<Index, Cache>::delete_doc(doc_id d_id)
+{
+    Index::delete_doc(d_id);
+    clear_cache();
+}
 }
 }
@@ -106,15 +106,15 @@ class chunk_handler
     uint32_t size() const;
 
     /**
-     * @return the size, in bytes, of the last chunk written to disk after
-     * merging.
+     * Merges all of the on-disk chunks in a single pass, deleting them
+     * afterward. The merged postings_data objects are handed to the
+     * consumer in increasing primary key order, so it can write the
+     * final postings file directly.
+     * @param consumer The function to call with each merged
+     * postings_data (as an rvalue)
      */
-    uint64_t final_size() const;
-
-    /**
-     * Merge the remaining on-disk chunks.
-     */
-    void merge_chunks();
+    template <class Consumer>
+    void merge_chunks(Consumer&& consumer);
 
     /**
      * @return the number of unique primary keys seen while merging chunks.
@@ -4,10 +4,13 @@
  */
 
 #include <algorithm>
+#include <memory>
 
 #include "index/chunk_handler.h"
 #include "index/disk_index.h"
-#include "parallel/thread_pool.h"
+#include "io/compressed_file_reader.h"
+#include "util/progress.h"
+#include "util/shim.h"
 
 namespace meta
 {
@@ -128,59 +131,78 @@ void chunk_handler<Index>::write_chunk(std::vector<index_pdata_type>& pdata)
 }
 
 template <class Index>
-void chunk_handler<Index>::merge_chunks()
+template <class Consumer>
+void chunk_handler<Index>::merge_chunks(Consumer&& consumer)
 {
-    size_t remaining = chunks_.size() - 1;
-    std::mutex mutex;
-    auto task = [&]()
+    if (chunks_.empty())
+        throw chunk_handler_exception{"there were no chunks to merge"};
+
+    std::vector<std::string> paths;
+    std::vector<std::unique_ptr<io::compressed_file_reader>> readers;
+    uint64_t total_bits = 0;
+    for (; !chunks_.empty(); chunks_.pop())
+    {
+        paths.push_back(chunks_.top().path());
+        total_bits += chunks_.top().size() * 8;
+        readers.push_back(make_unique<io::compressed_file_reader>(
+            paths.back(), io::default_compression_reader_func));
+    }
+
+    // the front postings_data of each chunk, and a min-heap of chunk
+    // indices ordered by those postings_data's primary keys
+    std::vector<index_pdata_type> fronts(readers.size());
+    auto comp = [&](uint64_t a, uint64_t b)
+    { return fronts[b] < fronts[a]; };
+    std::priority_queue<uint64_t, std::vector<uint64_t>, decltype(comp)>
+        to_merge{comp};
+
+    std::vector<uint64_t> bits_read(readers.size(), 0);
+    uint64_t total_read = 0;
+    auto advance = [&](uint64_t i)
     {
-        while (true)
+        if (!readers[i]->has_next())
+            return;
+        *readers[i] >> fronts[i];
+        total_read += readers[i]->bit_location() - bits_read[i];
+        bits_read[i] = readers[i]->bit_location();
+        to_merge.push(i);
+    };
+    for (uint64_t i = 0; i < readers.size(); ++i)
+        advance(i);
+
+    printing::progress progress{" > Merging " + std::to_string(paths.size())
+                                    + " chunks: ",
+                                total_bits, 500, 8 * 1024 /* 1KB */};
+    uint64_t unique_keys = 0;
+    while (!to_merge.empty())
+    {
+        auto i = to_merge.top();
+        to_merge.pop();
+        auto merged = std::move(fronts[i]);
+        advance(i);
+
+        // combine the postings for this key from every other chunk
+        while (!to_merge.empty()
+               && fronts[to_merge.top()].primary_key() == merged.primary_key())
         {
-            util::optional<chunk_t> first;
-            util::optional<chunk_t> second;
-            {
-                std::lock_guard<std::mutex> lock{mutables_};
-                if (chunks_.size() < 2)
-                    return;
-                first = chunks_.top();
-                chunks_.pop();
-                second = chunks_.top();
-                chunks_.pop();
-                LOG(progress) << "> Merging " << first->path() << " ("
-                              << printing::bytes_to_units(first->size())
-                              << ") and " << second->path() << " ("
-                              << printing::bytes_to_units(second->size())
-                              << "), " << --remaining << " remaining        \r"
-                              << ENDLG;
-            }
-            first->merge_with(*second);
-            {
-                std::lock_guard<std::mutex> lock{mutex};
-                chunks_.push(*first);
-            }
+            auto j = to_merge.top();
+            to_merge.pop();
+            merged.merge_with(fronts[j]);
+            advance(j);
         }
-    };
-
-    parallel::thread_pool pool;
-    auto thread_ids = pool.thread_ids();
-    std::vector<std::future<void>> futures;
-    for (size_t i = 0; i < thread_ids.size(); ++i)
-        futures.emplace_back(pool.submit_task(task));
-
-    for (auto& fut : futures)
-        fut.get();
 
-    LOG(progress) << '\n' << ENDLG;
-
-    if (chunks_.empty())
-        throw chunk_handler_exception{"there were no chunks to merge"};
+        progress(total_read);
+        consumer(std::move(merged));
+        ++unique_keys;
+    }
+    progress.end();
 
-    uint64_t unique_keys;
-    std::ifstream termfile{chunks_.top().path() + ".numterms"};
-    termfile >> unique_keys;
-    termfile.close();
-    filesystem::delete_file(chunks_.top().path() + ".numterms");
-    filesystem::rename_file(chunks_.top().path(), prefix_ + "/postings.index");
+    readers.clear();
+    for (const auto& path : paths)
+    {
+        filesystem::delete_file(path);
+        filesystem::delete_file(path + ".numterms");
+    }
 
     unique_primary_keys_ = unique_keys;
 }
@@ -194,15 +216,6 @@ uint64_t chunk_handler<Index>::unique_primary_keys() const
     return *unique_primary_keys_;
 }
 
-template <class Index>
-uint64_t chunk_handler<Index>::final_size() const
-{
-    if (chunks_.size() != 1)
-        throw chunk_handler_exception{
-            "merge not complete before final_size() called"};
-    return chunks_.top().size();
-}
-
 template <class Index>
 uint32_t chunk_handler<Index>::size() const
 {
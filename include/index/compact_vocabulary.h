@@ -0,0 +1,186 @@
+/**
+ * @file compact_vocabulary.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_COMPACT_VOCABULARY_H_
+#define META_COMPACT_VOCABULARY_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "io/mmap_file.h"
+#include "meta.h"
+
+namespace meta
+{
+namespace util
+{
+template <class>
+class optional;
+}
+}
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * A read-only mapping between terms and term_ids that takes much less
+ * space than a vocabulary_map, written by compact_vocabulary_writer.
+ *
+ * Terms are looked up with a minimal perfect hash function: a term is
+ * hashed once and the hash is probed against a short sequence of bit
+ * arrays, the first of which with a bit set at the probed position
+ * determines the term's slot. The slot holds the term_id, and the term
+ * stored under that term_id is compared with the term looked up, so that
+ * terms not in the vocabulary are rejected. Terms whose hashes collide
+ * with each other are kept in a small table searched by hash.
+ *
+ * Terms are stored in buckets of consecutive term_ids, each term but the
+ * first of a bucket storing only how much of the previous term it shares
+ * and the rest of its bytes. Sorted vocabularies, whose neighboring terms
+ * share long prefixes, take much less space this way.
+ *
+ * Looking up a term or a term_id takes time linear in the length of the
+ * term and independent of the size of the vocabulary.
+ */
+class compact_vocabulary
+{
+  public:
+    /// The number of consecutive terms stored in each bucket
+    const static constexpr uint64_t bucket_size = 16;
+
+    /// The number of bit arrays in the perfect hash function, at most
+    const static constexpr uint64_t max_levels = 32;
+
+    /**
+     * @param path The location of the file written by a
+     * compact_vocabulary_writer
+     */
+    compact_vocabulary(const std::string& path);
+
+    /**
+     * Move constructs a compact_vocabulary.
+     */
+    compact_vocabulary(compact_vocabulary&&) = default;
+
+    /**
+     * Move assigns a compact_vocabulary.
+     */
+    compact_vocabulary& operator=(compact_vocabulary&&) = default;
+
+    /**
+     * @param term The term to find an id for
+     * @return the term_id of the term, if it is in the vocabulary
+     */
+    util::optional<term_id> find(const std::string& term) const;
+
+    /**
+     * Finds the term associated with the given id. No bounds checking is
+     * performed---accessing beyond the maximum assigned term_id is
+     * undefined behavior.
+     * @param t_id The term id to find the string representation of
+     */
+    std::string find_term(term_id t_id) const;
+
+    /**
+     * @return the number of terms in the vocabulary
+     */
+    uint64_t size() const;
+
+    /**
+     * @param term The term to hash
+     * @return the hash of the term used by the perfect hash function
+     */
+    static uint64_t hash(const std::string& term);
+
+    /**
+     * @param hash The hash of a term
+     * @param level A level of the perfect hash function
+     * @param num_bits The number of bits in the level
+     * @return the position the term is probed at in the level
+     */
+    static uint64_t position(uint64_t hash, uint64_t level, uint64_t num_bits);
+
+    /**
+     * Basic exception for compact_vocabulary interactions.
+     */
+    class compact_vocabulary_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    using exception = compact_vocabulary_exception;
+
+  private:
+    /**
+     * @param pos A position in the bit arrays
+     * @return the number of bits set before pos
+     */
+    uint64_t rank(uint64_t pos) const;
+
+    /**
+     * @param slot A slot of the perfect hash function
+     * @return the term_id stored in the slot
+     */
+    uint64_t slot_id(uint64_t slot) const;
+
+    /**
+     * @param id A term_id
+     * @param term The term to compare with
+     * @return whether the term stored under id is term
+     */
+    bool matches(uint64_t id, const std::string& term) const;
+
+    /// the file holding the vocabulary, mmapped for performance
+    io::mmap_file file_;
+
+    /// the number of terms in the vocabulary
+    uint64_t num_terms_;
+
+    /// the number of levels in the perfect hash function
+    uint64_t num_levels_;
+
+    /// the number of slots, which is the number of terms not kept in the
+    /// table of colliding hashes
+    uint64_t num_slots_;
+
+    /// the number of entries in the table of colliding hashes
+    uint64_t num_collisions_;
+
+    /// the number of bits used to store each term_id in a slot
+    uint64_t id_bits_;
+
+    /// the number of bits in each level
+    const uint64_t* level_bits_;
+
+    /// the bits of every level, one after another
+    const uint64_t* bits_;
+
+    /// the number of bits set before every eighth word of bits_
+    const uint64_t* ranks_;
+
+    /// the term_id in each slot, packed in id_bits_ bits each
+    const uint64_t* slots_;
+
+    /// (hash, term_id) pairs for the terms whose hashes collide, sorted
+    const uint64_t* collisions_;
+
+    /// the byte position of each bucket of terms in strings_
+    const uint64_t* bucket_offsets_;
+
+    /// the buckets of terms
+    const unsigned char* strings_;
+};
+}
+}
+
+#endif
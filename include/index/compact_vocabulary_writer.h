@@ -0,0 +1,99 @@
+/**
+ * @file compact_vocabulary_writer.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_COMPACT_VOCABULARY_WRITER_H_
+#define META_COMPACT_VOCABULARY_WRITER_H_
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Writes the file read by a compact_vocabulary. Terms are given term_ids
+ * in the order they are inserted.
+ *
+ * Terms are written to a temporary file as they are inserted; the perfect
+ * hash function is built when the writer is destroyed, which takes about
+ * sixteen bytes of memory per term.
+ */
+class compact_vocabulary_writer
+{
+  public:
+    /**
+     * @param path The location of the file to write
+     */
+    compact_vocabulary_writer(const std::string& path);
+
+    /**
+     * Builds the perfect hash function and writes the file. This may block
+     * for a while on large vocabularies.
+     */
+    ~compact_vocabulary_writer();
+
+    /**
+     * Inserts a term, giving it the next term_id. No checking is done for
+     * duplicate terms, which would not be found by their term_ids. Terms
+     * inserted in sorted order are stored in much less space.
+     * @param term The term to insert
+     */
+    void insert(const std::string& term);
+
+    /**
+     * Basic exception for compact_vocabulary_writer interactions.
+     */
+    class compact_vocabulary_writer_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    using exception = compact_vocabulary_writer_exception;
+
+  private:
+    /**
+     * Writes an integer to the temporary file as a sequence of bytes with
+     * seven bits each.
+     * @param value The integer to write
+     */
+    void write_varint(uint64_t value);
+
+    /**
+     * Builds the perfect hash function and writes the file.
+     */
+    void write_vocabulary();
+
+    /// the location of the file to write
+    std::string path_;
+
+    /// the temporary file holding the buckets of terms
+    std::ofstream strings_;
+
+    /// the number of bytes written to strings_
+    uint64_t num_string_bytes_;
+
+    /// the last term inserted
+    std::string last_term_;
+
+    /// the hash of every term inserted, by term_id
+    std::vector<uint64_t> hashes_;
+
+    /// the byte position of each bucket of terms in strings_
+    std::vector<uint64_t> bucket_offsets_;
+};
+}
+}
+
+#endif
@@ -66,7 +66,8 @@ class disk_index
     std::string index_name() const;
 
     /**
-     * @return the number of documents in this index
+     * @return the number of documents in this index, including deleted
+     * ones; every doc_id is less than this
      */
     uint64_t num_docs() const;
 
@@ -83,10 +84,48 @@ class disk_index
     std::string doc_path(doc_id d_id) const;
 
     /**
-     * @return a vector of doc_ids that are contained in this index
+     * @return a vector of doc_ids that are contained in this index and
+     * have not been deleted
      */
     std::vector<doc_id> docs() const;
 
+    /**
+     * Marks a document as deleted. Deleted documents keep their doc_ids
+     * but are left out of docs(), search results, and the collection
+     * statistics; their postings are only removed when the index is
+     * merged. Deletions are saved with the index as they are made, and
+     * may be made from several threads at once.
+     * @param d_id The document to delete
+     */
+    virtual void delete_doc(doc_id d_id);
+
+    /**
+     * @param d_id The document to check
+     * @return whether the document has been deleted
+     */
+    bool is_deleted(doc_id d_id) const;
+
+    /**
+     * @return the number of documents that have been deleted
+     */
+    uint64_t num_deleted() const;
+
+    /**
+     * @return a number that changes whenever documents are deleted from
+     * the index; no two indexes opened by a process share one, so cached
+     * results can be tied to the exact state of the index they came from
+     */
+    uint64_t generation() const;
+
+    /**
+     * Reads the parts of the index that queries use into memory, so that
+     * the first queries after the index is loaded do not wait on page
+     * faults. The smaller, more widely used files are read first.
+     * @param budget The most bytes to read in
+     * @return the number of bytes read in
+     */
+    virtual uint64_t warm(uint64_t budget) const;
+
     /**
      * @param d_id The document to search for
      * @return the size of the given document (the total number of terms
@@ -176,6 +215,13 @@ class disk_index
      */
     disk_index& operator=(const disk_index&) = delete;
 
+    /**
+     * @return whether search_primary() is answered by a cache wrapping
+     * this index, in which case other readers of the postings should go
+     * through it as well
+     */
+    virtual bool caches_postings() const;
+
   public:
     /**
      * Move constructs a disk_index.
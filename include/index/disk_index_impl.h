@@ -10,8 +10,10 @@
 #ifndef META_INDEX_DISK_INDEX_IMPL_H_
 #define META_INDEX_DISK_INDEX_IMPL_H_
 
+#include <atomic>
 #include <mutex>
 
+#include "index/compact_vocabulary.h"
 #include "index/disk_index.h"
 #include "index/string_list.h"
 #include "index/vocabulary_map.h"
@@ -56,6 +58,12 @@ class disk_index::disk_index_impl
      */
     const static std::vector<const char*> files;
 
+    /**
+     * Filename of the compact_vocabulary, which only indexes configured to
+     * write one have.
+     */
+    const static char* const compact_term_ids_file;
+
     /**
      * Initializes the following metadata maps:
      * doc_sizes_, labels_, unique_terms_
@@ -81,13 +89,23 @@ class disk_index::disk_index_impl
      */
     void load_unique_terms(uint64_t num_docs = 0);
 
+    /**
+     * Loads the deleted documents, or starts with none when the index is
+     * being created or has never had any deleted. The doc sizes must
+     * already be loaded.
+     * @param num_docs The number of documents stored in the index, or 0
+     * if the index is being loaded
+     */
+    void load_deleted(uint64_t num_docs = 0);
+
     /**
      * Loads the doc_id mapping.
      */
     void load_doc_id_mapping();
 
     /**
-     * Loads the term_id mapping.
+     * Loads the term_id mapping, preferring the compact vocabulary when the
+     * index has one.
      */
     void load_term_id_mapping();
 
@@ -145,6 +163,29 @@ class disk_index::disk_index_impl
      */
     uint64_t total_unique_terms() const;
 
+    /**
+     * @param term The term to look up
+     * @return the term_id of the term, if it is in the index
+     */
+    util::optional<term_id> find_term_id(const std::string& term) const;
+
+    /**
+     * @param t_id A term_id in the index
+     * @return the text of the term
+     */
+    std::string find_term(term_id t_id) const;
+
+    /**
+     * @param id The document id
+     * @return whether the document has been deleted
+     */
+    bool is_deleted(doc_id id) const;
+
+    /**
+     * @return the total length of the deleted documents
+     */
+    uint64_t deleted_terms() const;
+
     /**
      * @return the label id for a given document.
      * @param id The document id
@@ -193,9 +234,28 @@ class disk_index::disk_index_impl
      */
     util::optional<util::disk_vector<uint64_t>> unique_terms_;
 
+    /**
+     * Bitmap of deleted documents: bit (id % 64) of word (id / 64) is set
+     * when document id has been deleted.
+     */
+    util::optional<util::disk_vector<uint64_t>> deleted_;
+
+    /// the number of deleted documents
+    std::atomic<uint64_t> num_deleted_{0};
+
+    /// the total length of the deleted documents
+    std::atomic<uint64_t> deleted_terms_{0};
+
+    /// changes whenever documents are deleted
+    std::atomic<uint64_t> generation_{0};
+
     /// Maps string terms to term_ids.
     util::optional<vocabulary_map> term_id_mapping_;
 
+    /// Maps string terms to term_ids instead of term_id_mapping_, if the
+    /// index was built with a compact vocabulary
+    util::optional<compact_vocabulary> compact_term_id_mapping_;
+
     /// Assigns an integer to each class label (used for liblinear mappings)
     util::invertible_map<class_label, label_id> label_ids_;
 
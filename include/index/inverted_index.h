@@ -11,8 +11,10 @@
 #ifndef META_INVERTED_INDEX_H_
 #define META_INVERTED_INDEX_H_
 
+#include <memory>
 #include <queue>
 #include <stdexcept>
+#include <vector>
 
 #include "index/disk_index.h"
 #include "index/make_index.h"
@@ -20,6 +22,11 @@
 namespace meta
 {
 
+namespace analyzers
+{
+class analyzer;
+}
+
 namespace corpus
 {
 class corpus;
@@ -34,6 +41,8 @@ class chunk_handler;
 
 template <class, class>
 class postings_data;
+
+class postings_cursor;
 }
 }
 
@@ -50,6 +59,16 @@ namespace index
  * postings file containing the (term_id -> each doc_id) information is saved on
  * disk. A lexicon (or "dictionary") contains pointers into the large postings
  * file. It is assumed that the lexicon will fit in memory.
+ *
+ * Setting the "compact-vocabulary" key of the configuration to true also
+ * writes a compact_vocabulary when the index is built, which is then used
+ * instead of the vocabulary_map to map terms to term_ids.
+ *
+ * Setting the "warm-budget" key to a number of bytes reads that much of
+ * the index into memory when an existing index is loaded (see warm()).
+ * The postings of the terms of a query are prefetched before a ranker
+ * scores them (see prefetch()) unless the "prefetch-postings" key is
+ * false.
  */
 class inverted_index : public disk_index
 {
@@ -69,6 +88,34 @@ class inverted_index : public disk_index
     using index_pdata_type = postings_data<std::string, doc_id>;
     using exception = inverted_index_exception;
 
+    /**
+     * The encodings available for the compressed postings file, selected
+     * by the "postings-codec" key in the configuration.
+     */
+    enum class postings_codec
+    {
+        /// bitwise gamma codes (the default)
+        gamma,
+        /// bit-packed blocks of gaps and counts
+        block
+    };
+
+    /**
+     * Statistics about a single term, computed when the index is built.
+     */
+    struct term_stats
+    {
+        /// the number of documents the term appears in
+        uint64_t doc_freq;
+        /// the number of times the term appears in the corpus
+        uint64_t corpus_count;
+        /// the largest number of times the term appears in one document
+        uint64_t max_count;
+        /// the size of the term's postings list, rounded up to whole
+        /// bytes for gamma coded postings
+        uint64_t postings_bytes;
+    };
+
     /**
      * inverted_index is a friend of the factory method used to create
      * it.
@@ -84,6 +131,17 @@ class inverted_index : public disk_index
     friend std::shared_ptr<cached_index<Index, Cache>>
         make_index(const std::string& config_file, Args&&... args);
 
+    /**
+     * segmented_index builds and merges the inverted_indexes that make up
+     * its segments.
+     */
+    friend class segmented_index;
+
+    /**
+     * sharded_index builds the inverted_indexes that make up its shards.
+     */
+    friend class sharded_index;
+
   protected:
     /**
      * @param config The table that specifies how to create the
@@ -91,6 +149,14 @@ class inverted_index : public disk_index
      */
     inverted_index(const cpptoml::table& config);
 
+    /**
+     * @param config The table that specifies how to create the
+     * index.
+     * @param name The location of the index, in place of the one given
+     * by the configuration
+     */
+    inverted_index(const cpptoml::table& config, const std::string& name);
+
   public:
     /**
      * Move constructs a inverted_index.
@@ -122,13 +188,62 @@ class inverted_index : public disk_index
      */
     void tokenize(corpus::document& doc);
 
+    /**
+     * tokenize() shares a single analyzer and so may not be called from
+     * several threads at once; each thread may instead tokenize with its
+     * own copy of the analyzer.
+     * @return a copy of the analyzer used to tokenize documents
+     */
+    std::unique_ptr<analyzers::analyzer> clone_analyzer() const;
+
+    /**
+     * Marks a document as deleted, and subtracts its postings from the
+     * statistics live_stats() returns. Every postings list is searched
+     * for the document, so this takes time proportional to the number of
+     * unique terms in the index rather than to the length of the
+     * document.
+     * @param d_id The document to delete
+     */
+    virtual void delete_doc(doc_id d_id) override;
+
     /**
      * @param t_id The term_id to search for
-     * @return the postings data for a given term_id
+     * @return the postings data for a given term_id, leaving out deleted
+     * documents
      */
     virtual std::shared_ptr<postings_data_type>
         search_primary(term_id t_id) const;
 
+    /**
+     * Opens a cursor over the postings for a term without allocating.
+     * Cursors read straight from the postings file, unless this index is
+     * wrapped by a cache, in which case they read the postings_data that
+     * search_primary() returns from it. They may be used from several
+     * threads at once, and may include deleted documents, which callers
+     * must skip.
+     * @param t_id The term_id to search for
+     * @return a cursor over the postings for the given term_id
+     */
+    postings_cursor postings(term_id t_id) const;
+
+    /**
+     * @param t_id The term to search for
+     * @return the statistics for a term, which are all zero if the term
+     * is not in the index; they include deleted documents until the index
+     * is merged
+     */
+    term_stats stats(term_id t_id) const;
+
+    /**
+     * @param t_id The term to search for
+     * @return the statistics for a term with its doc_freq and corpus_count
+     * counted over documents that have not been deleted, so they agree
+     * with num_docs() - num_deleted() and total_corpus_terms(); the other
+     * fields are as in stats(). Deleted postings are counted as documents
+     * are deleted, so this reads no postings.
+     */
+    term_stats live_stats(term_id t_id) const;
+
     /**
      * @param t_id The term to search for
      * @return the document frequency of a term (number of documents it
@@ -139,13 +254,35 @@ class inverted_index : public disk_index
     /**
      * @param t_id The term_id to search for
      * @param d_id The doc_id to search for
+     * @return the number of times the term appears in the document, or
+     * zero if the document has been deleted
      */
     uint64_t term_freq(term_id t_id, doc_id d_id) const;
 
     /**
-     * @return the total number of terms in this index
+     * @return whether this index stores the positions of terms within
+     * documents, as requested by the "positions" key in the configuration
+     */
+    bool has_positions() const;
+
+    /**
+     * Reads the positions at which some terms occur in a document. The
+     * position of a term is the number of terms the analyzer produced
+     * before it. Throws an exception if the index does not store
+     * positions.
+     * @param d_id The document to look in
+     * @param terms The terms to look up
+     * @param out Set to the positions, in increasing order, of each term
+     * in terms; terms that do not occur in the document have none
+     */
+    void positions(doc_id d_id, const std::vector<term_id>& terms,
+                   std::vector<std::vector<uint64_t>>& out) const;
+
+    /**
+     * @return the total number of terms in this index, not counting
+     * deleted documents
      */
-    uint64_t total_corpus_terms();
+    uint64_t total_corpus_terms() const;
 
     /**
      * @param t_id The specified term
@@ -154,9 +291,38 @@ class inverted_index : public disk_index
     uint64_t total_num_occurences(term_id t_id) const;
 
     /**
-     * @return the average document length in this index
+     * @return the average length of the documents in this index that have
+     * not been deleted
      */
-    double avg_doc_length();
+    double avg_doc_length() const;
+
+    /**
+     * @return the length of the shortest non-empty document in this index
+     * when it was built or merged, which remains a lower bound as
+     * documents are deleted
+     */
+    uint64_t min_doc_length() const;
+
+    /**
+     * Reads the document metadata, then the lexicon, term statistics and
+     * skip entries, then as much of the postings file as fits into
+     * memory, so that the first queries after the index is loaded do not
+     * wait on page faults.
+     * @param budget The most bytes to read in
+     * @return the number of bytes read in
+     */
+    virtual uint64_t warm(uint64_t budget) const override;
+
+    /**
+     * Starts reading the postings list and skip entries of a term into
+     * memory, without waiting for them; rankers call this for every term
+     * of a query with several before scoring any, so that their reads
+     * overlap. Does nothing if prefetching was turned off by the
+     * configuration, if the postings are served from a cache or were all
+     * read in by warm(), or if the term's list is already in memory.
+     * @param t_id The term whose postings will be read soon
+     */
+    void prefetch(term_id t_id) const;
 
   private:
     /**
@@ -166,6 +332,24 @@ class inverted_index : public disk_index
      */
     void create_index(const std::string& config_file);
 
+    /**
+     * Initializes the disk index from the documents of a corpus.
+     * @param config_file The configuration to be used
+     * @param docs The documents to index
+     */
+    void create_index(const std::string& config_file, corpus::corpus& docs);
+
+    /**
+     * Initializes the disk index by merging indexes that were built with
+     * the same configuration, without tokenizing their documents again.
+     * The documents of each index are numbered after those of the
+     * indexes before it.
+     * @param config_file The configuration to be used
+     * @param indexes The indexes to merge, in order
+     */
+    void merge_index(const std::string& config_file,
+                     const std::vector<const inverted_index*>& indexes);
+
     /**
      * This function loads a disk index from its filesystem
      * representation.
@@ -31,6 +31,9 @@ using dblru_inverted_index =
 /// Inverted index using splay cache
 using splay_inverted_index = cached_index<inverted_index, caching::splay_cache>;
 
+/// Inverted index using CLOCK cache, for many threads
+using clock_inverted_index = cached_index<inverted_index, caching::clock_cache>;
+
 /// In-memory forward index
 using memory_forward_index =
     cached_index<forward_index, caching::no_evict_cache>;
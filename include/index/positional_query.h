@@ -0,0 +1,75 @@
+/**
+ * @file positional_query.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_POSITIONAL_QUERY_H_
+#define META_INDEX_POSITIONAL_QUERY_H_
+
+#include <utility>
+#include <vector>
+
+#include "index/inverted_index.h"
+#include "meta.h"
+
+namespace meta
+{
+namespace corpus
+{
+class document;
+}
+
+namespace index
+{
+
+/**
+ * A document matched by a positional query, along with the number of
+ * times the query matched in it. Matches can be used to filter the
+ * documents a ranker scores, or as features alongside its scores.
+ */
+using positional_match = std::pair<doc_id, uint64_t>;
+
+/**
+ * Tokenizes a query, keeping the order of its terms.
+ * @param idx The index whose analyzer should tokenize the query
+ * @param query The query to tokenize, which must not have been tokenized
+ * already
+ * @return the term_ids of the terms in the query, in the order they were
+ * produced
+ */
+std::vector<term_id> ordered_terms(inverted_index& idx,
+                                   corpus::document& query);
+
+/**
+ * Finds the documents in which the terms occur next to each other, in
+ * order. Candidates are found by intersecting the terms' postings, so
+ * positions are only read for documents that contain every term.
+ * @param idx The index to search, which must store positions
+ * @param phrase The terms of the phrase, in order
+ * @return the matching documents in increasing order of doc_id, each with
+ * the number of times the phrase occurs in it
+ */
+std::vector<positional_match> match_phrase(const inverted_index& idx,
+                                           const std::vector<term_id>& phrase);
+
+/**
+ * Finds the documents in which every term occurs within a window of
+ * consecutive positions, in any order.
+ * @param idx The index to search, which must store positions
+ * @param terms The terms to look for
+ * @param window The number of positions the terms must fit in
+ * @return the matching documents in increasing order of doc_id, each with
+ * the number of minimal spans of positions that hold every term and fit
+ * in the window
+ */
+std::vector<positional_match>
+    match_proximity(const inverted_index& idx,
+                    const std::vector<term_id>& terms, uint64_t window);
+}
+}
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file postings_cursor.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_POSTINGS_CURSOR_H_
+#define META_INDEX_POSTINGS_CURSOR_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "index/inverted_index.h"
+#include "index/postings_data.h"
+#include "io/block_file_reader.h"
+#include "io/compressed_file_reader.h"
+#include "meta.h"
+#include "util/optional.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * A forward-only cursor over the postings list of one term, read straight
+ * out of an inverted_index's memory-mapped postings file. Postings are
+ * decoded a block at a time into a buffer held by the cursor itself, so
+ * obtaining and walking a cursor allocates nothing; callers that need the
+ * whole list at once can decode it into a buffer of their own, which may
+ * be reused across terms.
+ *
+ * The index keeps a skip_entry for every block of skip_interval postings,
+ * so advance_to() jumps over whole blocks without decoding them, and the
+ * largest count in each block is available as a score bound.
+ *
+ * When the index is wrapped by a cache, a cursor instead walks the
+ * postings_data held by the cache, so that ranking is served from it like
+ * search_primary is; those postings leave out deleted documents, while
+ * postings read from the file include them.
+ */
+class postings_cursor
+{
+  public:
+    /// A (doc_id, count) pair
+    using pair_t = std::pair<doc_id, double>;
+
+    /// The number of postings decoded at a time
+    const static constexpr uint64_t buffer_size = skip_interval;
+
+    /**
+     * Creates a cursor over an empty postings list.
+     * @param t_id The term the postings list belongs to
+     */
+    postings_cursor(term_id t_id);
+
+    /**
+     * @param t_id The term the postings list belongs to
+     * @param file The postings file to read from
+     * @param location The location of the postings list in the file: a
+     * bit offset for the gamma codec or a byte offset for the block codec
+     * @param codec The encoding of the postings file
+     * @param size The number of postings in the list
+     * @param skips The skip entries for the list, stored as the
+     * consecutive fields of a skip_entry; there is one for every block of
+     * skip_interval postings, rounding up
+     */
+    postings_cursor(term_id t_id, const io::mmap_file& file,
+                    uint64_t location, inverted_index::postings_codec codec,
+                    uint64_t size, const uint64_t* skips);
+
+    /**
+     * Creates a cursor over postings that have already been decoded, such
+     * as ones held by a cache wrapping the index.
+     * @param pdata The decoded postings
+     * @param size The number of postings in the list in the postings
+     * file, which the skip entries describe
+     * @param skips The skip entries for the list in the postings file
+     */
+    postings_cursor(
+        std::shared_ptr<const postings_data<term_id, doc_id>> pdata,
+        uint64_t size, const uint64_t* skips);
+
+    /**
+     * postings_cursor may be move-constructed.
+     */
+    postings_cursor(postings_cursor&&) = default;
+
+    /**
+     * postings_cursor may be move-assigned.
+     */
+    postings_cursor& operator=(postings_cursor&&) = default;
+
+    /**
+     * postings_cursor may not be copy-constructed.
+     */
+    postings_cursor(const postings_cursor&) = delete;
+
+    /**
+     * postings_cursor may not be copy-assigned.
+     */
+    postings_cursor& operator=(const postings_cursor&) = delete;
+
+    /**
+     * @return the term this postings list belongs to
+     */
+    term_id id() const;
+
+    /**
+     * @return the number of postings in the list
+     */
+    uint64_t size() const;
+
+    /**
+     * @return whether there are postings left to read
+     */
+    bool has_next() const;
+
+    /**
+     * @return the next posting without moving past it; it is up to the
+     * user to check has_next() first
+     */
+    const pair_t& peek() const;
+
+    /**
+     * @return the next posting; it is up to the user to check has_next()
+     * first
+     */
+    pair_t next();
+
+    /**
+     * Moves past every posting whose doc_id is less than target, decoding
+     * only the block that holds the first posting that is not.
+     * @param target The doc_id to advance to
+     */
+    void advance_to(doc_id target);
+
+    /**
+     * Decodes up to max postings into a caller-provided buffer.
+     * @param out The location to write postings to
+     * @param max The maximum number of postings to write
+     * @return the number of postings written, which is less than max only
+     * if the postings list has been exhausted
+     */
+    uint64_t read(pair_t* out, uint64_t max);
+
+    /**
+     * Decodes the remaining postings into out, replacing its contents but
+     * keeping its storage.
+     * @param out The vector to fill with postings
+     */
+    void read_all(std::vector<pair_t>& out);
+
+    /**
+     * @return the number of blocks in the list
+     */
+    uint64_t num_blocks() const;
+
+    /**
+     * @param idx The block to describe
+     * @return the skip entry for that block
+     */
+    skip_entry block(uint64_t idx) const;
+
+    /**
+     * Finds the block that holds the first remaining posting whose doc_id
+     * is at least target, without moving the cursor. For postings read
+     * from a cache, which may leave some out, it is the first block whose
+     * doc_ids reach target or the next remaining posting.
+     * @param target The doc_id to look for
+     * @return the index of that block, or num_blocks() if there is none
+     */
+    uint64_t find_block(doc_id target) const;
+
+  private:
+    /**
+     * Decodes the next batch of postings into the buffer, leaving it empty
+     * if there are none left.
+     */
+    void refill();
+
+    /**
+     * Moves the readers to the start of a block that has not been decoded
+     * yet and decodes it.
+     * @param idx The block to move to
+     */
+    void seek_block(uint64_t idx);
+
+    /// The term this postings list belongs to
+    term_id t_id_;
+
+    /// The reader for a block-encoded postings list, if any
+    util::optional<io::block_file_reader> block_;
+
+    /// The reader for a gamma-encoded postings list, if any
+    util::optional<io::compressed_file_reader> gamma_;
+
+    /// The decoded postings for a list read from a cache, if any
+    std::shared_ptr<const postings_data<term_id, doc_id>> decoded_;
+
+    /// The position in decoded_ of the first posting not yet buffered
+    uint64_t decoded_pos_;
+
+    /// The number of postings in the list
+    uint64_t size_;
+
+    /// The skip entries for the list
+    const uint64_t* skips_;
+
+    /// The number of postings decoded so far
+    uint64_t num_decoded_;
+
+    /// The doc_id of the last posting decoded
+    uint64_t last_id_;
+
+    /// The most recently decoded postings
+    pair_t buffer_[buffer_size];
+
+    /// The position of the next posting in the buffer
+    uint64_t pos_;
+
+    /// The number of postings in the buffer
+    uint64_t len_;
+};
+}
+}
+
+#endif
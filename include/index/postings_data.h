@@ -16,7 +16,10 @@
 #include <vector>
 
 #include "meta.h"
+#include "io/block_file_reader.h"
+#include "io/block_file_writer.h"
 #include "io/compressed_file_reader.h"
+#include "io/block_codec.h"
 #include "io/compressed_file_writer.h"
 #include "util/sparse_vector.h"
 
@@ -28,6 +31,27 @@ namespace index
 template <class, class>
 class postings_data;
 
+/**
+ * The number of postings covered by each skip_entry. It matches the size
+ * of a packed block, so that skips land on block boundaries.
+ */
+const static constexpr uint64_t skip_interval = io::block::block_size;
+
+/**
+ * Describes a block of skip_interval consecutive postings (or the last,
+ * possibly shorter, block of a postings list) so that a reader can jump
+ * over it without decoding it.
+ */
+struct skip_entry
+{
+    /// the SecondaryKey of the last posting in the block
+    uint64_t last_id;
+    /// the largest count of any posting in the block
+    uint64_t max_count;
+    /// the location of the posting following the block
+    uint64_t next_location;
+};
+
 template <class PrimaryKey, class SecondaryKey>
 io::compressed_file_reader& operator>>(io::compressed_file_reader&,
                                        postings_data<PrimaryKey,
@@ -179,8 +203,11 @@ class postings_data
      * We can also assume that we are already in the correct location of the
      * file.
      * @param writer The compressed file to write to
+     * @param skips If given, a skip_entry (holding a bit location) is
+     * appended to it for every block of postings written
      */
-    void write_compressed(io::compressed_file_writer& writer) const;
+    void write_compressed(io::compressed_file_writer& writer,
+                          std::vector<skip_entry>* skips = nullptr) const;
 
     /**
      * Reads compressed postings_data into this object. The mapping for the
@@ -191,6 +218,26 @@ class postings_data
      */
     void read_compressed(io::compressed_file_reader& reader);
 
+    /**
+     * Writes this postings_data to a block file: the SecondaryKeys are gap
+     * encoded and, along with their counts, bit-packed in blocks of
+     * io::block::block_size. Counts are assumed to be integral, which is
+     * the case for the inverted index. We can assume that we are already
+     * in the correct location of the file.
+     * @param writer The block file to write to
+     * @param skips If given, a skip_entry (holding a byte location) is
+     * appended to it for every block of postings written
+     */
+    void write_packed(io::block_file_writer& writer,
+                      std::vector<skip_entry>* skips = nullptr) const;
+
+    /**
+     * Reads block-encoded postings_data into this object. We can assume
+     * that we are already in the correct location of the file.
+     * @param reader The block file to read from
+     */
+    void read_packed(io::block_file_reader& reader);
+
     /**
      * @param out The output stream to write to
      */
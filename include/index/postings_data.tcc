@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cstring>
 #include "index/postings_data.h"
+#include "io/block_codec.h"
 
 namespace meta
 {
@@ -105,11 +106,21 @@ PrimaryKey postings_data<PrimaryKey, SecondaryKey>::primary_key() const
 }
 
 template <class PrimaryKey, class SecondaryKey>
-void postings_data
-    <PrimaryKey, SecondaryKey>::write_compressed(io::compressed_file_writer
-                                                 & writer) const
+void postings_data<PrimaryKey, SecondaryKey>::write_compressed(
+    io::compressed_file_writer& writer, std::vector<skip_entry>* skips) const
 {
     count_t mutable_counts{counts_.contents()};
+    uint64_t block_max = 0;
+    auto end_block = [&](size_t i, uint64_t id, double count)
+    {
+        block_max = std::max(block_max, static_cast<uint64_t>(count));
+        if ((i + 1) % skip_interval == 0 || i + 1 == mutable_counts.size())
+        {
+            skips->push_back({id, block_max, writer.bit_location()});
+            block_max = 0;
+        }
+    };
+
     writer.write(mutable_counts[0].first);
     if (std::is_same<PrimaryKey, term_id>::value
         || std::is_same<PrimaryKey, std::string>::value)
@@ -123,6 +134,8 @@ void postings_data
                     sizeof(mutable_counts[0].second));
         writer.write(to_write);
     }
+    if (skips)
+        end_block(0, mutable_counts[0].first, mutable_counts[0].second);
 
     // use gap encoding on the SecondaryKeys (we know they are integral types)
     uint64_t cur_id = mutable_counts[0].first;
@@ -145,6 +158,8 @@ void postings_data
                         sizeof(mutable_counts[i].second));
             writer.write(to_write);
         }
+        if (skips)
+            end_block(i, cur_id, mutable_counts[i].second);
     }
 
     // mark end of postings_data
@@ -184,6 +199,85 @@ void postings_data<PrimaryKey, SecondaryKey>::read_compressed(
     counts_.shrink_to_fit();
 }
 
+template <class PrimaryKey, class SecondaryKey>
+void postings_data<PrimaryKey, SecondaryKey>::write_packed(
+    io::block_file_writer& writer, std::vector<skip_entry>* skips) const
+{
+    const auto& counts = counts_.contents();
+    writer.write(counts.size());
+
+    uint64_t gaps[io::block::block_size];
+    uint64_t freqs[io::block::block_size];
+    uint64_t in_block = 0;
+
+    // use gap encoding on the SecondaryKeys; since they are strictly
+    // increasing, every gap after the first is at least one
+    uint64_t last_id = 0;
+    uint64_t block_max = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        uint64_t id = counts[i].first;
+        gaps[in_block] = i == 0 ? id : id - last_id - 1;
+        freqs[in_block] = static_cast<uint64_t>(counts[i].second);
+        block_max = std::max(block_max, freqs[in_block]);
+        last_id = id;
+
+        if (++in_block == io::block::block_size)
+        {
+            writer.write_block(gaps);
+            writer.write_block(freqs);
+            in_block = 0;
+            if (skips)
+                skips->push_back({last_id, block_max, writer.byte_location()});
+            block_max = 0;
+        }
+    }
+
+    // the last partial block is not worth packing
+    for (uint64_t i = 0; i < in_block; ++i)
+    {
+        writer.write(gaps[i]);
+        writer.write(freqs[i]);
+    }
+    if (skips && in_block > 0)
+        skips->push_back({last_id, block_max, writer.byte_location()});
+}
+
+template <class PrimaryKey, class SecondaryKey>
+void postings_data<PrimaryKey, SecondaryKey>::read_packed(
+        io::block_file_reader& reader)
+{
+    counts_.clear();
+    uint64_t size = reader.next();
+    counts_.reserve(size);
+
+    uint64_t gaps[io::block::block_size];
+    uint64_t freqs[io::block::block_size];
+
+    uint64_t last_id = 0;
+    uint64_t num_read = 0;
+    while (size - num_read >= io::block::block_size)
+    {
+        reader.next_block(gaps);
+        reader.next_block(freqs);
+        for (uint64_t i = 0; i < io::block::block_size; ++i)
+        {
+            last_id += (num_read + i == 0) ? gaps[i] : gaps[i] + 1;
+            counts_.emplace_back(SecondaryKey{last_id},
+                                 static_cast<double>(freqs[i]));
+        }
+        num_read += io::block::block_size;
+    }
+
+    for (; num_read < size; ++num_read)
+    {
+        auto gap = reader.next();
+        last_id += (num_read == 0) ? gap : gap + 1;
+        counts_.emplace_back(SecondaryKey{last_id},
+                             static_cast<double>(reader.next()));
+    }
+}
+
 namespace
 {
 template <class T>
@@ -0,0 +1,130 @@
+/**
+ * @file query_cache.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_QUERY_CACHE_H_
+#define META_INDEX_QUERY_CACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "caching/dblru_cache.h"
+#include "meta.h"
+
+namespace meta
+{
+
+namespace corpus
+{
+class document;
+}
+
+namespace index
+{
+
+class inverted_index;
+class ranker;
+
+/**
+ * Caches the results of ranker::score, so that repeated queries skip
+ * reading postings and scoring documents altogether.
+ *
+ * Results are keyed on the analyzed query---its terms and their counts,
+ * in any order---together with the ranker's signature and the index's
+ * generation. Deleting documents from the index changes its generation,
+ * so results cached before the deletion are never returned again; they
+ * age out of the cache like any other entry.
+ *
+ * The best k results of a query answer any later request for k or fewer
+ * of them, since rankings are ordered by score and then by doc_id.
+ * Queries scored with rankers that have no signature are scored every
+ * time.
+ *
+ * The cache may be used from several threads at once, though rankers and
+ * the index's analyzer may not be.
+ */
+class query_cache
+{
+  public:
+    /// The ranking for a single query, best first
+    using ranking = std::vector<std::pair<doc_id, double>>;
+
+    /**
+     * @param max_size The number of queries whose results are kept,
+     * roughly: the cache holds between max_size and twice max_size of the
+     * most recently used ones
+     */
+    query_cache(uint64_t max_size = 10000);
+
+    /**
+     * Scores a query, returning the cached results of an identical query
+     * when there are enough of them. The query is tokenized with the
+     * index's analyzer if it has not been already.
+     * @param idx The index to score the query against
+     * @param r The ranker to score with
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @return the best num_results documents, best first, exactly as
+     * r.score(idx, query, num_results) would return them
+     */
+    ranking score(inverted_index& idx, ranker& r, corpus::document& query,
+                  uint64_t num_results = 10);
+
+    /**
+     * @return the number of queries answered from the cache
+     */
+    uint64_t hits() const;
+
+    /**
+     * @return the number of queries that had to be scored
+     */
+    uint64_t misses() const;
+
+    /**
+     * Empties the cache.
+     */
+    void clear();
+
+  private:
+    /**
+     * The results of a query kept in the cache.
+     */
+    struct entry
+    {
+        /// the number of results the query was scored for
+        uint64_t num_results;
+        /// the results, which are all there are if fewer than num_results
+        std::shared_ptr<const ranking> results;
+    };
+
+    /**
+     * @param idx The index a query is scored against
+     * @param signature The signature of the ranker scoring the query
+     * @param query A tokenized query
+     * @return the key of the query's results
+     */
+    static std::string key(const inverted_index& idx,
+                           const std::string& signature,
+                           const corpus::document& query);
+
+    /// the cached results, by key
+    caching::default_dblru_cache<std::string, entry> cache_;
+
+    /// the number of queries answered from the cache
+    std::atomic<uint64_t> hits_;
+
+    /// the number of queries that had to be scored
+    std::atomic<uint64_t> misses_;
+};
+}
+}
+
+#endif
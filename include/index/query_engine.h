@@ -0,0 +1,129 @@
+/**
+ * @file query_engine.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_QUERY_ENGINE_H_
+#define META_INDEX_QUERY_ENGINE_H_
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "analyzers/analyzer.h"
+#include "corpus/document.h"
+#include "index/inverted_index.h"
+#include "index/ranker/ranker.h"
+#include "parallel/thread_pool.h"
+
+namespace meta
+{
+namespace index
+{
+
+/**
+ * Runs batches of queries concurrently against a shared inverted index.
+ * Rankers keep scratch space between queries and the index's analyzer
+ * holds tokenizing state, so each thread of the engine owns its own
+ * ranker and its own copy of the analyzer; the index itself is only read.
+ * Every query is scored exactly as ranker::score would score it, so the
+ * rankings are identical to running the queries one at a time.
+ */
+class query_engine
+{
+  public:
+    /// The ranking for a single query, best first
+    using ranking = std::vector<std::pair<doc_id, double>>;
+
+    /// Creates the ranker used by one thread of the engine
+    using ranker_factory = std::function<std::unique_ptr<ranker>()>;
+
+    /**
+     * The rankings and timings of a batch of queries.
+     */
+    struct batch_result
+    {
+        /// the ranking for each query, in the order the queries were given
+        std::vector<ranking> rankings;
+
+        /// the latency of each query in milliseconds, including tokenizing
+        std::vector<double> latencies;
+
+        /// the wall time taken by the whole batch, in milliseconds
+        double elapsed = 0;
+
+        /**
+         * @return the number of queries completed per second
+         */
+        double qps() const;
+
+        /**
+         * @param p The percentile to compute, in [0, 1]
+         * @return the query latency at that percentile, in milliseconds
+         */
+        double latency_percentile(double p) const;
+    };
+
+    /**
+     * @param idx The index to run queries against
+     * @param make_ranker Creates the ranker for each thread; every ranker
+     * it creates should be configured identically
+     * @param num_threads The number of threads to run queries on
+     */
+    query_engine(std::shared_ptr<inverted_index> idx,
+                 const ranker_factory& make_ranker,
+                 size_t num_threads = std::thread::hardware_concurrency());
+
+    /**
+     * Scores a batch of queries concurrently. Queries that have not been
+     * tokenized yet are tokenized by the thread that scores them.
+     * @param queries The queries to run
+     * @param num_results The number of results to return for each query
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results
+     * @return the rankings and timings of the batch
+     */
+    batch_result run(std::vector<corpus::document>& queries,
+                     uint64_t num_results = 10,
+                     const std::function<bool(doc_id d_id)>& filter
+                     = [](doc_id)
+                     {
+                         return true;
+                     });
+
+    /**
+     * @return the number of threads queries are run on
+     */
+    size_t num_threads() const;
+
+  private:
+    /**
+     * The scratch state owned by one thread of the engine.
+     */
+    struct worker_state
+    {
+        /// the ranker this thread scores with
+        std::unique_ptr<ranker> scorer;
+        /// this thread's copy of the index's analyzer
+        std::unique_ptr<analyzers::analyzer> analyzer;
+    };
+
+    /// the index queries are run against
+    std::shared_ptr<inverted_index> idx_;
+
+    /// the threads queries are run on
+    parallel::thread_pool pool_;
+
+    /// the state of each thread in the pool; read-only once constructed
+    std::unordered_map<std::thread::id, worker_state> workers_;
+};
+}
+}
+
+#endif
@@ -46,6 +46,27 @@ class dirichlet_prior : public language_model_ranker
      */
     double doc_constant(const score_data& sd) const override;
 
+    /**
+     * Scores a term directly from the ratio of its smoothed probability to
+     * its probability in the collection, which simplifies to a form that
+     * does not need doc_constant.
+     * @param sd score_data for the current query
+     */
+    double score_one(const score_data& sd) override;
+
+    /**
+     * @param sd score_data for the current query
+     * @param block The postings to score
+     * @param scores Set to the score of each posting
+     */
+    void score_block(const score_data& sd, const posting_block& block,
+                     std::vector<double>& scores) override;
+
+    /**
+     * @return the signature of this ranker
+     */
+    std::string signature() const override;
+
   private:
     /// the Dirichlet prior parameter
     const double mu_;
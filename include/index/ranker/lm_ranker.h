@@ -34,6 +34,19 @@ class language_model_ranker : public ranker
 
     double initial_score(const score_data& sd) const override;
 
+    /**
+     * @param sd score_data describing the most favorable document
+     */
+    double max_score_one(const score_data& sd) override;
+
+    /**
+     * The default assumes doc_constant is largest for the most favorable
+     * document; smoothing methods for which that is not true must
+     * override this.
+     * @param sd score_data describing the most favorable document
+     */
+    double max_initial_score(const score_data& sd) const override;
+
     /**
      * Calculates the smoothed probability of a term.
      * @param sd
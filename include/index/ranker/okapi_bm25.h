@@ -48,6 +48,24 @@ class okapi_bm25 : public ranker
      */
     double score_one(const score_data& sd) override;
 
+    /**
+     * @param sd score_data for the current query
+     * @param block The postings to score
+     * @param scores Set to the score of each posting
+     */
+    void score_block(const score_data& sd, const posting_block& block,
+                     std::vector<double>& scores) override;
+
+    /**
+     * @param sd score_data describing the most favorable document
+     */
+    double max_score_one(const score_data& sd) override;
+
+    /**
+     * @return the signature of this ranker
+     */
+    std::string signature() const override;
+
   private:
     /// Doc term smoothing
     const double k1_;
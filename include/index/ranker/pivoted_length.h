@@ -41,6 +41,24 @@ class pivoted_length : public ranker
      */
     double score_one(const score_data& sd) override;
 
+    /**
+     * @param sd the score_data for this query
+     * @param block The postings to score
+     * @param scores Set to the score of each posting
+     */
+    void score_block(const score_data& sd, const posting_block& block,
+                     std::vector<double>& scores) override;
+
+    /**
+     * @param sd the score_data describing the most favorable document
+     */
+    double max_score_one(const score_data& sd) override;
+
+    /**
+     * @return the signature of this ranker
+     */
+    std::string signature() const override;
+
   private:
     /// s parameter for pivoted_length normalization
     const double s_;
@@ -9,9 +9,14 @@
 #ifndef META_RANKER_H_
 #define META_RANKER_H_
 
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "index/score_data.h"
 #include "meta.h"
 
 namespace meta
@@ -34,19 +39,71 @@ namespace meta
 namespace index
 {
 
+/**
+ * The ways in which a ranker can traverse the postings lists of the query
+ * terms. All strategies return exactly the same results; they differ only
+ * in how much work is done to find them.
+ */
+enum class query_strategy
+{
+    /// Accumulate scores for every matching document, one term at a time
+    term_at_a_time,
+    /// Document-at-a-time with WAND pruning on per-term score bounds
+    wand,
+    /// WAND that additionally prunes using per-block score bounds
+    block_max_wand
+};
+
+/**
+ * Statistics of a collection that is split across several indexes. Scoring
+ * one of the indexes with the statistics of the whole collection gives
+ * every document the score it would have in a single index over the whole
+ * collection.
+ */
+struct collection_stats
+{
+    /**
+     * Statistics about a single term in the collection.
+     */
+    struct term_counts
+    {
+        /// the number of documents the term appears in
+        uint64_t doc_freq;
+        /// the number of times the term appears in the collection
+        uint64_t corpus_count;
+    };
+
+    /// the number of documents that have not been deleted
+    uint64_t num_docs;
+    /// the total number of terms in documents that have not been deleted
+    uint64_t total_terms;
+    /// the average length of documents that have not been deleted
+    double avg_dl;
+    /// the statistics of the query terms, by term
+    std::unordered_map<std::string, term_counts> terms;
+};
+
 /**
  * A ranker scores a query against all the documents in an inverted index,
  * returning a list of documents sorted by relevance.
+ *
+ * Documents with equal scores are ordered by increasing doc_id.
  */
 class ranker
 {
   public:
+    /**
+     * Constructor; rankers use term-at-a-time processing by default.
+     */
+    ranker();
+
     /**
      * @param idx The index this ranker is operating on
      * @param query The current query
      * @param num_results The number of results to return in the vector
      * @param filter A filtering function to apply to each doc_id; returns true
-     * if the document should be included in results
+     * if the document should be included in results. Deleted documents are
+     * never included.
      */
     std::vector<std::pair<doc_id, double>>
     score(inverted_index& idx, corpus::document& query,
@@ -55,6 +112,26 @@ class ranker
               return true;
           });
 
+    /**
+     * Scores a query against an index that holds part of a collection,
+     * using the statistics of the whole collection instead of the
+     * index's own. Query terms missing from stats are scored with the
+     * index's statistics.
+     * @param idx The index this ranker is operating on
+     * @param query The current query
+     * @param stats The statistics of the whole collection
+     * @param num_results The number of results to return in the vector
+     * @param filter A filtering function to apply to each doc_id; returns true
+     * if the document should be included in results. Deleted documents are
+     * never included.
+     */
+    std::vector<std::pair<doc_id, double>>
+    score(inverted_index& idx, corpus::document& query,
+          const collection_stats& stats, uint64_t num_results = 10,
+          const std::function<bool(doc_id d_id)>& filter = [](doc_id) {
+              return true;
+          });
+
     /**
      * Computes the contribution to the score of a document for a matched
      * query term.
@@ -62,6 +139,24 @@ class ranker
      */
     virtual double score_one(const score_data& sd) = 0;
 
+    /**
+     * Computes score_one for every posting in a block of postings of the
+     * current query term. The term-based fields of sd describe the term,
+     * and the document-based info comes from the block.
+     *
+     * The default calls score_one for each posting; rankers should
+     * override this to compute the parts of their formula that depend
+     * only on the term once per block. Overrides must return exactly what
+     * score_one would.
+     *
+     * @param sd The score_data for the query
+     * @param block The postings to score
+     * @param scores Set to the score of each posting in the block; it has
+     * as many elements as the block
+     */
+    virtual void score_block(const score_data& sd, const posting_block& block,
+                             std::vector<double>& scores);
+
     /**
      * Computes the constant contribution to the score of a particular
      * document.
@@ -69,14 +164,135 @@ class ranker
      */
     virtual double initial_score(const score_data& sd) const;
 
+    /**
+     * Computes an upper bound on score_one for the current query term over
+     * a set of documents. The document-based fields of sd describe the
+     * most favorable document in the set: doc_term_count is the largest
+     * count of the term in any of them, while doc_size and
+     * doc_unique_terms are lower bounds on their lengths and numbers of
+     * unique terms.
+     *
+     * The default returns infinity, which disables pruning; rankers must
+     * override this to benefit from the wand and block_max_wand
+     * strategies.
+     *
+     * @param sd The score_data for the query
+     */
+    virtual double max_score_one(const score_data& sd);
+
+    /**
+     * Computes an upper bound on initial_score over all documents, using
+     * the same conventions for sd as max_score_one. Rankers that override
+     * initial_score must override this as well.
+     *
+     * @param sd The score_data for the query
+     */
+    virtual double max_initial_score(const score_data& sd) const;
+
+    /**
+     * @param strategy The way postings should be traversed by score()
+     */
+    void strategy(query_strategy strategy);
+
+    /**
+     * @return the way postings are traversed by score()
+     */
+    query_strategy strategy() const;
+
+    /**
+     * Identifies this ranker and its parameters, so that the results of
+     * its queries can be cached: rankers with equal signatures must give
+     * every query the same results. The default is empty, which means the
+     * results of the ranker are never cached.
+     * @return the signature of this ranker
+     */
+    virtual std::string signature() const;
+
     /**
      * Default destructor.
      */
     virtual ~ranker() = default;
 
+  protected:
+    /**
+     * @param id The identifier of a ranker
+     * @param params The parameters of the ranker
+     * @return a signature holding the identifier and the exact value of
+     * every parameter
+     */
+    static std::string make_signature(const std::string& id,
+                                      std::initializer_list<double> params);
+
   private:
+    /**
+     * Scores a tokenized query with the chosen strategy.
+     * @param sd The score_data for the query
+     * @param stats The statistics of the whole collection, or nullptr to
+     * use the index's own
+     * @param num_results The number of results to return
+     * @param filter The filtering function to apply to each doc_id
+     */
+    std::vector<std::pair<doc_id, double>>
+        score(score_data& sd, const collection_stats* stats,
+              uint64_t num_results,
+              const std::function<bool(doc_id)>& filter);
+
+    /**
+     * Scores the query by accumulating a score for every matching document
+     * one term at a time.
+     * @param sd The score_data for the query
+     * @param stats The statistics of the whole collection, or nullptr
+     * @param num_results The number of results to return
+     * @param filter The filtering function to apply to each doc_id
+     */
+    std::vector<std::pair<doc_id, double>>
+        score_term_at_a_time(score_data& sd, const collection_stats* stats,
+                             uint64_t num_results,
+                             const std::function<bool(doc_id)>& filter);
+
+    /**
+     * Scores the query one document at a time, skipping documents whose
+     * score bounds show they cannot enter the top num_results.
+     * @param sd The score_data for the query
+     * @param stats The statistics of the whole collection, or nullptr
+     * @param num_results The number of results to return
+     * @param filter The filtering function to apply to each doc_id
+     * @param block_max Whether to use per-block score bounds in addition
+     * to per-term score bounds
+     */
+    std::vector<std::pair<doc_id, double>>
+        score_document_at_a_time(score_data& sd,
+                                 const collection_stats* stats,
+                                 uint64_t num_results,
+                                 const std::function<bool(doc_id)>& filter,
+                                 bool block_max);
+
+    /**
+     * Loads the document-based info of a range of postings_ into block_.
+     * @param idx The index being searched
+     * @param start The position of the first posting in the range
+     * @param size The number of postings in the range
+     */
+    void load_block(const inverted_index& idx, uint64_t start,
+                    uint64_t size);
+
+    /// the term_id of each query term, in the order of the query's counts
+    std::vector<term_id> term_ids_;
+
     /// results per doc_id
     std::vector<double> results_;
+
+    /// the scores of the block of postings being scored
+    std::vector<double> block_scores_;
+
+    /// the postings of the query term being scored
+    std::vector<std::pair<doc_id, double>> postings_;
+
+    /// the block of postings being scored
+    posting_block block_;
+
+    /// how postings are traversed by score()
+    query_strategy strategy_;
 };
 }
 }
@@ -10,6 +10,8 @@
 #ifndef META_SCORE_DATA_H_
 #define META_SCORE_DATA_H_
 
+#include <vector>
+
 #include "meta.h"
 
 namespace meta
@@ -44,7 +46,7 @@ struct score_data
     inverted_index& idx;
     /// average document length
     double avg_dl;
-    /// total number of documents
+    /// total number of documents that have not been deleted
     uint64_t num_docs;
     /// total number of terms in the index
     uint64_t total_terms;
@@ -77,7 +79,8 @@ struct score_data
      * Constructor to initialize most elements.
      * @param p_idx The index that is being used
      * @param p_avg_dl The average doc length in the index
-     * @param p_num_docs The number of docs in the index
+     * @param p_num_docs The number of docs in the index that have not been
+     * deleted
      * @param p_total_terms The total number of terms in the index
      * @param p_query The current query
      */
@@ -92,6 +95,32 @@ struct score_data
         /* nothing */
     }
 };
+
+/**
+ * The document-based info of score_data for a block of postings of a
+ * single term, stored as parallel arrays so that rankers can score a whole
+ * block in one loop. Counts and lengths are stored as doubles since that
+ * is how the scoring functions use them.
+ */
+struct posting_block
+{
+    /// document ids
+    std::vector<doc_id> d_ids;
+    /// number of times the term appears in each doc
+    std::vector<double> doc_term_counts;
+    /// total number of terms in each doc
+    std::vector<double> doc_sizes;
+    /// number of unique terms in each doc
+    std::vector<double> doc_unique_terms;
+
+    /**
+     * @return the number of postings in the block
+     */
+    uint64_t size() const
+    {
+        return d_ids.size();
+    }
+};
 }
 }
 
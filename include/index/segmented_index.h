@@ -0,0 +1,316 @@
+/**
+ * @file segmented_index.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_SEGMENTED_INDEX_H_
+#define META_INDEX_SEGMENTED_INDEX_H_
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "index/inverted_index.h"
+#include "meta.h"
+#include "parallel/thread_pool.h"
+
+namespace meta
+{
+
+namespace corpus
+{
+class corpus;
+class document;
+}
+
+namespace index
+{
+
+class ranker;
+struct collection_stats;
+
+/**
+ * An inverted index that grows by adding documents instead of being
+ * rebuilt. It is made of immutable segments, each a complete
+ * inverted_index stored in its own directory under the location named by
+ * the "inverted-index" key of the configuration. New documents are
+ * indexed into a new segment and searched together with the existing ones.
+ *
+ * Segments are kept in the order their documents were added, and a
+ * document's doc_id is the number of documents added before it, so
+ * doc_ids are unchanged when segments are merged. Deleted documents keep
+ * their doc_ids too, though their postings are dropped by merges.
+ *
+ * Segments are merged in the background by a tiered policy: a segment's
+ * tier is the number of digits of its number of documents written in base
+ * merge_factor, and whenever merge_factor adjacent segments share a tier
+ * they are merged into one segment in a higher tier. Merging reuses the
+ * segments' postings, so documents are never tokenized again.
+ *
+ * The segments that make up the index are listed in its "segments" file,
+ * which is replaced atomically whenever they change. Segment directories
+ * it does not list, left by a build or merge that was interrupted, are
+ * removed when the index is opened.
+ */
+class segmented_index
+{
+  public:
+    /**
+     * Basic exception for segmented_index interactions.
+     */
+    class segmented_index_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    using exception = segmented_index_exception;
+
+    /**
+     * One of the indexes that make up a segmented_index.
+     */
+    struct segment
+    {
+        /// the name of the segment's directory
+        std::string name;
+        /// the segment itself
+        std::shared_ptr<inverted_index> index;
+        /// the doc_id in the segmented_index of the segment's first document
+        doc_id first_doc;
+    };
+
+    /**
+     * Opens the segmented index named by a configuration, creating an
+     * empty one if it does not exist yet. The configuration is saved with
+     * the index, and every segment is built with the saved copy.
+     * @param config_file The path to the configuration file
+     * @param merge_factor The number of segments of a tier that are
+     * merged together
+     * @param num_threads The number of threads that merge segments
+     */
+    segmented_index(const std::string& config_file, uint64_t merge_factor = 10,
+                    size_t num_threads = 1);
+
+    /**
+     * Waits for the merges in progress to finish.
+     */
+    ~segmented_index();
+
+    /**
+     * segmented_index may not be copy-constructed.
+     */
+    segmented_index(const segmented_index&) = delete;
+
+    /**
+     * segmented_index may not be copy-assigned.
+     */
+    segmented_index& operator=(const segmented_index&) = delete;
+
+    /**
+     * @return the location of this index
+     */
+    std::string index_name() const;
+
+    /**
+     * Indexes documents into a new segment and schedules any merges that
+     * it makes possible. Documents may be added from several threads at
+     * once.
+     * @param docs The documents to add
+     * @return the doc_id of the first document added
+     */
+    doc_id add(corpus::corpus& docs);
+
+    /**
+     * Marks a document as deleted in the segment that holds it. Its
+     * postings are removed when the segment is next merged.
+     * @param d_id The document to delete
+     */
+    void delete_doc(doc_id d_id);
+
+    /**
+     * @param d_id The document to check
+     * @return whether the document has been deleted
+     */
+    bool is_deleted(doc_id d_id) const;
+
+    /**
+     * @return the number of documents that have been deleted
+     */
+    uint64_t num_deleted() const;
+
+    /**
+     * Schedules a merge of every segment holding deleted documents that is
+     * not already being merged, on its own, to remove their postings.
+     */
+    void compact();
+
+    /**
+     * Waits for every merge scheduled so far, and those they lead to, to
+     * finish. Rethrows the exception thrown by a failed merge, if any.
+     */
+    void wait_for_merges();
+
+    /**
+     * The segments returned remain usable while merges replace them.
+     * @return the segments that make up the index, in order
+     */
+    std::vector<segment> segments() const;
+
+    /**
+     * @return the number of segments that make up the index
+     */
+    uint64_t num_segments() const;
+
+    /**
+     * Scores a query against every segment and combines their results.
+     * Every segment is scored with the term and collection statistics of
+     * the whole index, so documents get the same scores they would in a
+     * single inverted_index holding them all.
+     * @param r The ranker to score with
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @return the best num_results documents, best first
+     */
+    std::vector<std::pair<doc_id, double>>
+        score(ranker& r, corpus::document& query,
+              uint64_t num_results = 10) const;
+
+    /**
+     * @return the number of documents in the index
+     */
+    uint64_t num_docs() const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the path of the file containing the document
+     */
+    std::string doc_path(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the name of the document, without its path
+     */
+    std::string doc_name(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the number of terms in the document
+     */
+    uint64_t doc_size(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the class label of the document
+     */
+    class_label label(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the number of unique terms in the document
+     */
+    uint64_t unique_terms(doc_id d_id) const;
+
+  private:
+    /**
+     * @param segs The segments to be searched
+     * @param query A tokenized query
+     * @return the statistics of the documents in the segments for the
+     * query
+     */
+    collection_stats query_stats(const std::vector<segment>& segs,
+                                 const corpus::document& query) const;
+
+    /**
+     * @param d_id A document in the index
+     * @return the segment holding the document, and the document's doc_id
+     * within it; must be called with the mutex held
+     */
+    std::pair<segment, doc_id> locate(doc_id d_id) const;
+
+    /**
+     * @return the number of documents in the index; must be called with
+     * the mutex held
+     */
+    uint64_t end_doc() const;
+
+    /**
+     * @param name The name of a segment
+     * @return a new, empty inverted_index for the segment
+     */
+    std::shared_ptr<inverted_index> make_segment(const std::string& name) const;
+
+    /**
+     * Saves the list of segments with the name marked as used, before
+     * its directory is made.
+     * @return the name for a new segment; must be called with the mutex
+     * held
+     */
+    std::string next_name();
+
+    /**
+     * Writes the list of segments; must be called with the mutex held.
+     */
+    void save_manifest() const;
+
+    /**
+     * Starts a merge for every run of merge_factor_ adjacent segments in
+     * the same tier that are not already being merged; must be called
+     * with the mutex held.
+     */
+    void schedule_merges();
+
+    /**
+     * Starts merging a run of adjacent segments that are not being merged;
+     * must be called with the mutex held.
+     * @param first The position of the first segment in the run
+     * @param last The position just past the last segment in the run
+     */
+    void start_merge(uint64_t first, uint64_t last);
+
+    /**
+     * Merges a run of adjacent segments and replaces them with the result.
+     * @param run The segments to merge
+     * @param name The name of the merged segment
+     */
+    void merge(const std::vector<segment>& run, const std::string& name);
+
+    /// the location of this index
+    std::string index_name_;
+
+    /// the path of the configuration saved with this index
+    std::string config_file_;
+
+    /// the number of segments of a tier that are merged together
+    uint64_t merge_factor_;
+
+    /// the number used to name the next segment
+    uint64_t next_segment_;
+
+    /// the segments that make up the index, in order
+    std::vector<segment> segments_;
+
+    /// the names of the segments being merged
+    std::unordered_set<std::string> merging_;
+
+    /// the merges that have not been waited for
+    std::vector<std::future<void>> merges_;
+
+    /// guards the segments and the merges
+    mutable std::mutex mutex_;
+
+    /// the threads that merge segments; destroyed first
+    parallel::thread_pool pool_;
+};
+}
+}
+
+#endif
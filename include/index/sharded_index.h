@@ -0,0 +1,217 @@
+/**
+ * @file sharded_index.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_INDEX_SHARDED_INDEX_H_
+#define META_INDEX_SHARDED_INDEX_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "index/inverted_index.h"
+#include "index/ranker/ranker.h"
+#include "meta.h"
+#include "parallel/thread_pool.h"
+
+namespace meta
+{
+
+namespace corpus
+{
+class document;
+}
+
+namespace index
+{
+
+/**
+ * An index over a corpus that is split into several shards, each a
+ * complete inverted_index stored in its own directory under the location
+ * named by the "inverted-index" key of the configuration. The corpus is
+ * split into contiguous ranges of documents when the index is built, so a
+ * document's doc_id is the same as in an unsharded index of the corpus.
+ *
+ * Queries are scored on every shard in parallel and the best results of
+ * each are merged. Each shard is scored with the term and collection
+ * statistics of the whole corpus, so scores and rankings are identical to
+ * those of an unsharded index.
+ */
+class sharded_index
+{
+  public:
+    /**
+     * Basic exception for sharded_index interactions.
+     */
+    class sharded_index_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    using exception = sharded_index_exception;
+
+    /// The ranking for a single query, best first
+    using ranking = std::vector<std::pair<doc_id, double>>;
+
+    /// Creates the ranker used to score one shard
+    using ranker_factory = std::function<std::unique_ptr<ranker>()>;
+
+    /**
+     * One of the indexes that make up a sharded_index.
+     */
+    struct shard
+    {
+        /// the shard itself
+        std::shared_ptr<inverted_index> index;
+        /// the doc_id in the sharded_index of the shard's first document
+        doc_id first_doc;
+    };
+
+    /**
+     * Opens the sharded index named by a configuration, building it from
+     * the configuration's corpus if it does not exist yet. The
+     * configuration is saved with the index, and every shard is built with
+     * the saved copy.
+     * @param config_file The path to the configuration file
+     * @param num_shards The number of shards to split the corpus into when
+     * building the index; an existing index keeps the shards it was built
+     * with
+     * @param num_threads The number of threads that score shards
+     */
+    sharded_index(const std::string& config_file, uint64_t num_shards,
+                  size_t num_threads = std::thread::hardware_concurrency());
+
+    /**
+     * sharded_index may not be copy-constructed.
+     */
+    sharded_index(const sharded_index&) = delete;
+
+    /**
+     * sharded_index may not be copy-assigned.
+     */
+    sharded_index& operator=(const sharded_index&) = delete;
+
+    /**
+     * @return the location of this index
+     */
+    std::string index_name() const;
+
+    /**
+     * @return the shards that make up the index, in order
+     */
+    const std::vector<shard>& shards() const;
+
+    /**
+     * @return the number of shards that make up the index
+     */
+    uint64_t num_shards() const;
+
+    /**
+     * Scores a query against every shard in parallel and merges their
+     * results. Queries may be scored from several threads at once.
+     * @param make_ranker Creates the ranker for each shard; it is called
+     * once per shard for every query, and every ranker it creates should
+     * be configured identically
+     * @param query The query to score
+     * @param num_results The number of results to return
+     * @param filter A filtering function to apply to each doc_id; returns
+     * true if the document should be included in results. It is called
+     * from several threads at once.
+     * @return the best num_results documents, best first
+     */
+    ranking score(const ranker_factory& make_ranker, corpus::document& query,
+                  uint64_t num_results = 10,
+                  const std::function<bool(doc_id d_id)>& filter
+                  = [](doc_id)
+                  {
+                      return true;
+                  });
+
+    /**
+     * @return the number of documents in the index
+     */
+    uint64_t num_docs() const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the path of the file containing the document
+     */
+    std::string doc_path(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the name of the document, without its path
+     */
+    std::string doc_name(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the number of terms in the document
+     */
+    uint64_t doc_size(doc_id d_id) const;
+
+    /**
+     * @param d_id The document to look up
+     * @return the class label of the document
+     */
+    class_label label(doc_id d_id) const;
+
+  private:
+    /**
+     * Splits the configuration's corpus into shards and builds them.
+     * @param num_shards The number of shards to build
+     */
+    void build(uint64_t num_shards);
+
+    /**
+     * @param s The position of a shard
+     * @return a new, empty inverted_index for the shard
+     */
+    std::shared_ptr<inverted_index> make_shard(uint64_t s) const;
+
+    /**
+     * @param query A tokenized query
+     * @return the statistics of the whole corpus for the query
+     */
+    collection_stats query_stats(const corpus::document& query) const;
+
+    /**
+     * @param d_id A document in the index
+     * @return the shard holding the document, and the document's doc_id
+     * within it
+     */
+    std::pair<const shard&, doc_id> locate(doc_id d_id) const;
+
+    /// the location of this index
+    std::string index_name_;
+
+    /// the path of the configuration saved with this index
+    std::string config_file_;
+
+    /// the shards that make up the index, in order
+    std::vector<shard> shards_;
+
+    /// the statistics of the whole corpus, without any query terms
+    collection_stats stats_;
+
+    /// guards the analyzer used to tokenize queries
+    std::mutex tokenize_mutex_;
+
+    /// the threads that score shards; destroyed first
+    parallel::thread_pool pool_;
+};
+}
+}
+
+#endif
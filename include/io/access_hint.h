@@ -0,0 +1,156 @@
+/**
+ * @file access_hint.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_IO_ACCESS_HINT_H_
+#define META_IO_ACCESS_HINT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace meta
+{
+namespace io
+{
+
+/**
+ * How a range of a memory-mapped file is about to be read, which lets the
+ * kernel choose how much to read ahead of page faults in it.
+ */
+enum class access_hint
+{
+    /// read ahead a little around every page fault (the kernel's default)
+    normal,
+    /// pages are read in no particular order, so nothing is read ahead
+    random,
+    /// pages are read in order, so read ahead aggressively
+    sequential,
+    /// the pages will be read soon, so start reading them in now
+    will_need
+};
+
+/**
+ * Gives the kernel a hint about how a range of a memory-mapped region will
+ * be read. Hints are only advice, so a hint the kernel rejects is ignored;
+ * will_need returns without waiting for the pages to be read in.
+ *
+ * @param start The beginning of the mapped region, which is page-aligned
+ * @param size The size of the mapped region in bytes
+ * @param hint How the range will be read
+ * @param offset The first byte of the range, relative to start
+ * @param length The number of bytes in the range; it is cut off at the end
+ * of the region
+ */
+inline void advise(const void* start, uint64_t size, access_hint hint,
+                   uint64_t offset = 0,
+                   uint64_t length = std::numeric_limits<uint64_t>::max())
+{
+    if (!start || offset >= size)
+        return;
+    length = std::min(length, size - offset);
+
+    // madvise() needs the range to start on a page boundary
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t first = offset - offset % page_size;
+    length += offset - first;
+
+    int advice = MADV_NORMAL;
+    switch (hint)
+    {
+        case access_hint::normal:
+            advice = MADV_NORMAL;
+            break;
+        case access_hint::random:
+            advice = MADV_RANDOM;
+            break;
+        case access_hint::sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case access_hint::will_need:
+            advice = MADV_WILLNEED;
+            break;
+    }
+
+    auto begin = static_cast<char*>(const_cast<void*>(start)) + first;
+    madvise(begin, length, advice);
+}
+
+/**
+ * Checks whether a range of a memory-mapped region is in memory, so that
+ * reading it would not wait on the disk.
+ *
+ * @param start The beginning of the mapped region, which is page-aligned
+ * @param size The size of the mapped region in bytes
+ * @param offset The first byte of the range, relative to start
+ * @param length The number of bytes in the range; it is cut off at the end
+ * of the region
+ * @return whether every page of the range is in memory; false if the
+ * kernel cannot tell
+ */
+inline bool resident(const void* start, uint64_t size, uint64_t offset,
+                     uint64_t length)
+{
+    if (!start || offset >= size)
+        return true;
+    length = std::min(length, size - offset);
+
+    // mincore() also needs the range to start on a page boundary
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t first = offset - offset % page_size;
+    length += offset - first;
+
+    std::vector<unsigned char> pages((length + page_size - 1) / page_size);
+    auto begin = static_cast<char*>(const_cast<void*>(start)) + first;
+    if (mincore(begin, length, pages.data()) != 0)
+        return false;
+    return std::all_of(pages.begin(), pages.end(), [](unsigned char page)
+                       {
+                           return (page & 1) != 0;
+                       });
+}
+
+/**
+ * Reads the pages of a range of a memory-mapped region into memory before
+ * returning, so that the first reads from them after a process starts do
+ * not fault.
+ *
+ * @param start The beginning of the mapped region, which is page-aligned
+ * @param size The size of the mapped region in bytes
+ * @param offset The first byte of the range, relative to start
+ * @param length The number of bytes in the range; it is cut off at the end
+ * of the region
+ * @return the number of bytes in the range, once it has been cut off
+ */
+inline uint64_t warm(const void* start, uint64_t size, uint64_t offset,
+                     uint64_t length)
+{
+    if (!start || offset >= size)
+        return 0;
+    length = std::min(length, size - offset);
+
+    // the kernel reads the whole range in at once, and then every page is
+    // touched to map it
+    advise(start, size, access_hint::will_need, offset, length);
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto bytes = static_cast<const volatile char*>(start);
+    char sink = 0;
+    for (uint64_t i = offset; i < offset + length; i += page_size)
+        sink ^= bytes[i];
+    if (length > 0)
+        sink ^= bytes[offset + length - 1];
+    (void)sink;
+    return length;
+}
+}
+}
+
+#endif
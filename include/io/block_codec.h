@@ -0,0 +1,70 @@
+/**
+ * @file block_codec.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_IO_BLOCK_CODEC_H_
+#define META_IO_BLOCK_CODEC_H_
+
+#include <cstdint>
+
+namespace meta
+{
+namespace io
+{
+
+/**
+ * Functions for bit-packing fixed-size blocks of unsigned integers. Every
+ * value in a block is stored using the same number of bits (the width of
+ * the largest value in the block), so a block of block_size values at
+ * width w occupies exactly 2 * w 64-bit words.
+ *
+ * Unpacking is specialized for every possible width so that the inner
+ * loop has a constant trip count and constant shifts, which allows the
+ * compiler to fully unroll and vectorize it.
+ */
+namespace block
+{
+
+/// The number of integers in each packed block
+const static constexpr uint64_t block_size = 128;
+
+/**
+ * @param width The bit width of each value in the block
+ * @return the number of 64-bit words needed to hold a packed block
+ */
+inline uint64_t num_words(uint8_t width)
+{
+    return width * block_size / 64;
+}
+
+/**
+ * @param values The block_size values that will be packed
+ * @return the minimum number of bits required to represent every value
+ */
+uint8_t bit_width(const uint64_t* values);
+
+/**
+ * Packs block_size values into num_words(width) words.
+ * @param values The values to pack
+ * @param width The number of bits to use for each value
+ * @param out The location to write the packed words to
+ */
+void pack(const uint64_t* values, uint8_t width, uint64_t* out);
+
+/**
+ * Unpacks num_words(width) words into block_size values.
+ * @param words The packed words
+ * @param width The number of bits used for each value
+ * @param out The location to write the block_size values to
+ */
+void unpack(const uint64_t* words, uint8_t width, uint64_t* out);
+}
+}
+}
+
+#endif
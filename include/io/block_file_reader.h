@@ -0,0 +1,116 @@
+/**
+ * @file block_file_reader.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BLOCK_FILE_READER_H_
+#define META_BLOCK_FILE_READER_H_
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace meta
+{
+namespace io
+{
+
+class mmap_file;
+
+/**
+ * Reads a file written by block_file_writer. Single values are decoded a
+ * byte at a time, while packed blocks are decoded a whole block at a time.
+ */
+class block_file_reader
+{
+  public:
+    /**
+     * Constructor; reads from an already memory-mapped file.
+     * @param file The file to read from
+     */
+    block_file_reader(const mmap_file& file);
+
+    /**
+     * Constructor to create a new mmap file for reading.
+     * @param filename The filename for the new file to read from
+     */
+    block_file_reader(const std::string& filename);
+
+    /**
+     * Move constructor.
+     */
+    block_file_reader(block_file_reader&&);
+
+    /**
+     * Move assignment.
+     */
+    block_file_reader& operator=(block_file_reader&&);
+
+    /**
+     * Destructor.
+     */
+    ~block_file_reader();
+
+    /**
+     * Sets the cursor to the specified position in the file. It is up to
+     * the user to specify a valid position.
+     * @param byte_offset Byte offset into the file
+     */
+    void seek(uint64_t byte_offset);
+
+    /**
+     * @return whether there is more data in the file
+     */
+    bool has_next() const;
+
+    /**
+     * @return the next single (variable-byte encoded) value
+     */
+    uint64_t next();
+
+    /**
+     * Decodes the next packed block.
+     * @param out The location to write block::block_size values to
+     */
+    void next_block(uint64_t* out);
+
+    /**
+     * @return the current byte location in this file
+     */
+    uint64_t byte_location() const;
+
+  private:
+    /**
+     * Pointer to the mmap_file we are reading: nullptr if we don't own it,
+     * initialized if we do
+     */
+    std::unique_ptr<mmap_file> file_;
+
+    /// Pointer to the beginning of the file
+    const char* start_;
+
+    /// The number of bytes in this file
+    uint64_t size_;
+
+    /// The current byte in the file
+    uint64_t cursor_;
+
+  public:
+    /**
+     * Basic exception for block_file_reader interactions.
+     */
+    class block_file_reader_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+};
+}
+}
+
+#endif
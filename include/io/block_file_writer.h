@@ -0,0 +1,88 @@
+/**
+ * @file block_file_writer.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BLOCK_FILE_WRITER_H_
+#define META_BLOCK_FILE_WRITER_H_
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace meta
+{
+namespace io
+{
+
+/**
+ * Writes a byte-aligned file of unsigned integers that is made up of
+ * bit-packed blocks (see block_codec.h) and variable-byte encoded single
+ * values. This is the block-oriented alternative to the gamma codes
+ * written by compressed_file_writer.
+ */
+class block_file_writer
+{
+  public:
+    /**
+     * Constructor; opens a block file for writing or creates a new file if
+     * it doesn't exist.
+     * @param filename The path to the file
+     */
+    block_file_writer(const std::string& filename);
+
+    /**
+     * Destructor; closes the file.
+     */
+    ~block_file_writer();
+
+    /**
+     * @return the byte offset of the current location in the file
+     */
+    uint64_t byte_location() const;
+
+    /**
+     * Writes a single value to the end of the file using a variable-byte
+     * code.
+     * @param value The number to write
+     */
+    void write(uint64_t value);
+
+    /**
+     * Bit-packs and writes exactly block::block_size values to the end of
+     * the file.
+     * @param values The values to write
+     */
+    void write_block(const uint64_t* values);
+
+    /**
+     * Closes this file.
+     */
+    void close();
+
+  private:
+    /// Where to write the data
+    std::ofstream outfile_;
+
+    /// The number of bytes that have been written (for seeking)
+    uint64_t byte_location_;
+
+  public:
+    /**
+     * Basic exception for block_file_writer interactions.
+     */
+    class block_file_writer_exception : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+};
+}
+}
+
+#endif
@@ -34,6 +34,11 @@ enum ReaderStatus
 
 /**
  * Represents a file of unsigned integers compressed using gamma compression.
+ *
+ * The file is read from memory, either from a memory-mapped file or from a
+ * buffer the caller owns, 64 bits at a time: the bits after the cursor are
+ * kept in a machine word, so the zeros before a value are counted with a
+ * single count-leading-zeros and its bits are taken with a shift.
  */
 class compressed_file_reader
 {
@@ -59,6 +64,29 @@ class compressed_file_reader
     compressed_file_reader(const std::string& filename,
                            std::function<uint64_t(uint64_t)> mapping);
 
+    /**
+     * Constructor to read compressed data that is already in memory, such
+     * as the contents of a buffer written by a compressed_file_writer. The
+     * data is not copied, so it must outlive the reader.
+     * @param data The beginning of the compressed data
+     * @param size The number of bytes of compressed data
+     * @param mapping A function to map the original numbers to their
+     * compressed id, usually to take advantage of a skewed distribution of
+     * towards many small numbers
+     */
+    compressed_file_reader(const char* data, uint64_t size,
+                           std::function<uint64_t(uint64_t)> mapping);
+
+    /**
+     * Move constructor.
+     */
+    compressed_file_reader(compressed_file_reader&&);
+
+    /**
+     * Move assignment.
+     */
+    compressed_file_reader& operator=(compressed_file_reader&&);
+
     /**
      * Destructor.
      */
@@ -117,9 +145,17 @@ class compressed_file_reader
     void get_next();
 
     /**
-     * @return the next bit in the file
+     * Loads bytes into the word until it holds more than 56 bits, or the
+     * rest of the file.
      */
-    bool read_bit();
+    void refill();
+
+    /**
+     * Moves the cursor past bits in the word.
+     * @param num_bits The number of bits to skip, at most the number of
+     * bits in the word
+     */
+    void skip(uint64_t num_bits);
 
     /**
      * Pointer to the mmap_file we are reading: nullptr if we don't own it,
@@ -131,7 +167,7 @@ class compressed_file_reader
      * Pointer to the beginning of the compressed file (which will be in
      * memory most of the time)
      */
-    char* start_;
+    const char* start_;
 
     /// the number of bytes in this compressed file
     uint64_t size_;
@@ -142,11 +178,15 @@ class compressed_file_reader
     /// current numeric value that was read
     uint64_t current_value_;
 
-    /// current byte in the compressed file
-    uint64_t current_char_;
+    /// the bits after the cursor, starting at the most significant bit;
+    /// the bits past the ones loaded are zero
+    uint64_t word_;
+
+    /// the number of bits loaded into the word
+    uint64_t word_bits_;
 
-    /// current bit inside the current byte
-    uint8_t current_bit_;
+    /// the first byte of the file not yet loaded into the word
+    uint64_t next_byte_;
 
     /// hold the (actual -> compressed id) mapping
     std::function<uint64_t(uint64_t)> mapping_;
@@ -10,9 +10,11 @@
 #ifndef META_COMPRESSED_FILE_WRITER_H_
 #define META_COMPRESSED_FILE_WRITER_H_
 
+#include <cstdio>
 #include <functional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace meta
 {
@@ -21,6 +23,11 @@ namespace io
 
 /**
  * Writes to a file of unsigned integers using gamma compression.
+ *
+ * Values are packed into a 64-bit word, a whole gamma code at a time, and
+ * each full word is appended to a buffer of bytes. The buffer is either
+ * written to a file whenever it fills up or is the caller's own, for
+ * compressed data that is kept in memory.
  */
 class compressed_file_writer
 {
@@ -36,6 +43,28 @@ class compressed_file_writer
     compressed_file_writer(const std::string& filename,
                            std::function<uint64_t(uint64_t)> mapping);
 
+    /**
+     * Constructor; writes the compressed data to the end of a buffer in
+     * memory instead of to a file. The buffer is complete once the writer
+     * is closed, and may be read with a compressed_file_reader.
+     * @param buffer The buffer to write to, which must outlive the writer
+     * @param mapping A function to map the original numbers to their
+     * compressed id, usually to take advantage of a skewed distribution of
+     * towards many small numbers
+     */
+    compressed_file_writer(std::vector<char>& buffer,
+                           std::function<uint64_t(uint64_t)> mapping);
+
+    /**
+     * compressed_file_writer may not be copy-constructed.
+     */
+    compressed_file_writer(const compressed_file_writer&) = delete;
+
+    /**
+     * compressed_file_writer may not be copy-assigned.
+     */
+    compressed_file_writer& operator=(const compressed_file_writer&) = delete;
+
     /**
      * Destructor; closes the compressed file.
      */
@@ -66,31 +95,41 @@ class compressed_file_writer
 
   private:
     /**
-     * Writes a bit to the file and advances the current location in the
-     * file.
-     * @param bit
+     * Writes bits after the ones already written.
+     * @param bits The bits to write, in the least significant bits; the
+     * rest must be zero
+     * @param num_bits The number of bits to write, from 1 to 64
+     */
+    void write_bits(uint64_t bits, uint64_t num_bits);
+
+    /**
+     * Appends the bytes of the word to the buffer, starting with its most
+     * significant byte, and writes the buffer to the file once it is full.
+     * @param num_bytes The number of bytes to append
      */
-    void write_bit(bool bit);
+    void flush_word(uint64_t num_bytes);
 
     /**
      * Writes the buffer to the file.
      */
-    void write_buffer() const;
+    void write_buffer();
 
-    /// Where to write the compressed data
+    /// Where to write the compressed data, if it isn't kept in memory
     FILE* outfile_;
 
-    /// The current byte this reader is on
-    uint64_t char_cursor_;
+    /// Bytes waiting to be written to the file
+    std::vector<char> file_buffer_;
 
-    /// The current bit of the current byte this reader is on
-    uint64_t bit_cursor_;
+    /// The buffer bytes are appended to: either file_buffer_ or the
+    /// caller's buffer
+    std::vector<char>* buffer_;
 
-    /// How large to make the internal writer buffer
-    uint64_t buffer_size_;
+    /// The bits not yet appended to the buffer, starting at the most
+    /// significant bit
+    uint64_t word_;
 
-    /// Saved data that is not yet written to disk
-    unsigned char* buffer_;
+    /// The number of bits in the word
+    uint64_t word_bits_;
 
     /// The mapping to use (actual -> compressed id)
     std::function<uint64_t(uint64_t)> mapping_;
@@ -10,9 +10,12 @@
 #ifndef META_MMAP_FILE_H_
 #define META_MMAP_FILE_H_
 
+#include <limits>
 #include <stdexcept>
 #include <string>
 
+#include "io/access_hint.h"
+
 namespace meta
 {
 namespace io
@@ -69,6 +72,34 @@ class mmap_file
      */
     char* begin() const;
 
+    /**
+     * Tells the kernel how a range of the file will be read; a will_need
+     * hint starts reading the range in without waiting for it.
+     * @param hint How the range will be read
+     * @param offset The first byte of the range
+     * @param length The number of bytes in the range, which defaults to
+     * the rest of the file
+     */
+    void advise(access_hint hint, uint64_t offset = 0,
+                uint64_t length = std::numeric_limits<uint64_t>::max()) const;
+
+    /**
+     * @param offset The first byte of a range of the file
+     * @param length The number of bytes in the range
+     * @return whether the whole range is in memory
+     */
+    bool resident(uint64_t offset, uint64_t length) const;
+
+    /**
+     * Reads a range of the file into memory before returning.
+     * @param offset The first byte of the range
+     * @param length The number of bytes in the range, which defaults to
+     * the rest of the file
+     * @return the number of bytes read in
+     */
+    uint64_t warm(uint64_t offset = 0,
+                  uint64_t length = std::numeric_limits<uint64_t>::max()) const;
+
   private:
     /// Filename of the text file
     std::string path_;
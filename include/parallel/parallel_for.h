@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -37,47 +38,72 @@ void parallel_for(Iterator begin, Iterator end, Function func)
 
 /**
  * Runs the given function on the range denoted by begin and end in parallel.
+ * Each of the pool's threads repeatedly claims the next grain_size
+ * elements until the range is exhausted, so threads that draw cheap
+ * elements simply claim more of them instead of idling while another
+ * finishes a fixed share.
+ *
  * @param begin The first element to operate on
  * @param end One past the last element to operate on
  * @param pool The thread pool to use
+ * @param grain_size The number of elements claimed at a time
  * @param func The function to perform on each element
  */
 template <class Iterator, class Function>
 void parallel_for(Iterator begin, Iterator end, thread_pool& pool,
-                  Function func)
+                  size_t grain_size, Function func)
 {
-    auto block_size = std::distance(begin, end)
-                      / std::thread::hardware_concurrency();
+    auto remaining = static_cast<size_t>(std::distance(begin, end));
+    if (remaining == 0)
+        return;
+    grain_size = std::max<size_t>(grain_size, 1);
 
-    Iterator last = begin;
-    if (block_size > 0)
-    {
-        std::advance(last,
-                     (std::thread::hardware_concurrency() - 1) * block_size);
-    }
-    else
-    {
-        last = end;
-        block_size = 1;
-    }
+    std::mutex mutex;
+    auto next = begin;
+    auto num_tasks
+        = std::min(pool.size(), (remaining + grain_size - 1) / grain_size);
 
     std::vector<std::future<void>> futures;
-    // first p - 1 groups
-    for (; begin != last; std::advance(begin, block_size))
+    for (size_t i = 0; i < num_tasks; ++i)
     {
-        futures.emplace_back(pool.submit_task([=]()
+        futures.emplace_back(pool.submit_task([&, func]() mutable
         {
-            auto mylast = begin;
-            std::advance(mylast, block_size);
-            std::for_each(begin, mylast, func);
+            while (true)
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                if (remaining == 0)
+                    return;
+                auto count = std::min(grain_size, remaining);
+                auto first = next;
+                std::advance(next, count);
+                auto last = next;
+                remaining -= count;
+                lock.unlock();
+
+                for (; first != last; ++first)
+                    func(*first);
+            }
         }));
     }
-    // last group
-    futures.emplace_back(pool.submit_task([=]()
-    { std::for_each(begin, end, func); }));
     for (auto& fut : futures)
         fut.get();
 }
+
+/**
+ * Runs the given function on the range denoted by begin and end in parallel,
+ * splitting it into about eight grains per thread.
+ * @param begin The first element to operate on
+ * @param end One past the last element to operate on
+ * @param pool The thread pool to use
+ * @param func The function to perform on each element
+ */
+template <class Iterator, class Function>
+void parallel_for(Iterator begin, Iterator end, thread_pool& pool,
+                  Function func)
+{
+    auto size = static_cast<size_t>(std::distance(begin, end));
+    parallel_for(begin, end, pool, size / (pool.size() * 8), func);
+}
 }
 }
 
@@ -13,13 +13,15 @@
 #ifndef META_THREAD_POOL_H_
 #define META_THREAD_POOL_H_
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
-#include <functional>
-#include <queue>
-#include <future>
 
 namespace meta
 {
@@ -29,6 +31,13 @@ namespace parallel
 /**
  * Represents a collection of a fixed number of threads, which tasks can be
  * added to.
+ *
+ * Each worker owns a deque of tasks. Tasks submitted from a worker go to
+ * the back of its own deque and it runs them newest first; tasks submitted
+ * from elsewhere are dealt round-robin across the deques. A worker whose
+ * deque is empty steals the oldest task from another worker's deque, so
+ * no thread sits idle while work is queued anywhere in the pool and
+ * submissions rarely contend on the same lock.
  */
 class thread_pool
 {
@@ -38,15 +47,20 @@ class thread_pool
      * with; by default, the hardware concurrency.
      */
     thread_pool(size_t num_threads = std::thread::hardware_concurrency())
-        : running_(true)
+        : running_{true}, pending_{0}, next_queue_{0}
     {
+        // hardware_concurrency() may report 0 when it cannot tell
+        num_threads = std::max<size_t>(num_threads, 1);
+        for (size_t i = 0; i < num_threads; ++i)
+            queues_.emplace_back(new task_queue);
         for (size_t i = 0; i < num_threads; ++i)
-            threads_.push_back(
-                std::thread{std::bind(&thread_pool::worker, this)});
+            threads_.emplace_back(&thread_pool::worker, this, i);
+        for (const auto& thread : threads_)
+            ids_.push_back(thread.get_id());
     }
 
     /**
-     * Destructor; joins all threads.
+     * Destructor; runs any remaining tasks and joins all threads.
      */
     ~thread_pool()
     {
@@ -75,11 +89,7 @@ class thread_pool
             new concrete_task<result_type>(func));
 
         auto future = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            tasks_.push(std::move(task));
-        }
-        cond_.notify_one();
+        push(std::move(task));
         return future;
     }
 
@@ -88,10 +98,15 @@ class thread_pool
      */
     std::vector<std::thread::id> thread_ids() const
     {
-        std::vector<std::thread::id> ids;
-        for (auto& t : threads_)
-            ids.emplace_back(t.get_id());
-        return ids;
+        return ids_;
+    }
+
+    /**
+     * @return the number of threads in the pool
+     */
+    size_t size() const
+    {
+        return threads_.size();
     }
 
     /**
@@ -99,8 +114,17 @@ class thread_pool
      */
     size_t tasks() const
     {
-        std::unique_lock<std::mutex> lock(mutex_);
-        return tasks_.size();
+        return pending_.load();
+    }
+
+    /**
+     * @return whether the calling thread is a worker of any thread_pool,
+     * so that work already running in parallel can avoid starting more
+     * threads of its own
+     */
+    static bool in_worker()
+    {
+        return worker_flag();
     }
 
   private:
@@ -160,36 +184,141 @@ class thread_pool
     };
 
     /**
-     * Function invoked by the worker threads to process tasks off the
-     * internal queue.
+     * The tasks owned by a single worker.
+     */
+    struct task_queue
+    {
+        /// the mutex guarding the deque
+        std::mutex mutex;
+        /// the tasks, oldest at the front
+        std::deque<std::unique_ptr<task>> tasks;
+    };
+
+    /**
+     * @return the index of the calling thread within the pool, or size()
+     * if it is not one of the pool's workers
+     */
+    size_t current_worker() const
+    {
+        auto id = std::this_thread::get_id();
+        for (size_t i = 0; i < ids_.size(); ++i)
+        {
+            if (ids_[i] == id)
+                return i;
+        }
+        return ids_.size();
+    }
+
+    /**
+     * @return whether the calling thread is a worker of a thread_pool
+     */
+    static bool& worker_flag()
+    {
+        static thread_local bool is_worker = false;
+        return is_worker;
+    }
+
+    /**
+     * Queues a task and wakes a worker to run it.
+     * @param task The task to queue
+     */
+    void push(std::unique_ptr<task> task)
+    {
+        auto idx = current_worker();
+        if (idx == queues_.size())
+            idx = next_queue_.fetch_add(1) % queues_.size();
+
+        // counted before it is visible, so that a worker that steals and
+        // starts it at once never takes pending_ below zero
+        ++pending_;
+        {
+            std::lock_guard<std::mutex> lock{queues_[idx]->mutex};
+            queues_[idx]->tasks.push_back(std::move(task));
+        }
+
+        // taking the lock orders this wakeup after any worker that has
+        // just found pending_ == 0 has started waiting
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+        }
+        cond_.notify_one();
+    }
+
+    /**
+     * Takes the newest task from a worker's own deque or, failing that,
+     * steals the oldest task from another worker.
+     * @param idx The worker looking for a task
+     * @return the task, or nullptr if every deque was empty
+     */
+    std::unique_ptr<task> pop(size_t idx)
+    {
+        std::unique_ptr<task> result;
+        {
+            auto& own = *queues_[idx];
+            std::lock_guard<std::mutex> lock{own.mutex};
+            if (!own.tasks.empty())
+            {
+                result = std::move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+
+        for (size_t i = 1; !result && i < queues_.size(); ++i)
+        {
+            auto& victim = *queues_[(idx + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tasks.empty())
+            {
+                result = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+
+        if (result)
+            --pending_;
+        return result;
+    }
+
+    /**
+     * Function invoked by the worker threads to process tasks off of
+     * their own deque, stealing from the others when it runs dry.
+     * @param idx The index of this worker
      */
-    void worker()
+    void worker(size_t idx)
     {
+        worker_flag() = true;
         while (true)
         {
-            std::unique_ptr<task> task;
+            if (auto task = pop(idx))
             {
-                std::unique_lock<std::mutex> lock(mutex_);
-                while (running_ && tasks_.empty())
-                    cond_.wait(lock);
-                if (!running_ && tasks_.empty())
-                    return;
-                task = std::move(tasks_.front());
-                tasks_.pop();
+                task->run();
+                continue;
             }
-            task->run();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (running_ && pending_ == 0)
+                cond_.wait(lock);
+            if (!running_ && pending_ == 0)
+                return;
         }
     }
 
     /// the threads in the pool
     std::vector<std::thread> threads_;
-    /// the queue containing the tasks to be run
-    std::queue<std::unique_ptr<task>> tasks_;
+    /// the ids of the threads in the pool, in worker order
+    std::vector<std::thread::id> ids_;
+    /// the task deques, one per worker
+    std::vector<std::unique_ptr<task_queue>> queues_;
 
     /// whether or not the pool is currently running
     bool running_;
+    /// the number of tasks queued but not yet started, counting a task
+    /// from just before it is queued
+    std::atomic<size_t> pending_;
+    /// the deque the next task submitted from outside the pool goes to
+    std::atomic<size_t> next_queue_;
 
-    /// the mutex to wrap queue operations
+    /// the mutex workers sleep under
     mutable std::mutex mutex_;
     /// the condition variable that workers sleep on when waiting for work
     std::condition_variable cond_;
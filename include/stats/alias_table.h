@@ -0,0 +1,80 @@
+/**
+ * @file alias_table.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_STATS_ALIAS_TABLE_H_
+#define META_STATS_ALIAS_TABLE_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace meta
+{
+namespace stats
+{
+
+/**
+ * A fixed discrete distribution over a set of events that can be sampled
+ * from in constant time, using Vose's alias method. Building the table
+ * takes time linear in the number of events.
+ */
+template <class T>
+class alias_table
+{
+  public:
+    /**
+     * The event type for this distribution.
+     */
+    using event_type = T;
+
+    /**
+     * Creates an empty table. It may not be sampled from.
+     */
+    alias_table() = default;
+
+    /**
+     * Builds the table.
+     *
+     * @param events The events of the distribution
+     * @param weights The (unnormalized, non-negative) weight of each
+     * event; must be the same length as events and sum to a positive
+     * number
+     */
+    alias_table(std::vector<T> events, const std::vector<double>& weights);
+
+    /**
+     * Samples from the distribution.
+     * @param gen The random number generator to be used
+     */
+    template <class Generator>
+    const T& operator()(Generator&& gen) const;
+
+    /**
+     * @return the number of events in the table
+     */
+    uint64_t size() const;
+
+    /**
+     * @return whether the table has no events
+     */
+    bool empty() const;
+
+  private:
+    /// The events, in the order they were given
+    std::vector<T> events_;
+
+    /// The probability of keeping each slot's own event
+    std::vector<double> keep_;
+
+    /// The slot whose event is used when a slot's own event is not kept
+    std::vector<uint64_t> alias_;
+};
+}
+}
+#include "stats/alias_table.tcc"
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file alias_table.tcc
+ * @author agent
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <random>
+#include "stats/alias_table.h"
+
+namespace meta
+{
+namespace stats
+{
+
+template <class T>
+alias_table<T>::alias_table(std::vector<T> events,
+                            const std::vector<double>& weights)
+    : events_(std::move(events)),
+      keep_(events_.size()),
+      alias_(events_.size())
+{
+    assert(events_.size() == weights.size());
+
+    auto n = events_.size();
+    auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    // scale the weights so that the average slot holds exactly 1, then
+    // pair each underfull slot with an overfull one that tops it up
+    std::vector<uint64_t> small;
+    std::vector<uint64_t> large;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        keep_[i] = weights[i] * n / total;
+        alias_[i] = i;
+        if (keep_[i] < 1)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        auto s = small.back();
+        small.pop_back();
+        auto l = large.back();
+
+        alias_[s] = l;
+        keep_[l] -= 1 - keep_[s];
+        if (keep_[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // whatever is left over is (up to rounding error) exactly full
+    for (const auto& i : small)
+        keep_[i] = 1;
+    for (const auto& i : large)
+        keep_[i] = 1;
+}
+
+template <class T>
+template <class Generator>
+const T& alias_table<T>::operator()(Generator&& gen) const
+{
+    std::uniform_real_distribution<> dist{0, 1};
+    auto pos = dist(gen) * events_.size();
+    auto slot = std::min(static_cast<uint64_t>(pos), events_.size() - 1);
+    if (pos - slot < keep_[slot])
+        return events_[slot];
+    return events_[alias_[slot]];
+}
+
+template <class T>
+uint64_t alias_table<T>::size() const
+{
+    return events_.size();
+}
+
+template <class T>
+bool alias_table<T>::empty() const
+{
+    return events_.empty();
+}
+}
+}
@@ -0,0 +1,28 @@
+/**
+ * @file block_codec_test.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_BLOCK_CODEC_TEST_H_
+#define META_BLOCK_CODEC_TEST_H_
+
+#include "test/unit_test.h"
+
+namespace meta
+{
+namespace testing
+{
+
+/**
+ * Tests the block codec, block_file_reader, block_file_writer, and the
+ * block-coded postings_data format.
+ */
+int block_codec_tests();
+}
+}
+
+#endif
@@ -41,6 +41,16 @@ void check_cv(Index& idx, Classifier& c, double min_accuracy);
 template <class Index, class Classifier>
 void check_split(Index& idx, Classifier& c, double min_accuracy);
 
+/**
+ * Trains a binary classifier on a split of the index and measures how
+ * often it tells documents with its positive label from the rest.
+ * @param idx The index to run the classifier on
+ * @param c The classifier to test
+ * @return the fraction of held-out documents classified correctly
+ */
+template <class Index>
+double binary_split_accuracy(Index& idx, classify::binary_classifier& c);
+
 /**
  * Runs the classifier tests.
  * @param type The index type
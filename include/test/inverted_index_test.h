@@ -14,7 +14,13 @@
 #include <iostream>
 #include "test/unit_test.h"
 #include "index/inverted_index.h"
+#include "index/positional_query.h"
+#include "index/postings_cursor.h"
 #include "index/postings_data.h"
+#include "index/ranker/dirichlet_prior.h"
+#include "index/ranker/okapi_bm25.h"
+#include "index/segmented_index.h"
+#include "index/sharded_index.h"
 #include "caching/all.h"
 #include "cpptoml.h"
 
@@ -25,8 +31,11 @@ namespace testing
 /**
  * Creates test-config.toml with the desired settings.
  * @param corpus_type line or file corpus
+ * @param codec The encoding to use for the inverted index postings
+ * @param positions Whether the inverted index should store positions
  */
-void create_config(const std::string& corpus_type);
+void create_config(const std::string& corpus_type,
+                   const std::string& codec = "gamma", bool positions = false);
 
 /**
  * Checks that ceeaus index was built correctly.
@@ -35,6 +44,17 @@ void create_config(const std::string& corpus_type);
 template <class Index>
 void check_ceeaus_expected(Index& idx);
 
+/**
+ * Checks eviction, memory accounting and concurrent use of a clock_cache.
+ */
+void check_clock_cache();
+
+/**
+ * Checks that caches stay within their memory budgets, that admission
+ * keeps hot keys cached, and that their stats are counted.
+ */
+void check_cache_budgets();
+
 /**
  * Checks that the term info is consistent with the correct one
  * @param idx The index to check
@@ -42,6 +62,66 @@ void check_ceeaus_expected(Index& idx);
 template <class Index>
 void check_term_id(Index& idx);
 
+/**
+ * Checks that postings cursors agree with search_primary for every term.
+ * @param idx The index to check
+ */
+template <class Index>
+void check_postings_cursor(Index& idx);
+
+/**
+ * Checks that the precomputed term and corpus statistics agree with the
+ * postings and document sizes.
+ * @param idx The index to check
+ */
+template <class Index>
+void check_stats(Index& idx);
+
+/**
+ * Checks the stored positions and the phrase and proximity queries
+ * against positions found by tokenizing the corpus again.
+ * @param idx The index to check, which must store positions
+ */
+template <class Index>
+void check_positions(Index& idx);
+
+/**
+ * Checks that deleted documents are left out of the index's documents,
+ * postings, and search results.
+ * @param idx The index to check, whose first document must be deleted
+ */
+template <class Index>
+void check_deletions(Index& idx);
+
+/**
+ * Checks that warming reads in no more than its budget, and that
+ * prefetching every term leaves the postings unchanged.
+ * @param idx The index to check
+ */
+template <class Index>
+void check_warm(Index& idx);
+
+/**
+ * Checks a segmented index made of copies of the same corpus, whose first
+ * segment merges all of the copies but the last.
+ * @param idx The index to check
+ * @param copies The number of copies of the corpus in the index
+ */
+void check_segments(index::segmented_index& idx, uint64_t copies);
+
+/**
+ * Checks that a sharded index with three shards ranks queries exactly as an
+ * unsharded index of the same corpus does.
+ * @param idx The index to check
+ * @param queries The queries to rank
+ * @param bm25 The okapi_bm25 rankings of the unsharded index
+ * @param dirichlet The dirichlet_prior rankings of the unsharded index
+ */
+void check_shards(index::sharded_index& idx,
+                  const std::vector<corpus::document>& queries,
+                  const std::vector<index::sharded_index::ranking>& bm25,
+                  const std::vector<index::sharded_index::ranking>& dirichlet);
+
 /**
  * Runs the inverted index tests.
  * @return the number of tests failed
@@ -13,8 +13,10 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <set>
 
 #include "test/unit_test.h"
+#include "util/range.h"
 #include "util/time.h"
 #include "parallel/parallel_for.h"
 #include "parallel/thread_pool.h"
@@ -51,6 +53,20 @@ int test_correctness(std::vector<double>& v);
  */
 int test_threadpool();
 
+/**
+ * Checks that tasks queued on one worker are stolen by the others.
+ * @return the number of tests failed
+ */
+int test_work_stealing();
+
+/**
+ * Checks that parallel_for visits every element of a range with skewed
+ * per-element cost exactly once, on the pool's threads, for several grain
+ * sizes.
+ * @return the number of tests failed
+ */
+int test_skewed_parallel_for();
+
 /**
  * Tests all the parallel functions.
  * @return the number of tests failed
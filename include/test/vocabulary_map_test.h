@@ -12,6 +12,8 @@
 
 #include <iostream>
 #include "io/binary.h"
+#include "index/compact_vocabulary.h"
+#include "index/compact_vocabulary_writer.h"
 #include "index/vocabulary_map_writer.h"
 #include "index/vocabulary_map.h"
 #include "util/disk_vector.h"
@@ -40,6 +42,13 @@ void assert_correctness(uint16_t size = 20);
  */
 void read_file(uint16_t size = 20);
 
+/**
+ * Writes a compact vocabulary and makes sure every term and term_id is
+ * found, and that missing terms are not.
+ * @param num_terms The number of terms to write
+ */
+void check_compact_vocabulary(uint64_t num_terms);
+
 /**
  * Runs the vocab map tests.
  * @return the number of tests failed
@@ -12,6 +12,7 @@
 
 #include <random>
 
+#include "stats/alias_table.h"
 #include "stats/multinomial.h"
 #include "topics/lda_model.h"
 #include "util/dense_matrix.h"
@@ -21,10 +22,42 @@ namespace meta
 namespace topics
 {
 
+/**
+ * The ways a collapsed Gibbs sampler can draw a token's new topic.
+ */
+enum class topic_sampler
+{
+    /**
+     * Computes the full conditional over all topics: O(K) per token.
+     */
+    full,
+
+    /**
+     * Runs a short Metropolis-Hastings chain that alternates between a
+     * document proposal and a word proposal drawn from alias tables, in
+     * the style of LightLDA. The tables are rebuilt from the counts at the
+     * start of every iteration, so the amortized cost per token does not
+     * depend on K.
+     */
+    alias_mh
+};
+
 /**
  * A LDA topic model implemented using a collapsed gibbs sampler.
  *
+ * The sampler used can be chosen in the `[lda]` config section:
+ *
+ * ~~~ toml
+ * # "full" (default) or "alias-mh"
+ * sampler = "alias-mh"
+ *
+ * # the number of Metropolis-Hastings steps per token for "alias-mh";
+ * # each step tries one document and one word proposal. Default is 2.
+ * mh-steps = 2
+ * ~~~
+ *
  * @see http://www.pnas.org/content/101/suppl.1/5228.full.pdf
+ * @see http://arxiv.org/abs/1412.1576
  */
 class lda_gibbs : public lda_model
 {
@@ -64,6 +97,20 @@ class lda_gibbs : public lda_model
      */
     virtual void run(uint64_t num_iters, double convergence = 1e-6) override;
 
+    /**
+     * Sets the method used to draw new topic assignments.
+     *
+     * @param method The sampler to use
+     * @param mh_steps The number of Metropolis-Hastings steps taken per
+     * token when using topic_sampler::alias_mh
+     */
+    void sampler(topic_sampler method, uint64_t mh_steps = 2);
+
+    /**
+     * @return the method used to draw new topic assignments
+     */
+    topic_sampler sampler() const;
+
   protected:
     /**
      * Samples a topic from the full conditional distribution
@@ -78,6 +125,42 @@ class lda_gibbs : public lda_model
      */
     topic_id sample_topic(term_id term, doc_id doc);
 
+    /**
+     * Draws a new topic for a token with the configured sampler. Must be
+     * called after the token's current assignment has been removed from
+     * the counts (but not from doc_word_topic_).
+     *
+     * @param term The term we are sampling a topic assignment for
+     * @param doc The document the term resides in
+     * @param position The position of the token within the document
+     * @param init Whether this is the online initialization pass, where
+     * only the tokens before position have been assigned
+     * @return the topic sampled for the token
+     */
+    topic_id draw_topic(term_id term, doc_id doc, uint64_t position,
+                        bool init);
+
+    /**
+     * Draws a new topic for a token by running a Metropolis-Hastings
+     * chain with alias table proposals (see topic_sampler::alias_mh).
+     *
+     * @param term The term we are sampling a topic assignment for
+     * @param doc The document the term resides in
+     * @param position The position of the token within the document
+     * @param init Whether this is the online initialization pass
+     * @return the topic sampled for the token
+     */
+    topic_id sample_topic_mh(term_id term, doc_id doc, uint64_t position,
+                             bool init);
+
+    /**
+     * Rebuilds the alias tables used for the word proposals from the
+     * current topic-term counts. Called at the start of every iteration
+     * when using topic_sampler::alias_mh; the counts may go stale during
+     * the iteration, which the acceptance step corrects for.
+     */
+    void build_proposals();
+
     /**
      * Computes a weight proportional to \f$P(z_i = j | w, \boldsymbol{z})\f$.
      *
@@ -187,6 +270,50 @@ class lda_gibbs : public lda_model
      * The random number generator for the sampler.
      */
     std::mt19937_64 rng_;
+
+    /**
+     * The method used to draw new topic assignments.
+     */
+    topic_sampler sampler_;
+
+    /**
+     * The number of Metropolis-Hastings steps per token.
+     */
+    uint64_t mh_steps_;
+
+    /**
+     * \f$1 / (n_k + V\beta)\f$ for each topic, as of the last call to
+     * build_proposals().
+     */
+    std::vector<double> proposal_norms_;
+
+    /**
+     * The smoothing part of the word proposal, proportional to
+     * \f$\beta / (n_k + V\beta)\f$; shared by all terms.
+     */
+    stats::alias_table<topic_id> prior_proposal_;
+
+    /**
+     * The total weight of prior_proposal_.
+     */
+    double prior_proposal_mass_;
+
+    /**
+     * The topic counts for each term, as of the last call to
+     * build_proposals(). Indexed as [term_id][topic].
+     */
+    std::vector<util::sparse_vector<topic_id, double>> term_topic_counts_;
+
+    /**
+     * The count-driven part of each term's word proposal, proportional to
+     * \f$n_{wk} / (n_k + V\beta)\f$ over the topics the term appears in.
+     */
+    std::vector<stats::alias_table<topic_id>> term_proposals_;
+
+    /**
+     * The total weight of each of term_proposals_.
+     */
+    std::vector<double> term_proposal_mass_;
 };
 }
 }
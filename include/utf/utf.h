@@ -13,6 +13,8 @@
 #include <functional>
 #include <string>
 
+#include "util/string_view.h"
+
 namespace meta
 {
 namespace utf
@@ -73,6 +75,14 @@ std::string toupper(const std::string& str);
  * @param str The string to convert
  * @return a case-folded utf8 string
  */
+std::string foldcase(util::string_view str);
+
+/**
+ * Folds the case of a utf8 string.
+ *
+ * @param str The string to convert
+ * @return a case-folded utf8 string
+ */
 std::string foldcase(const std::string& str);
 
 /**
@@ -94,14 +104,14 @@ std::string transform(const std::string& str, const std::string& id);
  * @return a utf8 formatted string with all codepoints matching pred
  * removed
  */
-std::string remove_if(const std::string& str,
+std::string remove_if(util::string_view str,
                       std::function<bool(uint32_t)> pred);
 
 /**
  * @return the number of code points in a utf8 string.
  * @param str The string to find the length of
  */
-uint64_t length(const std::string& str);
+uint64_t length(util::string_view str);
 
 /**
  * @return whether a code point is a letter character
@@ -10,12 +10,14 @@
 #ifndef META_DISK_VECTOR_H_
 #define META_DISK_VECTOR_H_
 
+#include <limits>
 #include <type_traits>
 #include <string>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include "io/access_hint.h"
 #include "meta.h"
 
 namespace meta
@@ -100,6 +102,25 @@ class disk_vector
      */
     uint64_t size() const;
 
+    /**
+     * Tells the kernel how a range of the vector will be read; a will_need
+     * hint starts reading the range in without waiting for it.
+     * @param hint How the range will be read
+     * @param first The index of the first element of the range
+     * @param count The number of elements in the range, which defaults to
+     * the rest of the vector
+     */
+    void advise(io::access_hint hint, uint64_t first = 0,
+                uint64_t count = std::numeric_limits<uint64_t>::max()) const;
+
+    /**
+     * Reads the beginning of the vector into memory before returning.
+     * @param max_bytes The most bytes of the vector to read in
+     * @return the number of bytes read in
+     */
+    uint64_t warm(uint64_t max_bytes
+                  = std::numeric_limits<uint64_t>::max()) const;
+
     /**
      * Provides iterator functionality for the disk_vector class.
      */
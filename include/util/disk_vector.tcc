@@ -117,6 +117,23 @@ uint64_t disk_vector<T>::size() const
     return size_;
 }
 
+template <class T>
+void disk_vector<T>::advise(io::access_hint hint, uint64_t first,
+                            uint64_t count) const
+{
+    if (first >= size_)
+        return;
+    count = std::min(count, size_ - first);
+    io::advise(start_, sizeof(T) * size_, hint, sizeof(T) * first,
+               sizeof(T) * count);
+}
+
+template <class T>
+uint64_t disk_vector<T>::warm(uint64_t max_bytes) const
+{
+    return io::warm(start_, sizeof(T) * size_, 0, max_bytes);
+}
+
 template <class T>
 typename disk_vector<T>::iterator disk_vector<T>::begin() const
 {
@@ -13,7 +13,9 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <dirent.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "io/mmap_file.h"
 #include "util/printing.h"
 #include "util/progress.h"
@@ -54,6 +56,27 @@ inline bool make_directory(const std::string& dir_name)
     return mkdir(dir_name.c_str(), 0755) == -1;
 }
 
+/**
+ * Deletes a directory along with the files in it. The directory may not
+ * contain other directories.
+ * @param dir_name The directory to delete
+ */
+inline void delete_directory(const std::string& dir_name)
+{
+    DIR* dir = opendir(dir_name.c_str());
+    if (dir == nullptr)
+        return;
+
+    while (auto entry = readdir(dir))
+    {
+        std::string name{entry->d_name};
+        if (name != "." && name != "..")
+            delete_file(dir_name + "/" + name);
+    }
+    closedir(dir);
+    rmdir(dir_name.c_str());
+}
+
 /**
  * @param filename The file to check
  * @return true if the file exists
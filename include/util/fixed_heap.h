@@ -0,0 +1,127 @@
+/**
+ * @file fixed_heap.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_FIXED_HEAP_H_
+#define META_UTIL_FIXED_HEAP_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * Collects the best max_elems elements pushed into it. Elements are ranked
+ * by a comparator that returns true when its first argument should come
+ * before its second, so ties are broken however the comparator breaks
+ * them. The kept elements are stored in a heap with the worst of them on
+ * top; once the heap is full, that element is the threshold any new
+ * element must beat, which lets callers skip work on elements that cannot
+ * be kept.
+ */
+template <class T, class Comparator = std::greater<T>>
+class fixed_heap
+{
+  public:
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    /**
+     * @param max_elems The number of elements to keep
+     * @param comp The comparator ranking the elements
+     */
+    fixed_heap(uint64_t max_elems, Comparator comp = Comparator());
+
+    /**
+     * Constructs an element in place, keeping it only if it is among the
+     * best max_elems elements seen so far.
+     * @param args The arguments to construct the element with
+     */
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    /**
+     * Keeps an element only if it is among the best max_elems elements
+     * seen so far.
+     * @param elem The element to push
+     */
+    void push(const T& elem);
+
+    /**
+     * @param elem An element that might be pushed
+     * @return whether pushing the element would keep it
+     */
+    bool would_keep(const T& elem) const;
+
+    /**
+     * @return the worst element kept, which is the next one to be dropped;
+     * it is up to the user to check that the heap is not empty first
+     */
+    const T& top() const;
+
+    /**
+     * @return the number of elements kept
+     */
+    uint64_t size() const;
+
+    /**
+     * @return the number of elements that may be kept
+     */
+    uint64_t max_elems() const;
+
+    /**
+     * @return whether no elements are kept
+     */
+    bool empty() const;
+
+    /**
+     * @return whether max_elems elements are kept, so that new elements
+     * must beat top() to be kept
+     */
+    bool full() const;
+
+    /**
+     * Removes every element, keeping the storage.
+     */
+    void clear();
+
+    /**
+     * Removes every element and returns them sorted from best to worst.
+     * @return the elements that were kept, best first
+     */
+    std::vector<T> extract_top();
+
+    /**
+     * @return an iterator to the beginning of the kept elements, which
+     * are in no particular order
+     */
+    const_iterator begin() const;
+
+    /**
+     * @return an iterator to the end of the kept elements
+     */
+    const_iterator end() const;
+
+  private:
+    /// the number of elements to keep
+    uint64_t max_elems_;
+
+    /// the comparator ranking the elements
+    Comparator comp_;
+
+    /// the kept elements, as a heap with the worst one on top
+    std::vector<T> heap_;
+};
+}
+}
+
+#include "util/fixed_heap.tcc"
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file fixed_heap.tcc
+ * @author agent
+ */
+
+#include <algorithm>
+
+#include "util/fixed_heap.h"
+
+namespace meta
+{
+namespace util
+{
+
+template <class T, class Comparator>
+fixed_heap<T, Comparator>::fixed_heap(uint64_t max_elems, Comparator comp)
+    : max_elems_{max_elems}, comp_(comp)
+{
+    heap_.reserve(max_elems_);
+}
+
+template <class T, class Comparator>
+template <class... Args>
+void fixed_heap<T, Comparator>::emplace(Args&&... args)
+{
+    if (heap_.size() < max_elems_)
+    {
+        heap_.emplace_back(std::forward<Args>(args)...);
+        std::push_heap(heap_.begin(), heap_.end(), comp_);
+    }
+    else
+        push(T(std::forward<Args>(args)...));
+}
+
+template <class T, class Comparator>
+void fixed_heap<T, Comparator>::push(const T& elem)
+{
+    if (heap_.size() < max_elems_)
+    {
+        heap_.push_back(elem);
+        std::push_heap(heap_.begin(), heap_.end(), comp_);
+    }
+    else if (would_keep(elem))
+    {
+        // replace the worst element, moving it to the back first
+        std::pop_heap(heap_.begin(), heap_.end(), comp_);
+        heap_.back() = elem;
+        std::push_heap(heap_.begin(), heap_.end(), comp_);
+    }
+}
+
+template <class T, class Comparator>
+bool fixed_heap<T, Comparator>::would_keep(const T& elem) const
+{
+    if (heap_.size() < max_elems_)
+        return true;
+    return max_elems_ > 0 && comp_(elem, heap_.front());
+}
+
+template <class T, class Comparator>
+const T& fixed_heap<T, Comparator>::top() const
+{
+    return heap_.front();
+}
+
+template <class T, class Comparator>
+uint64_t fixed_heap<T, Comparator>::size() const
+{
+    return heap_.size();
+}
+
+template <class T, class Comparator>
+uint64_t fixed_heap<T, Comparator>::max_elems() const
+{
+    return max_elems_;
+}
+
+template <class T, class Comparator>
+bool fixed_heap<T, Comparator>::empty() const
+{
+    return heap_.empty();
+}
+
+template <class T, class Comparator>
+bool fixed_heap<T, Comparator>::full() const
+{
+    return heap_.size() >= max_elems_;
+}
+
+template <class T, class Comparator>
+void fixed_heap<T, Comparator>::clear()
+{
+    heap_.clear();
+}
+
+template <class T, class Comparator>
+std::vector<T> fixed_heap<T, Comparator>::extract_top()
+{
+    // the comparator orders the best elements first
+    std::sort_heap(heap_.begin(), heap_.end(), comp_);
+    std::vector<T> sorted;
+    sorted.swap(heap_);
+    heap_.reserve(max_elems_);
+    return sorted;
+}
+
+template <class T, class Comparator>
+auto fixed_heap<T, Comparator>::begin() const -> const_iterator
+{
+    return heap_.begin();
+}
+
+template <class T, class Comparator>
+auto fixed_heap<T, Comparator>::end() const -> const_iterator
+{
+    return heap_.end();
+}
+}
+}
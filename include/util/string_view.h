@@ -0,0 +1,353 @@
+/**
+ * @file string_view.h
+ * @author agent
+ *
+ * All files in META are dual-licensed under the MIT and NCSA licenses. For more
+ * details, consult the file LICENSE.mit and LICENSE.ncsa in the root of the
+ * project.
+ */
+
+#ifndef META_UTIL_STRING_VIEW_H_
+#define META_UTIL_STRING_VIEW_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace meta
+{
+namespace util
+{
+
+/**
+ * A non-owning reference to a contiguous sequence of characters, modeled
+ * after std::experimental::basic_string_view. The referenced characters
+ * must outlive the view.
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class basic_string_view
+{
+  public:
+    using traits_type = Traits;
+    using value_type = Char;
+    using pointer = const Char*;
+    using const_pointer = const Char*;
+    using reference = const Char&;
+    using const_reference = const Char&;
+    using const_iterator = const Char*;
+    using iterator = const_iterator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /// Returned by the find functions when nothing is found
+    static constexpr size_type npos = size_type(-1);
+
+    /**
+     * Constructs an empty view.
+     */
+    constexpr basic_string_view() noexcept : data_{nullptr}, size_{0}
+    {
+        // nothing
+    }
+
+    /**
+     * @param str The string to view
+     */
+    template <class Allocator>
+    basic_string_view(
+        const std::basic_string<Char, Traits, Allocator>& str) noexcept
+        : data_{str.data()}, size_{str.size()}
+    {
+        // nothing
+    }
+
+    /**
+     * @param s The beginning of the characters to view
+     * @param count The number of characters to view
+     */
+    constexpr basic_string_view(const Char* s, size_type count)
+        : data_{s}, size_{count}
+    {
+        // nothing
+    }
+
+    /**
+     * @param s A null-terminated string to view
+     */
+    basic_string_view(const Char* s) : data_{s}, size_{Traits::length(s)}
+    {
+        // nothing
+    }
+
+    /**
+     * @return an iterator to the first character
+     */
+    constexpr const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    /**
+     * @return an iterator past the last character
+     */
+    constexpr const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    /**
+     * @param pos The index of the character to access (unchecked)
+     * @return the character at that index
+     */
+    constexpr const_reference operator[](size_type pos) const
+    {
+        return data_[pos];
+    }
+
+    /**
+     * @return the first character
+     */
+    constexpr const_reference front() const
+    {
+        return data_[0];
+    }
+
+    /**
+     * @return the last character
+     */
+    constexpr const_reference back() const
+    {
+        return data_[size_ - 1];
+    }
+
+    /**
+     * @return a pointer to the viewed characters (which need not be
+     * null-terminated)
+     */
+    constexpr const_pointer data() const noexcept
+    {
+        return data_;
+    }
+
+    /**
+     * @return the number of characters viewed
+     */
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+     * @return the number of characters viewed
+     */
+    constexpr size_type length() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+     * @return whether the view is empty
+     */
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /**
+     * Shrinks the view by moving its start forward.
+     * @param n The number of characters to remove
+     */
+    void remove_prefix(size_type n)
+    {
+        data_ += n;
+        size_ -= n;
+    }
+
+    /**
+     * Shrinks the view by moving its end backward.
+     * @param n The number of characters to remove
+     */
+    void remove_suffix(size_type n)
+    {
+        size_ -= n;
+    }
+
+    /**
+     * @param pos The first character of the substring
+     * @param count The maximum length of the substring
+     * @return a view of the substring
+     */
+    basic_string_view substr(size_type pos = 0, size_type count = npos) const
+    {
+        if (pos > size_)
+            throw std::out_of_range{"string_view::substr"};
+        return {data_ + pos, std::min(count, size_ - pos)};
+    }
+
+    /**
+     * @param other The view to compare with
+     * @return a negative number, zero, or a positive number if this view
+     * orders before, the same as, or after the other
+     */
+    int compare(basic_string_view other) const noexcept
+    {
+        auto len = std::min(size_, other.size_);
+        auto cmp = len == 0 ? 0 : Traits::compare(data_, other.data_, len);
+        if (cmp != 0)
+            return cmp;
+        if (size_ == other.size_)
+            return 0;
+        return size_ < other.size_ ? -1 : 1;
+    }
+
+    /**
+     * @param c The character to look for
+     * @param pos The index to start looking from
+     * @return the index of the first occurrence of c, or npos
+     */
+    size_type find(Char c, size_type pos = 0) const noexcept
+    {
+        for (; pos < size_; ++pos)
+        {
+            if (Traits::eq(data_[pos], c))
+                return pos;
+        }
+        return npos;
+    }
+
+    /**
+     * @return a std::basic_string holding a copy of the characters
+     */
+    template <class Allocator = std::allocator<Char>>
+    std::basic_string<Char, Traits, Allocator> to_string() const
+    {
+        return {data_, size_};
+    }
+
+    /**
+     * @return a std::basic_string holding a copy of the characters
+     */
+    template <class Allocator>
+    explicit operator std::basic_string<Char, Traits, Allocator>() const
+    {
+        return {data_, size_};
+    }
+
+  private:
+    /// The beginning of the viewed characters
+    const Char* data_;
+
+    /// The number of viewed characters
+    size_type size_;
+};
+
+template <class Char, class Traits>
+constexpr typename basic_string_view<Char, Traits>::size_type
+    basic_string_view<Char, Traits>::npos;
+
+/// A view of a sequence of chars
+using string_view = basic_string_view<char>;
+
+/**
+ * @return whether the two views refer to equal sequences of characters
+ */
+template <class Char, class Traits>
+bool operator==(basic_string_view<Char, Traits> lhs,
+                basic_string_view<Char, Traits> rhs) noexcept
+{
+    return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+}
+
+/**
+ * @return whether the two views refer to different sequences of characters
+ */
+template <class Char, class Traits>
+bool operator!=(basic_string_view<Char, Traits> lhs,
+                basic_string_view<Char, Traits> rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * @return whether lhs orders lexicographically before rhs
+ */
+template <class Char, class Traits>
+bool operator<(basic_string_view<Char, Traits> lhs,
+               basic_string_view<Char, Traits> rhs) noexcept
+{
+    return lhs.compare(rhs) < 0;
+}
+
+// comparisons with anything convertible to a view (strings, literals)
+
+template <class Char, class Traits, class T>
+bool operator==(basic_string_view<Char, Traits> lhs, const T& rhs)
+{
+    return lhs == basic_string_view<Char, Traits>{rhs};
+}
+
+template <class Char, class Traits, class T>
+bool operator==(const T& lhs, basic_string_view<Char, Traits> rhs)
+{
+    return basic_string_view<Char, Traits>{lhs} == rhs;
+}
+
+template <class Char, class Traits, class T>
+bool operator!=(basic_string_view<Char, Traits> lhs, const T& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <class Char, class Traits, class T>
+bool operator!=(const T& lhs, basic_string_view<Char, Traits> rhs)
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * Writes the viewed characters to a stream.
+ * @param os The stream to write to
+ * @param view The view to write
+ * @return the stream
+ */
+template <class Char, class Traits>
+std::basic_ostream<Char, Traits>&
+    operator<<(std::basic_ostream<Char, Traits>& os,
+               basic_string_view<Char, Traits> view)
+{
+    return os.write(view.data(), static_cast<std::streamsize>(view.size()));
+}
+}
+}
+
+namespace std
+{
+/**
+ * Hash specialization for string_view (FNV-1a over the characters).
+ */
+template <class Char, class Traits>
+struct hash<meta::util::basic_string_view<Char, Traits>>
+{
+    /**
+     * @param view The view to hash
+     * @return the hash of the viewed characters
+     */
+    size_t operator()(meta::util::basic_string_view<Char, Traits> view) const
+        noexcept
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        auto bytes = reinterpret_cast<const unsigned char*>(view.data());
+        for (std::size_t i = 0; i < view.size() * sizeof(Char); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+}
+
+#endif
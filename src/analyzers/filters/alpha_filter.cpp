@@ -4,6 +4,7 @@
  */
 
 #include <algorithm>
+#include <iterator>
 #include "analyzers/filters/alpha_filter.h"
 #include "utf/utf.h"
 
@@ -19,44 +20,86 @@ const std::string alpha_filter::id = "alpha";
 alpha_filter::alpha_filter(std::unique_ptr<token_stream> source)
     : source_{std::move(source)}
 {
-    next_token();
+    // nothing
 }
 
 alpha_filter::alpha_filter(const alpha_filter& other)
-    : source_{other.source_->clone()}, token_{other.token_}
+    : source_{other.source_->clone()}
 {
-    // nothing
+    if (other.token_)
+    {
+        buffer_.assign(other.token_->data(), other.token_->size());
+        token_ = util::string_view{buffer_};
+    }
 }
 
 void alpha_filter::set_content(const std::string& content)
 {
     source_->set_content(content);
-    next_token();
+    token_ = util::nullopt;
 }
 
 std::string alpha_filter::next()
 {
+    return next_view().to_string();
+}
+
+util::string_view alpha_filter::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
     auto tok = *token_;
-    next_token();
+    token_ = util::nullopt;
     return tok;
 }
 
-void alpha_filter::next_token()
+void alpha_filter::next_token() const
 {
+    auto keep = [](char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '\'';
+    };
+
     while (*source_)
     {
-        auto tok = source_->next();
+        auto tok = source_->next_view();
         if (tok == "<s>" || tok == "</s>")
         {
             token_ = tok;
             return;
         }
 
-        auto filt = utf::remove_if(tok, [](uint32_t codepoint)
-        { return !utf::isalpha(codepoint) && codepoint != '\''; });
-        if (!filt.empty())
+        bool ascii = std::all_of(tok.begin(), tok.end(), [](char c)
+                                 {
+            return static_cast<unsigned char>(c) < 0x80;
+        });
+
+        // plain ASCII tokens can be filtered without decoding; those with
+        // nothing to remove are passed through without a copy
+        if (ascii)
+        {
+            if (std::all_of(tok.begin(), tok.end(), keep))
+            {
+                if (!tok.empty())
+                {
+                    token_ = tok;
+                    return;
+                }
+                continue;
+            }
+            buffer_.clear();
+            std::copy_if(tok.begin(), tok.end(), std::back_inserter(buffer_),
+                         keep);
+        }
+        else
+        {
+            buffer_ = utf::remove_if(tok, [](uint32_t codepoint)
+            { return !utf::isalpha(codepoint) && codepoint != '\''; });
+        }
+
+        if (!buffer_.empty())
         {
-            token_ = filt;
+            token_ = util::string_view{buffer_};
             return;
         }
     }
@@ -65,6 +108,8 @@ void alpha_filter::next_token()
 
 alpha_filter::operator bool() const
 {
+    if (!token_)
+        next_token();
     return static_cast<bool>(token_);
 }
 }
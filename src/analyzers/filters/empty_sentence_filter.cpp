@@ -18,7 +18,7 @@ empty_sentence_filter::empty_sentence_filter(
     std::unique_ptr<token_stream> source)
     : source_{std::move(source)}
 {
-    next_token();
+    // nothing
 }
 
 empty_sentence_filter::empty_sentence_filter(const empty_sentence_filter& other)
@@ -26,17 +26,23 @@ empty_sentence_filter::empty_sentence_filter(const empty_sentence_filter& other)
       first_{other.first_},
       second_{other.second_}
 {
-    // nothing
+    // at most one of the pending tokens points into the other filter's
+    // source; when both are set, the first is always the literal "<s>"
+    auto& pending = second_ ? second_ : first_;
+    if (pending)
+    {
+        buffer_.assign(pending->data(), pending->size());
+        pending = util::string_view{buffer_};
+    }
 }
 
 void empty_sentence_filter::set_content(const std::string& content)
 {
     source_->set_content(content);
     first_ = second_ = util::nullopt;
-    next_token();
 }
 
-void empty_sentence_filter::next_token()
+void empty_sentence_filter::next_token() const
 {
     if (second_ || !*source_)
     {
@@ -47,10 +53,15 @@ void empty_sentence_filter::next_token()
 
     while (*source_)
     {
-        first_ = source_->next();
-        if (!*source_ || *first_ != "<s>")
+        first_ = source_->next_view();
+        if (*first_ != "<s>")
             return;
-        second_ = source_->next();
+        // testing or reading the source again invalidates the view we
+        // were handed, so hold on to the literal instead
+        first_ = util::string_view{"<s>"};
+        if (!*source_)
+            return;
+        second_ = source_->next_view();
         if (*second_ != "</s>")
             return;
         first_ = second_ = util::nullopt;
@@ -59,13 +70,22 @@ void empty_sentence_filter::next_token()
 
 std::string empty_sentence_filter::next()
 {
+    return next_view().to_string();
+}
+
+util::string_view empty_sentence_filter::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
     auto tok = *first_;
-    next_token();
+    first_ = util::nullopt;
     return tok;
 }
 
 empty_sentence_filter::operator bool() const
 {
+    if (!first_)
+        next_token();
     return static_cast<bool>(first_);
 }
 }
@@ -17,34 +17,51 @@ namespace filters
 const std::string english_normalizer::id = "normalize";
 
 english_normalizer::english_normalizer(std::unique_ptr<token_stream> source)
-    : source_{std::move(source)}
+    : source_{std::move(source)}, next_idx_{0}
 {
     // nothing
 }
 
 english_normalizer::english_normalizer(const english_normalizer& other)
-    : source_{other.source_->clone()}, tokens_{other.tokens_}
+    : source_{other.source_->clone()},
+      current_{other.current_},
+      tokens_{other.tokens_},
+      next_idx_{other.next_idx_}
 {
-    // nothing
+    // point the buffered pieces at our own copy of the token
+    auto begin = other.current_.data();
+    auto end = begin + other.current_.size();
+    for (auto& tok : tokens_)
+    {
+        if (tok.data() >= begin && tok.data() < end)
+            tok = util::string_view{
+                current_.data() + (tok.data() - begin), tok.size()};
+    }
 }
 
 void english_normalizer::set_content(const std::string& content)
 {
     tokens_.clear();
+    next_idx_ = 0;
     source_->set_content(content);
 }
 
 std::string english_normalizer::next()
+{
+    return next_view().to_string();
+}
+
+util::string_view english_normalizer::next_view()
 {
     // if we have buffered tokens, keep returning them until we have
     // exhausted the buffer
-    if (!tokens_.empty())
+    if (next_idx_ < tokens_.size())
         return current_token();
 
     if (!*source_)
         throw token_stream_exception{"next() called with empty source"};
 
-    auto token = source_->next();
+    auto token = source_->next_view();
 
     // if we have a whitespace token, keep reading any following whitespace
     // tokens to collapse them down to a single space. token_, afterwards,
@@ -53,10 +70,10 @@ std::string english_normalizer::next()
     if (is_whitespace(token))
     {
         while (is_whitespace(token) && *source_)
-            token = source_->next();
+            token = source_->next_view();
         if (!is_whitespace(token)) // source_ was non-empty after whitespace
             parse_token(token);
-        return " ";
+        return util::string_view{" "};
     }
 
     parse_token(token);
@@ -65,17 +82,23 @@ std::string english_normalizer::next()
 
 english_normalizer::operator bool() const
 {
-    return !tokens_.empty() || *source_;
+    return next_idx_ < tokens_.size() || *source_;
 }
 
-bool english_normalizer::is_whitespace(const std::string& token) const
+bool english_normalizer::is_whitespace(util::string_view token) const
 {
     auto space = [](char c) { return std::isspace(c); };
     return std::all_of(token.begin(), token.end(), space);
 }
 
-void english_normalizer::parse_token(const std::string& token)
+void english_normalizer::parse_token(util::string_view source_token)
 {
+    // copy the token once; everything buffered below is a piece of it
+    tokens_.clear();
+    next_idx_ = 0;
+    current_.assign(source_token.data(), source_token.size());
+    util::string_view token{current_};
+
     if (token.length() < 2)
     {
         tokens_.push_back(token);
@@ -104,7 +127,7 @@ void english_normalizer::parse_token(const std::string& token)
 
     // other leading punctuation should be separate tokens
     while (idx < end && !std::isalnum(token[idx]))
-        tokens_.emplace_back(1, token[idx++]);
+        tokens_.push_back(token.substr(idx++, 1));
 
     // split out sequences of alphanumeric characters into separate tokens
     while (idx < end)
@@ -115,7 +138,7 @@ void english_normalizer::parse_token(const std::string& token)
 }
 
 uint64_t english_normalizer::starting_quotes(uint64_t start,
-                                             const std::string& token)
+                                             util::string_view token)
 {
     if (token[start] == '"')
     {
@@ -138,16 +161,16 @@ bool english_normalizer::is_quote(char c)
 }
 
 uint64_t english_normalizer::strip_dashes(uint64_t start,
-                                          const std::string& token)
+                                          util::string_view token)
 {
     auto idx = start + 1;
     while (idx < token.length() && token[idx] == '-')
         ++idx;
-    tokens_.emplace_back(token, start, idx - start);
+    tokens_.push_back(token.substr(start, idx - start));
     return idx;
 }
 
-uint64_t english_normalizer::word(uint64_t start, const std::string& token)
+uint64_t english_normalizer::word(uint64_t start, util::string_view token)
 {
     // special case leading dashes: if there are consecutive ones, we want
     // to strip them out into their own token
@@ -167,7 +190,7 @@ uint64_t english_normalizer::word(uint64_t start, const std::string& token)
             // or something
 
             // place the current token, before the dash, into the buffer
-            tokens_.emplace_back(token, start, idx - start);
+            tokens_.push_back(token.substr(start, idx - start));
             // place the dashes onto the buffer
             start = strip_dashes(idx, token);
         }
@@ -179,15 +202,13 @@ uint64_t english_normalizer::word(uint64_t start, const std::string& token)
         ++idx;
     }
 
-    tokens_.emplace_back(token, start, idx - start);
+    tokens_.push_back(token.substr(start, idx - start));
     return idx;
 }
 
-std::string english_normalizer::current_token()
+util::string_view english_normalizer::current_token()
 {
-    auto token = tokens_.front();
-    tokens_.pop_front();
-    return token;
+    return tokens_[next_idx_++];
 }
 }
 }
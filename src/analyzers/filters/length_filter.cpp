@@ -20,48 +20,53 @@ length_filter::length_filter(std::unique_ptr<token_stream> source, uint64_t min,
                              uint64_t max)
     : source_{std::move(source)}, min_length_{min}, max_length_{max}
 {
-    next_token();
+    // nothing
 }
 
 length_filter::length_filter(const length_filter& other)
     : source_{other.source_->clone()},
-      token_{other.token_},
       min_length_{other.min_length_},
       max_length_{other.max_length_}
 {
-    // nothing
+    if (other.token_)
+    {
+        buffer_.assign(other.token_->data(), other.token_->size());
+        token_ = util::string_view{buffer_};
+    }
 }
 
 void length_filter::set_content(const std::string& content)
 {
     token_ = util::nullopt;
     source_->set_content(content);
-    next_token();
 }
 
 std::string length_filter::next()
 {
+    return next_view().to_string();
+}
+
+util::string_view length_filter::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
     auto tok = *token_;
-    next_token();
+    token_ = util::nullopt;
     return tok;
 }
 
 length_filter::operator bool() const
 {
-    return token_ || *source_;
+    if (!token_)
+        next_token();
+    return static_cast<bool>(token_);
 }
 
-void length_filter::next_token()
+void length_filter::next_token() const
 {
-    if (!*source_)
-    {
-        token_ = util::nullopt;
-        return;
-    }
-
     while (*source_)
     {
-        auto tok = source_->next();
+        auto tok = source_->next_view();
         if (tok == "<s>" || tok == "</s>")
         {
             token_ = tok;
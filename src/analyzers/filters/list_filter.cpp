@@ -27,50 +27,54 @@ list_filter::list_filter(std::unique_ptr<token_stream> source,
     std::string line;
     while (std::getline(file, line))
         list_.emplace(std::move(line));
-
-    next_token();
 }
 
 list_filter::list_filter(const list_filter& other)
     : source_{other.source_->clone()},
-      token_{other.token_},
       list_{other.list_},
       method_{other.method_}
 {
-    // nothing
+    if (other.token_)
+    {
+        buffer_.assign(other.token_->data(), other.token_->size());
+        token_ = util::string_view{buffer_};
+    }
 }
 
 void list_filter::set_content(const std::string& content)
 {
     token_ = util::nullopt;
     source_->set_content(content);
-    next_token();
 }
 
 std::string list_filter::next()
 {
+    return next_view().to_string();
+}
+
+util::string_view list_filter::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
     auto tok = *token_;
-    next_token();
+    token_ = util::nullopt;
     return tok;
 }
 
 list_filter::operator bool() const
 {
-    return token_ || *source_;
+    if (!token_)
+        next_token();
+    return static_cast<bool>(token_);
 }
 
-void list_filter::next_token()
+void list_filter::next_token() const
 {
-    if (!*source_)
-    {
-        token_ = util::nullopt;
-        return;
-    }
-
     while (*source_)
     {
-        auto tok = source_->next();
-        auto found = list_.find(tok) != list_.end();
+        auto tok = source_->next_view();
+        lookup_.assign(tok.data(), tok.size());
+        auto found = list_.find(lookup_) != list_.end();
         switch (method_)
         {
             case type::ACCEPT:
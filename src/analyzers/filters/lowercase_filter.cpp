@@ -36,8 +36,34 @@ void lowercase_filter::set_content(const std::string& content)
 
 std::string lowercase_filter::next()
 {
-    auto tok = source_->next();
-    return utf::foldcase(tok);
+    return next_view().to_string();
+}
+
+util::string_view lowercase_filter::next_view()
+{
+    auto tok = source_->next_view();
+
+    bool upper = false;
+    for (const auto& c : tok)
+    {
+        // non-ASCII text needs the full unicode case folding
+        if (static_cast<unsigned char>(c) >= 0x80)
+        {
+            buffer_ = utf::foldcase(tok);
+            return buffer_;
+        }
+        upper = upper || (c >= 'A' && c <= 'Z');
+    }
+
+    if (!upper)
+        return tok;
+
+    buffer_.assign(tok.data(), tok.size());
+    std::transform(buffer_.begin(), buffer_.end(), buffer_.begin(), [](char c)
+                   {
+        return static_cast<char>(std::tolower(c));
+    });
+    return buffer_;
 }
 
 lowercase_filter::operator bool() const
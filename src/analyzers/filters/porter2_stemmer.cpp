@@ -18,37 +18,49 @@ const std::string porter2_stemmer::id = "porter2-stemmer";
 porter2_stemmer::porter2_stemmer(std::unique_ptr<token_stream> source)
     : source_{std::move(source)}
 {
-    next_token();
+    // nothing
 }
 
 porter2_stemmer::porter2_stemmer(const porter2_stemmer& other)
-    : source_{other.source_->clone()}, token_{other.token_}
+    : source_{other.source_->clone()}
 {
-    // nothing
+    if (other.token_)
+    {
+        buffer_.assign(other.token_->data(), other.token_->size());
+        token_ = util::string_view{buffer_};
+    }
 }
 
 void porter2_stemmer::set_content(const std::string& content)
 {
     source_->set_content(content);
-    next_token();
+    token_ = util::nullopt;
 }
 
 std::string porter2_stemmer::next()
 {
+    return next_view().to_string();
+}
+
+util::string_view porter2_stemmer::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
     auto tok = *token_;
-    next_token();
+    token_ = util::nullopt;
     return tok;
 }
 
-void porter2_stemmer::next_token()
+void porter2_stemmer::next_token() const
 {
     while (*source_)
     {
-        auto tok = source_->next();
-        Porter2Stemmer::stem(tok);
-        if (!tok.empty())
+        auto tok = source_->next_view();
+        buffer_.assign(tok.data(), tok.size());
+        Porter2Stemmer::stem(buffer_);
+        if (!buffer_.empty())
         {
-            token_ = tok;
+            token_ = util::string_view{buffer_};
             return;
         }
     }
@@ -57,6 +69,8 @@ void porter2_stemmer::next_token()
 
 porter2_stemmer::operator bool() const
 {
+    if (!token_)
+        next_token();
     return static_cast<bool>(token_);
 }
 }
@@ -20,33 +20,42 @@ const std::string ngram_word_analyzer::id = "ngram-word";
 
 ngram_word_analyzer::ngram_word_analyzer(uint16_t n,
                                          std::unique_ptr<token_stream> stream)
-    : base{n}, stream_{std::move(stream)}
+    : base{n}, stream_{std::move(stream)}, window_(n)
 {
     // nothing
 }
 
 ngram_word_analyzer::ngram_word_analyzer(const ngram_word_analyzer& other)
-    : base{other.n_value()}, stream_{other.stream_->clone()}
+    : base{other.n_value()},
+      stream_{other.stream_->clone()},
+      window_(other.n_value())
 {
     // nothing
 }
 
 void ngram_word_analyzer::tokenize(corpus::document& doc)
 {
-    // first, get tokens
     stream_->set_content(get_content(doc));
-    std::vector<std::string> tokens;
-    while (*stream_)
-        tokens.push_back(stream_->next());
 
-    // second, create ngrams from them
-    for (size_t i = n_value() - 1; i < tokens.size(); ++i)
+    // keep the last n tokens in a ring of reused strings so that reading
+    // token views and building ngrams does not allocate per token
+    auto n = n_value();
+    uint64_t count = 0;
+    while (*stream_)
     {
-        std::string combined = tokens[i];
-        for (size_t j = 1; j < n_value(); ++j)
-            combined = tokens[i - j] + "_" + combined;
+        auto tok = stream_->next_view();
+        window_[count % n].assign(tok.data(), tok.size());
+        if (++count < n)
+            continue;
 
-        doc.increment(combined, 1);
+        ngram_.clear();
+        for (uint64_t j = count - n; j < count; ++j)
+        {
+            if (j != count - n)
+                ngram_ += '_';
+            ngram_ += window_[j % n];
+        }
+        doc.increment(ngram_, 1);
     }
 }
 
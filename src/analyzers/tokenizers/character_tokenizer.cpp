@@ -35,6 +35,14 @@ std::string character_tokenizer::next()
     return {1, content_[idx_++]};
 }
 
+util::string_view character_tokenizer::next_view()
+{
+    if (!*this)
+        throw token_stream_exception{"next() called with no tokens left"};
+
+    return {content_.data() + idx_++, 1};
+}
+
 character_tokenizer::operator bool() const
 {
     return idx_ < content_.size();
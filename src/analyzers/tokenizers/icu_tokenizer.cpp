@@ -87,11 +87,24 @@ class icu_tokenizer::impl
     {
         if (!*this)
             throw token_stream_exception{"next() called with no tokens left"};
-        auto result = tokens_.front();
+        auto result = std::move(tokens_.front());
         tokens_.pop_front();
         return result;
     }
 
+    /**
+     * @return a view of the next token, which is moved out of the buffer
+     * rather than copied
+     */
+    util::string_view next_view()
+    {
+        if (!*this)
+            throw token_stream_exception{"next() called with no tokens left"};
+        current_ = std::move(tokens_.front());
+        tokens_.pop_front();
+        return current_;
+    }
+
     /**
      * True if tokens is not empty.
      */
@@ -109,6 +122,9 @@ class icu_tokenizer::impl
 
     /// Buffered tokens
     std::deque<std::string> tokens_;
+
+    /// The token most recently returned by next_view()
+    std::string current_;
 };
 
 icu_tokenizer::icu_tokenizer(bool suppress_tags) : impl_{suppress_tags}
@@ -141,6 +157,11 @@ std::string icu_tokenizer::next()
     return impl_->next();
 }
 
+util::string_view icu_tokenizer::next_view()
+{
+    return impl_->next_view();
+}
+
 icu_tokenizer::operator bool() const
 {
     return static_cast<bool>(*impl_);
@@ -0,0 +1,154 @@
+/**
+ * @file tokenize_bench.cpp
+ * @author agent
+ *
+ * Measures the throughput of an analyzer's filter chain when tokens are
+ * read as owning strings (next()) versus as views (next_view()).
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cpptoml.h"
+#include "analyzers/all.h"
+#include "analyzers/token_stream.h"
+#include "corpus/corpus.h"
+#include "logging/logger.h"
+#include "util/time.h"
+
+using namespace meta;
+
+namespace
+{
+/**
+ * Totals gathered from one pass over the corpus.
+ */
+struct pass_stats
+{
+    uint64_t tokens = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Runs the stream over every document, reading tokens with next().
+ */
+pass_stats read_strings(analyzers::token_stream& stream,
+                        const std::vector<std::string>& docs)
+{
+    pass_stats stats;
+    for (const auto& content : docs)
+    {
+        stream.set_content(content);
+        while (stream)
+        {
+            auto tok = stream.next();
+            ++stats.tokens;
+            stats.bytes += tok.size();
+        }
+    }
+    return stats;
+}
+
+/**
+ * Runs the stream over every document, reading tokens with next_view().
+ */
+pass_stats read_views(analyzers::token_stream& stream,
+                      const std::vector<std::string>& docs)
+{
+    pass_stats stats;
+    for (const auto& content : docs)
+    {
+        stream.set_content(content);
+        while (stream)
+        {
+            auto tok = stream.next_view();
+            ++stats.tokens;
+            stats.bytes += tok.size();
+        }
+    }
+    return stats;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " config.toml [passes]"
+                  << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging();
+
+    auto config = cpptoml::parse_file(argv[1]);
+    uint64_t passes = argc > 2 ? std::stoul(argv[2]) : 3;
+
+    std::unique_ptr<analyzers::token_stream> stream;
+    auto analyzers = config.get_table_array("analyzers");
+    for (const auto& group : analyzers->get())
+    {
+        auto method = group->get_as<std::string>("method");
+        if (method && *method == analyzers::ngram_word_analyzer::id)
+        {
+            stream = analyzers::analyzer::load_filters(config, *group);
+            break;
+        }
+    }
+
+    if (!stream)
+    {
+        LOG(fatal) << "Failed to find an ngram-word analyzer configuration in "
+                   << argv[1] << ENDLG;
+        return 1;
+    }
+
+    // read the corpus up front so that only the analysis is timed
+    std::vector<std::string> docs;
+    uint64_t corpus_bytes = 0;
+    auto corpus = corpus::corpus::load(argv[1]);
+    while (corpus->has_next())
+    {
+        auto doc = corpus->next();
+        docs.push_back(analyzers::analyzer::get_content(doc));
+        corpus_bytes += docs.back().size();
+    }
+
+    std::cout << "Documents: " << docs.size() << ", " << corpus_bytes
+              << " bytes, best of " << passes << " passes" << std::endl;
+
+    auto run = [&](const std::string& name, pass_stats (*read)(
+        analyzers::token_stream&, const std::vector<std::string>&))
+    {
+        pass_stats stats;
+        auto best = std::chrono::milliseconds::max();
+        for (uint64_t i = 0; i < passes; ++i)
+        {
+            auto time = common::time([&]()
+                                     {
+                stats = read(*stream, docs);
+            });
+            best = std::min(best, time);
+        }
+
+        auto secs = std::max<double>(best.count(), 1) / 1000;
+        std::cout << name << ": " << best.count() << "ms, "
+                  << stats.tokens / secs << " tokens/s, "
+                  << corpus_bytes / secs / (1024 * 1024) << " MB/s"
+                  << std::endl;
+        return stats;
+    };
+
+    auto strings = run("next()     ", read_strings);
+    auto views = run("next_view()", read_views);
+
+    if (strings.tokens != views.tokens || strings.bytes != views.bytes)
+    {
+        LOG(fatal) << "Token streams disagree: " << strings.tokens << " vs "
+                   << views.tokens << " tokens" << ENDLG;
+        return 1;
+    }
+
+    return 0;
+}
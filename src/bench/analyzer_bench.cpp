@@ -0,0 +1,91 @@
+/**
+ * @file analyzer_bench.cpp
+ * @author agent
+ */
+
+#include <fstream>
+
+#include "analyzers/filters/all.h"
+#include "analyzers/tokenizers/icu_tokenizer.h"
+#include "analyzers/tokenizers/whitespace_tokenizer.h"
+#include "bench/analyzer_bench.h"
+#include "bench/synthetic.h"
+#include "util/shim.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+/**
+ * Drains the stream over every document.
+ * @return the number of tokens produced
+ */
+uint64_t drain(analyzers::token_stream& stream,
+               const std::vector<std::string>& docs)
+{
+    uint64_t tokens = 0;
+    for (const auto& doc : docs)
+    {
+        stream.set_content(doc);
+        while (stream)
+        {
+            stream.next_view();
+            ++tokens;
+        }
+    }
+    return tokens;
+}
+}
+
+void analyzer_benchmarks(runner& r)
+{
+    corpus_options options;
+    options.num_docs = 1000;
+    std::vector<std::string> labels;
+    auto docs = synthetic_documents(options, labels);
+
+    // the most frequent words make a stand-in stopword list
+    std::string stopwords = "bench-data/stopwords.txt";
+    {
+        std::ofstream out{stopwords};
+        for (uint64_t rank = 0; rank < 50; ++rank)
+            out << synthetic_word(rank) << "\n";
+    }
+
+    // time every stage per input token, so that the difference between
+    // successive stages is the cost of the filter just added
+    using namespace analyzers;
+    std::unique_ptr<token_stream> stream
+        = make_unique<tokenizers::whitespace_tokenizer>();
+    auto num_tokens = drain(*stream, docs);
+
+    auto time_stage = [&](const std::string& name)
+    {
+        r.run("analyzer-" + name, num_tokens, [&]()
+              {
+            do_not_optimize(drain(*stream, docs));
+        }, 10);
+    };
+
+    time_stage("whitespace-tokenizer");
+    stream = make_unique<filters::lowercase_filter>(std::move(stream));
+    time_stage("lowercase");
+    stream = make_unique<filters::alpha_filter>(std::move(stream));
+    time_stage("alpha");
+    stream = make_unique<filters::length_filter>(std::move(stream), 2, 35);
+    time_stage("length");
+    stream = make_unique<filters::list_filter>(std::move(stream), stopwords);
+    time_stage("list");
+    stream = make_unique<filters::porter2_stemmer>(std::move(stream));
+    time_stage("porter2-stemmer");
+    stream = make_unique<filters::empty_sentence_filter>(std::move(stream));
+    time_stage("empty-sentence");
+
+    stream = make_unique<tokenizers::icu_tokenizer>();
+    time_stage("icu-tokenizer");
+}
+}
+}
@@ -0,0 +1,164 @@
+/**
+ * @file bench.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "bench/bench.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+/**
+ * @param sorted Values in increasing order
+ * @param p The percentile to compute, in [0, 1]
+ * @return the value at that percentile (nearest rank)
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+}
+
+double result::ops_per_sec() const
+{
+    return p50_ns > 0 ? 1e9 / p50_ns : 0;
+}
+
+double result::mb_per_sec() const
+{
+    // p50_ns is per operation, so a sample takes p50_ns * ops
+    return p50_ns > 0 && ops > 0 ? bytes * 1e3 / (p50_ns * ops) : 0;
+}
+
+runner::runner(uint64_t samples, uint64_t warmup)
+    : samples_{std::max<uint64_t>(samples, 1)}, warmup_{warmup}
+{
+    // nothing
+}
+
+const result& runner::record(const std::string& name, uint64_t ops,
+                             std::vector<double> times, uint64_t bytes)
+{
+    std::sort(times.begin(), times.end());
+
+    result res;
+    res.name = name;
+    res.samples = times.size();
+    res.ops = ops;
+    res.p50_ns = percentile(times, 0.50);
+    res.p95_ns = percentile(times, 0.95);
+    res.p99_ns = percentile(times, 0.99);
+    res.bytes = bytes;
+    results_.push_back(res);
+
+    std::cerr << std::left << std::setw(40) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(1)
+              << res.p50_ns << " ns/op  p99 " << std::setw(12) << res.p99_ns
+              << " ns/op";
+    if (bytes > 0)
+        std::cerr << std::setw(10) << res.mb_per_sec() << " MB/s";
+    std::cerr << std::endl;
+    return results_.back();
+}
+
+const std::vector<result>& runner::results() const
+{
+    return results_;
+}
+
+void write_results(std::ostream& out, const std::vector<result>& results)
+{
+    out << "benchmark\tsamples\tops\tp50_ns\tp95_ns\tp99_ns\tops_per_sec"
+           "\tbytes\tmb_per_sec\n";
+    out << std::setprecision(6);
+    for (const auto& res : results)
+    {
+        out << res.name << "\t" << res.samples << "\t" << res.ops << "\t"
+            << res.p50_ns << "\t" << res.p95_ns << "\t" << res.p99_ns << "\t"
+            << res.ops_per_sec() << "\t" << res.bytes << "\t"
+            << res.mb_per_sec() << "\n";
+    }
+    out.flush();
+}
+
+std::vector<result> read_results(std::istream& in)
+{
+    std::vector<result> results;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line.compare(0, 9, "benchmark") == 0)
+            continue;
+
+        std::istringstream fields{line};
+        result res;
+        std::getline(fields, res.name, '\t');
+        fields >> res.samples >> res.ops >> res.p50_ns >> res.p95_ns
+            >> res.p99_ns;
+        if (!fields)
+            continue;
+
+        // results written before throughput was recorded have no bytes
+        double ops_per_sec;
+        if (!(fields >> ops_per_sec >> res.bytes))
+            res.bytes = 0;
+        results.push_back(res);
+    }
+    return results;
+}
+
+uint64_t compare_results(std::ostream& out,
+                         const std::vector<result>& baseline,
+                         const std::vector<result>& current, double threshold)
+{
+    std::unordered_map<std::string, const result*> base;
+    for (const auto& res : baseline)
+        base[res.name] = &res;
+
+    uint64_t regressions = 0;
+    out << std::left << std::setw(40) << "benchmark" << std::right
+        << std::setw(14) << "baseline ns" << std::setw(14) << "current ns"
+        << std::setw(10) << "change" << "\n";
+    for (const auto& res : current)
+    {
+        out << std::left << std::setw(40) << res.name << std::right;
+        auto it = base.find(res.name);
+        if (it == base.end() || it->second->p50_ns <= 0)
+        {
+            out << std::setw(14) << "-" << std::setw(14) << std::fixed
+                << std::setprecision(1) << res.p50_ns << std::setw(10) << "new"
+                << "\n";
+            continue;
+        }
+
+        auto ratio = res.p50_ns / it->second->p50_ns;
+        out << std::setw(14) << std::fixed << std::setprecision(1)
+            << it->second->p50_ns << std::setw(14) << res.p50_ns
+            << std::setw(9) << std::showpos << (ratio - 1) * 100 << "%"
+            << std::noshowpos;
+        if (ratio > 1 + threshold)
+        {
+            out << "  REGRESSION";
+            ++regressions;
+        }
+        out << "\n";
+    }
+    out.flush();
+    return regressions;
+}
+}
+}
@@ -0,0 +1,105 @@
+/**
+ * @file cache_bench.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include "bench/cache_bench.h"
+#include "bench/synthetic.h"
+#include "caching/clock_cache.h"
+#include "caching/dblru_cache.h"
+#include "caching/splay_cache.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+/**
+ * Times find and insert on a cache holding a tenth of a Zipf-distributed
+ * key space, as a postings cache sees query terms.
+ */
+template <class Cache>
+void time_cache(runner& r, const std::string& name, Cache& cache,
+                const std::vector<uint64_t>& keys)
+{
+    for (const auto& key : keys)
+        cache.insert(key, key);
+
+    r.run(name + "-get", keys.size(), [&]()
+          {
+        uint64_t hits = 0;
+        for (const auto& key : keys)
+            hits += static_cast<bool>(cache.find(key));
+        do_not_optimize(hits);
+    });
+
+    r.run(name + "-put", keys.size(), [&]()
+          {
+        for (const auto& key : keys)
+            cache.insert(key, key);
+    });
+}
+
+/**
+ * Times find on a cache from several threads at once, each looking up
+ * every key, as a postings cache sees concurrent queries.
+ */
+template <class Cache>
+void time_concurrent_cache(runner& r, const std::string& name, Cache& cache,
+                           const std::vector<uint64_t>& keys,
+                           uint64_t num_threads)
+{
+    for (const auto& key : keys)
+        cache.insert(key, key);
+
+    r.run(name + "-get-" + std::to_string(num_threads) + "-threads",
+          keys.size() * num_threads, [&]()
+          {
+        std::vector<std::thread> threads;
+        for (uint64_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&]()
+                                 {
+                uint64_t hits = 0;
+                for (const auto& key : keys)
+                    hits += static_cast<bool>(cache.find(key));
+                do_not_optimize(hits);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }, 10);
+}
+}
+
+void cache_benchmarks(runner& r)
+{
+    const uint64_t key_space = 100000;
+    std::mt19937_64 rng{47};
+    zipf_distribution zipf{key_space};
+    std::vector<uint64_t> keys(100000);
+    for (auto& key : keys)
+        key = zipf(rng);
+
+    caching::dblru_cache<uint64_t, uint64_t> dblru{key_space / 10};
+    time_cache(r, "dblru-cache", dblru, keys);
+
+    caching::splay_cache<uint64_t, uint64_t> splay{key_space / 10};
+    time_cache(r, "splay-cache", splay, keys);
+
+    caching::clock_cache<uint64_t, uint64_t> clock{key_space / 10};
+    time_cache(r, "clock-cache", clock, keys);
+
+    uint64_t num_threads = std::max(4u, std::thread::hardware_concurrency());
+    time_concurrent_cache(r, "dblru-cache", dblru, keys, num_threads);
+    time_concurrent_cache(r, "splay-cache", splay, keys, num_threads);
+    time_concurrent_cache(r, "clock-cache", clock, keys, num_threads);
+}
+}
+}
@@ -0,0 +1,216 @@
+/**
+ * @file codec_bench.cpp
+ * @author agent
+ */
+
+#include <random>
+
+#include "bench/codec_bench.h"
+#include "index/postings_data.h"
+#include "io/block_file_reader.h"
+#include "io/block_file_writer.h"
+#include "io/compressed_file_reader.h"
+#include "io/compressed_file_writer.h"
+#include "io/mmap_file.h"
+#include "meta.h"
+#include "util/filesystem.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+using pdata_type = index::postings_data<term_id, doc_id>;
+
+/**
+ * @return postings lists whose lengths and d-gaps resemble those of an
+ * inverted index: many short lists and a few long ones
+ */
+std::vector<pdata_type> synthetic_postings(uint64_t num_lists,
+                                           uint64_t num_docs)
+{
+    std::mt19937_64 rng{47};
+    std::vector<pdata_type> lists;
+    for (uint64_t t = 0; t < num_lists; ++t)
+    {
+        pdata_type pdata{term_id{t}};
+        auto df = std::max<uint64_t>(num_docs / (t + 1), 1);
+        std::uniform_int_distribution<uint64_t> gap{1, 2 * num_docs / df};
+        std::geometric_distribution<uint64_t> count{0.6};
+        uint64_t id = (gap(rng) - 1) % num_docs;
+        for (uint64_t i = 0; i < df && id < num_docs; ++i, id += gap(rng))
+            pdata.increase_count(doc_id{id}, count(rng) + 1);
+        lists.push_back(std::move(pdata));
+    }
+    return lists;
+}
+
+/**
+ * @return the total number of postings in the lists
+ */
+uint64_t total_postings(const std::vector<pdata_type>& lists)
+{
+    uint64_t total = 0;
+    for (const auto& pdata : lists)
+        total += pdata.counts().size();
+    return total;
+}
+
+/**
+ * Decodes gamma-coded values a bit at a time, as compressed_file_reader
+ * did before it read whole words, as a baseline for its throughput.
+ * @param data The compressed values
+ * @param count The number of values to decode
+ * @return the sum of the values
+ */
+uint64_t decode_bitwise(const char* data, uint64_t count)
+{
+    uint64_t bit = 0;
+    auto read_bit = [&]()
+    {
+        bool set = data[bit / 8] & (1 << (7 - bit % 8));
+        ++bit;
+        return set;
+    };
+
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t num_bits = 0;
+        while (!read_bit())
+            ++num_bits;
+
+        uint64_t value = 1;
+        for (uint64_t b = 0; b < num_bits; ++b)
+            value = (value << 1) | read_bit();
+        sum += io::default_compression_reader_func(value);
+    }
+    return sum;
+}
+
+void gamma_benchmarks(runner& r)
+{
+    // d-gap-like values: mostly small, occasionally large
+    std::mt19937_64 rng{47};
+    std::geometric_distribution<uint64_t> gap{0.05};
+    std::vector<uint64_t> values(1 << 20);
+    for (auto& v : values)
+        v = gap(rng) + 1;
+
+    // throughput is measured in compressed bytes
+    std::vector<char> buffer;
+    {
+        io::compressed_file_writer out{buffer,
+                                       io::default_compression_writer_func};
+        for (const auto& v : values)
+            out.write(v);
+    }
+    uint64_t bytes = buffer.size();
+
+    std::string filename = "bench-data/gamma.bin";
+    r.run("gamma-encode", values.size(), [&]()
+          {
+        io::compressed_file_writer out{filename,
+                                       io::default_compression_writer_func};
+        for (const auto& v : values)
+            out.write(v);
+    }, 10, bytes);
+
+    r.run("gamma-encode-buffer", values.size(), [&]()
+          {
+        buffer.clear();
+        io::compressed_file_writer out{buffer,
+                                       io::default_compression_writer_func};
+        for (const auto& v : values)
+            out.write(v);
+    }, 10, bytes);
+
+    io::compressed_file_reader in{filename,
+                                  io::default_compression_reader_func};
+    r.run("gamma-decode", values.size(), [&]()
+          {
+        in.reset();
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < values.size(); ++i)
+            sum += in.next();
+        do_not_optimize(sum);
+    }, 10, bytes);
+
+    io::compressed_file_reader buffer_in{buffer.data(), buffer.size(),
+                                         io::default_compression_reader_func};
+    r.run("gamma-decode-buffer", values.size(), [&]()
+          {
+        buffer_in.reset();
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < values.size(); ++i)
+            sum += buffer_in.next();
+        do_not_optimize(sum);
+    }, 10, bytes);
+
+    io::mmap_file file{filename};
+    r.run("gamma-decode-bitwise", values.size(), [&]()
+          {
+        do_not_optimize(decode_bitwise(file.begin(), values.size()));
+    }, 10, bytes);
+}
+
+void postings_benchmarks(runner& r)
+{
+    auto lists = synthetic_postings(2000, 100000);
+    auto num_postings = total_postings(lists);
+
+    std::string gamma_file = "bench-data/postings-gamma.bin";
+    {
+        io::compressed_file_writer out{gamma_file,
+                                       io::default_compression_writer_func};
+        for (const auto& pdata : lists)
+            pdata.write_compressed(out);
+    }
+
+    std::string block_file = "bench-data/postings-block.bin";
+    {
+        io::block_file_writer out{block_file};
+        for (const auto& pdata : lists)
+            pdata.write_packed(out);
+    }
+
+    io::compressed_file_reader gamma_in{gamma_file,
+                                        io::default_compression_reader_func};
+    r.run("postings-decode-gamma", num_postings, [&]()
+          {
+        gamma_in.reset();
+        uint64_t sum = 0;
+        pdata_type pdata;
+        for (uint64_t i = 0; i < lists.size(); ++i)
+        {
+            pdata.read_compressed(gamma_in);
+            sum += pdata.counts().size();
+        }
+        do_not_optimize(sum);
+    });
+
+    io::block_file_reader block_in{block_file};
+    r.run("postings-decode-block", num_postings, [&]()
+          {
+        block_in.seek(0);
+        uint64_t sum = 0;
+        pdata_type pdata;
+        for (uint64_t i = 0; i < lists.size(); ++i)
+        {
+            pdata.read_packed(block_in);
+            sum += pdata.counts().size();
+        }
+        do_not_optimize(sum);
+    });
+}
+}
+
+void codec_benchmarks(runner& r)
+{
+    gamma_benchmarks(r);
+    postings_benchmarks(r);
+}
+}
+}
@@ -0,0 +1,316 @@
+/**
+ * @file index_bench.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <queue>
+#include <random>
+
+#include "bench/index_bench.h"
+#include "bench/synthetic.h"
+#include "corpus/document.h"
+#include "index/compact_vocabulary.h"
+#include "index/compact_vocabulary_writer.h"
+#include "index/inverted_index.h"
+#include "index/postings_cursor.h"
+#include "index/postings_data.h"
+#include "index/query_engine.h"
+#include "index/ranker/okapi_bm25.h"
+#include "index/vocabulary_map.h"
+#include "index/vocabulary_map_writer.h"
+#include "util/fixed_heap.h"
+#include "util/shim.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+void vocabulary_benchmarks(runner& r)
+{
+    std::vector<std::string> terms;
+    for (uint64_t rank = 0; rank < 200000; ++rank)
+        terms.push_back(synthetic_word(rank));
+    std::sort(terms.begin(), terms.end());
+
+    std::string path = "bench-data/vocab.index";
+    std::string compact_path = "bench-data/vocab.compact";
+    {
+        index::vocabulary_map_writer writer{path};
+        index::compact_vocabulary_writer compact_writer{compact_path};
+        for (const auto& term : terms)
+        {
+            writer.insert(term);
+            compact_writer.insert(term);
+        }
+    }
+    index::vocabulary_map vocab{path};
+    index::compact_vocabulary compact_vocab{compact_path};
+
+    // look terms up in a frequency-skewed order, with one miss in ten
+    std::mt19937_64 rng{47};
+    zipf_distribution zipf{terms.size()};
+    std::vector<std::string> lookups;
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+        if (i % 10 == 0)
+            lookups.push_back(synthetic_word(terms.size() + i));
+        else
+            lookups.push_back(synthetic_word(zipf(rng)));
+    }
+
+    r.run("vocabulary-map-find", lookups.size(), [&]()
+          {
+        uint64_t found = 0;
+        for (const auto& term : lookups)
+            found += static_cast<bool>(vocab.find(term));
+        do_not_optimize(found);
+    });
+
+    r.run("compact-vocabulary-find", lookups.size(), [&]()
+          {
+        uint64_t found = 0;
+        for (const auto& term : lookups)
+            found += static_cast<bool>(compact_vocab.find(term));
+        do_not_optimize(found);
+    });
+
+    std::vector<term_id> ids;
+    for (uint64_t i = 0; i < 10000; ++i)
+        ids.push_back(term_id{zipf(rng)});
+
+    r.run("vocabulary-map-find-term", ids.size(), [&]()
+          {
+        uint64_t length = 0;
+        for (const auto& t_id : ids)
+            length += vocab.find_term(t_id).length();
+        do_not_optimize(length);
+    });
+
+    r.run("compact-vocabulary-find-term", ids.size(), [&]()
+          {
+        uint64_t length = 0;
+        for (const auto& t_id : ids)
+            length += compact_vocab.find_term(t_id).length();
+        do_not_optimize(length);
+    });
+}
+
+/**
+ * Orders scores by decreasing score, breaking ties by increasing doc_id,
+ * as the rankers do.
+ */
+struct score_comp
+{
+    bool operator()(const std::pair<uint64_t, double>& a,
+                    const std::pair<uint64_t, double>& b) const
+    {
+        if (a.second != b.second)
+            return a.second > b.second;
+        return a.first < b.first;
+    }
+};
+
+void topk_benchmarks(runner& r)
+{
+    // scores for every document in a large collection, as a ranker would
+    // see them at the end of term-at-a-time processing
+    std::mt19937_64 rng{47};
+    std::uniform_real_distribution<double> dist{0, 20};
+    std::vector<double> scores(1000000);
+    for (auto& score : scores)
+        score = dist(rng);
+
+    for (uint64_t k : {10, 1000})
+    {
+        // a heap that is popped whenever it grows past k
+        r.run("topk-priority-queue-" + std::to_string(k), scores.size(), [&]()
+              {
+            std::priority_queue<std::pair<uint64_t, double>,
+                                std::vector<std::pair<uint64_t, double>>,
+                                score_comp> pq;
+            for (uint64_t id = 0; id < scores.size(); ++id)
+            {
+                pq.emplace(id, scores[id]);
+                if (pq.size() > k)
+                    pq.pop();
+            }
+            do_not_optimize(pq.top().first);
+        }, 10);
+
+        // a heap that checks the threshold before doing any work
+        r.run("topk-fixed-heap-" + std::to_string(k), scores.size(), [&]()
+              {
+            util::fixed_heap<std::pair<uint64_t, double>, score_comp> heap{k};
+            for (uint64_t id = 0; id < scores.size(); ++id)
+                heap.emplace(id, scores[id]);
+            do_not_optimize(heap.extract_top().front().first);
+        }, 10);
+    }
+}
+
+void postings_benchmarks(runner& r, const index::inverted_index& idx,
+                         const std::string& codec)
+{
+    uint64_t num_postings = 0;
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+        num_postings += idx.doc_freq(t_id);
+
+    // decode every postings list, materialized or through a cursor
+    r.run("postings-search-primary-" + codec, num_postings, [&]()
+          {
+        uint64_t total = 0;
+        for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+            total += idx.search_primary(t_id)->counts().size();
+        do_not_optimize(total);
+    }, 10);
+
+    std::vector<index::postings_cursor::pair_t> postings;
+    r.run("postings-cursor-" + codec, num_postings, [&]()
+          {
+        uint64_t total = 0;
+        for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+        {
+            idx.postings(t_id).read_all(postings);
+            total += postings.size();
+        }
+        do_not_optimize(total);
+    }, 10);
+
+    // intersect the rarest terms with the most frequent ones, where
+    // skipping through the frequent terms' postings pays off most
+    std::vector<term_id> by_freq;
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+        by_freq.push_back(t_id);
+    std::sort(by_freq.begin(), by_freq.end(), [&](term_id a, term_id b)
+              {
+                  return idx.doc_freq(a) > idx.doc_freq(b);
+              });
+    std::vector<std::pair<term_id, term_id>> pairs;
+    for (uint64_t i = 0; i < 100 && i < by_freq.size(); ++i)
+        pairs.emplace_back(by_freq[by_freq.size() - 1 - i],
+                           by_freq[i % 10]);
+
+    r.run("postings-intersect-scan-" + codec, pairs.size(), [&]()
+          {
+        uint64_t matches = 0;
+        for (const auto& pair : pairs)
+        {
+            auto rare = idx.postings(pair.first);
+            auto frequent = idx.postings(pair.second);
+            while (rare.has_next())
+            {
+                auto d_id = rare.next().first;
+                while (frequent.has_next() && frequent.peek().first < d_id)
+                    frequent.next();
+                matches += frequent.has_next()
+                           && frequent.peek().first == d_id;
+            }
+        }
+        do_not_optimize(matches);
+    }, 10);
+
+    r.run("postings-intersect-skip-" + codec, pairs.size(), [&]()
+          {
+        uint64_t matches = 0;
+        for (const auto& pair : pairs)
+        {
+            auto rare = idx.postings(pair.first);
+            auto frequent = idx.postings(pair.second);
+            while (rare.has_next())
+            {
+                auto d_id = rare.next().first;
+                frequent.advance_to(d_id);
+                matches += frequent.has_next()
+                           && frequent.peek().first == d_id;
+            }
+        }
+        do_not_optimize(matches);
+    }, 10);
+}
+
+void ranker_benchmarks(runner& r, const std::string& codec,
+                       std::vector<index::query_strategy> strategies)
+{
+    corpus_options options;
+    options.num_docs = 10000;
+    options.name = "ranker";
+    auto config = write_synthetic_corpus("bench-data", options, codec);
+    auto idx = index::make_index<index::inverted_index>(config);
+    postings_benchmarks(r, *idx, codec);
+
+    // queries of two to four terms drawn from the head of the vocabulary
+    std::mt19937_64 rng{47};
+    zipf_distribution zipf{2000};
+    std::uniform_int_distribution<uint64_t> length{2, 4};
+    std::vector<corpus::document> queries(200);
+    for (auto& query : queries)
+    {
+        std::string content;
+        for (auto i = length(rng); i > 0; --i)
+            content += synthetic_word(zipf(rng)) + " ";
+        query.content(content);
+    }
+
+    // concurrent batches, as a search host would serve them
+    index::query_engine engine{idx, []()
+                               {
+        return make_unique<index::okapi_bm25>();
+    }};
+    r.run("query-engine-batch-" + codec, queries.size(), [&]()
+          {
+        do_not_optimize(engine.run(queries, 10).rankings.size());
+    }, 10);
+
+    std::vector<double> latencies;
+    for (uint64_t i = 0; i < 5; ++i)
+    {
+        for (const auto& latency : engine.run(queries, 10).latencies)
+            latencies.push_back(latency * 1e6);
+    }
+    r.record("query-engine-latency-" + codec, 1, std::move(latencies));
+
+    index::okapi_bm25 ranker;
+    for (const auto& strategy : strategies)
+    {
+        std::string name = "ranker-score-" + codec + "-";
+        switch (strategy)
+        {
+            case index::query_strategy::term_at_a_time:
+                name += "taat";
+                break;
+            case index::query_strategy::wand:
+                name += "wand";
+                break;
+            case index::query_strategy::block_max_wand:
+                name += "bmw";
+                break;
+        }
+
+        ranker.strategy(strategy);
+        uint64_t next = 0;
+        r.run(name, 1, [&]()
+              {
+            auto results = ranker.score(*idx, queries[next++ % queries.size()],
+                                        10);
+            do_not_optimize(results.size());
+        }, queries.size());
+    }
+}
+}
+
+void index_benchmarks(runner& r)
+{
+    vocabulary_benchmarks(r);
+    topk_benchmarks(r);
+    ranker_benchmarks(r, "gamma", {index::query_strategy::term_at_a_time,
+                                   index::query_strategy::wand});
+    ranker_benchmarks(r, "block", {index::query_strategy::term_at_a_time,
+                                   index::query_strategy::wand,
+                                   index::query_strategy::block_max_wand});
+}
+}
+}
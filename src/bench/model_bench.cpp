@@ -0,0 +1,106 @@
+/**
+ * @file model_bench.cpp
+ * @author agent
+ */
+
+#include "bench/model_bench.h"
+#include "bench/synthetic.h"
+#include "classify/classifier/sgd.h"
+#include "classify/loss/hinge.h"
+#include "index/forward_index.h"
+#include "topics/lda_gibbs.h"
+#include "util/shim.h"
+
+namespace meta
+{
+namespace bench
+{
+
+namespace
+{
+/**
+ * Exposes the sampling iterations of lda_gibbs so they can be timed
+ * without the likelihood computation done by run().
+ */
+class timed_lda : public topics::lda_gibbs
+{
+  public:
+    using topics::lda_gibbs::lda_gibbs;
+
+    /**
+     * Assigns the initial topics.
+     */
+    void init()
+    {
+        initialize();
+    }
+
+    /**
+     * Performs one sampling pass over the corpus.
+     */
+    void iterate()
+    {
+        perform_iteration(++iter_);
+    }
+
+  private:
+    /// the number of iterations performed so far
+    uint64_t iter_ = 0;
+};
+
+void lda_benchmarks(runner& r, std::shared_ptr<index::forward_index> idx,
+                    uint64_t num_tokens)
+{
+    for (auto sampler :
+         {topics::topic_sampler::full, topics::topic_sampler::alias_mh})
+    {
+        timed_lda lda{idx, 100, 0.1, 0.01};
+        lda.sampler(sampler);
+        lda.init();
+        r.run(std::string{"lda-gibbs-"}
+                  + (sampler == topics::topic_sampler::full ? "full"
+                                                            : "alias-mh"),
+              num_tokens, [&]()
+              {
+            lda.iterate();
+        }, 5);
+    }
+}
+
+void sgd_benchmarks(runner& r, std::shared_ptr<index::forward_index> idx)
+{
+    auto docs = idx->docs();
+    // a gamma of zero disables the convergence check, so each call to
+    // train() runs exactly one epoch; the weights carry over between calls
+    classify::sgd sgd{"bench-data/sgd-model", idx, class_label{"pos"},
+                      class_label{"neg"}, make_unique<classify::loss::hinge>(),
+                      classify::sgd::default_alpha, 0,
+                      classify::sgd::default_bias,
+                      classify::sgd::default_lambda, 1};
+
+    r.run("sgd-update", docs.size(), [&]()
+          {
+        sgd.train(docs);
+    }, 10);
+}
+}
+
+void model_benchmarks(runner& r)
+{
+    corpus_options options;
+    options.name = "model";
+    auto config = write_synthetic_corpus("bench-data", options);
+    auto idx = index::make_index<index::forward_index>(config);
+
+    uint64_t num_tokens = 0;
+    for (const auto& d_id : idx->docs())
+    {
+        num_tokens += idx->doc_size(d_id);
+        idx->search_primary(d_id);
+    }
+
+    lda_benchmarks(r, idx, num_tokens);
+    sgd_benchmarks(r, idx);
+}
+}
+}
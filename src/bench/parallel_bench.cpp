@@ -0,0 +1,59 @@
+/**
+ * @file parallel_bench.cpp
+ * @author agent
+ */
+
+#include "bench/parallel_bench.h"
+#include "parallel/parallel_for.h"
+#include "parallel/thread_pool.h"
+
+namespace meta
+{
+namespace bench
+{
+
+void parallel_benchmarks(runner& r)
+{
+    parallel::thread_pool pool;
+
+    const uint64_t num_tasks = 10000;
+    r.run("thread-pool-task", num_tasks, [&]()
+          {
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(num_tasks);
+        for (uint64_t i = 0; i < num_tasks; ++i)
+            futures.emplace_back(pool.submit_task([i]()
+                                                  {
+                return i;
+            }));
+        uint64_t sum = 0;
+        for (auto& fut : futures)
+            sum += fut.get();
+        do_not_optimize(sum);
+    });
+
+    // trivial bodies, so that what is timed is the scheduling overhead
+    std::vector<uint64_t> values(1 << 20);
+    for (uint64_t grain : {uint64_t{0}, uint64_t{64}, uint64_t{1024}})
+    {
+        auto name = "parallel-for-grain-"
+                    + (grain == 0 ? std::string{"default"}
+                                  : std::to_string(grain));
+        r.run(name, values.size(), [&]()
+              {
+            auto func = [](uint64_t& v)
+            {
+                ++v;
+            };
+            if (grain == 0)
+                parallel::parallel_for(values.begin(), values.end(), pool,
+                                       func);
+            else
+                parallel::parallel_for(values.begin(), values.end(), pool,
+                                       grain, func);
+        }, 10);
+    }
+    do_not_optimize(values.front());
+}
+}
+}
@@ -0,0 +1,131 @@
+/**
+ * @file synthetic.cpp
+ * @author agent
+ */
+
+#include <cmath>
+#include <fstream>
+
+#include "bench/synthetic.h"
+#include "util/filesystem.h"
+
+namespace meta
+{
+namespace bench
+{
+
+zipf_distribution::zipf_distribution(uint64_t n, double s)
+    : cdf_(std::max<uint64_t>(n, 1))
+{
+    double sum = 0;
+    for (uint64_t r = 0; r < cdf_.size(); ++r)
+    {
+        sum += 1.0 / std::pow(r + 1, s);
+        cdf_[r] = sum;
+    }
+}
+
+std::string synthetic_word(uint64_t rank)
+{
+    static const char* syllables[]
+        = {"ba", "ke", "di", "mo", "nu", "ra", "se", "ti", "lo", "vu",
+           "ga", "pe", "fi", "zo", "hu", "ja", "we", "yi", "co", "xu"};
+    static const char* suffixes[] = {"", "", "", "s", "ed", "ing", "ly"};
+
+    // at least two syllables, so that every word survives length filters
+    std::string word;
+    for (auto r = rank + 20; r > 0; r /= 20)
+        word += syllables[r % 20];
+    return word + suffixes[rank % 7];
+}
+
+std::vector<std::string> synthetic_documents(const corpus_options& options,
+                                             std::vector<std::string>& labels)
+{
+    std::mt19937_64 rng{options.seed};
+    zipf_distribution zipf{options.vocab_size};
+    std::uniform_int_distribution<uint64_t> length{options.min_length,
+                                                   options.max_length};
+    std::uniform_int_distribution<uint64_t> sentence{5, 25};
+    std::uniform_int_distribution<uint64_t> indicative{0, 49};
+    std::bernoulli_distribution coin{0.5};
+    std::bernoulli_distribution signal{0.1};
+
+    std::vector<std::string> docs;
+    docs.reserve(options.num_docs);
+    labels.clear();
+    labels.reserve(options.num_docs);
+    for (uint64_t d = 0; d < options.num_docs; ++d)
+    {
+        bool positive = coin(rng);
+        labels.push_back(positive ? "pos" : "neg");
+
+        // label-specific words sit just past the end of the vocabulary
+        auto label_words = options.vocab_size + (positive ? 0 : 50);
+
+        std::string doc;
+        auto len = length(rng);
+        auto until_stop = sentence(rng);
+        bool capitalize = true;
+        for (uint64_t i = 0; i < len; ++i)
+        {
+            auto rank = signal(rng) ? label_words + indicative(rng) : zipf(rng);
+            auto word = synthetic_word(rank);
+            if (capitalize)
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+            capitalize = --until_stop == 0 || i + 1 == len;
+            if (capitalize)
+            {
+                word += '.';
+                until_stop = sentence(rng);
+            }
+
+            if (!doc.empty())
+                doc += ' ';
+            doc += word;
+        }
+        docs.push_back(std::move(doc));
+    }
+    return docs;
+}
+
+std::string write_synthetic_corpus(const std::string& prefix,
+                                   const corpus_options& options,
+                                   const std::string& codec)
+{
+    const auto& dataset = options.name;
+    filesystem::make_directory(prefix + "/" + dataset);
+
+    std::vector<std::string> labels;
+    auto docs = synthetic_documents(options, labels);
+    {
+        auto path = prefix + "/" + dataset + "/" + dataset + ".dat";
+        std::ofstream content{path};
+        std::ofstream label_file{path + ".labels"};
+        for (uint64_t d = 0; d < docs.size(); ++d)
+        {
+            content << docs[d] << "\n";
+            label_file << labels[d] << "\n";
+        }
+    }
+
+    auto config_path = prefix + "/" + dataset + "-" + codec + ".toml";
+    std::ofstream config{config_path};
+    config << "prefix = \"" << prefix << "\"\n"
+           << "dataset = \"" << dataset << "\"\n"
+           << "corpus-type = \"line-corpus\"\n"
+           << "forward-index = \"" << prefix << "/" << dataset << "-fwd\"\n"
+           << "inverted-index = \"" << prefix << "/" << dataset << "-" << codec
+           << "-inv\"\n"
+           << "postings-codec = \"" << codec << "\"\n"
+           << "[[analyzers]]\n"
+           << "method = \"ngram-word\"\n"
+           << "ngram = 1\n"
+           << "[[analyzers.filter]]\n"
+           << "type = \"whitespace-tokenizer\"\n"
+           << "[[analyzers.filter]]\n"
+           << "type = \"lowercase\"\n";
+    return config_path;
+}
+}
+}
@@ -0,0 +1,137 @@
+/**
+ * @file bench.cpp
+ * @author agent
+ *
+ * Runs the benchmark suites on synthetic data, writes the results as
+ * tab-separated values, and optionally compares them against a baseline
+ * written by an earlier run.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include "bench/analyzer_bench.h"
+#include "bench/bench.h"
+#include "bench/cache_bench.h"
+#include "bench/codec_bench.h"
+#include "bench/index_bench.h"
+#include "bench/model_bench.h"
+#include "bench/parallel_bench.h"
+#include "logging/logger.h"
+#include "util/filesystem.h"
+
+using namespace meta;
+
+int main(int argc, char* argv[])
+{
+    std::unordered_set<std::string> suites;
+    std::string output;
+    std::string baseline;
+    double threshold = 0.10;
+    uint64_t samples = 30;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+            output = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baseline = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            threshold = std::stod(argv[++i]) / 100;
+        else if (arg == "--samples" && i + 1 < argc)
+            samples = std::stoul(argv[++i]);
+        else
+            suites.insert(arg);
+    }
+
+    if (suites.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [options] suite [suite [...]]"
+                  << std::endl;
+        std::cerr << "where suite is one of: " << std::endl;
+        std::cerr << " \"all\": runs all benchmarks" << std::endl;
+        std::cerr << " \"codec\": gamma coding and postings decoding"
+                  << std::endl;
+        std::cerr << " \"index\": vocabulary lookups and ranker latency"
+                  << std::endl;
+        std::cerr << " \"analyzers\": analyzer throughput per filter"
+                  << std::endl;
+        std::cerr << " \"caches\": dblru_cache and splay_cache get/put"
+                  << std::endl;
+        std::cerr << " \"parallel\": thread_pool and parallel_for overhead"
+                  << std::endl;
+        std::cerr << " \"models\": LDA sampling and SGD update rates"
+                  << std::endl;
+        std::cerr << "and options are:" << std::endl;
+        std::cerr << " --out file: writes the results to file instead of "
+                     "standard output" << std::endl;
+        std::cerr << " --baseline file: compares the results with those in "
+                     "file, exiting\n   with a failure if any is slower by "
+                     "more than the threshold" << std::endl;
+        std::cerr << " --threshold percent: the allowed slowdown (default 10)"
+                  << std::endl;
+        std::cerr << " --samples n: timed samples per benchmark (default 30)"
+                  << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging(logging::logger::severity_level::warning);
+
+    // all of the synthetic data lives here and is rebuilt on every run
+    system("rm -rf bench-data");
+    filesystem::make_directory("bench-data");
+
+    auto run = [&](const std::string& suite)
+    {
+        return suites.count("all") > 0 || suites.count(suite) > 0;
+    };
+
+    bench::runner runner{samples};
+    if (run("codec"))
+        bench::codec_benchmarks(runner);
+    if (run("index"))
+        bench::index_benchmarks(runner);
+    if (run("analyzers"))
+        bench::analyzer_benchmarks(runner);
+    if (run("caches"))
+        bench::cache_benchmarks(runner);
+    if (run("parallel"))
+        bench::parallel_benchmarks(runner);
+    if (run("models"))
+        bench::model_benchmarks(runner);
+
+    system("rm -rf bench-data");
+
+    if (output.empty())
+    {
+        bench::write_results(std::cout, runner.results());
+    }
+    else
+    {
+        std::ofstream out{output};
+        bench::write_results(out, runner.results());
+    }
+
+    if (!baseline.empty())
+    {
+        std::ifstream in{baseline};
+        if (!in)
+        {
+            std::cerr << "Failed to open baseline " << baseline << std::endl;
+            return 1;
+        }
+        auto regressions = bench::compare_results(
+            std::cerr, bench::read_results(in), runner.results(), threshold);
+        if (regressions > 0)
+        {
+            std::cerr << regressions << " benchmark(s) regressed by more than "
+                      << threshold * 100 << "%" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
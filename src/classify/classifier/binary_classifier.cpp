@@ -35,5 +35,10 @@ const class_label& binary_classifier::negative_label() const
     return negative_;
 }
 
+size_t binary_classifier::num_training_threads() const
+{
+    return 1;
+}
+
 }
 }
@@ -46,7 +46,9 @@ class_label knn::classify(doc_id d_id)
     for (const auto& count : idx_->search_primary(d_id)->counts())
         query.increment(idx_->term_text(count.first), count.second);
 
-    auto scored = ranker_->score(*inv_idx_, query, inv_idx_->num_docs(),
+    // only the neighbors that get a vote are ranked, so the ranker keeps no
+    // more than k_ + 1 results at a time
+    auto scored = ranker_->score(*inv_idx_, query, k_ + 1u,
                                  [&](doc_id d_id)
                                  {
         return legal_docs_.find(d_id) != legal_docs_.end();
@@ -10,6 +10,7 @@
 #include "classify/classifier/nearest_centroid.h"
 #include "corpus/document.h"
 #include "index/postings_data.h"
+#include "util/fixed_heap.h"
 
 namespace meta
 {
@@ -51,9 +52,6 @@ void nearest_centroid::train(const std::vector<doc_id>& docs)
 
 class_label nearest_centroid::classify(doc_id d_id)
 {
-    double best_score = std::numeric_limits<double>::lowest();
-    class_label best_label;
-
     auto pdata = idx_->search_primary(d_id);
 
     // convert to TF-IDF representation
@@ -62,17 +60,20 @@ class_label nearest_centroid::classify(doc_id d_id)
     for (auto& count : counts)
         count.second *= std::log(num_docs / inv_idx_->doc_freq(count.first));
 
-    for (auto& centroid : centroids_)
+    // only a strictly better score replaces the best centroid, so ties go
+    // to the first centroid seen
+    using scored_label = std::pair<double, class_label>;
+    auto by_score = [](const scored_label& a, const scored_label& b)
     {
-        double score = cosine_sim(counts, centroid.second);
-        if (score > best_score)
-        {
-            best_score = score;
-            best_label = centroid.first;
-        }
-    }
+        return a.first > b.first;
+    };
+    util::fixed_heap<scored_label, decltype(by_score)> best{1, by_score};
+    for (auto& centroid : centroids_)
+        best.emplace(cosine_sim(counts, centroid.second), centroid.first);
 
-    return best_label;
+    if (best.empty())
+        return class_label{};
+    return best.top().second;
 }
 
 double nearest_centroid::cosine_sim(
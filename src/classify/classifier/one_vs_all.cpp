@@ -16,6 +16,19 @@ const std::string one_vs_all::id = "one-vs-all";
 
 void one_vs_all::train(const std::vector<doc_id>& docs)
 {
+    // labels are trained in parallel only when their classifiers would
+    // each train on a single thread; otherwise the classifiers' own
+    // threads are used, one label at a time
+    for (const auto& pair : classifiers_)
+    {
+        if (pair.second->num_training_threads() > 1)
+        {
+            for (auto& p : classifiers_)
+                p.second->train(docs);
+            return;
+        }
+    }
+
     parallel::parallel_for(classifiers_.begin(), classifiers_.end(),
                            [&](decltype(*classifiers_.begin()) p)
     { p.second->train(docs); });
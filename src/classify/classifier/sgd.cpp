@@ -3,12 +3,15 @@
  * @author Chase Geigle
  */
 
+#include <atomic>
+#include <cmath>
 #include <numeric>
 #include <random>
 
 #include "classify/classifier/sgd.h"
 #include "classify/loss/loss_function_factory.h"
 #include "index/postings_data.h"
+#include "parallel/thread_pool.h"
 
 namespace meta
 {
@@ -20,7 +23,7 @@ const std::string sgd::id = "sgd";
 sgd::sgd(const std::string& prefix, std::shared_ptr<index::forward_index> idx,
          class_label positive, class_label negative,
          std::unique_ptr<loss::loss_function> loss, double alpha, double gamma,
-         double bias, double lambda, size_t max_iter)
+         double bias, double lambda, size_t max_iter, size_t threads)
     : binary_classifier{std::move(idx), positive, negative},
       weights_{prefix + "_" + std::to_string(idx_->id(positive)) + ".model",
                idx_->unique_terms()},
@@ -30,6 +33,7 @@ sgd::sgd(const std::string& prefix, std::shared_ptr<index::forward_index> idx,
       bias_weight_{bias},
       lambda_{lambda},
       max_iter_{max_iter},
+      num_threads_{std::max<size_t>(threads, 1)},
       loss_{std::move(loss)}
 {
     reset();
@@ -50,6 +54,21 @@ double sgd::predict(const counts_t& doc) const
 }
 
 void sgd::train(const std::vector<doc_id>& docs)
+{
+    // when already running on a pool's thread, more threads would only
+    // oversubscribe the machine
+    if (num_threads_ > 1 && !parallel::thread_pool::in_worker())
+        train_hogwild(docs);
+    else
+        train_serial(docs);
+}
+
+size_t sgd::num_training_threads() const
+{
+    return num_threads_;
+}
+
+void sgd::train_serial(const std::vector<doc_id>& docs)
 {
     std::vector<size_t> indices(docs.size());
     std::vector<int> labels(docs.size());
@@ -115,6 +134,121 @@ void sgd::train(const std::vector<doc_id>& docs)
     }
 }
 
+void sgd::train_hogwild(const std::vector<doc_id>& docs)
+{
+    // fold any scale left over from serial training into the weights,
+    // since the threads below regularize each weight directly
+    if (coeff_ != 1)
+    {
+        bias_ *= coeff_;
+        for (auto& w : weights_)
+            w *= coeff_;
+        coeff_ = 1;
+    }
+
+    std::vector<size_t> indices(docs.size());
+    std::vector<int> labels(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i)
+    {
+        indices[i] = i;
+        labels[i] = idx_->label(docs[i]) == positive_label() ? 1 : -1;
+    }
+
+    // the L2 penalty shrinks every weight by decay each step; a weight is
+    // only shrunk when it is next touched, by decay^(steps since then).
+    // last_step[j] is the step weight j has been shrunk through, with the
+    // final slot used for the bias.
+    auto decay = 1 - alpha_ * lambda_;
+    std::vector<std::atomic<uint64_t>> last_step(weights_.size() + 1);
+    for (auto& last : last_step)
+        last.store(0, std::memory_order_relaxed);
+    auto bias_id = weights_.size();
+    std::atomic<uint64_t> step{0};
+
+    // brings a weight up to date through the given step; if another
+    // thread has already done so this is a no-op
+    auto catch_up = [&](uint64_t id, double& weight, uint64_t through)
+    {
+        auto last = last_step[id].load(std::memory_order_relaxed);
+        while (last < through)
+        {
+            if (last_step[id].compare_exchange_weak(last, through))
+            {
+                weight *= std::pow(decay, static_cast<double>(through - last));
+                return;
+            }
+        }
+    };
+
+    std::random_device d;
+    std::mt19937 g{d()};
+    parallel::thread_pool pool{num_threads_};
+    double prev_loss = std::numeric_limits<double>::max();
+    for (size_t iter = 0; iter < max_iter_; ++iter)
+    {
+        std::shuffle(indices.begin(), indices.end(), g);
+
+        std::vector<std::future<double>> futures;
+        auto chunk = (indices.size() + num_threads_ - 1) / num_threads_;
+        for (size_t begin = 0; begin < indices.size(); begin += chunk)
+        {
+            auto end = std::min(begin + chunk, indices.size());
+            futures.emplace_back(pool.submit_task([&, begin, end]()
+                                                  {
+                double sum_loss = 0;
+                for (auto i = begin; i < end; ++i)
+                {
+                    auto t = ++step;
+                    auto pdata = idx_->search_primary(docs[indices[i]]);
+                    const counts_t& doc = pdata->counts();
+
+                    // predict with the weights as of the previous step
+                    catch_up(bias_id, bias_, t - 1);
+                    double prediction = bias_ * bias_weight_;
+                    for (const auto& count : doc)
+                    {
+                        auto& w = weights_[count.first];
+                        catch_up(count.first, w, t - 1);
+                        prediction += count.second * w;
+                    }
+                    int actual = labels[indices[i]];
+                    sum_loss += loss_->loss(prediction, actual);
+
+                    // then shrink for this step and apply the gradient
+                    double update
+                        = -alpha_ * loss_->derivative(prediction, actual);
+                    for (const auto& count : doc)
+                    {
+                        auto& w = weights_[count.first];
+                        catch_up(count.first, w, t);
+                        w += update * count.second;
+                    }
+                    catch_up(bias_id, bias_, t);
+                    bias_ += update * bias_weight_;
+                }
+                return sum_loss;
+            }));
+        }
+
+        double sum_loss = 0;
+        for (auto& fut : futures)
+            sum_loss += fut.get();
+
+        // the serial trainer checks every tenth of the data; here the
+        // check happens between epochs, when no updates are in flight
+        sum_loss /= docs.size();
+        if (std::abs(prev_loss - sum_loss) < gamma_)
+            break;
+        prev_loss = sum_loss;
+    }
+
+    // apply the regularization still owed to weights not touched lately
+    auto last = step.load();
+    for (uint64_t id = 0; id < weights_.size(); ++id)
+        catch_up(id, weights_[id], last);
+    catch_up(bias_id, bias_, last);
+}
+
 void sgd::reset()
 {
     for (auto& w : weights_)
@@ -159,9 +293,14 @@ std::unique_ptr<binary_classifier>
     if (auto c_max_iter = config.get_as<int64_t>("max-iter"))
         max_iter = *c_max_iter;
 
-    return make_unique<sgd>(
-        *prefix, std::move(idx), std::move(positive), std::move(negative),
-        loss::make_loss_function(*loss), alpha, gamma, bias, lambda, max_iter);
+    auto threads = sgd::default_threads;
+    if (auto c_threads = config.get_as<int64_t>("threads"))
+        threads = *c_threads;
+
+    return make_unique<sgd>(*prefix, std::move(idx), std::move(positive),
+                            std::move(negative),
+                            loss::make_loss_function(*loss), alpha, gamma,
+                            bias, lambda, max_iter, threads);
 }
 }
 }
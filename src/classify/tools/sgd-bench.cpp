@@ -0,0 +1,112 @@
+/**
+ * @file sgd-bench.cpp
+ * @author agent
+ *
+ * Measures how binary sgd training scales with the number of Hogwild
+ * threads, reporting the training time and held-out accuracy for each.
+ */
+
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "classify/classifier/sgd.h"
+#include "classify/loss/hinge.h"
+#include "index/forward_index.h"
+#include "logging/logger.h"
+#include "util/time.h"
+
+using namespace meta;
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage:\t" << argv[0] << " config.toml [max-threads]\n"
+                     "\tTrains binary sgd (hinge loss), with the most common "
+                     "label as the positive\n\tclass, on 80% of the "
+                     "configured forward index with 1, 2, 4, ...\n\t"
+                     "max-threads threads and tests on the rest. "
+                     "max-threads defaults to the\n\thardware concurrency."
+                  << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging(logging::logger::severity_level::warning);
+
+    size_t max_threads = argc > 2 ? std::stoul(argv[2])
+                                  : std::thread::hardware_concurrency();
+    max_threads = std::max<size_t>(max_threads, 1);
+
+    auto f_idx = index::make_index<index::memory_forward_index>(argv[1]);
+
+    // every run uses the same split so accuracies are comparable
+    auto docs = f_idx->docs();
+    std::mt19937 g{47};
+    std::shuffle(docs.begin(), docs.end(), g);
+    auto mid = docs.begin() + static_cast<std::ptrdiff_t>(docs.size() * 4 / 5);
+    std::vector<doc_id> train_docs{docs.begin(), mid};
+    std::vector<doc_id> test_docs{mid, docs.end()};
+
+    // load the documents into the cache so that only training is timed
+    for (const auto& d_id : docs)
+        f_idx->search_primary(d_id);
+
+    // one binary problem, so that every thread trains the same model
+    std::unordered_map<class_label, uint64_t> label_counts;
+    for (const auto& d_id : train_docs)
+        ++label_counts[f_idx->label(d_id)];
+    class_label positive;
+    uint64_t positive_count = 0;
+    for (const auto& count : label_counts)
+    {
+        if (count.second > positive_count)
+        {
+            positive = count.first;
+            positive_count = count.second;
+        }
+    }
+    class_label negative{"negative"};
+
+    std::cout << "Training documents: " << train_docs.size()
+              << ", test documents: " << test_docs.size()
+              << ", positive label: " << positive << std::endl;
+    std::cout << "threads\ttrain ms\tspeedup\taccuracy" << std::endl;
+
+    double serial_ms = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        classify::sgd model{"sgd-bench-model", f_idx, positive, negative,
+                            make_unique<classify::loss::hinge>(),
+                            classify::sgd::default_alpha,
+                            classify::sgd::default_gamma,
+                            classify::sgd::default_bias,
+                            classify::sgd::default_lambda,
+                            classify::sgd::default_max_iter, threads};
+
+        auto time = common::time([&]()
+                                 {
+            model.train(train_docs);
+        });
+        auto ms = std::max<double>(time.count(), 1);
+        if (threads == 1)
+            serial_ms = ms;
+
+        uint64_t correct = 0;
+        for (const auto& d_id : test_docs)
+        {
+            auto actual = f_idx->label(d_id) == positive ? positive : negative;
+            if (model.classify(d_id) == actual)
+                ++correct;
+        }
+        auto accuracy = static_cast<double>(correct)
+                        / std::max<size_t>(test_docs.size(), 1);
+        std::cout << threads << "\t" << time.count() << "\t"
+                  << serial_ms / ms << "\t" << accuracy << std::endl;
+    }
+
+    return 0;
+}
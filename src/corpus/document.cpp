@@ -14,7 +14,13 @@ namespace corpus
 
 document::document(const std::string& path, doc_id d_id,
                    const class_label& label)
-    : path_{path}, d_id_{d_id}, label_{label}, length_{0}, encoding_{"utf-8"}
+    : path_{path},
+      d_id_{d_id},
+      label_{label},
+      length_{0},
+      record_positions_{false},
+      num_increments_{0},
+      encoding_{"utf-8"}
 {
     size_t idx = path.find_last_of("/") + 1;
     name_ = path.substr(idx);
@@ -24,6 +30,20 @@ void document::increment(const std::string& term, double amount)
 {
     counts_[term] += amount;
     length_ += amount;
+    if (record_positions_)
+        positions_[term].push_back(num_increments_);
+    ++num_increments_;
+}
+
+void document::record_positions(bool record)
+{
+    record_positions_ = record;
+}
+
+auto document::positions() const
+    -> const std::unordered_map<std::string, std::vector<uint64_t>> &
+{
+    return positions_;
 }
 
 std::string document::path() const
@@ -91,6 +111,11 @@ doc_id document::id() const
     return d_id_;
 }
 
+void document::id(doc_id d_id)
+{
+    d_id_ = d_id;
+}
+
 bool document::contains_content() const
 {
     return static_cast<bool>(content_);
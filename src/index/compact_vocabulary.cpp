@@ -0,0 +1,238 @@
+/**
+ * @file compact_vocabulary.cpp
+ * @author agent
+ */
+
+#include <cstring>
+
+#include "index/compact_vocabulary.h"
+#include "util/optional.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/// The number of words in the header of the file
+const static constexpr uint64_t header_words = 6;
+
+/// The number of words of bits counted by each entry in the rank table
+const static constexpr uint64_t rank_sample_words = 8;
+
+/**
+ * Reads an integer written by compact_vocabulary_writer::write_varint.
+ * @param pos The position of the integer, moved past it
+ * @return the integer
+ */
+uint64_t read_varint(const unsigned char*& pos)
+{
+    uint64_t value = 0;
+    uint64_t shift = 0;
+    while (*pos & 0x80)
+    {
+        value |= static_cast<uint64_t>(*pos++ & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint64_t>(*pos++) << shift;
+    return value;
+}
+}
+
+compact_vocabulary::compact_vocabulary(const std::string& path) : file_{path}
+{
+    if (file_.size() < header_words * sizeof(uint64_t))
+        throw compact_vocabulary_exception{"invalid compact vocabulary: "
+                                           + path};
+
+    auto words = reinterpret_cast<const uint64_t*>(file_.begin());
+    num_terms_ = words[0];
+    num_levels_ = words[1];
+    auto num_bits = words[2];
+    num_slots_ = words[3];
+    num_collisions_ = words[4];
+    auto num_string_bytes = words[5];
+
+    id_bits_ = 1;
+    while (id_bits_ < 64 && (uint64_t{1} << id_bits_) < num_terms_)
+        ++id_bits_;
+
+    auto num_words = num_bits / 64;
+    auto num_buckets = (num_terms_ + bucket_size - 1) / bucket_size;
+
+    level_bits_ = words + header_words;
+    bits_ = level_bits_ + num_levels_;
+    ranks_ = bits_ + num_words;
+    slots_ = ranks_ + num_words / rank_sample_words + 1;
+    collisions_ = slots_ + (num_slots_ * id_bits_ + 63) / 64;
+    bucket_offsets_ = collisions_ + 2 * num_collisions_;
+    strings_ = reinterpret_cast<const unsigned char*>(bucket_offsets_
+                                                      + num_buckets);
+
+    auto end = reinterpret_cast<const char*>(strings_) + num_string_bytes;
+    if (end > file_.begin() + file_.size())
+        throw compact_vocabulary_exception{"truncated compact vocabulary: "
+                                           + path};
+}
+
+util::optional<term_id> compact_vocabulary::find(const std::string& term) const
+{
+    auto h = hash(term);
+
+    uint64_t offset = 0;
+    for (uint64_t level = 0; level < num_levels_; ++level)
+    {
+        auto pos = offset + position(h, level, level_bits_[level]);
+        if ((bits_[pos / 64] >> (pos % 64)) & 1)
+        {
+            auto id = slot_id(rank(pos));
+            if (!matches(id, term))
+                return util::nullopt;
+            return term_id{id};
+        }
+        offset += level_bits_[level];
+    }
+
+    // the term is either missing or one whose hash collided with another
+    uint64_t first = 0;
+    uint64_t last = num_collisions_;
+    while (first < last)
+    {
+        auto mid = first + (last - first) / 2;
+        if (collisions_[2 * mid] < h)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    for (; first < num_collisions_ && collisions_[2 * first] == h; ++first)
+    {
+        if (matches(collisions_[2 * first + 1], term))
+            return term_id{collisions_[2 * first + 1]};
+    }
+    return util::nullopt;
+}
+
+std::string compact_vocabulary::find_term(term_id t_id) const
+{
+    auto pos = strings_ + bucket_offsets_[t_id / bucket_size];
+
+    auto length = read_varint(pos);
+    std::string term{reinterpret_cast<const char*>(pos), length};
+    pos += length;
+    for (uint64_t i = 0; i < t_id % bucket_size; ++i)
+    {
+        auto shared = read_varint(pos);
+        auto suffix = read_varint(pos);
+        term.resize(shared);
+        term.append(reinterpret_cast<const char*>(pos), suffix);
+        pos += suffix;
+    }
+    return term;
+}
+
+uint64_t compact_vocabulary::size() const
+{
+    return num_terms_;
+}
+
+uint64_t compact_vocabulary::hash(const std::string& term)
+{
+    // MurmurHash64A, by Austin Appleby (public domain)
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    auto len = term.length();
+    uint64_t h = 0x8445d61a4e774912ULL ^ (len * m);
+
+    auto data = term.data();
+    auto end = data + (len / 8) * 8;
+    for (; data != end; data += 8)
+    {
+        uint64_t k;
+        std::memcpy(&k, data, sizeof(uint64_t));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    auto tail = reinterpret_cast<const unsigned char*>(data);
+    switch (len & 7)
+    {
+        case 7:
+            h ^= uint64_t(tail[6]) << 48;
+        // fall through
+        case 6:
+            h ^= uint64_t(tail[5]) << 40;
+        // fall through
+        case 5:
+            h ^= uint64_t(tail[4]) << 32;
+        // fall through
+        case 4:
+            h ^= uint64_t(tail[3]) << 24;
+        // fall through
+        case 3:
+            h ^= uint64_t(tail[2]) << 16;
+        // fall through
+        case 2:
+            h ^= uint64_t(tail[1]) << 8;
+        // fall through
+        case 1:
+            h ^= uint64_t(tail[0]);
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+uint64_t compact_vocabulary::position(uint64_t hash, uint64_t level,
+                                      uint64_t num_bits)
+{
+    // each level rehashes with the splitmix64 finalizer
+    uint64_t z = hash + (level + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return z % num_bits;
+}
+
+uint64_t compact_vocabulary::rank(uint64_t pos) const
+{
+    auto word = pos / 64;
+    auto sample = word / rank_sample_words;
+    auto count = ranks_[sample];
+    for (auto w = sample * rank_sample_words; w < word; ++w)
+        count += __builtin_popcountll(bits_[w]);
+    if (pos % 64 != 0)
+        count += __builtin_popcountll(bits_[word]
+                                      & ((uint64_t{1} << (pos % 64)) - 1));
+    return count;
+}
+
+uint64_t compact_vocabulary::slot_id(uint64_t slot) const
+{
+    auto bit = slot * id_bits_;
+    auto word = bit / 64;
+    auto offset = bit % 64;
+
+    uint64_t id = slots_[word] >> offset;
+    if (offset + id_bits_ > 64)
+        id |= slots_[word + 1] << (64 - offset);
+    if (id_bits_ < 64)
+        id &= (uint64_t{1} << id_bits_) - 1;
+    return id;
+}
+
+bool compact_vocabulary::matches(uint64_t id, const std::string& term) const
+{
+    return id < num_terms_ && find_term(term_id{id}) == term;
+}
+}
+}
@@ -0,0 +1,209 @@
+/**
+ * @file compact_vocabulary_writer.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "index/compact_vocabulary.h"
+#include "index/compact_vocabulary_writer.h"
+#include "io/binary.h"
+#include "util/filesystem.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/**
+ * Writes a vector of words to a file.
+ * @param out The file to write to
+ * @param words The words to write
+ */
+void write_words(std::ofstream& out, const std::vector<uint64_t>& words)
+{
+    out.write(reinterpret_cast<const char*>(words.data()),
+              static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));
+}
+}
+
+compact_vocabulary_writer::compact_vocabulary_writer(const std::string& path)
+    : path_{path},
+      strings_{path + ".tmp", std::ios::binary | std::ios::trunc},
+      num_string_bytes_{0}
+{
+    if (!strings_)
+        throw compact_vocabulary_writer_exception{
+            "failed to open compact vocabulary file"};
+}
+
+void compact_vocabulary_writer::insert(const std::string& term)
+{
+    if (hashes_.size() % compact_vocabulary::bucket_size == 0)
+    {
+        // the first term of a bucket is stored whole
+        bucket_offsets_.push_back(num_string_bytes_);
+        write_varint(term.length());
+        strings_.write(term.data(), term.length());
+        num_string_bytes_ += term.length();
+    }
+    else
+    {
+        uint64_t shared = 0;
+        auto max_shared = std::min(term.length(), last_term_.length());
+        while (shared < max_shared && term[shared] == last_term_[shared])
+            ++shared;
+
+        auto suffix = term.length() - shared;
+        write_varint(shared);
+        write_varint(suffix);
+        strings_.write(term.data() + shared, suffix);
+        num_string_bytes_ += suffix;
+    }
+
+    hashes_.push_back(compact_vocabulary::hash(term));
+    last_term_ = term;
+}
+
+void compact_vocabulary_writer::write_varint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        strings_.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+        ++num_string_bytes_;
+    }
+    strings_.put(static_cast<char>(value));
+    ++num_string_bytes_;
+}
+
+compact_vocabulary_writer::~compact_vocabulary_writer()
+{
+    write_vocabulary();
+}
+
+void compact_vocabulary_writer::write_vocabulary()
+{
+    strings_.close();
+    uint64_t num_terms = hashes_.size();
+
+    // build the levels of the perfect hash function: the terms whose
+    // positions are not shared with any other term keep their bit set in a
+    // level, and the rest move on to the next one
+    std::vector<uint64_t> level_bits;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> keys(num_terms);
+    for (uint64_t id = 0; id < num_terms; ++id)
+        keys[id] = id;
+
+    while (!keys.empty() && level_bits.size() < compact_vocabulary::max_levels)
+    {
+        auto level = level_bits.size();
+        auto num_bits = std::max<uint64_t>(64, (2 * keys.size() + 63) / 64 * 64);
+        std::vector<uint64_t> seen(num_bits / 64, 0);
+        std::vector<uint64_t> collide(num_bits / 64, 0);
+
+        for (const auto& id : keys)
+        {
+            auto pos = compact_vocabulary::position(hashes_[id], level, num_bits);
+            auto mask = uint64_t{1} << (pos % 64);
+            if (seen[pos / 64] & mask)
+                collide[pos / 64] |= mask;
+            seen[pos / 64] |= mask;
+        }
+
+        std::vector<uint64_t> next;
+        for (const auto& id : keys)
+        {
+            auto pos = compact_vocabulary::position(hashes_[id], level, num_bits);
+            if ((collide[pos / 64] >> (pos % 64)) & 1)
+                next.push_back(id);
+        }
+
+        for (uint64_t w = 0; w < seen.size(); ++w)
+            bits.push_back(seen[w] & ~collide[w]);
+        level_bits.push_back(num_bits);
+        keys = std::move(next);
+    }
+
+    // the number of bits set before each word, and a sample of every
+    // eighth of them for the rank table
+    std::vector<uint64_t> word_ranks(bits.size() + 1, 0);
+    for (uint64_t w = 0; w < bits.size(); ++w)
+        word_ranks[w + 1] = word_ranks[w] + __builtin_popcountll(bits[w]);
+
+    std::vector<uint64_t> ranks;
+    for (uint64_t w = 0; w <= bits.size(); w += 8)
+        ranks.push_back(word_ranks[w]);
+
+    uint64_t num_slots = word_ranks.back();
+    uint64_t id_bits = 1;
+    while (id_bits < 64 && (uint64_t{1} << id_bits) < num_terms)
+        ++id_bits;
+
+    // place every term in the slot its level's bit ranks to
+    std::vector<uint64_t> slots((num_slots * id_bits + 63) / 64, 0);
+    std::vector<std::pair<uint64_t, uint64_t>> collisions;
+    for (uint64_t id = 0; id < num_terms; ++id)
+    {
+        uint64_t offset = 0;
+        bool placed = false;
+        for (uint64_t level = 0; level < level_bits.size() && !placed; ++level)
+        {
+            auto pos = offset + compact_vocabulary::position(
+                                    hashes_[id], level, level_bits[level]);
+            if ((bits[pos / 64] >> (pos % 64)) & 1)
+            {
+                auto slot = word_ranks[pos / 64];
+                if (pos % 64 != 0)
+                    slot += __builtin_popcountll(
+                        bits[pos / 64] & ((uint64_t{1} << (pos % 64)) - 1));
+
+                auto bit = slot * id_bits;
+                slots[bit / 64] |= id << (bit % 64);
+                if (bit % 64 + id_bits > 64)
+                    slots[bit / 64 + 1] |= id >> (64 - bit % 64);
+                placed = true;
+            }
+            offset += level_bits[level];
+        }
+
+        if (!placed)
+            collisions.emplace_back(hashes_[id], id);
+    }
+    std::sort(collisions.begin(), collisions.end());
+
+    std::ofstream out{path_, std::ios::binary | std::ios::trunc};
+    uint64_t num_bits = bits.size() * 64;
+    uint64_t num_collisions = collisions.size();
+    io::write_binary(out, num_terms);
+    io::write_binary(out, static_cast<uint64_t>(level_bits.size()));
+    io::write_binary(out, num_bits);
+    io::write_binary(out, num_slots);
+    io::write_binary(out, num_collisions);
+    io::write_binary(out, num_string_bytes_);
+    write_words(out, level_bits);
+    write_words(out, bits);
+    write_words(out, ranks);
+    write_words(out, slots);
+    for (const auto& collision : collisions)
+    {
+        io::write_binary(out, collision.first);
+        io::write_binary(out, collision.second);
+    }
+    write_words(out, bucket_offsets_);
+
+    {
+        std::ifstream strings{path_ + ".tmp", std::ios::binary};
+        if (num_string_bytes_ > 0)
+            out << strings.rdbuf();
+    }
+    std::string padding((8 - num_string_bytes_ % 8) % 8, '\0');
+    out.write(padding.data(), padding.length());
+    filesystem::delete_file(path_ + ".tmp");
+}
+}
+}
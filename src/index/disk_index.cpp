@@ -3,6 +3,8 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+#include <atomic>
 #include <numeric>
 
 #include "index/disk_index.h"
@@ -12,6 +14,7 @@
 #include "index/vocabulary_map.h"
 #include "analyzers/analyzer.h"
 #include "util/disk_vector.h"
+#include "util/filesystem.h"
 #include "util/mapping.h"
 #include "util/optional.h"
 #include "util/pimpl.tcc"
@@ -21,9 +24,22 @@ namespace meta
 namespace index
 {
 
+namespace
+{
+/**
+ * @return a generation no index of this process has had before
+ */
+uint64_t next_generation()
+{
+    static std::atomic<uint64_t> generation{0};
+    return ++generation;
+}
+}
+
 disk_index::disk_index(const cpptoml::table&, const std::string& name)
 {
     impl_->index_name_ = name;
+    impl_->generation_ = next_generation();
 }
 
 std::string disk_index::index_name() const
@@ -33,14 +49,11 @@ std::string disk_index::index_name() const
 
 term_id disk_index::get_term_id(const std::string& term)
 {
-    std::lock_guard<std::mutex> lock{impl_->mutex_};
-
-    auto termID = impl_->term_id_mapping_->find(term);
+    auto termID = impl_->find_term_id(term);
     if (termID)
-        return term_id{*termID};
+        return *termID;
 
-    uint64_t size = impl_->term_id_mapping_->size();
-    return term_id{size};
+    return term_id{impl_->total_unique_terms()};
 }
 
 class_label disk_index::label(doc_id d_id) const
@@ -80,7 +93,7 @@ uint64_t disk_index::unique_terms(doc_id d_id) const
 
 uint64_t disk_index::unique_terms() const
 {
-    return impl_->term_id_mapping_->size();
+    return impl_->total_unique_terms();
 }
 
 uint64_t disk_index::doc_size(doc_id d_id) const
@@ -108,9 +121,63 @@ std::vector<doc_id> disk_index::docs() const
 {
     std::vector<doc_id> ret(impl_->doc_id_mapping_->size());
     std::iota(ret.begin(), ret.end(), 0);
+    if (num_deleted() > 0)
+    {
+        ret.erase(std::remove_if(ret.begin(), ret.end(), [&](doc_id d_id)
+                                 {
+                                     return is_deleted(d_id);
+                                 }),
+                  ret.end());
+    }
     return ret;
 }
 
+void disk_index::delete_doc(doc_id d_id)
+{
+    if (d_id >= num_docs())
+        throw std::out_of_range{"doc_id " + std::to_string(d_id)
+                                + " is not in the index"};
+
+    std::lock_guard<std::mutex> lock{impl_->mutex_};
+    if (impl_->is_deleted(d_id))
+        return;
+
+    (*impl_->deleted_)[d_id / 64] |= uint64_t{1} << (d_id % 64);
+    ++impl_->num_deleted_;
+    impl_->deleted_terms_ += doc_size(d_id);
+    impl_->generation_ = next_generation();
+}
+
+bool disk_index::is_deleted(doc_id d_id) const
+{
+    return impl_->is_deleted(d_id);
+}
+
+uint64_t disk_index::num_deleted() const
+{
+    return impl_->num_deleted_;
+}
+
+uint64_t disk_index::generation() const
+{
+    return impl_->generation_;
+}
+
+bool disk_index::caches_postings() const
+{
+    return false;
+}
+
+uint64_t disk_index::warm(uint64_t budget) const
+{
+    uint64_t bytes = 0;
+    bytes += impl_->deleted_->warm(budget - bytes);
+    bytes += impl_->doc_sizes_->warm(budget - bytes);
+    bytes += impl_->unique_terms_->warm(budget - bytes);
+    bytes += impl_->labels_->warm(budget - bytes);
+    return bytes;
+}
+
 // disk_index_impl
 
 const std::vector<const char*> disk_index::disk_index_impl::files
@@ -118,6 +185,9 @@ const std::vector<const char*> disk_index::disk_index_impl::files
        "/docs.labels",    "/docs.uniqueterms",     "/labelids.mapping",
        "/postings.index", "/termids.mapping",      "/termids.mapping.inverse"};
 
+const char* const disk_index::disk_index_impl::compact_term_ids_file
+    = "/termids.mapping.compact";
+
 label_id disk_index::disk_index_impl::get_label_id(const class_label& lbl)
 {
     std::lock_guard<std::mutex> lock{mutex_};
@@ -137,6 +207,7 @@ void disk_index::disk_index_impl::initialize_metadata(uint64_t num_docs)
     load_doc_sizes(num_docs);
     load_labels(num_docs);
     load_unique_terms(num_docs);
+    load_deleted(num_docs);
 }
 
 void disk_index::disk_index_impl::load_doc_sizes(uint64_t num_docs)
@@ -157,6 +228,33 @@ void disk_index::disk_index_impl::load_unique_terms(uint64_t num_docs)
         index_name_ + files[DOC_UNIQUETERMS], num_docs};
 }
 
+void disk_index::disk_index_impl::load_deleted(uint64_t num_docs)
+{
+    auto filename = index_name_ + "/deleted.bitmap";
+    if (num_docs == 0 && filesystem::file_exists(filename))
+        deleted_ = util::disk_vector<uint64_t>{filename};
+    else
+    {
+        // a new bitmap must not pick up the bits of an old one
+        filesystem::delete_file(filename);
+        auto num_words = std::max<uint64_t>((doc_sizes_->size() + 63) / 64, 1);
+        deleted_ = util::disk_vector<uint64_t>{filename, num_words};
+        for (uint64_t i = 0; i < num_words; ++i)
+            (*deleted_)[i] = 0;
+    }
+
+    num_deleted_ = 0;
+    deleted_terms_ = 0;
+    for (uint64_t id = 0; id < doc_sizes_->size(); ++id)
+    {
+        if (is_deleted(doc_id{id}))
+        {
+            ++num_deleted_;
+            deleted_terms_ += (*doc_sizes_)[id];
+        }
+    }
+}
+
 void disk_index::disk_index_impl::load_doc_id_mapping()
 {
     doc_id_mapping_ = string_list{index_name_ + files[DOC_IDS_MAPPING]};
@@ -164,7 +262,18 @@ void disk_index::disk_index_impl::load_doc_id_mapping()
 
 void disk_index::disk_index_impl::load_term_id_mapping()
 {
-    term_id_mapping_ = vocabulary_map{index_name_ + files[TERM_IDS_MAPPING]};
+    auto compact = index_name_ + compact_term_ids_file;
+    if (filesystem::file_exists(compact))
+    {
+        compact_term_id_mapping_ = compact_vocabulary{compact};
+        term_id_mapping_ = util::nullopt;
+    }
+    else
+    {
+        term_id_mapping_
+            = vocabulary_map{index_name_ + files[TERM_IDS_MAPPING]};
+        compact_term_id_mapping_ = util::nullopt;
+    }
 }
 
 void disk_index::disk_index_impl::load_label_id_mapping()
@@ -210,9 +319,39 @@ const io::mmap_file& disk_index::disk_index_impl::postings() const
 
 uint64_t disk_index::disk_index_impl::total_unique_terms() const
 {
+    if (compact_term_id_mapping_)
+        return compact_term_id_mapping_->size();
     return term_id_mapping_->size();
 }
 
+util::optional<term_id>
+    disk_index::disk_index_impl::find_term_id(const std::string& term) const
+{
+    // the compact vocabulary is read-only and needs no locking
+    if (compact_term_id_mapping_)
+        return compact_term_id_mapping_->find(term);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    return term_id_mapping_->find(term);
+}
+
+std::string disk_index::disk_index_impl::find_term(term_id t_id) const
+{
+    if (compact_term_id_mapping_)
+        return compact_term_id_mapping_->find_term(t_id);
+    return term_id_mapping_->find_term(t_id);
+}
+
+bool disk_index::disk_index_impl::is_deleted(doc_id id) const
+{
+    return ((*deleted_)[id / 64] >> (id % 64)) & 1;
+}
+
+uint64_t disk_index::disk_index_impl::deleted_terms() const
+{
+    return deleted_terms_;
+}
+
 label_id disk_index::disk_index_impl::doc_label_id(doc_id id) const
 {
     return labels_->at(id);
@@ -229,9 +368,9 @@ std::vector<class_label> disk_index::disk_index_impl::class_labels() const
 
 std::string disk_index::term_text(term_id t_id) const
 {
-    if (t_id >= impl_->term_id_mapping_->size())
+    if (t_id >= impl_->total_unique_terms())
         return "";
-    return impl_->term_id_mapping_->find_term(t_id);
+    return impl_->find_term(t_id);
 }
 }
 }
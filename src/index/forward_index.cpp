@@ -3,6 +3,9 @@
  * @author Sean Massung
  */
 
+#include <cstring>
+#include <sstream>
+
 #include "cpptoml.h"
 #include "index/chunk_handler.h"
 #include "index/disk_index_impl.h"
@@ -49,8 +52,10 @@ class forward_index::impl
 
     /**
      * Initializes this index's metadata structures.
+     * @param num_docs The number of documents in the index, or zero if
+     * the metadata files already exist
      */
-    void init_metadata();
+    void init_metadata(uint64_t num_docs = 0);
 
     /**
      * @param config the configuration settings for this index
@@ -80,15 +85,38 @@ class forward_index::impl
     bool is_libsvm_format(const cpptoml::table& config) const;
 
     /**
-     * Calculates which documents start at which bytes in the postings file.
+     * Calculates which documents start at which bytes in a libsvm
+     * formatted postings file.
      */
     void set_doc_byte_locations();
 
     /**
-     * Converts postings.index into a libsvm formatted file
-     * @param num_docs The total number of documents
+     * @return whether postings.index is in the binary format (as opposed
+     * to the libsvm text format used by older indexes)
+     */
+    bool has_binary_postings() const;
+
+    /**
+     * Converts a libsvm formatted postings.index into the binary format,
+     * updating the document byte locations.
+     */
+    void libsvm_postings_to_binary();
+
+    /**
+     * Writes a document's postings in the binary format.
+     * @param out The stream to write to
+     * @param counts The (term_id, count) pairs for the document
+     * @return the number of bytes written
      */
-    void compressed_postings_to_libsvm(uint64_t num_docs);
+    static uint64_t write_binary(std::ofstream& out,
+                                 const postings_data_type::count_t& counts);
+
+    /**
+     * Marks the beginning of a binary postings file. Each document's
+     * postings follow as its number of pairs and then its (term_id,
+     * count) pairs, all stored as eight-byte values.
+     */
+    const static uint64_t binary_magic = 0x316477666174656dULL;
 
     /// the total number of unique terms if term_id_mapping_ is unused
     uint64_t total_unique_terms_;
@@ -101,6 +129,8 @@ class forward_index::impl
     forward_index* idx_;
 };
 
+const uint64_t forward_index::impl::binary_magic;
+
 forward_index::forward_index(const cpptoml::table& config)
     : disk_index{config, *config.get_as<std::string>("forward-index")},
       fwd_impl_{this}
@@ -141,19 +171,13 @@ bool forward_index::valid() const
 
 std::string forward_index::liblinear_data(doc_id d_id) const
 {
-    if (d_id >= num_docs())
-        throw forward_index_exception{"invalid doc_id in search_primary"};
+    auto pdata = search_primary(d_id);
 
-    uint64_t begin = (*fwd_impl_->doc_byte_locations_)[d_id];
-    uint64_t length = 0;
-    while (impl_->postings()[begin + length] != '\n')
-    {
-        ++length;
-        if (begin + length >= impl_->postings().size())
-            throw forward_index_exception{"out of bounds!"};
-    }
-
-    return std::string{impl_->postings().begin() + begin, length};
+    std::ostringstream out;
+    out << static_cast<uint32_t>(impl_->doc_label_id(d_id));
+    for (auto& c : pdata->counts())
+        out << ' ' << (c.first + 1) << ':' << c.second;
+    return out.str();
 }
 
 void forward_index::load_index()
@@ -165,6 +189,12 @@ void forward_index::load_index()
     impl_->load_doc_id_mapping();
     impl_->load_postings();
 
+    if (!fwd_impl_->has_binary_postings())
+    {
+        LOG(info) << "Converting libsvm postings to binary format" << ENDLG;
+        fwd_impl_->libsvm_postings_to_binary();
+    }
+
     auto config = cpptoml::parse_file(index_name() + "/config.toml");
     if (!fwd_impl_->is_libsvm_format(config))
         impl_->load_term_id_mapping();
@@ -190,6 +220,7 @@ void forward_index::create_index(const std::string& config_file)
         fwd_impl_->create_libsvm_postings(config);
         fwd_impl_->create_libsvm_metadata();
         impl_->save_label_id_mapping();
+        fwd_impl_->libsvm_postings_to_binary();
     }
     else
     {
@@ -202,10 +233,9 @@ void forward_index::create_index(const std::string& config_file)
 
         fwd_impl_->create_uninverted_metadata(inv_idx->index_name());
         impl_->load_label_id_mapping();
+        fwd_impl_->init_metadata(inv_idx->num_docs());
         fwd_impl_->uninvert(*inv_idx);
-        fwd_impl_->init_metadata();
         impl_->load_postings();
-        fwd_impl_->set_doc_byte_locations();
         impl_->load_term_id_mapping();
         fwd_impl_->total_unique_terms_ = impl_->total_unique_terms();
     }
@@ -233,10 +263,10 @@ void forward_index::impl::create_libsvm_postings(const cpptoml::table& config)
     std::string existing_file = *prefix + "/" + *dataset + "/" + *dataset
                                 + ".dat";
 
-    filesystem::copy_file(existing_file,
-                          idx_->index_name() + idx_->impl_->files[POSTINGS]);
+    auto filename = idx_->index_name() + idx_->impl_->files[POSTINGS];
+    filesystem::copy_file(existing_file, filename);
 
-    init_metadata();
+    init_metadata(filesystem::num_lines(filename));
 
     // now, assign byte locations for libsvm doc starting points
     idx_->impl_->load_postings();
@@ -261,10 +291,8 @@ void forward_index::impl::set_doc_byte_locations()
     }
 }
 
-void forward_index::impl::init_metadata()
+void forward_index::impl::init_metadata(uint64_t num_docs)
 {
-    uint64_t num_docs = filesystem::num_lines(idx_->index_name()
-                                              + idx_->impl_->files[POSTINGS]);
     idx_->impl_->initialize_metadata(num_docs);
     doc_byte_locations_ = util::disk_vector<uint64_t>(
         idx_->index_name() + "/lexicon.index", num_docs);
@@ -321,6 +349,10 @@ void forward_index::impl::create_uninverted_metadata(const std::string& name)
     for (const auto& file : files)
         filesystem::copy_file(name + idx_->impl_->files[file],
                               idx_->index_name() + idx_->impl_->files[file]);
+
+    std::string compact = idx_->impl_->compact_term_ids_file;
+    if (filesystem::file_exists(name + compact))
+        filesystem::copy_file(name + compact, idx_->index_name() + compact);
 }
 
 bool forward_index::impl::is_libsvm_format(const cpptoml::table& config) const
@@ -344,80 +376,147 @@ uint64_t forward_index::unique_terms() const
 auto forward_index::search_primary(
     doc_id d_id) const -> std::shared_ptr<postings_data_type>
 {
+    if (d_id >= num_docs())
+        throw forward_index_exception{"invalid doc_id in search_primary"};
+
+    // deleted documents have no terms
+    if (is_deleted(d_id))
+        return std::make_shared<postings_data_type>(d_id);
+
+    const auto& postings = impl_->postings();
+    uint64_t begin = (*fwd_impl_->doc_byte_locations_)[d_id];
+    if (begin + sizeof(uint64_t) > postings.size())
+        throw forward_index_exception{"out of bounds!"};
+
+    uint64_t num_pairs;
+    std::memcpy(&num_pairs, postings.begin() + begin, sizeof(uint64_t));
+    begin += sizeof(uint64_t);
+    if (begin + num_pairs * 2 * sizeof(uint64_t) > postings.size())
+        throw forward_index_exception{"out of bounds!"};
+
+    postings_data_type::count_t counts;
+    counts.reserve(num_pairs);
+    const char* pair = postings.begin() + begin;
+    for (uint64_t i = 0; i < num_pairs; ++i)
+    {
+        uint64_t t_id;
+        double count;
+        std::memcpy(&t_id, pair, sizeof(uint64_t));
+        std::memcpy(&count, pair + sizeof(uint64_t), sizeof(double));
+        counts.emplace_back(term_id{t_id}, count);
+        pair += 2 * sizeof(uint64_t);
+    }
+
     auto pdata = std::make_shared<postings_data_type>(d_id);
-    auto line = liblinear_data(d_id);
-    pdata->set_counts(io::libsvm_parser::counts(line));
+    pdata->set_counts(counts);
     return pdata;
 }
 
 void forward_index::impl::uninvert(const inverted_index& inv_idx)
 {
-    io::compressed_file_reader inv_reader{inv_idx.index_name()
-                                          + idx_->impl_->files[POSTINGS],
-                                          io::default_compression_reader_func};
-
-    term_id t_id{0};
+    // go through search_primary so that we don't depend on which codec
+    // the inverted index's postings file was written with
     chunk_handler<forward_index> handler{idx_->index_name()};
     {
         auto producer = handler.make_producer();
-        while (inv_reader.has_next())
+        for (term_id t_id{0}; t_id < inv_idx.unique_terms(); ++t_id)
         {
-            inverted_pdata_type pdata{t_id};
-            pdata.read_compressed(inv_reader);
-            producer(pdata.primary_key(), pdata.counts());
-            ++t_id;
+            auto pdata = inv_idx.search_primary(t_id);
+            producer(pdata->primary_key(), pdata->counts());
         }
     }
 
-    handler.merge_chunks();
-    compressed_postings_to_libsvm(inv_idx.num_docs());
-}
-
-void forward_index::impl::compressed_postings_to_libsvm(uint64_t num_docs)
-{
-    idx_->impl_->load_labels();
 
+    // merge the chunks straight into the binary postings file
     auto filename = idx_->index_name() + idx_->impl_->files[POSTINGS];
-    filesystem::rename_file(filename, filename + ".tmp");
-    std::ofstream output{filename};
-    io::compressed_file_reader input{filename + ".tmp",
-                                     io::default_compression_reader_func};
+    std::ofstream output{filename, std::ios::binary};
+    output.write(reinterpret_cast<const char*>(&binary_magic),
+                 sizeof(uint64_t));
+    uint64_t byte_pos = sizeof(uint64_t);
 
     // handler for writing gaps of blank documents
-    doc_id last_id{0};
+    doc_id next_empty{0};
     auto write_gap = [&](doc_id next_id)
     {
-        while (next_id > last_id + 1)
+        for (; next_empty < next_id; ++next_empty)
         {
-            ++last_id;
-            index_pdata_type empty;
-            empty.set_primary_key(
-                static_cast<doc_id>(idx_->impl_->doc_label_id(last_id)));
-            empty.write_libsvm(output);
+            (*doc_byte_locations_)[next_empty] = byte_pos;
+            byte_pos += write_binary(output, {});
         }
     };
 
-    // read from input, write to output, changing doc_id to class_label for the
-    // correct libsvm format
-    index_pdata_type pdata;
-    while (input >> pdata)
+    handler.merge_chunks([&](index_pdata_type&& pdata)
     {
         doc_id d_id = pdata.primary_key();
 
-        // write empty document lines for any documents in a gap
+        // write empty documents for any documents in a gap
         write_gap(d_id);
 
         // write current document
-        pdata.set_primary_key(
-            static_cast<doc_id>(idx_->impl_->doc_label_id(d_id)));
-        pdata.write_libsvm(output);
-        last_id = d_id;
-    }
+        (*doc_byte_locations_)[d_id] = byte_pos;
+        byte_pos += write_binary(output, pdata.counts());
+        next_empty = d_id + 1;
+    });
 
     // write any trailing empty documents
-    write_gap(doc_id{num_docs});
+    write_gap(doc_id{inv_idx.num_docs()});
+}
+
+bool forward_index::impl::has_binary_postings() const
+{
+    const auto& postings = idx_->impl_->postings();
+    if (postings.size() < sizeof(uint64_t))
+        return false;
+
+    uint64_t magic;
+    std::memcpy(&magic, postings.begin(), sizeof(uint64_t));
+    return magic == binary_magic;
+}
 
-    filesystem::delete_file(filename + ".tmp");
+void forward_index::impl::libsvm_postings_to_binary()
+{
+    auto filename = idx_->index_name() + idx_->impl_->files[POSTINGS];
+    {
+        std::ofstream output{filename + ".tmp", std::ios::binary};
+        output.write(reinterpret_cast<const char*>(&binary_magic),
+                     sizeof(uint64_t));
+        uint64_t byte_pos = sizeof(uint64_t);
+
+        const auto& postings = idx_->impl_->postings();
+        printing::progress progress{" > Converting postings: ",
+                                    doc_byte_locations_->size()};
+        for (doc_id d_id{0}; d_id < doc_byte_locations_->size(); ++d_id)
+        {
+            progress(d_id);
+            uint64_t begin = (*doc_byte_locations_)[d_id];
+            uint64_t end = begin;
+            while (end < postings.size() && postings[end] != '\n')
+                ++end;
+
+            std::string line{postings.begin() + begin, end - begin};
+            (*doc_byte_locations_)[d_id] = byte_pos;
+            byte_pos += write_binary(output, io::libsvm_parser::counts(line));
+        }
+    }
+
+    filesystem::delete_file(filename);
+    filesystem::rename_file(filename + ".tmp", filename);
+    idx_->impl_->load_postings();
+}
+
+uint64_t
+    forward_index::impl::write_binary(std::ofstream& out,
+                                      const postings_data_type::count_t& counts)
+{
+    uint64_t num_pairs = counts.size();
+    out.write(reinterpret_cast<const char*>(&num_pairs), sizeof(uint64_t));
+    for (auto& c : counts)
+    {
+        uint64_t t_id = c.first;
+        out.write(reinterpret_cast<const char*>(&t_id), sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(&c.second), sizeof(double));
+    }
+    return (1 + 2 * num_pairs) * sizeof(uint64_t);
 }
 }
 }
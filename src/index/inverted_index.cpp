@@ -4,14 +4,23 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 #include "corpus/corpus.h"
 #include "index/chunk_handler.h"
+#include "index/compact_vocabulary_writer.h"
 #include "index/disk_index_impl.h"
 #include "index/inverted_index.h"
+#include "index/postings_cursor.h"
 #include "index/string_list.h"
 #include "index/string_list_writer.h"
 #include "index/vocabulary_map.h"
 #include "index/vocabulary_map_writer.h"
+#include "io/binary.h"
 #include "parallel/thread_pool.h"
 #include "analyzers/analyzer.h"
 #include "util/mapping.h"
@@ -58,35 +67,286 @@ class inverted_index::impl
     void create_lexicon(const std::string& postings_file,
                         const std::string& lexicon_file);
 
+    /// Receives postings_data in increasing order of their terms
+    using pdata_consumer = std::function<void(index_pdata_type&&)>;
+
+    /**
+     * Merges the chunks written by the handler, writing the compressed
+     * postings file, vocabulary, and lexicon as it goes.
+     * @param handler The chunk handler for this index
+     */
+    void merge_and_compress(chunk_handler<inverted_index>& handler);
+
+    /**
+     * Writes the compressed postings file, vocabulary, lexicon, term
+     * statistics, and skip entries.
+     * @param merge Called with the consumer that writes the postings_data
+     * for each term, which must be given to it in increasing order of
+     * their terms
+     */
+    void compress(const std::function<void(const pdata_consumer&)>& merge);
+
+    /**
+     * Merges the postings of other indexes into this one, numbering the
+     * documents of each index after those of the indexes before it and
+     * leaving out deleted documents.
+     * @param indexes The indexes to merge, in order
+     * @param term_maps Set to the term_id in this index of every term of
+     * each index; terms that only appear in deleted documents are left
+     * out of this index, so their entries are meaningless
+     */
+    void merge_postings(const std::vector<const inverted_index*>& indexes,
+                        std::vector<std::vector<term_id>>& term_maps);
+
+    /**
+     * @param config The config group
+     * @return the postings encoding requested by the config group
+     */
+    static postings_codec load_codec(const cpptoml::table& config);
+
+    /**
+     * @param config The config group
+     * @return whether the config group asks for term positions
+     */
+    static bool load_positional(const cpptoml::table& config);
+
+    /**
+     * @param config The config group
+     * @return whether the config group asks for a compact_vocabulary
+     */
+    static bool load_compact_vocabulary(const cpptoml::table& config);
+
+    /**
+     * @param config The config group
+     * @return the number of bytes of the index to read in when it is
+     * loaded
+     */
+    static uint64_t load_warm_budget(const cpptoml::table& config);
+
+    /**
+     * @param config The config group
+     * @return whether the postings of query terms are prefetched
+     */
+    static bool load_prefetch(const cpptoml::table& config);
+
+    /**
+     * Converts the term positions saved while tokenizing into the
+     * positions file, which is indexed by document. The term_id mapping
+     * must already be loaded.
+     */
+    void write_positions();
+
+    /**
+     * Copies the positions of other indexes into this one, with their
+     * documents numbered as merge_postings() numbers them.
+     * @param indexes The indexes to merge, in order
+     * @param term_maps The term_id in this index of every term of each
+     * index
+     */
+    void merge_positions(const std::vector<const inverted_index*>& indexes,
+                         const std::vector<std::vector<term_id>>& term_maps);
+
+    /**
+     * Loads the positions file.
+     */
+    void load_positions();
+
+    /**
+     * Computes the collection-level totals from the document sizes and
+     * saves them alongside the index.
+     */
+    void save_corpus_stats();
+
+    /**
+     * Loads the per-term statistics and the collection-level totals.
+     */
+    void load_stats();
+
+    /**
+     * Loads the skip entries for the postings lists.
+     */
+    void load_skips();
+
+    /**
+     * Saves the counts of each term's postings in deleted documents as
+     * all zero, for a newly written postings file, which holds no
+     * postings of deleted documents.
+     */
+    void reset_deleted_stats();
+
+    /**
+     * Loads the counts of each term's postings in deleted documents,
+     * counting them from the postings if they were not saved with the
+     * index.
+     */
+    void load_deleted_stats();
+
+    /**
+     * Adds the postings of a document to the counts of each term's
+     * postings in deleted documents; must be called with delete_mutex_
+     * held, before the document is marked as deleted.
+     * @param d_id The document being deleted
+     */
+    void count_deleted(doc_id d_id);
+
     /**
-     * Compresses the large postings file.
+     * @param t_id A term_id in the index
+     * @return a cursor over the term's postings in the postings file,
+     * bypassing any cache
      */
-    void compress(const std::string& filename, uint64_t num_unique_terms);
+    postings_cursor disk_postings(term_id t_id) const;
 
     /// The analyzer used to tokenize documents.
     std::unique_ptr<analyzers::analyzer> analyzer_;
 
+    /// The encoding used for the compressed postings file
+    postings_codec codec_;
+
+    /// Whether the positions of terms within documents are stored
+    bool positional_;
+
+    /// Whether a compact_vocabulary is written alongside the term_id mapping
+    bool compact_vocabulary_;
+
+    /// The number of bytes of the index to read in when it is loaded
+    uint64_t warm_budget_;
+
+    /// Whether the postings of query terms are prefetched
+    bool prefetch_;
+
+    /// Whether warm() has read in the whole postings file
+    mutable std::atomic<bool> postings_warm_;
+
     /**
-     * PrimaryKey -> postings location.
+     * PrimaryKey -> postings location. This is a bit offset for gamma
+     * coded postings and a byte offset for block coded postings.
      * Each index corresponds to a PrimaryKey (uint64_t).
      */
     util::optional<util::disk_vector<uint64_t>> term_bit_locations_;
 
+    /**
+     * PrimaryKey -> term statistics, stored as the consecutive fields of
+     * a term_stats.
+     * Each run of num_stat_fields values corresponds to a PrimaryKey.
+     */
+    util::optional<util::disk_vector<uint64_t>> term_stats_;
+
+    /// the number of fields in a term_stats
+    const static constexpr uint64_t num_stat_fields
+        = sizeof(term_stats) / sizeof(uint64_t);
+
+    /**
+     * The skip entries of every postings list, one after another, stored
+     * as the consecutive fields of a skip_entry.
+     */
+    util::optional<util::disk_vector<uint64_t>> skips_;
+
+    /**
+     * PrimaryKey -> the position in skips_ of the first field of the
+     * postings list's first skip entry.
+     * Each index corresponds to a PrimaryKey (uint64_t).
+     */
+    util::optional<util::disk_vector<uint64_t>> skip_locations_;
+
+    /**
+     * PrimaryKey -> the number of deleted documents in the term's
+     * postings, then the number of times the term appears in them. These
+     * are subtracted from the term's statistics by live_stats().
+     */
+    util::optional<util::disk_vector<uint64_t>> deleted_stats_;
+
+    /// makes deletions one at a time, so no posting is counted twice
+    std::mutex delete_mutex_;
+
+    /**
+     * The gamma coded positions of the terms in each document. Each
+     * document's record holds the gaps between the positions of each of
+     * its unique terms, in increasing order of term_id, followed by a
+     * directory of the terms: their number, the number of bits of
+     * positions before the directory, and then for each term its term_id
+     * gap, its count, and the number of bits its position gaps take up.
+     * The directory lets the positions of a few terms be read without
+     * decoding those of the others.
+     */
+    util::optional<io::mmap_file> positions_;
+
+    /**
+     * doc_id -> bit offset of the document's term directory in
+     * positions_. Each index corresponds to a doc_id (uint64_t).
+     */
+    util::optional<util::disk_vector<uint64_t>> position_locations_;
+
     /// the total number of term occurrences in the entire corpus
     uint64_t total_corpus_terms_;
+
+    /// the length of the shortest non-empty document in the corpus
+    uint64_t min_doc_length_;
 };
 
 inverted_index::impl::impl(inverted_index* idx, const cpptoml::table& config)
     : idx_{idx},
       analyzer_{analyzers::analyzer::load(config)},
-      total_corpus_terms_{0}
+      codec_{load_codec(config)},
+      positional_{load_positional(config)},
+      compact_vocabulary_{load_compact_vocabulary(config)},
+      warm_budget_{load_warm_budget(config)},
+      prefetch_{load_prefetch(config)},
+      postings_warm_{false},
+      total_corpus_terms_{0},
+      min_doc_length_{0}
 {
     // nothing
 }
 
+auto inverted_index::impl::load_codec(const cpptoml::table& config)
+    -> postings_codec
+{
+    auto codec = config.get_as<std::string>("postings-codec");
+    if (!codec || *codec == "gamma")
+        return postings_codec::gamma;
+    if (*codec == "block")
+        return postings_codec::block;
+    throw inverted_index_exception{"unknown postings-codec: " + *codec};
+}
+
+bool inverted_index::impl::load_positional(const cpptoml::table& config)
+{
+    auto positions = config.get_as<bool>("positions");
+    return positions && *positions;
+}
+
+bool inverted_index::impl::load_compact_vocabulary(
+    const cpptoml::table& config)
+{
+    auto compact = config.get_as<bool>("compact-vocabulary");
+    return compact && *compact;
+}
+
+uint64_t inverted_index::impl::load_warm_budget(const cpptoml::table& config)
+{
+    auto budget = config.get_as<int64_t>("warm-budget");
+    if (!budget)
+        return 0;
+    if (*budget < 0)
+        throw inverted_index_exception{"warm-budget must not be negative"};
+    return static_cast<uint64_t>(*budget);
+}
+
+bool inverted_index::impl::load_prefetch(const cpptoml::table& config)
+{
+    auto prefetch = config.get_as<bool>("prefetch-postings");
+    return !prefetch || *prefetch;
+}
+
 inverted_index::inverted_index(const cpptoml::table& config)
-    : disk_index{config, *config.get_as<std::string>("inverted-index")},
-      inv_impl_{this, config}
+    : inverted_index{config, *config.get_as<std::string>("inverted-index")}
+{
+    // nothing
+}
+
+inverted_index::inverted_index(const cpptoml::table& config,
+                               const std::string& name)
+    : disk_index{config, name}, inv_impl_{this, config}
 {
     // nothing
 }
@@ -97,7 +357,13 @@ inverted_index::~inverted_index() = default;
 
 bool inverted_index::valid() const
 {
-    for (auto& f : impl_->files)
+    auto files = impl_->files;
+    files.insert(files.end(),
+                 {"/lexicon.index", "/termstats.index", "/corpus.stats",
+                  "/skips.index", "/skiplocations.index"});
+    if (inv_impl_->positional_)
+        files.insert(files.end(), {"/positions.index", "/positions.locations"});
+    for (auto& f : files)
     {
         if (!filesystem::file_exists(index_name() + "/" + std::string{f}))
         {
@@ -111,39 +377,103 @@ bool inverted_index::valid() const
 }
 
 void inverted_index::create_index(const std::string& config_file)
+{
+    // load the documents from the corpus
+    auto docs = corpus::corpus::load(config_file);
+    create_index(config_file, *docs);
+}
+
+void inverted_index::create_index(const std::string& config_file,
+                                  corpus::corpus& docs)
 {
     // save the config file so we can recreate the analyzer
     filesystem::copy_file(config_file, index_name() + "/config.toml");
 
     LOG(info) << "Creating index: " << index_name() << ENDLG;
 
-    // load the documents from the corpus
-    auto docs = corpus::corpus::load(config_file);
-
-    uint64_t num_docs = docs->size();
+    uint64_t num_docs = docs.size();
     impl_->initialize_metadata(num_docs);
 
     chunk_handler<inverted_index> handler{index_name()};
-    inv_impl_->tokenize_docs(docs.get(), handler);
+    inv_impl_->tokenize_docs(&docs, handler);
 
     impl_->load_doc_id_mapping();
 
-    handler.merge_chunks();
+    inv_impl_->merge_and_compress(handler);
+    inv_impl_->save_corpus_stats();
+    inv_impl_->load_stats();
+    inv_impl_->load_skips();
+    inv_impl_->reset_deleted_stats();
+
+    impl_->load_term_id_mapping();
+    if (inv_impl_->positional_)
+    {
+        inv_impl_->write_positions();
+        inv_impl_->load_positions();
+    }
+
+    impl_->save_label_id_mapping();
+    impl_->load_postings();
+
+    LOG(info) << "Done creating index: " << index_name() << ENDLG;
+}
+
+void inverted_index::merge_index(
+    const std::string& config_file,
+    const std::vector<const inverted_index*>& indexes)
+{
+    filesystem::copy_file(config_file, index_name() + "/config.toml");
+
+    LOG(info) << "Merging " << indexes.size()
+              << " indexes into: " << index_name() << ENDLG;
+
+    uint64_t num_docs = 0;
+    for (const auto& idx : indexes)
+        num_docs += idx->num_docs();
+    impl_->initialize_metadata(num_docs);
 
-    LOG(info) << "Created uncompressed postings file " << index_name()
-              << impl_->files[POSTINGS] << " ("
-              << printing::bytes_to_units(handler.final_size()) << ")" << ENDLG;
+    {
+        // deleted documents keep their doc_ids, but are emptied
+        auto docid_writer = impl_->make_doc_id_writer(num_docs);
+        doc_id d_id{0};
+        for (const auto& idx : indexes)
+        {
+            for (doc_id id{0}; id < idx->num_docs(); ++id, ++d_id)
+            {
+                auto deleted = idx->is_deleted(id);
+                docid_writer.insert(d_id, idx->doc_path(id));
+                impl_->set_length(d_id, deleted ? 0 : idx->doc_size(id));
+                impl_->set_unique_terms(d_id,
+                                        deleted ? 0 : idx->unique_terms(id));
+                impl_->set_label(d_id, idx->label(id));
 
-    uint64_t num_unique_terms = handler.unique_primary_keys();
-    inv_impl_->compress(index_name() + impl_->files[POSTINGS],
-                        num_unique_terms);
+                // the merged postings leave the document out, so there
+                // are no postings to count
+                if (deleted)
+                    disk_index::delete_doc(d_id);
+            }
+        }
+    }
+    impl_->load_doc_id_mapping();
+
+    std::vector<std::vector<term_id>> term_maps;
+    inv_impl_->merge_postings(indexes, term_maps);
+    inv_impl_->save_corpus_stats();
+    inv_impl_->load_stats();
+    inv_impl_->load_skips();
+    inv_impl_->reset_deleted_stats();
 
     impl_->load_term_id_mapping();
+    if (inv_impl_->positional_)
+    {
+        inv_impl_->merge_positions(indexes, term_maps);
+        inv_impl_->load_positions();
+    }
 
     impl_->save_label_id_mapping();
     impl_->load_postings();
 
-    LOG(info) << "Done creating index: " << index_name() << ENDLG;
+    LOG(info) << "Done merging index: " << index_name() << ENDLG;
 }
 
 void inverted_index::load_index()
@@ -151,6 +481,8 @@ void inverted_index::load_index()
     LOG(info) << "Loading index from disk: " << index_name() << ENDLG;
 
     auto config = cpptoml::parse_file(index_name() + "/config.toml");
+    inv_impl_->codec_ = impl::load_codec(config);
+    inv_impl_->positional_ = impl::load_positional(config);
 
     impl_->initialize_metadata();
     impl_->load_doc_id_mapping();
@@ -158,9 +490,22 @@ void inverted_index::load_index()
 
     inv_impl_->term_bit_locations_
         = util::disk_vector<uint64_t>(index_name() + "/lexicon.index");
+    inv_impl_->term_bit_locations_->advise(io::access_hint::random);
+    inv_impl_->load_stats();
+    inv_impl_->load_skips();
+    if (inv_impl_->positional_)
+        inv_impl_->load_positions();
 
     impl_->load_label_id_mapping();
     impl_->load_postings();
+    inv_impl_->load_deleted_stats();
+
+    if (inv_impl_->warm_budget_ > 0)
+    {
+        auto bytes = warm(inv_impl_->warm_budget_);
+        LOG(info) << "Warmed " << printing::bytes_to_units(bytes)
+                  << " of the index" << ENDLG;
+    }
 }
 
 void inverted_index::impl::tokenize_docs(corpus::corpus* docs,
@@ -171,6 +516,12 @@ void inverted_index::impl::tokenize_docs(corpus::corpus* docs,
 
     printing::progress progress{" > Tokenizing Docs: ", docs->size()};
 
+    // term positions are saved by term string until the term_ids are known
+    std::ofstream positions;
+    if (positional_)
+        positions.open(idx_->index_name() + "/positions.tmp",
+                       std::ios::binary);
+
     auto task = [&]()
     {
         auto producer = handler.make_producer();
@@ -188,8 +539,24 @@ void inverted_index::impl::tokenize_docs(corpus::corpus* docs,
                 progress(doc->id());
             }
 
+            if (positional_)
+                doc->record_positions(true);
             analyzer->tokenize(*doc);
 
+            if (positional_)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                io::write_binary(positions, doc->id());
+                io::write_binary(positions, uint64_t{doc->positions().size()});
+                for (const auto& term : doc->positions())
+                {
+                    io::write_binary(positions, term.first);
+                    io::write_binary(positions, uint64_t{term.second.size()});
+                    for (const auto& position : term.second)
+                        io::write_binary(positions, position);
+                }
+            }
+
             // warn if there is an empty document
             if (doc->counts().empty())
             {
@@ -218,85 +585,512 @@ void inverted_index::impl::tokenize_docs(corpus::corpus* docs,
         fut.get();
 }
 
-void inverted_index::impl::compress(const std::string& filename,
-                                    uint64_t num_unique_terms)
+void inverted_index::impl::merge_and_compress(
+    chunk_handler<inverted_index>& handler)
 {
-    std::string cfilename{filename + ".compressed"};
+    compress([&](const pdata_consumer& consumer)
+             {
+                 handler.merge_chunks(consumer);
+             });
+}
 
-    // create scope so the writer closes and we can calculate the size of the
-    // file as well as rename it
+void inverted_index::impl::merge_postings(
+    const std::vector<const inverted_index*>& indexes,
+    std::vector<std::vector<term_id>>& term_maps)
+{
+    // every vocabulary is sorted, so the merged one is found by merging
+    // them; fronts holds the next term of each index, if it has any left
+    std::vector<term_id> next(indexes.size(), term_id{0});
+    std::vector<util::optional<std::string>> fronts(indexes.size());
+    auto load_front = [&](uint64_t i)
     {
-        io::compressed_file_writer out{cfilename,
-                                       io::default_compression_writer_func};
+        if (next[i] < indexes[i]->unique_terms())
+            fronts[i] = indexes[i]->term_text(next[i]);
+        else
+            fronts[i] = util::nullopt;
+    };
+    for (uint64_t i = 0; i < indexes.size(); ++i)
+        load_front(i);
+    term_maps.assign(indexes.size(), {});
+
+    std::vector<postings_cursor::pair_t> postings;
+    index_pdata_type::count_t counts;
+    compress([&](const pdata_consumer& consumer)
+             {
+        term_id t_id{0};
+        while (true)
+        {
+            util::optional<std::string> term;
+            for (const auto& front : fronts)
+            {
+                if (front && (!term || *front < *term))
+                    term = front;
+            }
+            if (!term)
+                return;
+
+            counts.clear();
+            uint64_t first_doc = 0;
+            for (uint64_t i = 0; i < indexes.size(); ++i)
+            {
+                if (fronts[i] && *fronts[i] == *term)
+                {
+                    indexes[i]->postings(next[i]).read_all(postings);
+                    for (const auto& posting : postings)
+                    {
+                        if (!indexes[i]->is_deleted(posting.first))
+                            counts.emplace_back(
+                                doc_id{first_doc + posting.first},
+                                posting.second);
+                    }
+
+                    term_maps[i].push_back(t_id);
+                    ++next[i];
+                    load_front(i);
+                }
+                first_doc += indexes[i]->num_docs();
+            }
+
+            // t_id is reused for the next term if this one is left out
+            if (counts.empty())
+                continue;
+
+            index_pdata_type pdata{*term};
+            pdata.set_counts(counts);
+            consumer(std::move(pdata));
+            ++t_id;
+        }
+    });
+}
+
+void inverted_index::impl::compress(
+    const std::function<void(const pdata_consumer&)>& merge)
+{
+    auto filename = idx_->index_name() + idx_->impl_->files[POSTINGS];
+    auto lexicon_filename = idx_->index_name() + "/lexicon.index";
+    auto stats_filename = idx_->index_name() + "/termstats.index";
+    auto skips_filename = idx_->index_name() + "/skips.index";
+    auto skip_locations_filename = idx_->index_name() + "/skiplocations.index";
+
+    // create scope so the writers close and we can calculate the size of
+    // the file as well as map the lexicon
+    {
+        std::unique_ptr<io::compressed_file_writer> gamma_out;
+        std::unique_ptr<io::block_file_writer> block_out;
+        if (codec_ == postings_codec::block)
+            block_out = make_unique<io::block_file_writer>(filename);
+        else
+            gamma_out = make_unique<io::compressed_file_writer>(
+                filename, io::default_compression_writer_func);
 
         vocabulary_map_writer vocab{idx_->index_name()
                                     + idx_->impl_->files[TERM_IDS_MAPPING]};
 
-        postings_data<std::string, doc_id> pdata;
-        auto length = filesystem::file_size(filename) * 8; // number of bits
-        io::compressed_file_reader in{filename,
-                                      io::default_compression_reader_func};
+        // the tree is always written for the vocabulary tools, but the
+        // compact vocabulary is the one loaded when it exists
+        auto compact_filename
+            = idx_->index_name() + idx_->impl_->compact_term_ids_file;
+        std::unique_ptr<compact_vocabulary_writer> compact_vocab;
+        if (compact_vocabulary_)
+            compact_vocab
+                = make_unique<compact_vocabulary_writer>(compact_filename);
+        else
+            filesystem::delete_file(compact_filename);
 
-        // allocate memory for the term_id -> term location mapping now
-        // that we know how many terms there are
-        term_bit_locations_ = util::disk_vector<uint64_t>(
-            idx_->index_name() + "/lexicon.index", num_unique_terms);
+        // the number of terms isn't known until the merge is done, so the
+        // term_id -> term location mapping is written sequentially
+        std::ofstream lexicon{lexicon_filename, std::ios::binary};
+        std::ofstream stats{stats_filename, std::ios::binary};
+        std::ofstream skips_out{skips_filename, std::ios::binary};
+        std::ofstream skip_locations{skip_locations_filename,
+                                     std::ios::binary};
+        std::vector<skip_entry> skips;
+        uint64_t num_skip_fields = 0;
 
-        printing::progress progress{
-            " > Compressing postings: ", length, 500, 8 * 1024 /* 1KB */
-        };
-        // note: we will be accessing pdata in sorted order
-        term_id t_id{0};
-        while (in.has_next())
+        // note: we will be receiving pdata in sorted order
+        merge([&](index_pdata_type&& pdata)
         {
-            in >> pdata;
-            progress(in.bit_location());
             vocab.insert(pdata.primary_key());
-            (*term_bit_locations_)[t_id] = out.bit_location();
-            pdata.write_compressed(out);
-            ++t_id;
-        }
+            if (compact_vocab)
+                compact_vocab->insert(pdata.primary_key());
+            uint64_t location;
+            uint64_t num_bytes;
+            skips.clear();
+            if (block_out)
+            {
+                location = block_out->byte_location();
+                pdata.write_packed(*block_out, &skips);
+                num_bytes = block_out->byte_location() - location;
+            }
+            else
+            {
+                location = gamma_out->bit_location();
+                pdata.write_compressed(*gamma_out, &skips);
+                num_bytes = (gamma_out->bit_location() - location + 7) / 8;
+            }
+            lexicon.write(reinterpret_cast<const char*>(&location),
+                          sizeof(uint64_t));
+
+            skip_locations.write(reinterpret_cast<const char*>(
+                                     &num_skip_fields),
+                                 sizeof(uint64_t));
+            for (const auto& skip : skips)
+            {
+                uint64_t fields[]
+                    = {skip.last_id, skip.max_count, skip.next_location};
+                skips_out.write(reinterpret_cast<const char*>(fields),
+                                sizeof(fields));
+                num_skip_fields += sizeof(fields) / sizeof(uint64_t);
+            }
+
+            // the corpus count is accumulated as total_num_occurences
+            // used to compute it from the postings
+            double sum = 0;
+            double max = 0;
+            for (const auto& count : pdata.counts())
+            {
+                sum += count.second;
+                max = std::max(max, count.second);
+            }
+            uint64_t fields[] = {pdata.counts().size(),
+                                 static_cast<uint64_t>(sum),
+                                 static_cast<uint64_t>(max), num_bytes};
+            stats.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+        });
     }
 
+    term_bit_locations_ = util::disk_vector<uint64_t>(lexicon_filename);
+
     LOG(info) << "Created compressed postings file ("
-              << printing::bytes_to_units(filesystem::file_size(cfilename))
+              << printing::bytes_to_units(filesystem::file_size(filename))
               << ")" << ENDLG;
+}
+
+uint64_t inverted_index::term_freq(term_id t_id, doc_id d_id) const
+{
+    if (is_deleted(d_id))
+        return 0;
+
+    auto cursor = postings(t_id);
+    while (cursor.has_next())
+    {
+        auto posting = cursor.next();
+        if (posting.first >= d_id)
+            return posting.first == d_id ? posting.second : 0;
+    }
+    return 0;
+}
+
+void inverted_index::impl::save_corpus_stats()
+{
+    uint64_t total_corpus_terms = 0;
+    uint64_t min_doc_length = 0;
+    for (auto& id : idx_->docs())
+    {
+        auto length = idx_->doc_size(id);
+        total_corpus_terms += length;
+        if (length > 0 && (min_doc_length == 0 || length < min_doc_length))
+            min_doc_length = length;
+    }
+
+    util::disk_vector<uint64_t> corpus_stats{
+        idx_->index_name() + "/corpus.stats", 2};
+    corpus_stats[0] = total_corpus_terms;
+    corpus_stats[1] = min_doc_length;
+}
+
+void inverted_index::impl::load_stats()
+{
+    term_stats_
+        = util::disk_vector<uint64_t>(idx_->index_name() + "/termstats.index");
+    // each query reads the statistics of just a few terms
+    term_stats_->advise(io::access_hint::random);
+
+    util::disk_vector<uint64_t> corpus_stats{idx_->index_name()
+                                             + "/corpus.stats"};
+    total_corpus_terms_ = corpus_stats[0];
+    min_doc_length_ = corpus_stats[1];
+}
+
+void inverted_index::impl::write_positions()
+{
+    auto tmp_filename = idx_->index_name() + "/positions.tmp";
+    {
+        std::ifstream tmp{tmp_filename, std::ios::binary};
+        io::compressed_file_writer out{idx_->index_name()
+                                           + "/positions.index",
+                                       io::default_compression_writer_func};
+        util::disk_vector<uint64_t> locations{
+            idx_->index_name() + "/positions.locations", idx_->num_docs()};
+
+        printing::progress progress{" > Writing positions: ",
+                                    idx_->num_docs()};
+        std::vector<std::pair<term_id, std::vector<uint64_t>>> terms;
+        std::vector<uint64_t> lengths;
+        for (uint64_t i = 0; i < idx_->num_docs(); ++i)
+        {
+            progress(i);
+
+            doc_id d_id;
+            uint64_t num_terms;
+            io::read_binary(tmp, d_id);
+            io::read_binary(tmp, num_terms);
+
+            terms.resize(num_terms);
+            for (auto& term : terms)
+            {
+                std::string text;
+                uint64_t count;
+                io::read_binary(tmp, text);
+                io::read_binary(tmp, count);
+                term.first = idx_->get_term_id(text);
+                term.second.resize(count);
+                for (auto& position : term.second)
+                    io::read_binary(tmp, position);
+            }
+            std::sort(terms.begin(), terms.end());
 
+            auto start = out.bit_location();
+            lengths.clear();
+            for (const auto& term : terms)
+            {
+                auto begin = out.bit_location();
+                uint64_t last_position = 0;
+                for (const auto& position : term.second)
+                {
+                    out.write(position - last_position);
+                    last_position = position;
+                }
+                lengths.push_back(out.bit_location() - begin);
+            }
+
+            locations[d_id] = out.bit_location();
+            out.write(num_terms);
+            out.write(locations[d_id] - start);
+            uint64_t last_term = 0;
+            for (uint64_t k = 0; k < terms.size(); ++k)
+            {
+                out.write(terms[k].first - last_term);
+                out.write(terms[k].second.size());
+                out.write(lengths[k]);
+                last_term = terms[k].first;
+            }
+        }
+    }
+    filesystem::delete_file(tmp_filename);
+}
+
+void inverted_index::impl::merge_positions(
+    const std::vector<const inverted_index*>& indexes,
+    const std::vector<std::vector<term_id>>& term_maps)
+{
+    io::compressed_file_writer out{idx_->index_name() + "/positions.index",
+                                   io::default_compression_writer_func};
+    util::disk_vector<uint64_t> locations{
+        idx_->index_name() + "/positions.locations", idx_->num_docs()};
+
+    // both vocabularies are sorted, so the terms of each record stay in
+    // increasing order once their term_ids are replaced, and the position
+    // gaps are copied unchanged
+    std::vector<std::array<uint64_t, 3>> directory;
+    uint64_t d_id = 0;
+    for (uint64_t i = 0; i < indexes.size(); ++i)
+    {
+        const auto& source = *indexes[i]->inv_impl_;
+        io::compressed_file_reader reader{*source.positions_,
+                                          io::default_compression_reader_func};
+        for (uint64_t j = 0; j < indexes[i]->num_docs(); ++j, ++d_id)
+        {
+            if (indexes[i]->is_deleted(doc_id{j}))
+            {
+                locations[d_id] = out.bit_location();
+                out.write(0);
+                out.write(0);
+                continue;
+            }
+
+            auto location = source.position_locations_->at(j);
+            reader.seek(location);
+            auto num_terms = reader.next();
+            auto start = location - reader.next();
+            directory.resize(num_terms);
+            uint64_t last_term = 0;
+            for (auto& term : directory)
+            {
+                last_term += reader.next();
+                term[0] = term_maps[i][last_term];
+                term[1] = reader.next();
+                term[2] = reader.next();
+            }
+
+            auto begin = out.bit_location();
+            if (num_terms > 0)
+                reader.seek(start);
+            for (const auto& term : directory)
+            {
+                for (uint64_t p = 0; p < term[1]; ++p)
+                    out.write(reader.next());
+            }
+
+            locations[d_id] = out.bit_location();
+            out.write(num_terms);
+            out.write(locations[d_id] - begin);
+            uint64_t last_merged = 0;
+            for (const auto& term : directory)
+            {
+                out.write(term[0] - last_merged);
+                out.write(term[1]);
+                out.write(term[2]);
+                last_merged = term[0];
+            }
+        }
+    }
+}
+
+void inverted_index::impl::load_positions()
+{
+    positions_ = io::mmap_file{idx_->index_name() + "/positions.index"};
+    position_locations_ = util::disk_vector<uint64_t>(
+        idx_->index_name() + "/positions.locations");
+}
+
+void inverted_index::impl::load_skips()
+{
+    skips_ = util::disk_vector<uint64_t>(idx_->index_name() + "/skips.index");
+    skip_locations_ = util::disk_vector<uint64_t>(idx_->index_name()
+                                                  + "/skiplocations.index");
+    skip_locations_->advise(io::access_hint::random);
+}
+
+void inverted_index::impl::reset_deleted_stats()
+{
+    // a new file must not pick up the counts of an old one
+    auto filename = idx_->index_name() + "/deleted.termstats";
     filesystem::delete_file(filename);
-    filesystem::rename_file(cfilename, filename);
+    auto size = std::max<uint64_t>(2 * term_bit_locations_->size(), 2);
+    deleted_stats_ = util::disk_vector<uint64_t>{filename, size};
+    for (uint64_t i = 0; i < size; ++i)
+        (*deleted_stats_)[i] = 0;
 }
 
-uint64_t inverted_index::term_freq(term_id t_id, doc_id d_id) const
+void inverted_index::impl::load_deleted_stats()
 {
-    auto pdata = search_primary(t_id);
-    return pdata->count(d_id);
+    auto filename = idx_->index_name() + "/deleted.termstats";
+    auto size = std::max<uint64_t>(2 * term_bit_locations_->size(), 2);
+    if (filesystem::file_exists(filename)
+        && filesystem::file_size(filename) == size * sizeof(uint64_t))
+    {
+        deleted_stats_ = util::disk_vector<uint64_t>{filename};
+        return;
+    }
+
+    // indexes saved without the counts have them counted once, here
+    reset_deleted_stats();
+    if (idx_->num_deleted() == 0)
+        return;
+    auto& deleted = *deleted_stats_;
+    for (uint64_t idx = 0; idx < term_bit_locations_->size(); ++idx)
+    {
+        auto cursor = disk_postings(term_id{idx});
+        for (; cursor.has_next(); cursor.next())
+        {
+            const auto& posting = cursor.peek();
+            if (idx_->is_deleted(posting.first))
+            {
+                ++deleted[2 * idx];
+                deleted[2 * idx + 1] += static_cast<uint64_t>(posting.second);
+            }
+        }
+    }
 }
 
-uint64_t inverted_index::total_corpus_terms()
+void inverted_index::impl::count_deleted(doc_id d_id)
 {
-    if (inv_impl_->total_corpus_terms_ == 0)
+    auto& deleted = *deleted_stats_;
+    for (uint64_t idx = 0; idx < term_bit_locations_->size(); ++idx)
     {
-        for (auto& id : docs())
-            inv_impl_->total_corpus_terms_ += doc_size(id);
+        // the skip entries lead to the one block that could hold the
+        // document, so no more than the first block and that one are
+        // decoded
+        auto cursor = disk_postings(term_id{idx});
+        cursor.advance_to(d_id);
+        if (cursor.has_next() && cursor.peek().first == d_id)
+        {
+            ++deleted[2 * idx];
+            deleted[2 * idx + 1] += static_cast<uint64_t>(cursor.peek().second);
+        }
     }
+}
 
-    return inv_impl_->total_corpus_terms_;
+postings_cursor inverted_index::impl::disk_postings(term_id t_id) const
+{
+    uint64_t idx{t_id};
+    const auto& skips = *skips_;
+    return postings_cursor{t_id,
+                           idx_->impl_->postings(),
+                           term_bit_locations_->at(idx),
+                           codec_,
+                           idx_->stats(t_id).doc_freq,
+                           &skips[skip_locations_->at(idx)]};
 }
 
-uint64_t inverted_index::total_num_occurences(term_id t_id) const
+void inverted_index::delete_doc(doc_id d_id)
+{
+    if (d_id >= num_docs())
+        throw std::out_of_range{"doc_id " + std::to_string(d_id)
+                                + " is not in the index"};
+
+    std::lock_guard<std::mutex> lock{inv_impl_->delete_mutex_};
+    if (is_deleted(d_id))
+        return;
+    inv_impl_->count_deleted(d_id);
+    disk_index::delete_doc(d_id);
+}
+
+auto inverted_index::stats(term_id t_id) const -> term_stats
 {
-    auto pdata = search_primary(t_id);
+    uint64_t idx{t_id};
+    if (idx >= inv_impl_->term_bit_locations_->size())
+        return {0, 0, 0, 0};
 
-    double sum = 0;
-    for (auto& c : pdata->counts())
-        sum += c.second;
+    const auto& stats = *inv_impl_->term_stats_;
+    auto first = idx * impl::num_stat_fields;
+    return {stats[first], stats[first + 1], stats[first + 2],
+            stats[first + 3]};
+}
 
-    return sum;
+auto inverted_index::live_stats(term_id t_id) const -> term_stats
+{
+    auto t_stats = stats(t_id);
+    uint64_t idx{t_id};
+    if (num_deleted() == 0 || idx >= inv_impl_->term_bit_locations_->size())
+        return t_stats;
+
+    const auto& deleted = *inv_impl_->deleted_stats_;
+    t_stats.doc_freq -= deleted[2 * idx];
+    t_stats.corpus_count -= deleted[2 * idx + 1];
+    return t_stats;
 }
 
-double inverted_index::avg_doc_length()
+uint64_t inverted_index::total_corpus_terms() const
 {
-    return static_cast<double>(total_corpus_terms()) / num_docs();
+    return inv_impl_->total_corpus_terms_ - impl_->deleted_terms();
+}
+
+uint64_t inverted_index::min_doc_length() const
+{
+    return inv_impl_->min_doc_length_;
+}
+
+uint64_t inverted_index::total_num_occurences(term_id t_id) const
+{
+    return stats(t_id).corpus_count;
+}
+
+double inverted_index::avg_doc_length() const
+{
+    return static_cast<double>(total_corpus_terms())
+           / (num_docs() - num_deleted());
 }
 
 void inverted_index::tokenize(corpus::document& doc)
@@ -304,9 +1098,80 @@ void inverted_index::tokenize(corpus::document& doc)
     inv_impl_->analyzer_->tokenize(doc);
 }
 
+std::unique_ptr<analyzers::analyzer> inverted_index::clone_analyzer() const
+{
+    return inv_impl_->analyzer_->clone();
+}
+
+bool inverted_index::has_positions() const
+{
+    return inv_impl_->positional_;
+}
+
+void inverted_index::positions(doc_id d_id, const std::vector<term_id>& terms,
+                               std::vector<std::vector<uint64_t>>& out) const
+{
+    if (!inv_impl_->positional_)
+        throw inverted_index_exception{"index does not store positions"};
+
+    out.resize(terms.size());
+    for (auto& positions : out)
+        positions.clear();
+
+    io::compressed_file_reader reader{*inv_impl_->positions_,
+                                      io::default_compression_reader_func};
+    auto location = inv_impl_->position_locations_->at(d_id);
+    reader.seek(location);
+
+    // terms are stored in increasing order, so stop past the largest one
+    term_id last_wanted{0};
+    for (const auto& t_id : terms)
+        last_wanted = std::max(last_wanted, t_id);
+
+    // find where the positions of the wanted terms start in the
+    // directory, without decoding the positions of any other term
+    std::vector<std::pair<uint64_t, uint64_t>> wanted(terms.size(), {0, 0});
+    auto num_terms = reader.next();
+    auto offset = location - reader.next();
+    uint64_t last_term = 0;
+    for (uint64_t i = 0; i < num_terms && last_term <= last_wanted; ++i)
+    {
+        last_term += reader.next();
+        auto count = reader.next();
+        for (uint64_t j = 0; j < terms.size(); ++j)
+        {
+            if (terms[j] == last_term)
+                wanted[j] = {offset, count};
+        }
+        offset += reader.next();
+    }
+
+    for (uint64_t j = 0; j < terms.size(); ++j)
+    {
+        if (wanted[j].second == 0)
+            continue;
+
+        // the same term may be wanted more than once, as in a phrase
+        auto first = std::find(terms.begin(), terms.begin() + j, terms[j]);
+        if (first != terms.begin() + j)
+        {
+            out[j] = out[first - terms.begin()];
+            continue;
+        }
+
+        reader.seek(wanted[j].first);
+        uint64_t position = 0;
+        for (uint64_t k = 0; k < wanted[j].second; ++k)
+        {
+            position += reader.next();
+            out[j].push_back(position);
+        }
+    }
+}
+
 uint64_t inverted_index::doc_freq(term_id t_id) const
 {
-    return search_primary(t_id)->counts().size();
+    return stats(t_id).doc_freq;
 }
 
 auto inverted_index::search_primary(
@@ -318,14 +1183,99 @@ auto inverted_index::search_primary(
     if (idx >= inv_impl_->term_bit_locations_->size())
         return std::make_shared<postings_data_type>(t_id);
 
-    io::compressed_file_reader reader{impl_->postings(),
-                                      io::default_compression_reader_func};
-    reader.seek(inv_impl_->term_bit_locations_->at(idx));
-
     auto pdata = std::make_shared<postings_data_type>(t_id);
-    pdata->read_compressed(reader);
+    if (inv_impl_->codec_ == postings_codec::block)
+    {
+        io::block_file_reader reader{impl_->postings()};
+        reader.seek(inv_impl_->term_bit_locations_->at(idx));
+        pdata->read_packed(reader);
+    }
+    else
+    {
+        io::compressed_file_reader reader{impl_->postings(),
+                                          io::default_compression_reader_func};
+        reader.seek(inv_impl_->term_bit_locations_->at(idx));
+        pdata->read_compressed(reader);
+    }
+
+    if (num_deleted() > 0)
+    {
+        auto counts = pdata->counts();
+        counts.erase(std::remove_if(counts.begin(), counts.end(),
+                                    [&](const std::pair<doc_id, double>& p)
+                                    {
+                                        return is_deleted(p.first);
+                                    }),
+                     counts.end());
+        pdata->set_counts(counts);
+    }
 
     return pdata;
 }
+
+uint64_t inverted_index::warm(uint64_t budget) const
+{
+    auto bytes = disk_index::warm(budget);
+    bytes += inv_impl_->term_bit_locations_->warm(budget - bytes);
+    bytes += inv_impl_->term_stats_->warm(budget - bytes);
+    bytes += inv_impl_->skip_locations_->warm(budget - bytes);
+    bytes += inv_impl_->skips_->warm(budget - bytes);
+    auto postings_bytes = impl_->postings().warm(0, budget - bytes);
+    if (postings_bytes == impl_->postings().size())
+        inv_impl_->postings_warm_ = true;
+    return bytes + postings_bytes;
+}
+
+void inverted_index::prefetch(term_id t_id) const
+{
+    uint64_t idx{t_id};
+    if (!inv_impl_->prefetch_ || inv_impl_->postings_warm_ || caches_postings()
+        || idx >= inv_impl_->term_bit_locations_->size())
+        return;
+
+    // gamma coded lists start at a bit offset, and may end one byte past
+    // their rounded up size
+    auto location = inv_impl_->term_bit_locations_->at(idx);
+    auto length = stats(t_id).postings_bytes;
+    if (inv_impl_->codec_ == postings_codec::gamma)
+    {
+        location /= 8;
+        ++length;
+    }
+
+    // a list read by recent queries is still in memory, along with its
+    // skip entries, so there is nothing to start reading
+    const auto& postings = impl_->postings();
+    if (postings.resident(location, length))
+        return;
+    postings.advise(io::access_hint::will_need, location, length);
+
+    // the next term's skip entries start where this term's end
+    const auto& skip_locations = *inv_impl_->skip_locations_;
+    auto first = skip_locations[idx];
+    auto last = idx + 1 < skip_locations.size() ? skip_locations[idx + 1]
+                                                : inv_impl_->skips_->size();
+    if (last > first)
+        inv_impl_->skips_->advise(io::access_hint::will_need, first,
+                                  last - first);
+}
+
+postings_cursor inverted_index::postings(term_id t_id) const
+{
+    uint64_t idx{t_id};
+
+    // if the term doesn't exist in the index, return an empty cursor
+    if (idx >= inv_impl_->term_bit_locations_->size())
+        return postings_cursor{t_id};
+
+    if (caches_postings())
+    {
+        // go through the cache, which search_primary() is answered from
+        const auto& skips = *inv_impl_->skips_;
+        return postings_cursor{search_primary(t_id), stats(t_id).doc_freq,
+                               &skips[inv_impl_->skip_locations_->at(idx)]};
+    }
+    return inv_impl_->disk_postings(t_id);
+}
 }
 }
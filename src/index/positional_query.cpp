@@ -0,0 +1,175 @@
+/**
+ * @file positional_query.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <map>
+
+#include "corpus/document.h"
+#include "index/positional_query.h"
+#include "index/postings_cursor.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/**
+ * Calls a function with the positions of the terms in every document that
+ * contains all of them and has not been deleted, in increasing order of
+ * doc_id.
+ * @param idx The index to search
+ * @param terms The terms to look for
+ * @param count Called with the positions of each term in a document;
+ * returns the number of times the document matched
+ * @return the documents with at least one match
+ */
+template <class Counter>
+std::vector<positional_match> match(const inverted_index& idx,
+                                    const std::vector<term_id>& terms,
+                                    Counter&& count)
+{
+    if (!idx.has_positions())
+        throw inverted_index::inverted_index_exception{
+            "positional queries need an index that stores positions"};
+
+    std::vector<positional_match> matches;
+    if (terms.empty())
+        return matches;
+
+    std::vector<postings_cursor> cursors;
+    cursors.reserve(terms.size());
+    for (const auto& t_id : terms)
+        cursors.push_back(idx.postings(t_id));
+
+    std::vector<std::vector<uint64_t>> positions;
+    while (true)
+    {
+        // every cursor is moved up to the largest doc_id among them,
+        // until they all agree
+        doc_id target{0};
+        for (const auto& cursor : cursors)
+        {
+            if (!cursor.has_next())
+                return matches;
+            target = std::max(target, cursor.peek().first);
+        }
+
+        bool agree = true;
+        for (auto& cursor : cursors)
+        {
+            cursor.advance_to(target);
+            if (!cursor.has_next())
+                return matches;
+            agree = agree && cursor.peek().first == target;
+        }
+        if (!agree)
+            continue;
+
+        if (!idx.is_deleted(target))
+        {
+            idx.positions(target, terms, positions);
+            auto num_matches = count(positions);
+            if (num_matches > 0)
+                matches.emplace_back(target, num_matches);
+        }
+
+        for (auto& cursor : cursors)
+            cursor.next();
+    }
+}
+}
+
+std::vector<term_id> ordered_terms(inverted_index& idx,
+                                   corpus::document& query)
+{
+    if (!query.counts().empty())
+        throw inverted_index::inverted_index_exception{
+            "query has already been tokenized"};
+
+    query.record_positions(true);
+    idx.tokenize(query);
+
+    std::map<uint64_t, std::string> by_position;
+    for (const auto& term : query.positions())
+    {
+        for (const auto& position : term.second)
+            by_position[position] = term.first;
+    }
+
+    std::vector<term_id> terms;
+    for (const auto& term : by_position)
+        terms.push_back(idx.get_term_id(term.second));
+    return terms;
+}
+
+std::vector<positional_match> match_phrase(const inverted_index& idx,
+                                           const std::vector<term_id>& phrase)
+{
+    return match(idx, phrase,
+                 [](const std::vector<std::vector<uint64_t>>& positions)
+                 {
+        uint64_t num_matches = 0;
+        for (const auto& start : positions[0])
+        {
+            bool found = true;
+            for (uint64_t i = 1; i < positions.size() && found; ++i)
+                found = std::binary_search(positions[i].begin(),
+                                           positions[i].end(), start + i);
+            num_matches += found;
+        }
+        return num_matches;
+    });
+}
+
+std::vector<positional_match>
+    match_proximity(const inverted_index& idx,
+                    const std::vector<term_id>& terms, uint64_t window)
+{
+    // repeated terms would occupy the same positions
+    auto unique = terms;
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    std::vector<std::pair<uint64_t, uint64_t>> merged;
+    std::vector<uint64_t> in_span(unique.size());
+    return match(idx, unique,
+                 [&](const std::vector<std::vector<uint64_t>>& positions)
+                 {
+        // (position, term) pairs in increasing order of position
+        merged.clear();
+        for (uint64_t i = 0; i < positions.size(); ++i)
+        {
+            for (const auto& position : positions[i])
+                merged.emplace_back(position, i);
+        }
+        std::sort(merged.begin(), merged.end());
+
+        // slide a span over the positions, shrinking it from the left
+        // whenever it holds every term; a span is minimal when the terms
+        // at both of its ends occur in it only once
+        std::fill(in_span.begin(), in_span.end(), 0);
+        uint64_t num_terms = 0;
+        uint64_t num_matches = 0;
+        uint64_t left = 0;
+        for (uint64_t right = 0; right < merged.size(); ++right)
+        {
+            num_terms += in_span[merged[right].second]++ == 0;
+            if (num_terms < unique.size())
+                continue;
+
+            while (in_span[merged[left].second] > 1)
+                --in_span[merged[left++].second];
+
+            auto width = merged[right].first - merged[left].first + 1;
+            if (in_span[merged[right].second] == 1 && width <= window)
+                ++num_matches;
+        }
+        return num_matches;
+    });
+}
+}
+}
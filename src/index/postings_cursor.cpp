@@ -0,0 +1,292 @@
+/**
+ * @file postings_cursor.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "index/postings_cursor.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/// Marks the end of a gamma-encoded postings list
+const static constexpr uint64_t delimiter
+    = std::numeric_limits<uint64_t>::max();
+
+/// The number of fields in a skip_entry
+const static constexpr uint64_t skip_fields
+    = sizeof(skip_entry) / sizeof(uint64_t);
+}
+
+postings_cursor::postings_cursor(term_id t_id)
+    : t_id_{t_id},
+      decoded_pos_{0},
+      size_{0},
+      skips_{nullptr},
+      num_decoded_{0},
+      last_id_{0},
+      pos_{0},
+      len_{0}
+{
+    // nothing
+}
+
+postings_cursor::postings_cursor(term_id t_id, const io::mmap_file& file,
+                                 uint64_t location,
+                                 inverted_index::postings_codec codec,
+                                 uint64_t size, const uint64_t* skips)
+    : postings_cursor{t_id}
+{
+    size_ = size;
+    skips_ = skips;
+    if (codec == inverted_index::postings_codec::block)
+    {
+        block_ = io::block_file_reader{file};
+        block_->seek(location);
+        block_->next(); // the size, which is already known
+    }
+    else
+    {
+        gamma_ = io::compressed_file_reader{
+            file, io::default_compression_reader_func};
+        gamma_->seek(location);
+    }
+    refill();
+}
+
+postings_cursor::postings_cursor(
+    std::shared_ptr<const postings_data<term_id, doc_id>> pdata,
+    uint64_t size, const uint64_t* skips)
+    : postings_cursor{pdata->primary_key()}
+{
+    decoded_ = std::move(pdata);
+    size_ = size;
+    skips_ = skips;
+    refill();
+}
+
+term_id postings_cursor::id() const
+{
+    return t_id_;
+}
+
+uint64_t postings_cursor::size() const
+{
+    return size_;
+}
+
+bool postings_cursor::has_next() const
+{
+    return pos_ < len_;
+}
+
+auto postings_cursor::peek() const -> const pair_t &
+{
+    return buffer_[pos_];
+}
+
+auto postings_cursor::next() -> pair_t
+{
+    auto posting = buffer_[pos_++];
+    if (pos_ == len_)
+        refill();
+    return posting;
+}
+
+void postings_cursor::advance_to(doc_id target)
+{
+    if (!has_next() || buffer_[pos_].first >= target)
+        return;
+
+    if (decoded_ && buffer_[len_ - 1].first < target)
+    {
+        // the decoded postings are searched directly
+        const auto& counts = decoded_->counts();
+        decoded_pos_ = static_cast<uint64_t>(
+            std::lower_bound(counts.begin() + decoded_pos_, counts.end(),
+                             target, [](const pair_t& p, doc_id d)
+                             {
+                                 return p.first < d;
+                             }) - counts.begin());
+        refill();
+        return;
+    }
+
+    if (buffer_[len_ - 1].first < target)
+    {
+        auto idx = find_block(target);
+        if (idx == num_blocks())
+        {
+            // nothing left is at least target
+            block_ = util::nullopt;
+            gamma_ = util::nullopt;
+            pos_ = len_ = 0;
+            return;
+        }
+        seek_block(idx);
+    }
+
+    pos_ = static_cast<uint64_t>(
+        std::lower_bound(buffer_ + pos_, buffer_ + len_, target,
+                         [](const pair_t& p, doc_id d)
+                         {
+                             return p.first < d;
+                         }) - buffer_);
+}
+
+uint64_t postings_cursor::read(pair_t* out, uint64_t max)
+{
+    uint64_t num_read = 0;
+    while (num_read < max && has_next())
+    {
+        auto num = std::min(max - num_read, len_ - pos_);
+        std::copy(buffer_ + pos_, buffer_ + pos_ + num, out + num_read);
+        num_read += num;
+        pos_ += num;
+        if (pos_ == len_)
+            refill();
+    }
+    return num_read;
+}
+
+void postings_cursor::read_all(std::vector<pair_t>& out)
+{
+    out.clear();
+    if (has_next())
+        out.reserve(len_ - pos_ + size_ - num_decoded_);
+    while (has_next())
+    {
+        out.insert(out.end(), buffer_ + pos_, buffer_ + len_);
+        pos_ = len_;
+        refill();
+    }
+}
+
+uint64_t postings_cursor::num_blocks() const
+{
+    return (size_ + skip_interval - 1) / skip_interval;
+}
+
+skip_entry postings_cursor::block(uint64_t idx) const
+{
+    auto entry = skips_ + idx * skip_fields;
+    return {entry[0], entry[1], entry[2]};
+}
+
+uint64_t postings_cursor::find_block(doc_id target) const
+{
+    if (!has_next())
+        return num_blocks();
+
+    uint64_t first = 0;
+    if (decoded_)
+    {
+        // postings from a cache may leave some out, so the buffer does
+        // not line up with the blocks; the block is the one that holds
+        // the next posting, or a later one
+        target = std::max(target, buffer_[pos_].first);
+    }
+    else
+    {
+        // blocks are decoded whole, so the buffer holds the current block
+        auto current = (num_decoded_ - 1) / skip_interval;
+        if (buffer_[len_ - 1].first >= target)
+            return current;
+        first = current + 1;
+    }
+
+    // binary search the remaining blocks by their last doc_ids
+    uint64_t last = num_blocks();
+    while (first < last)
+    {
+        auto mid = first + (last - first) / 2;
+        if (skips_[mid * skip_fields] < target)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return first;
+}
+
+void postings_cursor::seek_block(uint64_t idx)
+{
+    // resume decoding just after the end of the block before it
+    auto previous = block(idx - 1);
+    last_id_ = previous.last_id;
+    num_decoded_ = idx * skip_interval;
+    if (block_)
+        block_->seek(previous.next_location);
+    else
+        gamma_->seek(previous.next_location);
+    refill();
+}
+
+void postings_cursor::refill()
+{
+    pos_ = 0;
+    len_ = 0;
+
+    auto remaining = size_ - num_decoded_;
+    if (block_ && remaining >= buffer_size)
+    {
+        uint64_t gaps[buffer_size];
+        uint64_t freqs[buffer_size];
+        block_->next_block(gaps);
+        block_->next_block(freqs);
+
+        // every gap after the first posting's is stored less one
+        for (; len_ < buffer_size; ++len_)
+        {
+            last_id_ += (num_decoded_ + len_ == 0) ? gaps[len_]
+                                                   : gaps[len_] + 1;
+            buffer_[len_] = {doc_id{last_id_},
+                             static_cast<double>(freqs[len_])};
+        }
+    }
+    else if (block_)
+    {
+        for (; len_ < remaining; ++len_)
+        {
+            auto gap = block_->next();
+            last_id_ += (num_decoded_ + len_ == 0) ? gap : gap + 1;
+            buffer_[len_] = {doc_id{last_id_},
+                             static_cast<double>(block_->next())};
+        }
+    }
+    else if (decoded_)
+    {
+        const auto& counts = decoded_->counts();
+        len_ = counts.size() - decoded_pos_;
+        if (len_ > buffer_size)
+            len_ = buffer_size;
+        std::copy(counts.begin() + decoded_pos_,
+                  counts.begin() + decoded_pos_ + len_, buffer_);
+        decoded_pos_ += len_;
+    }
+    else if (gamma_)
+    {
+        while (len_ < buffer_size)
+        {
+            auto gap = gamma_->next();
+            if (gap == delimiter)
+            {
+                gamma_ = util::nullopt;
+                break;
+            }
+
+            last_id_ += gap;
+            buffer_[len_++] = {doc_id{last_id_},
+                               static_cast<double>(gamma_->next())};
+        }
+    }
+
+    num_decoded_ += len_;
+}
+}
+}
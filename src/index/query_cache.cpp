@@ -0,0 +1,112 @@
+/**
+ * @file query_cache.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+
+#include "corpus/document.h"
+#include "index/inverted_index.h"
+#include "index/query_cache.h"
+#include "index/ranker/ranker.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/**
+ * Appends the bytes of a value to a key.
+ * @param key The key to append to
+ * @param value The value to append
+ */
+template <class T>
+void append(std::string& key, const T& value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}
+
+query_cache::query_cache(uint64_t max_size)
+    : cache_{max_size}, hits_{0}, misses_{0}
+{
+    // nothing
+}
+
+auto query_cache::score(inverted_index& idx, ranker& r,
+                        corpus::document& query, uint64_t num_results)
+    -> ranking
+{
+    auto signature = r.signature();
+    if (signature.empty())
+    {
+        ++misses_;
+        return r.score(idx, query, num_results);
+    }
+
+    if (query.counts().empty())
+        idx.tokenize(query);
+
+    auto query_key = key(idx, signature, query);
+    if (auto cached = cache_.find(query_key))
+    {
+        // a ranking holding fewer results than it was scored for holds
+        // every document the query matches
+        const auto& results = *cached->results;
+        if (num_results <= cached->num_results
+            || results.size() < cached->num_results)
+        {
+            ++hits_;
+            auto size = std::min<uint64_t>(num_results, results.size());
+            return ranking(results.begin(), results.begin() + size);
+        }
+    }
+
+    ++misses_;
+    auto results = std::make_shared<const ranking>(
+        r.score(idx, query, num_results));
+    cache_.insert(query_key, entry{num_results, results});
+    return *results;
+}
+
+uint64_t query_cache::hits() const
+{
+    return hits_;
+}
+
+uint64_t query_cache::misses() const
+{
+    return misses_;
+}
+
+void query_cache::clear()
+{
+    cache_.clear();
+}
+
+std::string query_cache::key(const inverted_index& idx,
+                             const std::string& signature,
+                             const corpus::document& query)
+{
+    // the counts are unordered, so the terms are sorted to give identical
+    // queries identical keys
+    std::vector<std::pair<std::string, double>> counts{query.counts().begin(),
+                                                        query.counts().end()};
+    std::sort(counts.begin(), counts.end());
+
+    std::string key;
+    append(key, idx.generation());
+    append(key, static_cast<uint64_t>(signature.length()));
+    key += signature;
+    for (const auto& count : counts)
+    {
+        append(key, static_cast<uint64_t>(count.first.length()));
+        key += count.first;
+        append(key, count.second);
+    }
+    return key;
+}
+}
+}
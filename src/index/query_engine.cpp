@@ -0,0 +1,101 @@
+/**
+ * @file query_engine.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+
+#include "index/query_engine.h"
+#include "parallel/parallel_for.h"
+#include "util/range.h"
+
+namespace meta
+{
+namespace index
+{
+
+double query_engine::batch_result::qps() const
+{
+    if (elapsed <= 0)
+        return 0;
+    return latencies.size() / (elapsed / 1000);
+}
+
+double query_engine::batch_result::latency_percentile(double p) const
+{
+    if (latencies.empty())
+        return 0;
+
+    auto sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+
+    // nearest rank
+    auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+query_engine::query_engine(std::shared_ptr<inverted_index> idx,
+                           const ranker_factory& make_ranker,
+                           size_t num_threads)
+    : idx_{std::move(idx)}, pool_{num_threads}
+{
+    for (const auto& id : pool_.thread_ids())
+    {
+        auto& state = workers_[id];
+        state.scorer = make_ranker();
+        state.analyzer = idx_->clone_analyzer();
+    }
+}
+
+auto query_engine::run(std::vector<corpus::document>& queries,
+                       uint64_t num_results,
+                       const std::function<bool(doc_id d_id)>& filter)
+    -> batch_result
+{
+    batch_result result;
+    result.rankings.resize(queries.size());
+    result.latencies.resize(queries.size());
+    if (queries.empty())
+        return result;
+
+    // queries vary widely in cost, so they are claimed one at a time
+    auto range = util::range<size_t>(0, queries.size() - 1);
+    std::mutex empty_query_mutex;
+    auto start = std::chrono::steady_clock::now();
+    parallel::parallel_for(range.begin(), range.end(), pool_, 1, [&](size_t i)
+                           {
+        auto& state = workers_.at(std::this_thread::get_id());
+        auto query_start = std::chrono::steady_clock::now();
+
+        auto& query = queries[i];
+        if (query.counts().empty())
+            state.analyzer->tokenize(query);
+
+        // ranker::score tokenizes a query with no terms again, using the
+        // index's shared analyzer
+        std::unique_lock<std::mutex> lock{empty_query_mutex, std::defer_lock};
+        if (query.counts().empty())
+            lock.lock();
+        result.rankings[i]
+            = state.scorer->score(*idx_, query, num_results, filter);
+
+        std::chrono::duration<double, std::milli> latency
+            = std::chrono::steady_clock::now() - query_start;
+        result.latencies[i] = latency.count();
+    });
+    std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    result.elapsed = elapsed.count();
+
+    return result;
+}
+
+size_t query_engine::num_threads() const
+{
+    return pool_.size();
+}
+}
+}
@@ -4,7 +4,9 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include "cpptoml.h"
+#include "corpus/document.h"
 #include "index/ranker/absolute_discount.h"
 #include "index/score_data.h"
 
@@ -34,6 +36,71 @@ double absolute_discount::doc_constant(const score_data& sd) const
     return delta_ * unique / sd.doc_size;
 }
 
+namespace
+{
+/**
+ * The absolute discounting score of a term. With this smoothing method,
+ * ps / (doc_constant * pc) is 1 + max(count - delta, 0) / (delta * pc *
+ * doc_unique_terms), which does not depend on the document's length.
+ */
+class absolute_discount_term
+{
+  public:
+    absolute_discount_term(const score_data& sd, double delta)
+        : delta_{delta}, weight_{sd.query_term_weight}
+    {
+        double pc = static_cast<double>(sd.corpus_term_count) / sd.total_terms;
+        inv_mass_ = 1.0 / (delta * pc);
+    }
+
+    /**
+     * @param count The number of times the term appears in the document
+     * @param unique The number of unique terms in the document
+     * @return the score of the term in the document
+     */
+    double operator()(double count, double unique) const
+    {
+        double discounted = std::max(count - delta_, 0.0);
+        return weight_ * std::log(1.0 + discounted * inv_mass_ / unique);
+    }
+
+  private:
+    /// the absolute discounting parameter
+    double delta_;
+    /// the query term weight
+    double weight_;
+    /// the reciprocal of delta * pc
+    double inv_mass_;
+};
+}
+
+double absolute_discount::score_one(const score_data& sd)
+{
+    absolute_discount_term score{sd, delta_};
+    return score(sd.doc_term_count, sd.doc_unique_terms);
+}
+
+void absolute_discount::score_block(const score_data& sd,
+                                    const posting_block& block,
+                                    std::vector<double>& scores)
+{
+    absolute_discount_term score{sd, delta_};
+    for (uint64_t i = 0; i < block.size(); ++i)
+        scores[i] = score(block.doc_term_counts[i], block.doc_unique_terms[i]);
+}
+
+double absolute_discount::max_initial_score(const score_data& sd) const
+{
+    // a document never has more unique terms than terms, so doc_constant
+    // is at most delta
+    return sd.query.length() * std::log(delta_);
+}
+
+std::string absolute_discount::signature() const
+{
+    return make_signature(id, {delta_});
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<absolute_discount>(const cpptoml::table& config)
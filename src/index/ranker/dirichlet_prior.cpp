@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <cmath>
 #include "cpptoml.h"
 #include "index/ranker/dirichlet_prior.h"
 #include "index/score_data.h"
@@ -32,6 +33,60 @@ double dirichlet_prior::doc_constant(const score_data& sd) const
     return mu_ / (sd.doc_size + mu_);
 }
 
+namespace
+{
+/**
+ * The Dirichlet prior score of a term. With this smoothing method,
+ * ps / (doc_constant * pc) is 1 + count / (mu * pc), which does not depend
+ * on the document's length.
+ */
+class dirichlet_term
+{
+  public:
+    dirichlet_term(const score_data& sd, double mu)
+        : weight_{sd.query_term_weight}
+    {
+        double pc = static_cast<double>(sd.corpus_term_count) / sd.total_terms;
+        inv_prior_ = 1.0 / (mu * pc);
+    }
+
+    /**
+     * @param count The number of times the term appears in the document
+     * @return the score of the term in the document
+     */
+    double operator()(double count) const
+    {
+        return weight_ * std::log(1.0 + count * inv_prior_);
+    }
+
+  private:
+    /// the query term weight
+    double weight_;
+    /// the reciprocal of the term's pseudo-count from the prior
+    double inv_prior_;
+};
+}
+
+double dirichlet_prior::score_one(const score_data& sd)
+{
+    dirichlet_term score{sd, mu_};
+    return score(sd.doc_term_count);
+}
+
+void dirichlet_prior::score_block(const score_data& sd,
+                                  const posting_block& block,
+                                  std::vector<double>& scores)
+{
+    dirichlet_term score{sd, mu_};
+    for (uint64_t i = 0; i < block.size(); ++i)
+        scores[i] = score(block.doc_term_counts[i]);
+}
+
+std::string dirichlet_prior::signature() const
+{
+    return make_signature(id, {mu_});
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<dirichlet_prior>(const cpptoml::table& config)
@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <cmath>
 #include "cpptoml.h"
 #include "index/ranker/jelinek_mercer.h"
 #include "index/score_data.h"
@@ -32,6 +33,61 @@ double jelinek_mercer::doc_constant(const score_data&) const
     return lambda_;
 }
 
+namespace
+{
+/**
+ * The Jelinek-Mercer score of a term. With this smoothing method,
+ * ps / (doc_constant * pc) is 1 + (1 - lambda) / (lambda * pc) * count /
+ * doc_size.
+ */
+class jelinek_mercer_term
+{
+  public:
+    jelinek_mercer_term(const score_data& sd, double lambda)
+        : weight_{sd.query_term_weight}
+    {
+        double pc = static_cast<double>(sd.corpus_term_count) / sd.total_terms;
+        scale_ = (1.0 - lambda) / (lambda * pc);
+    }
+
+    /**
+     * @param count The number of times the term appears in the document
+     * @param doc_len The length of the document
+     * @return the score of the term in the document
+     */
+    double operator()(double count, double doc_len) const
+    {
+        return weight_ * std::log(1.0 + scale_ * count / doc_len);
+    }
+
+  private:
+    /// the query term weight
+    double weight_;
+    /// the weight of the document model relative to the collection model
+    double scale_;
+};
+}
+
+double jelinek_mercer::score_one(const score_data& sd)
+{
+    jelinek_mercer_term score{sd, lambda_};
+    return score(sd.doc_term_count, sd.doc_size);
+}
+
+void jelinek_mercer::score_block(const score_data& sd,
+                                 const posting_block& block,
+                                 std::vector<double>& scores)
+{
+    jelinek_mercer_term score{sd, lambda_};
+    for (uint64_t i = 0; i < block.size(); ++i)
+        scores[i] = score(block.doc_term_counts[i], block.doc_sizes[i]);
+}
+
+std::string jelinek_mercer::signature() const
+{
+    return make_signature(id, {lambda_});
+}
+
 template <>
 std::unique_ptr<ranker>
     make_ranker<jelinek_mercer>(const cpptoml::table& config)
@@ -28,5 +28,17 @@ double language_model_ranker::initial_score(const score_data& sd) const
     return sd.query.length() * std::log(doc_constant(sd));
 }
 
+double language_model_ranker::max_score_one(const score_data& sd)
+{
+    // for each smoothing method, ps / doc_constant grows with the term
+    // count and shrinks with the document length and number of unique terms
+    return score_one(sd);
+}
+
+double language_model_ranker::max_initial_score(const score_data& sd) const
+{
+    return initial_score(sd);
+}
+
 }
 }
@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
 #include <cmath>
 #include "index/inverted_index.h"
 #include "index/ranker/okapi_bm25.h"
@@ -20,22 +21,76 @@ okapi_bm25::okapi_bm25(double k1, double b, double k3) : k1_{k1}, b_{b}, k3_{k3}
     /* nothing */
 }
 
-double okapi_bm25::score_one(const score_data& sd)
+namespace
 {
-    double doc_len = sd.idx.doc_size(sd.d_id);
+/**
+ * The BM25 formula with the parts that depend only on the query term
+ * computed once.
+ */
+class bm25_term
+{
+  public:
+    bm25_term(const score_data& sd, double k1, double b, double k3)
+        : length_base_{k1 * (1.0 - b)}, length_scale_{k1 * b / sd.avg_dl}
+    {
+        // add 1.0 to the IDF to ensure that the result is positive; the
+        // difference is taken in floating point so a doc_count above
+        // num_docs can never wrap around
+        double missing = std::max(
+            0.0, static_cast<double>(sd.num_docs) - sd.doc_count);
+        double IDF = std::log(1.0 + (missing + 0.5) / (sd.doc_count + 0.5));
 
-    // add 1.0 to the IDF to ensure that the result is positive
-    double IDF = std::log(
-        1.0 + (sd.num_docs - sd.doc_count + 0.5) / (sd.doc_count + 0.5));
+        double QTF = ((k3 + 1.0) * sd.query_term_weight)
+                     / (k3 + sd.query_term_weight);
 
-    double TF = ((k1_ + 1.0) * sd.doc_term_count)
-                / ((k1_ * ((1.0 - b_) + b_ * doc_len / sd.avg_dl))
-                   + sd.doc_term_count);
+        weight_ = (k1 + 1.0) * IDF * QTF;
+    }
 
-    double QTF = ((k3_ + 1.0) * sd.query_term_weight)
-                 / (k3_ + sd.query_term_weight);
+    /**
+     * @param count The number of times the term appears in the document
+     * @param doc_len The length of the document
+     * @return the score of the term in the document
+     */
+    double operator()(double count, double doc_len) const
+    {
+        double TF = count / (length_base_ + length_scale_ * doc_len + count);
+        return TF * weight_;
+    }
 
-    return TF * IDF * QTF;
+  private:
+    /// the length normalization of an empty document
+    double length_base_;
+    /// the growth of the length normalization with document length
+    double length_scale_;
+    /// the product of IDF, QTF and the TF numerator's constant factor
+    double weight_;
+};
+}
+
+double okapi_bm25::score_one(const score_data& sd)
+{
+    bm25_term score{sd, k1_, b_, k3_};
+    return score(sd.doc_term_count, sd.doc_size);
+}
+
+void okapi_bm25::score_block(const score_data& sd, const posting_block& block,
+                             std::vector<double>& scores)
+{
+    bm25_term score{sd, k1_, b_, k3_};
+    for (uint64_t i = 0; i < block.size(); ++i)
+        scores[i] = score(block.doc_term_counts[i], block.doc_sizes[i]);
+}
+
+double okapi_bm25::max_score_one(const score_data& sd)
+{
+    // the score increases with the term count and decreases with the
+    // document length
+    return score_one(sd);
+}
+
+std::string okapi_bm25::signature() const
+{
+    return make_signature(id, {k1_, b_, k3_});
 }
 
 template <>
@@ -3,6 +3,7 @@
  * @author Sean Massung
  */
 
+#include <cmath>
 #include "index/inverted_index.h"
 #include "index/ranker/pivoted_length.h"
 #include "index/score_data.h"
@@ -19,14 +20,69 @@ pivoted_length::pivoted_length(double s) : s_{s}
     /* nothing */
 }
 
+namespace
+{
+/**
+ * The pivoted length normalization formula with the parts that depend only
+ * on the query term computed once.
+ */
+class pivoted_term
+{
+  public:
+    pivoted_term(const score_data& sd, double s)
+        : norm_base_{1 - s}, norm_scale_{s / sd.avg_dl}
+    {
+        double IDF = std::log((sd.num_docs + 1) / (0.5 + sd.doc_count));
+        weight_ = sd.query_term_weight * IDF;
+    }
+
+    /**
+     * @param count The number of times the term appears in the document
+     * @param doc_len The length of the document
+     * @return the score of the term in the document
+     */
+    double operator()(double count, double doc_len) const
+    {
+        double TF = 1 + std::log(1 + std::log(count));
+        double norm = norm_base_ + norm_scale_ * doc_len;
+        return TF / norm * weight_;
+    }
+
+  private:
+    /// the normalization of an empty document
+    double norm_base_;
+    /// the growth of the normalization with document length
+    double norm_scale_;
+    /// the product of the query term weight and IDF
+    double weight_;
+};
+}
+
 double pivoted_length::score_one(const score_data& sd)
 {
-    double doc_len = sd.idx.doc_size(sd.d_id);
-    double TF = 1 + log(1 + log(sd.doc_term_count));
-    double norm = (1 - s_) + s_ * (doc_len / sd.avg_dl);
-    double IDF = log((sd.num_docs + 1) / (0.5 + sd.doc_count));
+    pivoted_term score{sd, s_};
+    return score(sd.doc_term_count, sd.doc_size);
+}
+
+void pivoted_length::score_block(const score_data& sd,
+                                 const posting_block& block,
+                                 std::vector<double>& scores)
+{
+    pivoted_term score{sd, s_};
+    for (uint64_t i = 0; i < block.size(); ++i)
+        scores[i] = score(block.doc_term_counts[i], block.doc_sizes[i]);
+}
 
-    return TF / norm * sd.query_term_weight * IDF;
+double pivoted_length::max_score_one(const score_data& sd)
+{
+    // the score increases with the term count and decreases with the
+    // document length
+    return score_one(sd);
+}
+
+std::string pivoted_length::signature() const
+{
+    return make_signature(id, {s_});
 }
 
 template <>
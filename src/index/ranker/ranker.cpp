@@ -3,17 +3,236 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
 #include "corpus/document.h"
 #include "index/inverted_index.h"
+#include "index/postings_cursor.h"
 #include "index/postings_data.h"
 #include "index/ranker/ranker.h"
 #include "index/score_data.h"
+#include "util/fixed_heap.h"
 
 namespace meta
 {
 namespace index
 {
 
+namespace
+{
+using doc_pair = std::pair<doc_id, double>;
+
+/// The number of postings scored at once by term-at-a-time processing
+const static constexpr uint64_t max_block_size = 128;
+
+/**
+ * Orders results by decreasing score, breaking ties by increasing doc_id.
+ */
+struct doc_pair_comp
+{
+    bool operator()(const doc_pair& a, const doc_pair& b) const
+    {
+        if (a.second != b.second)
+            return a.second > b.second;
+        return a.first < b.first;
+    }
+};
+
+/**
+ * The best results seen so far, with the worst of them on top.
+ */
+using result_heap = util::fixed_heap<doc_pair, doc_pair_comp>;
+
+/**
+ * A position in the postings list of one query term, along with the
+ * score bounds used to skip over documents during document-at-a-time
+ * query processing. Score bounds are kept for each block of postings
+ * described by the index's skip entries.
+ */
+class term_cursor
+{
+  public:
+    /// The doc_id of an exhausted cursor
+    const static constexpr uint64_t end_doc
+        = std::numeric_limits<uint64_t>::max();
+
+    term_cursor(postings_cursor postings, double query_term_weight,
+                const inverted_index::term_stats& stats)
+        : postings_{std::move(postings)},
+          query_term_weight_{query_term_weight},
+          stats_(stats),
+          max_score_{0}
+    {
+        // nothing
+    }
+
+    /**
+     * Sets the term-based fields of sd to describe this cursor's term.
+     */
+    void load_term(score_data& sd) const
+    {
+        sd.t_id = postings_.id();
+        sd.query_term_weight = query_term_weight_;
+        sd.doc_count = stats_.doc_freq;
+        sd.corpus_term_count = stats_.corpus_count;
+    }
+
+    /**
+     * Computes the score bounds for the whole postings list and for each
+     * of its blocks.
+     * @param r The ranker computing the bounds
+     * @param sd The score_data whose document-based fields hold lower
+     * bounds on document length and number of unique terms
+     */
+    void compute_bounds(ranker& r, score_data& sd)
+    {
+        load_term(sd);
+
+        // the true contribution of a term is never above zero when its
+        // bound is, so clamping keeps the bounds valid
+        sd.doc_term_count = stats_.max_count;
+        max_score_ = std::max(r.max_score_one(sd), 0.0);
+
+        block_max_.resize(postings_.num_blocks());
+        for (uint64_t i = 0; i < block_max_.size(); ++i)
+        {
+            sd.doc_term_count = postings_.block(i).max_count;
+            block_max_[i] = std::max(r.max_score_one(sd), 0.0);
+        }
+    }
+
+    /**
+     * @return the doc_id the cursor is on, or end_doc if it is exhausted
+     */
+    uint64_t doc() const
+    {
+        return postings_.has_next()
+                   ? static_cast<uint64_t>(postings_.peek().first)
+                   : end_doc;
+    }
+
+    /**
+     * @return the count of the term in the current document
+     */
+    uint64_t count() const
+    {
+        return static_cast<uint64_t>(postings_.peek().second);
+    }
+
+    /**
+     * Moves to the next posting.
+     */
+    void next()
+    {
+        postings_.next();
+    }
+
+    /**
+     * Moves to the first posting whose doc_id is at least target.
+     */
+    void advance_to(uint64_t target)
+    {
+        postings_.advance_to(doc_id{target});
+    }
+
+    /**
+     * @return an upper bound on this term's contribution to any document
+     */
+    double max_score() const
+    {
+        return max_score_;
+    }
+
+    /**
+     * Finds the block that holds the first posting whose doc_id is at
+     * least target, without moving the cursor.
+     * @param target The doc_id to look for
+     * @param last_doc Set to the last doc_id in that block (or end_doc if
+     * there is no such block)
+     * @return the score bound of that block
+     */
+    double block_max_score(uint64_t target, uint64_t& last_doc) const
+    {
+        auto block = postings_.find_block(doc_id{target});
+        if (block == block_max_.size())
+        {
+            last_doc = end_doc;
+            return 0;
+        }
+        last_doc = postings_.block(block).last_id;
+        return block_max_[block];
+    }
+
+  private:
+    /// The postings being traversed
+    postings_cursor postings_;
+
+    /// The weight of the term in the query
+    double query_term_weight_;
+
+    /// The statistics of the term being traversed
+    inverted_index::term_stats stats_;
+
+    /// The score bound of each block
+    std::vector<double> block_max_;
+
+    /// The score bound for the whole postings list
+    double max_score_;
+};
+
+/**
+ * @param idx The index being searched
+ * @param t_id A query term
+ * @param term The text of the query term
+ * @param stats The statistics of the whole collection, or nullptr
+ * @return the statistics to score the term with: its counts in the whole
+ * collection when they are known, otherwise its counts over the documents
+ * of idx that have not been deleted, and its largest count in a single
+ * document of idx, which bounds its scores there
+ */
+inverted_index::term_stats term_stats(const inverted_index& idx, term_id t_id,
+                                      const std::string& term,
+                                      const collection_stats* stats)
+{
+    if (stats)
+    {
+        auto it = stats->terms.find(term);
+        if (it != stats->terms.end())
+        {
+            auto t_stats = idx.stats(t_id);
+            t_stats.doc_freq = it->second.doc_freq;
+            t_stats.corpus_count = it->second.corpus_count;
+            return t_stats;
+        }
+    }
+    return idx.live_stats(t_id);
+}
+
+/**
+ * Determines whether a score bound could still place a document in the
+ * results. Bounds are inflated slightly so that differences in rounding
+ * between a bound and the score it bounds never cause a document to be
+ * skipped incorrectly.
+ * @param bound The upper bound on a document's score
+ * @param pq The best results so far
+ */
+bool may_enter(double bound, const result_heap& pq)
+{
+    if (!pq.full())
+        return true;
+    return bound + 1e-9 * (1.0 + std::abs(bound)) > pq.top().second;
+}
+}
+
+ranker::ranker() : strategy_{query_strategy::term_at_a_time}
+{
+    /* nothing */
+}
+
 std::vector<std::pair<doc_id, double>>
 ranker::score(inverted_index& idx, corpus::document& query,
               uint64_t num_results /* = 10 */,
@@ -22,64 +241,316 @@ ranker::score(inverted_index& idx, corpus::document& query,
     if (query.counts().empty())
         idx.tokenize(query);
 
-    score_data sd{idx,            idx.avg_doc_length(),
-                  idx.num_docs(), idx.total_corpus_terms(),
+    score_data sd{idx, idx.avg_doc_length(),
+                  idx.num_docs() - idx.num_deleted(),
+                  idx.total_corpus_terms(), query};
+    return score(sd, nullptr, num_results, filter);
+}
+
+std::vector<std::pair<doc_id, double>>
+ranker::score(inverted_index& idx, corpus::document& query,
+              const collection_stats& stats, uint64_t num_results /* = 10 */,
+              const std::function<bool(doc_id d_id)>& filter /* return true */)
+{
+    if (query.counts().empty())
+        idx.tokenize(query);
+
+    score_data sd{idx, stats.avg_dl, stats.num_docs, stats.total_terms,
                   query};
+    return score(sd, &stats, num_results, filter);
+}
+
+std::vector<std::pair<doc_id, double>>
+ranker::score(score_data& sd, const collection_stats* stats,
+              uint64_t num_results, const std::function<bool(doc_id)>& filter)
+{
+    auto& idx = sd.idx;
+
+    // the postings still hold deleted documents, so they are filtered out
+    std::function<bool(doc_id)> live_filter;
+    if (idx.num_deleted() > 0)
+    {
+        live_filter = [&](doc_id d_id)
+        {
+            return !idx.is_deleted(d_id) && filter(d_id);
+        };
+    }
+    const auto& docs_filter = live_filter ? live_filter : filter;
+
+    // each term is looked up once, in the order the strategies visit them
+    term_ids_.clear();
+    for (auto& tpair : sd.query.counts())
+        term_ids_.push_back(idx.get_term_id(tpair.first));
+
+    // every term's postings start being read in before any are scored, so
+    // a cold index waits on the disk about once rather than once per term;
+    // a single term has no reads to overlap
+    if (term_ids_.size() > 1)
+    {
+        for (const auto& t_id : term_ids_)
+            idx.prefetch(t_id);
+    }
+
+    if (strategy_ == query_strategy::term_at_a_time)
+        return score_term_at_a_time(sd, stats, num_results, docs_filter);
+    return score_document_at_a_time(sd, stats, num_results, docs_filter,
+                                    strategy_
+                                        == query_strategy::block_max_wand);
+}
+
+std::vector<std::pair<doc_id, double>>
+ranker::score_term_at_a_time(score_data& sd, const collection_stats* stats,
+                             uint64_t num_results,
+                             const std::function<bool(doc_id)>& filter)
+{
+    auto& idx = sd.idx;
 
     // zeros out elements and (if necessary) resizes the vector; this eliminates
     // constructing a new vector each query for the same index
-    results_.assign(sd.num_docs, std::numeric_limits<double>::lowest());
+    results_.assign(idx.num_docs(), std::numeric_limits<double>::lowest());
 
-    for (auto& tpair : query.counts())
+    uint64_t term = 0;
+    for (auto& tpair : sd.query.counts())
     {
-        term_id t_id{idx.get_term_id(tpair.first)};
-        auto pdata = idx.search_primary(t_id);
-        sd.doc_count = pdata->counts().size();
+        auto t_id = term_ids_[term++];
+        idx.postings(t_id).read_all(postings_);
+        auto t_stats = term_stats(idx, t_id, tpair.first, stats);
+        sd.doc_count = t_stats.doc_freq;
         sd.t_id = t_id;
         sd.query_term_weight = tpair.second;
-        sd.corpus_term_count = idx.total_num_occurences(sd.t_id);
-        for (auto& dpair : pdata->counts())
+        sd.corpus_term_count = t_stats.corpus_count;
+        for (uint64_t start = 0; start < postings_.size();
+             start += max_block_size)
         {
-            sd.d_id = dpair.first;
-            sd.doc_term_count = dpair.second;
-            sd.doc_size = idx.doc_size(dpair.first);
-            sd.doc_unique_terms = idx.unique_terms(dpair.first);
+            auto size = std::min<uint64_t>(max_block_size,
+                                           postings_.size() - start);
+            load_block(idx, start, size);
+            block_scores_.resize(size);
+            score_block(sd, block_, block_scores_);
+
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                auto d_id = block_.d_ids[i];
 
-            // if this is the first time we've seen this document, compute
-            // its initial score
-            if (results_[dpair.first] == std::numeric_limits<double>::lowest())
-                results_[dpair.first] = initial_score(sd);
+                // if this is the first time we've seen this document,
+                // compute its initial score
+                if (results_[d_id] == std::numeric_limits<double>::lowest())
+                {
+                    sd.d_id = d_id;
+                    sd.doc_term_count = postings_[start + i].second;
+                    sd.doc_size = idx.doc_size(d_id);
+                    sd.doc_unique_terms = idx.unique_terms(d_id);
+                    results_[d_id] = initial_score(sd);
+                }
 
-            results_[dpair.first] += score_one(sd);
+                results_[d_id] += block_scores_[i];
+            }
         }
     }
 
-    using doc_pair = std::pair<doc_id, double>;
-    auto doc_pair_comp = [](const doc_pair& a, const doc_pair& b)
-    { return a.second > b.second; };
-
-    std::priority_queue<doc_pair,
-                        std::vector<doc_pair>,
-                        decltype(doc_pair_comp)> pq{doc_pair_comp};
+    // the filter is only consulted for documents that would make it into
+    // the results
+    result_heap pq{num_results};
     for (uint64_t id = 0; id < results_.size(); ++id)
     {
-        if (!filter(doc_id{id}))
+        doc_pair result{doc_id{id}, results_[id]};
+        if (pq.would_keep(result) && filter(result.first))
+            pq.push(result);
+    }
+
+    return pq.extract_top();
+}
+
+std::vector<std::pair<doc_id, double>>
+ranker::score_document_at_a_time(score_data& sd,
+                                 const collection_stats* stats,
+                                 uint64_t num_results,
+                                 const std::function<bool(doc_id)>& filter,
+                                 bool block_max)
+{
+    if (num_results == 0)
+        return {};
+
+    auto& idx = sd.idx;
+    result_heap pq{num_results};
+
+    // cursors are kept in query order so that each document's score is
+    // summed in the same order as term-at-a-time processing would
+    std::vector<term_cursor> cursors;
+    cursors.reserve(sd.query.counts().size());
+    uint64_t term = 0;
+    for (auto& tpair : sd.query.counts())
+    {
+        auto t_id = term_ids_[term++];
+        cursors.emplace_back(idx.postings(t_id), tpair.second,
+                             term_stats(idx, t_id, tpair.first, stats));
+    }
+
+    // the most favorable document possible
+    sd.doc_size = idx.min_doc_length();
+    sd.doc_unique_terms = 1;
+    for (auto& cur : cursors)
+        cur.compute_bounds(*this, sd);
+    auto max_initial = max_initial_score(sd);
+
+    // cursor indices, sorted by current doc_id
+    std::vector<uint64_t> order(cursors.size());
+    for (uint64_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    while (true)
+    {
+        std::sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b)
+                  {
+                      return cursors[a].doc() < cursors[b].doc();
+                  });
+
+        // find the pivot: the first document whose bound could place it
+        // in the results; no document before it can be
+        double bound = max_initial;
+        uint64_t pivot = order.size();
+        for (uint64_t i = 0; i < order.size(); ++i)
+        {
+            if (cursors[order[i]].doc() == term_cursor::end_doc)
+                break;
+            bound += cursors[order[i]].max_score();
+            if (may_enter(bound, pq))
+            {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == order.size())
+            break;
+
+        auto pivot_doc = cursors[order[pivot]].doc();
+
+        // every cursor on the pivot document contributes to its score
+        auto last = pivot;
+        while (last + 1 < order.size()
+               && cursors[order[last + 1]].doc() == pivot_doc)
+            ++last;
+
+        if (block_max)
+        {
+            double block_bound = max_initial;
+            auto next_doc = last + 1 < order.size()
+                                ? cursors[order[last + 1]].doc()
+                                : term_cursor::end_doc;
+            for (uint64_t i = 0; i <= last; ++i)
+            {
+                uint64_t last_doc;
+                block_bound
+                    += cursors[order[i]].block_max_score(pivot_doc, last_doc);
+                if (last_doc != term_cursor::end_doc)
+                    next_doc = std::min(next_doc, last_doc + 1);
+            }
+
+            // no document up to the end of the current blocks can make it
+            // into the results, so jump past them
+            if (!may_enter(block_bound, pq))
+            {
+                for (uint64_t i = 0; i <= last; ++i)
+                {
+                    if (cursors[order[i]].doc() < next_doc)
+                        cursors[order[i]].advance_to(next_doc);
+                }
+                continue;
+            }
+        }
+
+        if (cursors[order[0]].doc() != pivot_doc)
+        {
+            // skip the documents before the pivot
+            for (uint64_t i = 0; i < pivot; ++i)
+                cursors[order[i]].advance_to(pivot_doc);
             continue;
+        }
+
+        if (filter(doc_id{pivot_doc}))
+        {
+            sd.d_id = doc_id{pivot_doc};
+            sd.doc_size = idx.doc_size(sd.d_id);
+            sd.doc_unique_terms = idx.unique_terms(sd.d_id);
+
+            bool first = true;
+            double score = 0;
+            for (auto& cur : cursors)
+            {
+                if (cur.doc() != pivot_doc)
+                    continue;
+                cur.load_term(sd);
+                sd.doc_term_count = cur.count();
+                if (first)
+                {
+                    score = initial_score(sd);
+                    first = false;
+                }
+                score += score_one(sd);
+            }
+
+            // documents arrive in increasing doc_id order, so a document
+            // with the same score as the worst result never replaces it
+            pq.emplace(sd.d_id, score);
+        }
 
-        pq.emplace(doc_id{id}, results_[id]);
-        if (pq.size() > num_results)
-            pq.pop();
+        for (uint64_t i = 0; i <= last; ++i)
+            cursors[order[i]].next();
     }
 
-    std::vector<doc_pair> sorted;
-    while (!pq.empty())
+    // as with term-at-a-time processing, fill any remaining slots with
+    // unmatched documents. Nothing is skipped until the results are full,
+    // so here every matched document that passes the filter is already in
+    // the results.
+    if (!pq.full())
     {
-        sorted.emplace_back(pq.top());
-        pq.pop();
+        std::vector<uint64_t> matched;
+        for (auto& result : pq)
+            matched.push_back(result.first);
+        std::sort(matched.begin(), matched.end());
+
+        for (uint64_t id = 0; id < idx.num_docs() && !pq.full(); ++id)
+        {
+            if (std::binary_search(matched.begin(), matched.end(), id)
+                || !filter(doc_id{id}))
+                continue;
+            pq.emplace(doc_id{id}, std::numeric_limits<double>::lowest());
+        }
+    }
+
+    return pq.extract_top();
+}
+
+void ranker::load_block(const inverted_index& idx, uint64_t start,
+                        uint64_t size)
+{
+    block_.d_ids.resize(size);
+    block_.doc_term_counts.resize(size);
+    block_.doc_sizes.resize(size);
+    block_.doc_unique_terms.resize(size);
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        auto d_id = postings_[start + i].first;
+        block_.d_ids[i] = d_id;
+        block_.doc_term_counts[i] = postings_[start + i].second;
+        block_.doc_sizes[i] = idx.doc_size(d_id);
+        block_.doc_unique_terms[i] = idx.unique_terms(d_id);
     }
-    std::reverse(sorted.begin(), sorted.end());
+}
 
-    return sorted;
+void ranker::score_block(const score_data& sd, const posting_block& block,
+                         std::vector<double>& scores)
+{
+    auto doc_sd = sd;
+    for (uint64_t i = 0; i < block.size(); ++i)
+    {
+        doc_sd.d_id = block.d_ids[i];
+        doc_sd.doc_term_count = static_cast<uint64_t>(block.doc_term_counts[i]);
+        doc_sd.doc_size = static_cast<uint64_t>(block.doc_sizes[i]);
+        doc_sd.doc_unique_terms
+            = static_cast<uint64_t>(block.doc_unique_terms[i]);
+        scores[i] = score_one(doc_sd);
+    }
 }
 
 double ranker::initial_score(const score_data&) const
@@ -87,5 +558,39 @@ double ranker::initial_score(const score_data&) const
     return 0.0;
 }
 
+double ranker::max_score_one(const score_data&)
+{
+    return std::numeric_limits<double>::infinity();
+}
+
+double ranker::max_initial_score(const score_data&) const
+{
+    return 0.0;
+}
+
+void ranker::strategy(query_strategy strategy)
+{
+    strategy_ = strategy;
+}
+
+query_strategy ranker::strategy() const
+{
+    return strategy_;
+}
+std::string ranker::signature() const
+{
+    return "";
+}
+
+std::string ranker::make_signature(const std::string& id,
+                                   std::initializer_list<double> params)
+{
+    std::ostringstream signature;
+    signature << id << std::setprecision(
+                           std::numeric_limits<double>::max_digits10);
+    for (const auto& param : params)
+        signature << ' ' << param;
+    return signature.str();
+}
 }
 }
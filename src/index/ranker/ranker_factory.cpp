@@ -34,7 +34,22 @@ std::unique_ptr<ranker> make_ranker(const cpptoml::table& config)
     if (!function)
         throw ranker_factory::exception{
             "ranking-function required to construct a ranker"};
-    return ranker_factory::get().create(*function, config);
+    auto ranker = ranker_factory::get().create(*function, config);
+
+    if (auto strategy = config.get_as<std::string>("query-strategy"))
+    {
+        if (*strategy == "term-at-a-time")
+            ranker->strategy(query_strategy::term_at_a_time);
+        else if (*strategy == "wand")
+            ranker->strategy(query_strategy::wand);
+        else if (*strategy == "block-max-wand")
+            ranker->strategy(query_strategy::block_max_wand);
+        else
+            throw ranker_factory::exception{"unknown query-strategy: "
+                                            + *strategy};
+    }
+
+    return ranker;
 }
 }
 }
@@ -0,0 +1,435 @@
+/**
+ * @file segmented_index.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "corpus/corpus.h"
+#include "index/ranker/ranker.h"
+#include "index/segmented_index.h"
+#include "util/filesystem.h"
+#include "util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+segmented_index::segmented_index(const std::string& config_file,
+                                 uint64_t merge_factor, size_t num_threads)
+    : merge_factor_{merge_factor}, next_segment_{0}, pool_{num_threads}
+{
+    if (merge_factor_ < 2)
+        throw segmented_index_exception{"merge factor must be at least 2"};
+
+    auto config = cpptoml::parse_file(config_file);
+    auto name = config.get_as<std::string>("inverted-index");
+    if (!name)
+        throw segmented_index_exception{
+            "inverted-index missing from configuration file"};
+    index_name_ = *name;
+    config_file_ = index_name_ + "/config.toml";
+
+    filesystem::make_directory(index_name_);
+    if (!filesystem::file_exists(index_name_ + "/segments"))
+    {
+        LOG(info) << "Creating segmented index: " << index_name_ << ENDLG;
+        filesystem::copy_file(config_file, config_file_);
+        save_manifest();
+        return;
+    }
+
+    LOG(info) << "Loading segmented index from disk: " << index_name_
+              << ENDLG;
+
+    std::ifstream manifest{index_name_ + "/segments"};
+    manifest >> next_segment_;
+    std::string segment_name;
+    std::unordered_set<std::string> listed;
+    while (manifest >> segment_name)
+    {
+        auto idx = make_segment(segment_name);
+        if (!idx->valid())
+            throw segmented_index_exception{"segment " + segment_name
+                                            + " is incomplete"};
+        idx->load_index();
+        segments_.push_back({segment_name, idx, doc_id{end_doc()}});
+        listed.insert(segment_name);
+    }
+
+    // every segment name handed out is saved before its directory is
+    // made, so this finds what is left of interrupted builds and merges,
+    // and of merged segments that were not removed yet
+    for (uint64_t i = 0; i < next_segment_; ++i)
+    {
+        auto name = "segment-" + std::to_string(i);
+        if (listed.find(name) == listed.end())
+            filesystem::delete_directory(index_name_ + "/" + name);
+    }
+
+    // pick up any merges that were interrupted
+    std::lock_guard<std::mutex> lock{mutex_};
+    schedule_merges();
+}
+
+segmented_index::~segmented_index()
+{
+    try
+    {
+        wait_for_merges();
+    }
+    catch (...)
+    {
+        // a failed merge leaves the segments it would have replaced
+    }
+}
+
+std::string segmented_index::index_name() const
+{
+    return index_name_;
+}
+
+doc_id segmented_index::add(corpus::corpus& docs)
+{
+    if (docs.size() == 0)
+        throw segmented_index_exception{"no documents to add"};
+
+    std::string name;
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        name = next_name();
+    }
+
+    // the segment is built without holding the lock, so it may be
+    // searched and merged in the meantime
+    auto idx = make_segment(name);
+    idx->create_index(config_file_, docs);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    doc_id first_doc{end_doc()};
+    segments_.push_back({name, idx, first_doc});
+    save_manifest();
+    schedule_merges();
+    return first_doc;
+}
+
+void segmented_index::delete_doc(doc_id d_id)
+{
+    // a merge replacing the segment must not start copying its deletions
+    // before this one is made
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    location.first.index->delete_doc(location.second);
+}
+
+bool segmented_index::is_deleted(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->is_deleted(location.second);
+}
+
+uint64_t segmented_index::num_deleted() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    uint64_t num_deleted = 0;
+    for (const auto& seg : segments_)
+        num_deleted += seg.index->num_deleted();
+    return num_deleted;
+}
+
+void segmented_index::compact()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    for (uint64_t i = 0; i < segments_.size(); ++i)
+    {
+        const auto& seg = segments_[i];
+        if (seg.index->num_deleted() > 0
+            && merging_.find(seg.name) == merging_.end())
+            start_merge(i, i + 1);
+    }
+}
+
+void segmented_index::wait_for_merges()
+{
+    while (true)
+    {
+        std::future<void> merge;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (merges_.empty())
+                return;
+            merge = std::move(merges_.back());
+            merges_.pop_back();
+        }
+        merge.get();
+    }
+}
+
+auto segmented_index::segments() const -> std::vector<segment>
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return segments_;
+}
+
+uint64_t segmented_index::num_segments() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return segments_.size();
+}
+
+std::vector<std::pair<doc_id, double>>
+    segmented_index::score(ranker& r, corpus::document& query,
+                           uint64_t num_results) const
+{
+    auto segs = segments();
+    if (segs.empty())
+        return {};
+
+    // every segment is built with the same configuration, so any of their
+    // analyzers tokenizes the query the same way
+    if (query.counts().empty())
+        segs.front().index->tokenize(query);
+    auto stats = query_stats(segs, query);
+
+    using doc_pair = std::pair<doc_id, double>;
+    auto comp = [](const doc_pair& a, const doc_pair& b)
+    {
+        if (a.second != b.second)
+            return a.second > b.second;
+        return a.first < b.first;
+    };
+
+    util::fixed_heap<doc_pair, decltype(comp)> results{num_results, comp};
+    for (const auto& seg : segs)
+    {
+        for (const auto& result :
+             r.score(*seg.index, query, stats, num_results))
+            results.emplace(doc_id{seg.first_doc + result.first},
+                            result.second);
+    }
+    return results.extract_top();
+}
+
+uint64_t segmented_index::num_docs() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return end_doc();
+}
+
+std::string segmented_index::doc_path(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->doc_path(location.second);
+}
+
+std::string segmented_index::doc_name(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->doc_name(location.second);
+}
+
+uint64_t segmented_index::doc_size(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->doc_size(location.second);
+}
+
+class_label segmented_index::label(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->label(location.second);
+}
+
+uint64_t segmented_index::unique_terms(doc_id d_id) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto location = locate(d_id);
+    return location.first.index->unique_terms(location.second);
+}
+
+collection_stats
+    segmented_index::query_stats(const std::vector<segment>& segs,
+                                 const corpus::document& query) const
+{
+    collection_stats stats{0, 0, 0, {}};
+    for (const auto& seg : segs)
+    {
+        stats.num_docs += seg.index->num_docs() - seg.index->num_deleted();
+        stats.total_terms += seg.index->total_corpus_terms();
+    }
+    if (stats.num_docs > 0)
+        stats.avg_dl = static_cast<double>(stats.total_terms) / stats.num_docs;
+
+    for (const auto& count : query.counts())
+    {
+        collection_stats::term_counts counts{0, 0};
+        for (const auto& seg : segs)
+        {
+            auto& idx = *seg.index;
+            auto t_stats = idx.live_stats(idx.get_term_id(count.first));
+            counts.doc_freq += t_stats.doc_freq;
+            counts.corpus_count += t_stats.corpus_count;
+        }
+        stats.terms[count.first] = counts;
+    }
+    return stats;
+}
+
+auto segmented_index::locate(doc_id d_id) const -> std::pair<segment, doc_id>
+{
+    if (d_id >= end_doc())
+        throw segmented_index_exception{"doc_id " + std::to_string(d_id)
+                                        + " is not in the index"};
+
+    // the last segment whose first document is not after d_id
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), d_id,
+                               [](doc_id id, const segment& seg)
+                               {
+                                   return id < seg.first_doc;
+                               });
+    --it;
+    return {*it, doc_id{d_id - it->first_doc}};
+}
+
+uint64_t segmented_index::end_doc() const
+{
+    if (segments_.empty())
+        return 0;
+    return segments_.back().first_doc + segments_.back().index->num_docs();
+}
+
+std::shared_ptr<inverted_index>
+    segmented_index::make_segment(const std::string& name) const
+{
+    auto config = cpptoml::parse_file(config_file_);
+    auto path = index_name_ + "/" + name;
+    filesystem::make_directory(path);
+
+    // can't use std::make_shared here since the constructor is protected
+    return std::shared_ptr<inverted_index>{new inverted_index(config, path)};
+}
+
+std::string segmented_index::next_name()
+{
+    auto name = "segment-" + std::to_string(next_segment_++);
+
+    // the name is saved as used before its directory exists, so a crash
+    // while the segment is written never leads to the name being reused
+    save_manifest();
+    return name;
+}
+
+void segmented_index::save_manifest() const
+{
+    // write a new list and swap it in, so a crash leaves one list or the
+    // other
+    auto filename = index_name_ + "/segments";
+    {
+        std::ofstream manifest{filename + ".tmp"};
+        manifest << next_segment_ << '\n';
+        for (const auto& seg : segments_)
+            manifest << seg.name << '\n';
+    }
+    filesystem::rename_file(filename + ".tmp", filename);
+}
+
+void segmented_index::schedule_merges()
+{
+    auto tier = [&](const segment& seg)
+    {
+        uint64_t tier = 0;
+        for (auto size = seg.index->num_docs(); size >= merge_factor_;
+             size /= merge_factor_)
+            ++tier;
+        return tier;
+    };
+
+    uint64_t i = 0;
+    while (i + merge_factor_ <= segments_.size())
+    {
+        auto j = i;
+        while (j < segments_.size() && j - i < merge_factor_
+               && merging_.find(segments_[j].name) == merging_.end()
+               && tier(segments_[j]) == tier(segments_[i]))
+            ++j;
+
+        // no run that starts before j can be long enough
+        if (j - i < merge_factor_)
+        {
+            i = std::max(j, i + 1);
+            continue;
+        }
+
+        start_merge(i, j);
+        i = j;
+    }
+}
+
+void segmented_index::start_merge(uint64_t first, uint64_t last)
+{
+    std::vector<segment> run{segments_.begin() + first,
+                             segments_.begin() + last};
+    for (const auto& seg : run)
+        merging_.insert(seg.name);
+    auto name = next_name();
+    merges_.push_back(pool_.submit_task([this, run, name]()
+                                        {
+        merge(run, name);
+    }));
+}
+
+void segmented_index::merge(const std::vector<segment>& run,
+                            const std::string& name)
+{
+    std::vector<const inverted_index*> indexes;
+    for (const auto& seg : run)
+        indexes.push_back(seg.index.get());
+
+    auto idx = make_segment(name);
+    idx->merge_index(config_file_, indexes);
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        // segments are only ever appended or replaced by runs that are not
+        // being merged, so the run is still in one piece
+        auto first = std::find_if(segments_.begin(), segments_.end(),
+                                  [&](const segment& seg)
+                                  {
+                                      return seg.name == run.front().name;
+                                  });
+        first = segments_.erase(first, first + run.size());
+        segments_.insert(first, {name, idx, run.front().first_doc});
+
+        // documents may have been deleted from the run while it was being
+        // merged
+        doc_id d_id{0};
+        for (const auto& seg : run)
+        {
+            for (doc_id id{0}; id < seg.index->num_docs(); ++id, ++d_id)
+            {
+                if (seg.index->is_deleted(id))
+                    idx->delete_doc(d_id);
+            }
+        }
+        for (const auto& seg : run)
+            merging_.erase(seg.name);
+
+        save_manifest();
+        schedule_merges();
+    }
+
+    // readers may still hold the old segments, whose files stay mapped
+    // until they are released
+    for (const auto& seg : run)
+        filesystem::delete_directory(index_name_ + "/" + seg.name);
+}
+}
+}
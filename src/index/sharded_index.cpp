@@ -0,0 +1,303 @@
+/**
+ * @file sharded_index.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <future>
+
+#include "corpus/corpus.h"
+#include "corpus/document.h"
+#include "index/sharded_index.h"
+#include "util/filesystem.h"
+#include "util/fixed_heap.h"
+
+namespace meta
+{
+namespace index
+{
+
+namespace
+{
+/**
+ * The next documents of a corpus, renumbered from zero.
+ */
+class corpus_range : public meta::corpus::corpus
+{
+  public:
+    /**
+     * @param docs The corpus to read documents from
+     * @param size The number of documents to read
+     */
+    corpus_range(meta::corpus::corpus& docs, uint64_t size)
+        : meta::corpus::corpus{docs.encoding()},
+          docs_(docs),
+          size_{size},
+          next_{0}
+    {
+        // nothing
+    }
+
+    bool has_next() const override
+    {
+        return next_ < size_ && docs_.has_next();
+    }
+
+    meta::corpus::document next() override
+    {
+        auto doc = docs_.next();
+        doc.id(doc_id{next_++});
+        return doc;
+    }
+
+    uint64_t size() const override
+    {
+        return size_;
+    }
+
+  private:
+    /// the corpus documents are read from
+    meta::corpus::corpus& docs_;
+    /// the number of documents to read
+    uint64_t size_;
+    /// the number of documents read so far
+    uint64_t next_;
+};
+}
+
+sharded_index::sharded_index(const std::string& config_file,
+                             uint64_t num_shards, size_t num_threads)
+    : pool_{num_threads}
+{
+    auto config = cpptoml::parse_file(config_file);
+    auto name = config.get_as<std::string>("inverted-index");
+    if (!name)
+        throw sharded_index_exception{
+            "inverted-index missing from configuration file"};
+    index_name_ = *name;
+    config_file_ = index_name_ + "/config.toml";
+
+    if (!filesystem::file_exists(index_name_ + "/shards"))
+    {
+        LOG(info) << "Creating sharded index: " << index_name_ << ENDLG;
+        filesystem::make_directory(index_name_);
+        filesystem::copy_file(config_file, config_file_);
+        build(num_shards);
+    }
+    else
+    {
+        LOG(info) << "Loading sharded index from disk: " << index_name_
+                  << ENDLG;
+
+        std::ifstream manifest{index_name_ + "/shards"};
+        manifest >> num_shards;
+        doc_id first_doc{0};
+        for (uint64_t s = 0; s < num_shards; ++s)
+        {
+            auto idx = make_shard(s);
+            if (!idx->valid())
+                throw sharded_index_exception{"shard " + std::to_string(s)
+                                              + " is incomplete"};
+            idx->load_index();
+            shards_.push_back({idx, first_doc});
+            first_doc = doc_id{first_doc + idx->num_docs()};
+        }
+    }
+
+    stats_.num_docs = 0;
+    stats_.total_terms = 0;
+    for (const auto& shard : shards_)
+    {
+        stats_.num_docs += shard.index->num_docs() - shard.index->num_deleted();
+        stats_.total_terms += shard.index->total_corpus_terms();
+    }
+    stats_.avg_dl = static_cast<double>(stats_.total_terms) / stats_.num_docs;
+}
+
+std::string sharded_index::index_name() const
+{
+    return index_name_;
+}
+
+auto sharded_index::shards() const -> const std::vector<shard> &
+{
+    return shards_;
+}
+
+uint64_t sharded_index::num_shards() const
+{
+    return shards_.size();
+}
+
+auto sharded_index::score(const ranker_factory& make_ranker,
+                          corpus::document& query, uint64_t num_results,
+                          const std::function<bool(doc_id d_id)>& filter)
+    -> ranking
+{
+    // every shard is built with the same configuration, so any of their
+    // analyzers tokenizes the query the same way
+    if (query.counts().empty())
+    {
+        std::lock_guard<std::mutex> lock{tokenize_mutex_};
+        shards_.front().index->tokenize(query);
+    }
+    auto stats = query_stats(query);
+
+    std::vector<std::unique_ptr<ranker>> rankers;
+    for (uint64_t s = 0; s < shards_.size(); ++s)
+        rankers.push_back(make_ranker());
+
+    std::vector<std::future<ranking>> rankings;
+    for (uint64_t i = 0; i < shards_.size(); ++i)
+    {
+        auto scorer = rankers[i].get();
+        const auto& s = shards_[i];
+        rankings.push_back(pool_.submit_task([&, scorer, s]()
+                                             {
+            auto shard_query = query;
+            return scorer->score(*s.index, shard_query, stats, num_results,
+                                 [&](doc_id d_id)
+                                 {
+                return filter(doc_id{s.first_doc + d_id});
+            });
+        }));
+    }
+
+    using doc_pair = std::pair<doc_id, double>;
+    auto comp = [](const doc_pair& a, const doc_pair& b)
+    {
+        if (a.second != b.second)
+            return a.second > b.second;
+        return a.first < b.first;
+    };
+
+    // every shard has already been waited for when an exception escapes,
+    // since their tasks refer to this function's locals
+    util::fixed_heap<doc_pair, decltype(comp)> results{num_results, comp};
+    std::exception_ptr error;
+    for (uint64_t s = 0; s < shards_.size(); ++s)
+    {
+        try
+        {
+            for (const auto& result : rankings[s].get())
+                results.emplace(doc_id{shards_[s].first_doc + result.first},
+                                result.second);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+    return results.extract_top();
+}
+
+uint64_t sharded_index::num_docs() const
+{
+    if (shards_.empty())
+        return 0;
+    return shards_.back().first_doc + shards_.back().index->num_docs();
+}
+
+std::string sharded_index::doc_path(doc_id d_id) const
+{
+    auto location = locate(d_id);
+    return location.first.index->doc_path(location.second);
+}
+
+std::string sharded_index::doc_name(doc_id d_id) const
+{
+    auto location = locate(d_id);
+    return location.first.index->doc_name(location.second);
+}
+
+uint64_t sharded_index::doc_size(doc_id d_id) const
+{
+    auto location = locate(d_id);
+    return location.first.index->doc_size(location.second);
+}
+
+class_label sharded_index::label(doc_id d_id) const
+{
+    auto location = locate(d_id);
+    return location.first.index->label(location.second);
+}
+
+void sharded_index::build(uint64_t num_shards)
+{
+    if (num_shards == 0)
+        throw sharded_index_exception{"a sharded index needs a shard"};
+
+    auto docs = corpus::corpus::load(config_file_);
+    auto num_docs = docs->size();
+    if (num_docs < num_shards)
+        throw sharded_index_exception{"fewer documents than shards"};
+
+    // shards are built one after another from a single pass over the
+    // corpus; each builds with as many threads as the configuration allows
+    doc_id first_doc{0};
+    for (uint64_t s = 0; s < num_shards; ++s)
+    {
+        auto size = num_docs / num_shards + (s < num_docs % num_shards);
+        corpus_range range{*docs, size};
+        auto idx = make_shard(s);
+        idx->create_index(config_file_, range);
+        shards_.push_back({idx, first_doc});
+        first_doc = doc_id{first_doc + size};
+    }
+
+    // the list of shards is written last, so an interrupted build is
+    // started over
+    std::ofstream manifest{index_name_ + "/shards"};
+    manifest << num_shards << '\n';
+}
+
+std::shared_ptr<inverted_index> sharded_index::make_shard(uint64_t s) const
+{
+    auto config = cpptoml::parse_file(config_file_);
+    auto path = index_name_ + "/shard-" + std::to_string(s);
+    filesystem::make_directory(path);
+
+    // can't use std::make_shared here since the constructor is protected
+    return std::shared_ptr<inverted_index>{new inverted_index(config, path)};
+}
+
+collection_stats
+    sharded_index::query_stats(const corpus::document& query) const
+{
+    auto stats = stats_;
+    for (const auto& count : query.counts())
+    {
+        collection_stats::term_counts counts{0, 0};
+        for (const auto& shard : shards_)
+        {
+            auto& idx = *shard.index;
+            auto t_stats = idx.live_stats(idx.get_term_id(count.first));
+            counts.doc_freq += t_stats.doc_freq;
+            counts.corpus_count += t_stats.corpus_count;
+        }
+        stats.terms[count.first] = counts;
+    }
+    return stats;
+}
+
+auto sharded_index::locate(doc_id d_id) const -> std::pair<const shard&, doc_id>
+{
+    if (d_id >= num_docs())
+        throw sharded_index_exception{"doc_id " + std::to_string(d_id)
+                                      + " is not in the index"};
+
+    // the last shard whose first document is not after d_id
+    auto it = std::upper_bound(shards_.begin(), shards_.end(), d_id,
+                               [](doc_id id, const shard& s)
+                               {
+                                   return id < s.first_doc;
+                               });
+    --it;
+    return {*it, doc_id{d_id - it->first_doc}};
+}
+}
+}
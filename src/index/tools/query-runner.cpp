@@ -3,13 +3,16 @@
  * @author Sean Massung
  */
 
-#include <vector>
-#include <string>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
-#include "util/time.h"
+#include "caching/memory_budget.h"
 #include "corpus/document.h"
 #include "index/inverted_index.h"
+#include "index/query_engine.h"
 #include "index/ranker/ranker_factory.h"
 #include "parser/analyzers/tree_analyzer.h"
 #include "sequence/analyzers/ngram_pos_analyzer.h"
@@ -18,13 +21,14 @@ using namespace meta;
 
 /**
  * Demo app to read a file with one query per line and run each query on an
- * inverted index.
+ * inverted index. The queries are run as one batch, spread across threads.
  */
 int main(int argc, char* argv[])
 {
-    if (argc != 2)
+    if (argc != 2 && argc != 3)
     {
-        std::cerr << "Usage:\t" << argv[0] << " configFile" << std::endl;
+        std::cerr << "Usage:\t" << argv[0] << " configFile [threads]"
+                  << std::endl;
         return 1;
     }
 
@@ -35,56 +39,84 @@ int main(int argc, char* argv[])
     parser::register_analyzers();
     sequence::register_analyzers();
 
+    auto config = cpptoml::parse_file(argv[1]);
+
     // Create an inverted index using a DBLRU cache. The arguments forwarded to
     //  make_index are the config file for the index and any parameters for the
     //  cache. In this case, we set the maximum hash table size for the
-    //  dblru_cache to be 10000.
-    auto idx = index::make_index<index::dblru_inverted_index>(argv[1], 10000);
+    //  dblru_cache to be 10000. If the config file gives "cache-bytes", the
+    //  postings it caches are also limited to that many bytes, and only
+    //  postings for terms looked up more than once are cached.
+    caching::memory_budget budget;
+    if (auto cache_bytes = config.get_as<int64_t>("cache-bytes"))
+        budget = caching::memory_budget{static_cast<uint64_t>(*cache_bytes),
+                                        true};
+    auto idx = index::make_index<index::dblru_inverted_index>(argv[1], 10000,
+                                                              budget);
 
-    // Create a ranking class based on the config file.
-    auto config = cpptoml::parse_file(argv[1]);
+    // Create a ranking class based on the config file; each thread of the
+    //  query engine gets its own.
     auto group = config.get_table("ranker");
     if (!group)
         throw std::runtime_error{"\"ranker\" group needed in config file!"};
-    auto ranker = index::make_ranker(*group);
+    auto make_ranker = [&]()
+    {
+        return index::make_ranker(*group);
+    };
+
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (argc == 3)
+        num_threads = std::stoul(argv[2]);
+    index::query_engine engine{idx, make_ranker, num_threads};
 
     // Get the path to the file containing queries
     auto query_path = config.get_as<std::string>("querypath");
     if (!query_path)
         throw std::runtime_error{"config file needs a \"querypath\" parameter"};
 
-    std::ifstream queries{*query_path + *config.get_as<std::string>("dataset")
-                          + "-queries.txt"};
+    std::ifstream query_file{*query_path
+                             + *config.get_as<std::string>("dataset")
+                             + "-queries.txt"};
+    std::vector<corpus::document> queries;
     std::string content;
-    auto elapsed_seconds = common::time([&]()
+    // only look at first 500 queries
+    while (queries.size() < 500 && std::getline(query_file, content))
+    {
+        queries.emplace_back("[user input]", doc_id{0});
+        queries.back().content(content);
+    }
+
+    // Use the rankers to score the queries over the index. By default, the
+    //  rankers return 10 documents, so we will display the "top 10 of 10"
+    //  docs.
+    auto batch = engine.run(queries);
+    for (size_t i = 0; i < queries.size(); ++i)
     {
-        size_t i = 1;
-        while (queries.good() && i <= 500) // only look at first 500 queries
+        const auto& ranking = batch.rankings[i];
+        std::cout << "Ranking query " << i + 1 << ": " << queries[i].path()
+                  << std::endl;
+        std::cout << "Showing top 10 of " << ranking.size() << " results."
+                  << std::endl;
+
+        for (size_t j = 0; j < ranking.size() && j < 10; ++j)
         {
-            std::getline(queries, content);
-            corpus::document query{"[user input]", doc_id{0}};
-            query.content(content);
-            std::cout << "Ranking query " << i++ << ": " << query.path()
-                      << std::endl;
-
-            // Use the ranker to score the query over the index. By default, the
-            //  ranker returns 10 documents, so we will display the "top 10 of
-            //  10" docs.
-            auto ranking = ranker->score(*idx, query);
-            std::cout << "Showing top 10 of " << ranking.size() << " results."
-                      << std::endl;
-
-            for (size_t i = 0; i < ranking.size() && i < 10; ++i)
-            {
-                std::cout << (i + 1) << ". " << idx->doc_name(ranking[i].first)
-                          << " " << ranking[i].second << std::endl;
-            }
-            std::cout << std::endl;
+            std::cout << (j + 1) << ". " << idx->doc_name(ranking[j].first)
+                      << " " << ranking[j].second << std::endl;
         }
-    });
+        std::cout << std::endl;
+    }
+
+    std::cout << "Elapsed time: " << batch.elapsed << "ms on "
+              << engine.num_threads() << " threads" << std::endl;
+    std::cout << "Throughput: " << batch.qps() << " queries/s" << std::endl;
+    std::cout << "Latency: p50 " << batch.latency_percentile(0.50)
+              << "ms, p95 " << batch.latency_percentile(0.95) << "ms, p99 "
+              << batch.latency_percentile(0.99) << "ms" << std::endl;
 
-    std::cout << "Elapsed time: " << elapsed_seconds.count() << "ms"
-              << std::endl;
+    auto stats = idx->cache_stats();
+    std::cout << "Postings cache: " << stats.hit_rate() * 100 << "% hits, "
+              << stats.evictions << " evictions, " << stats.rejections
+              << " rejections" << std::endl;
 
     return 0;
 }
@@ -0,0 +1,130 @@
+/**
+ * @file block_codec.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "io/block_codec.h"
+
+namespace meta
+{
+namespace io
+{
+namespace block
+{
+
+namespace
+{
+/// Function type for a width-specialized block unpacker
+using unpack_func = void (*)(const uint64_t*, uint64_t*);
+
+/**
+ * Unpacks a block whose values are all Width bits wide.
+ * @param words The packed words
+ * @param out The location to write the block_size values to
+ */
+template <uint8_t Width>
+void unpack_width(const uint64_t* words, uint64_t* out)
+{
+    const uint64_t mask = Width == 64 ? ~uint64_t{0}
+                                      : (uint64_t{1} << (Width % 64)) - 1;
+    for (uint64_t i = 0; i < block_size; ++i)
+    {
+        uint64_t bit = i * Width;
+        uint64_t word = bit / 64;
+        uint64_t offset = bit % 64;
+        uint64_t value = words[word] >> offset;
+        if (offset + Width > 64)
+            value |= words[word + 1] << (64 - offset);
+        out[i] = value & mask;
+    }
+}
+
+/**
+ * Unpacks a block of zeros, which has no packed words to read.
+ * @param out The location to write the block_size zeros to
+ */
+template <>
+void unpack_width<0>(const uint64_t*, uint64_t* out)
+{
+    std::fill(out, out + block_size, uint64_t{0});
+}
+
+/**
+ * Fills a table of unpackers, indexed by width, at compile time.
+ */
+template <uint8_t Width>
+struct unpack_table
+{
+    static void fill(unpack_func* table)
+    {
+        table[Width] = &unpack_width<Width>;
+        unpack_table<Width - 1>::fill(table);
+    }
+};
+
+/**
+ * Base case: the zero-width unpacker.
+ */
+template <>
+struct unpack_table<0>
+{
+    static void fill(unpack_func* table)
+    {
+        table[0] = &unpack_width<0>;
+    }
+};
+
+/**
+ * @return the table of unpackers for widths 0 through 64
+ */
+const unpack_func* unpackers()
+{
+    static unpack_func table[65];
+    static bool init = (unpack_table<64>::fill(table), true);
+    (void)init;
+    return table;
+}
+}
+
+uint8_t bit_width(const uint64_t* values)
+{
+    uint64_t all = 0;
+    for (uint64_t i = 0; i < block_size; ++i)
+        all |= values[i];
+
+    uint8_t width = 0;
+    while (all)
+    {
+        ++width;
+        all >>= 1;
+    }
+    return width;
+}
+
+void pack(const uint64_t* values, uint8_t width, uint64_t* out)
+{
+    auto words = num_words(width);
+    std::memset(out, 0, words * sizeof(uint64_t));
+    if (width == 0)
+        return;
+
+    for (uint64_t i = 0; i < block_size; ++i)
+    {
+        uint64_t bit = i * width;
+        uint64_t word = bit / 64;
+        uint64_t offset = bit % 64;
+        out[word] |= values[i] << offset;
+        if (offset + width > 64)
+            out[word + 1] |= values[i] >> (64 - offset);
+    }
+}
+
+void unpack(const uint64_t* words, uint8_t width, uint64_t* out)
+{
+    unpackers()[width](words, out);
+}
+}
+}
+}
@@ -0,0 +1,93 @@
+/**
+ * @file block_file_reader.cpp
+ * @author agent
+ */
+
+#include <cstring>
+#include "io/block_codec.h"
+#include "io/block_file_reader.h"
+#include "io/mmap_file.h"
+#include "util/shim.h"
+
+namespace meta
+{
+namespace io
+{
+
+block_file_reader::block_file_reader(const mmap_file& file)
+    : file_{nullptr}, start_{file.begin()}, size_{file.size()}, cursor_{0}
+{
+    // nothing
+}
+
+block_file_reader::block_file_reader(const std::string& filename)
+    : file_{make_unique<mmap_file>(filename)},
+      start_{file_->begin()},
+      size_{file_->size()},
+      cursor_{0}
+{
+    // nothing
+}
+
+block_file_reader::block_file_reader(block_file_reader&&) = default;
+
+block_file_reader& block_file_reader::operator=(block_file_reader&&)
+    = default;
+
+block_file_reader::~block_file_reader() = default;
+
+void block_file_reader::seek(uint64_t byte_offset)
+{
+    if (byte_offset > size_)
+        throw block_file_reader_exception{
+            "error seeking: parameter out of bounds"};
+    cursor_ = byte_offset;
+}
+
+bool block_file_reader::has_next() const
+{
+    return cursor_ < size_;
+}
+
+uint64_t block_file_reader::next()
+{
+    uint64_t value = 0;
+    uint8_t shift = 0;
+    while (true)
+    {
+        if (cursor_ >= size_)
+            throw block_file_reader_exception{"read past end of file"};
+        auto byte = static_cast<uint8_t>(start_[cursor_++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+        shift += 7;
+    }
+}
+
+void block_file_reader::next_block(uint64_t* out)
+{
+    if (cursor_ >= size_)
+        throw block_file_reader_exception{"read past end of file"};
+
+    auto width = static_cast<uint8_t>(start_[cursor_++]);
+    if (width > 64)
+        throw block_file_reader_exception{"corrupt block header"};
+
+    auto bytes = block::num_words(width) * sizeof(uint64_t);
+    if (cursor_ + bytes > size_)
+        throw block_file_reader_exception{"read past end of file"};
+
+    // copy out of the mapped region: blocks are not word-aligned on disk
+    uint64_t words[2 * 64];
+    std::memcpy(words, start_ + cursor_, bytes);
+    cursor_ += bytes;
+    block::unpack(words, width, out);
+}
+
+uint64_t block_file_reader::byte_location() const
+{
+    return cursor_;
+}
+}
+}
@@ -0,0 +1,66 @@
+/**
+ * @file block_file_writer.cpp
+ * @author agent
+ */
+
+#include "io/block_codec.h"
+#include "io/block_file_writer.h"
+
+namespace meta
+{
+namespace io
+{
+
+block_file_writer::block_file_writer(const std::string& filename)
+    : outfile_{filename, std::ios::binary | std::ios::trunc},
+      byte_location_{0}
+{
+    if (!outfile_)
+        throw block_file_writer_exception{"failed to open " + filename};
+}
+
+block_file_writer::~block_file_writer()
+{
+    close();
+}
+
+uint64_t block_file_writer::byte_location() const
+{
+    return byte_location_;
+}
+
+void block_file_writer::write(uint64_t value)
+{
+    // seven bits per byte, high bit set on all but the last byte
+    while (value >= 0x80)
+    {
+        outfile_.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+        ++byte_location_;
+    }
+    outfile_.put(static_cast<char>(value));
+    ++byte_location_;
+}
+
+void block_file_writer::write_block(const uint64_t* values)
+{
+    uint64_t words[2 * 64];
+    auto width = block::bit_width(values);
+    block::pack(values, width, words);
+
+    outfile_.put(static_cast<char>(width));
+    auto bytes = block::num_words(width) * sizeof(uint64_t);
+    outfile_.write(reinterpret_cast<const char*>(words), bytes);
+    byte_location_ += 1 + bytes;
+
+    if (!outfile_)
+        throw block_file_writer_exception{"error writing to file"};
+}
+
+void block_file_writer::close()
+{
+    if (outfile_.is_open())
+        outfile_.close();
+}
+}
+}
@@ -3,6 +3,8 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include "io/compressed_file_reader.h"
 #include "io/mmap_file.h"
@@ -13,6 +15,24 @@ namespace meta
 namespace io
 {
 
+namespace
+{
+/**
+ * @param bytes The first of eight bytes
+ * @return the bytes as a word, with the first one in its most significant
+ * bits
+ */
+uint64_t load_word(const char* bytes)
+{
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+}
+
 compressed_file_reader::compressed_file_reader(const std::string& filename,
                                                std::function
                                                <uint64_t(uint64_t)> mapping)
@@ -21,8 +41,9 @@ compressed_file_reader::compressed_file_reader(const std::string& filename,
       size_{file_->size()},
       status_{notDone},
       current_value_{0},
-      current_char_{0},
-      current_bit_{0},
+      word_{0},
+      word_bits_{0},
+      next_byte_{0},
       mapping_{std::move(mapping)}
 {
     // initialize the stream
@@ -37,14 +58,38 @@ compressed_file_reader::compressed_file_reader(const mmap_file& file,
       size_{file.size()},
       status_{notDone},
       current_value_{0},
-      current_char_{0},
-      current_bit_{0},
+      word_{0},
+      word_bits_{0},
+      next_byte_{0},
+      mapping_{std::move(mapping)}
+{
+    // initialize the stream
+    get_next();
+}
+
+compressed_file_reader::compressed_file_reader(const char* data, uint64_t size,
+                                               std::function
+                                               <uint64_t(uint64_t)> mapping)
+    : file_{nullptr},
+      start_{data},
+      size_{size},
+      status_{notDone},
+      current_value_{0},
+      word_{0},
+      word_bits_{0},
+      next_byte_{0},
       mapping_{std::move(mapping)}
 {
     // initialize the stream
     get_next();
 }
 
+compressed_file_reader::compressed_file_reader(compressed_file_reader&&)
+    = default;
+
+compressed_file_reader& compressed_file_reader::
+    operator=(compressed_file_reader&&) = default;
+
 compressed_file_reader::~compressed_file_reader() = default;
 
 void compressed_file_reader::close()
@@ -54,13 +99,14 @@ void compressed_file_reader::close()
 
 uint64_t compressed_file_reader::bit_location() const
 {
-    return (current_char_ * 8) + current_bit_;
+    return next_byte_ * 8 - word_bits_;
 }
 
 void compressed_file_reader::reset()
 {
-    current_char_ = 0;
-    current_bit_ = 0;
+    word_ = 0;
+    word_bits_ = 0;
+    next_byte_ = 0;
     status_ = notDone;
     get_next();
 }
@@ -77,13 +123,16 @@ std::string compressed_file_reader::next_string()
 void compressed_file_reader::seek(uint64_t bit_offset)
 {
     uint64_t byte = bit_offset / 8;
-    uint8_t bit = bit_offset % 8;
+    uint64_t bit = bit_offset % 8;
 
     if (byte < size_)
     {
-        current_char_ = byte;
-        current_bit_ = bit;
+        word_ = 0;
+        word_bits_ = 0;
+        next_byte_ = byte;
         status_ = notDone;
+        refill();
+        skip(bit);
         get_next();
     }
     else
@@ -114,35 +163,99 @@ uint64_t compressed_file_reader::next()
 
 void compressed_file_reader::get_next()
 {
-    uint64_t numberBits = 0;
-    while (status_ == 0 && !read_bit())
-        ++numberBits;
+    refill();
 
-    current_value_ = 0;
-    for (int64_t bit = numberBits - 1; status_ == 0 && bit >= 0; --bit)
+    // almost every value is in the word: since as many zeros come before
+    // it as there are bits after its leading one, it is the word's top
+    // 2 * zeros + 1 bits
+    if (word_ != 0)
     {
-        if (read_bit())
-            current_value_ |= (1 << bit);
+        uint64_t zeros = __builtin_clzll(word_);
+        uint64_t length = 2 * zeros + 1;
+        if (length <= word_bits_)
+        {
+            current_value_ = word_ >> (64 - length);
+            skip(length);
+            if (word_bits_ == 0 && next_byte_ == size_)
+                status_ = readerDone;
+            return;
+        }
     }
 
-    current_value_ |= (1 << numberBits);
+    // otherwise, count the zeros before the leading one of the value,
+    // which are all in the word unless the value has more than 56 bits
+    uint64_t num_bits = 0;
+    while (word_ == 0)
+    {
+        num_bits += word_bits_;
+        word_bits_ = 0;
+        refill();
+        if (word_bits_ == 0)
+        {
+            status_ = readerDone;
+            current_value_ = 0;
+            return;
+        }
+    }
+    uint64_t zeros = __builtin_clzll(word_);
+    num_bits += zeros;
+    skip(zeros + 1);
+
+    // then take the bits after the leading one, a word at a time; a valid
+    // value has at most 63 of them
+    current_value_ = 1;
+    uint64_t remaining = std::min<uint64_t>(num_bits, 63);
+    while (remaining > 0)
+    {
+        refill();
+        if (word_bits_ == 0)
+        {
+            status_ = readerDone;
+            return;
+        }
+        auto taken = std::min(remaining, word_bits_);
+        current_value_ = (current_value_ << taken) | (word_ >> (64 - taken));
+        skip(taken);
+        remaining -= taken;
+    }
+
+    if (word_bits_ == 0 && next_byte_ == size_)
+        status_ = readerDone;
 }
 
-bool compressed_file_reader::read_bit()
+void compressed_file_reader::refill()
 {
-    // (7 - current_Bit) to read from left to right
-    bool bit = start_[current_char_] & (1 << (7 - current_bit_));
-    if (current_bit_ == 7)
+    if (word_bits_ > 56)
+        return;
+
+    if (next_byte_ + 8 <= size_)
     {
-        current_bit_ = 0;
-        if (++current_char_ == size_)
-            status_ = readerDone;
+        // load all the whole bytes that fit after the bits in the word, and
+        // clear the part of a byte that does not
+        uint64_t num_bytes = (64 - word_bits_) / 8;
+        uint64_t bits = word_bits_ + num_bytes * 8;
+        uint64_t loaded = load_word(start_ + next_byte_) >> word_bits_;
+        if (bits < 64)
+            loaded &= ~(~uint64_t{0} >> bits);
+        word_ |= loaded;
+        word_bits_ = bits;
+        next_byte_ += num_bytes;
+        return;
     }
-    else
+
+    // near the end of the file, bytes are loaded one at a time
+    while (word_bits_ <= 56 && next_byte_ < size_)
     {
-        ++current_bit_;
+        auto byte = static_cast<uint8_t>(start_[next_byte_++]);
+        word_ |= static_cast<uint64_t>(byte) << (56 - word_bits_);
+        word_bits_ += 8;
     }
-    return bit;
+}
+
+void compressed_file_reader::skip(uint64_t num_bits)
+{
+    word_ = num_bits < 64 ? word_ << num_bits : 0;
+    word_bits_ -= num_bits;
 }
 
 uint64_t default_compression_reader_func(uint64_t value)
@@ -3,7 +3,6 @@
  * @author Sean Massung
  */
 
-#include <cmath>
 #include <cstring>
 #include <limits>
 #include "io/compressed_file_writer.h"
@@ -13,25 +12,46 @@ namespace meta
 namespace io
 {
 
+namespace
+{
+/// the number of bytes written to the file at a time
+const uint64_t file_buffer_size = 1024 * 1024; // 1 MB
+}
+
 compressed_file_writer::compressed_file_writer(const std::string& filename,
                                                std::function
                                                <uint64_t(uint64_t)> mapping)
     : outfile_{fopen(filename.c_str(), "w")},
-      char_cursor_{0},
-      bit_cursor_{0},
-      buffer_size_{1024 * 1024 * 64}, // 64 MB
-      buffer_{new unsigned char[buffer_size_]},
+      buffer_{&file_buffer_},
+      word_{0},
+      word_bits_{0},
       mapping_{std::move(mapping)},
       bit_location_{0},
       closed_{false}
 {
-    // disable buffering
+    if (!outfile_)
+        throw compressed_file_writer_exception("error opening " + filename);
+
+    // disable buffering, since whole buffers are written at once
     if (setvbuf(outfile_, nullptr, _IONBF, 0) != 0)
         throw compressed_file_writer_exception(
             "error disabling buffering (setvbuf)");
 
-    // zero out, we'll only write ones
-    memset(buffer_, 0, buffer_size_);
+    file_buffer_.reserve(file_buffer_size);
+}
+
+compressed_file_writer::compressed_file_writer(std::vector<char>& buffer,
+                                               std::function
+                                               <uint64_t(uint64_t)> mapping)
+    : outfile_{nullptr},
+      buffer_{&buffer},
+      word_{0},
+      word_bits_{0},
+      mapping_{std::move(mapping)},
+      bit_location_{0},
+      closed_{false}
+{
+    // nothing
 }
 
 void compressed_file_writer::write(const std::string& str)
@@ -60,10 +80,14 @@ void compressed_file_writer::close()
 {
     if (!closed_)
     {
-        // write the remaining bits, up to the nearest byte
-        fwrite(buffer_, 1, char_cursor_ + 1, outfile_);
-        delete[] buffer_;
-        fclose(outfile_);
+        // write the remaining bits, up to the nearest byte, followed by at
+        // least one zero bit so readers can tell where the last value ends
+        flush_word(word_bits_ / 8 + 1);
+        if (outfile_)
+        {
+            write_buffer();
+            fclose(outfile_);
+        }
 
         closed_ = true;
     }
@@ -72,40 +96,65 @@ void compressed_file_writer::close()
 void compressed_file_writer::write(uint64_t value)
 {
     uint64_t cvalue = mapping_(value);
-    uint64_t length = std::log2(cvalue);
-
-    for (uint64_t bit = 0; bit < length; ++bit)
-        write_bit(false);
-
-    write_bit(true);
+    if (cvalue == 0)
+        throw compressed_file_writer_exception(
+            "zero cannot be gamma compressed");
 
-    for (int64_t bit = length - 1; bit >= 0; --bit)
-        write_bit(cvalue & 1 << bit);
+    // the value is written as as many zeros as there are bits after its
+    // leading one, followed by the value itself
+    uint64_t length = 63 - __builtin_clzll(cvalue);
+    if (2 * length + 1 <= 64)
+    {
+        write_bits(cvalue, 2 * length + 1);
+    }
+    else
+    {
+        write_bits(0, length);
+        write_bits(cvalue, length + 1);
+    }
 }
 
-void compressed_file_writer::write_bit(bool bit)
+void compressed_file_writer::write_bits(uint64_t bits, uint64_t num_bits)
 {
-    ++bit_location_;
-
-    if (bit)
-        buffer_[char_cursor_] |= (1 << (7 - bit_cursor_));
+    bit_location_ += num_bits;
 
-    if (++bit_cursor_ == 8)
+    uint64_t free_bits = 64 - word_bits_;
+    if (num_bits < free_bits)
     {
-        bit_cursor_ = 0;
-        if (++char_cursor_ == buffer_size_)
-        {
-            char_cursor_ = 0;
-            write_buffer();
-        }
+        word_ |= bits << (free_bits - num_bits);
+        word_bits_ += num_bits;
+        return;
     }
+
+    // fill the word and flush it, then start the next word with the bits
+    // that did not fit
+    uint64_t rest = num_bits - free_bits;
+    word_ |= bits >> rest;
+    flush_word(8);
+    word_ = rest > 0 ? bits << (64 - rest) : 0;
+    word_bits_ = rest;
+}
+
+void compressed_file_writer::flush_word(uint64_t num_bytes)
+{
+    uint64_t word = word_;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    char bytes[sizeof(word)];
+    std::memcpy(bytes, &word, sizeof(word));
+    buffer_->insert(buffer_->end(), bytes, bytes + num_bytes);
+
+    if (outfile_ && buffer_->size() >= file_buffer_size)
+        write_buffer();
 }
 
-void compressed_file_writer::write_buffer() const
+void compressed_file_writer::write_buffer()
 {
-    if (fwrite(buffer_, 1, buffer_size_, outfile_) != buffer_size_)
+    if (fwrite(buffer_->data(), 1, buffer_->size(), outfile_)
+        != buffer_->size())
         throw compressed_file_writer_exception("error writing to file");
-    memset(buffer_, 0, buffer_size_);
+    buffer_->clear();
 }
 
 uint64_t default_compression_writer_func(uint64_t key)
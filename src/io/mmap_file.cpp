@@ -73,6 +73,22 @@ mmap_file& mmap_file::operator=(mmap_file&& other)
     return *this;
 }
 
+void mmap_file::advise(access_hint hint, uint64_t offset,
+                       uint64_t length) const
+{
+    io::advise(start_, size_, hint, offset, length);
+}
+
+bool mmap_file::resident(uint64_t offset, uint64_t length) const
+{
+    return io::resident(start_, size_, offset, length);
+}
+
+uint64_t mmap_file::warm(uint64_t offset, uint64_t length) const
+{
+    return io::warm(start_, size_, offset, length);
+}
+
 uint64_t mmap_file::size() const
 {
     return size_;
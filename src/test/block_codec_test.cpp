@@ -0,0 +1,163 @@
+/**
+ * @file block_codec_test.cpp
+ * @author agent
+ */
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include "index/postings_data.h"
+#include "io/block_codec.h"
+#include "io/block_file_reader.h"
+#include "io/block_file_writer.h"
+#include "util/filesystem.h"
+#include "test/block_codec_test.h"
+
+namespace meta
+{
+namespace testing
+{
+
+namespace
+{
+using pdata_t = index::postings_data<term_id, doc_id>;
+
+/**
+ * @param size The number of postings to generate
+ * @param max_gap The largest gap between consecutive doc_ids
+ * @param gen The random number generator to use
+ * @return a postings_data with size random postings
+ */
+pdata_t make_postings(uint64_t size, uint64_t max_gap, std::mt19937_64& gen)
+{
+    std::uniform_int_distribution<uint64_t> gaps{1, max_gap};
+    std::uniform_int_distribution<uint64_t> counts{1, 1000};
+
+    pdata_t::count_t counts_vec;
+    uint64_t id = gaps(gen) - 1;
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        counts_vec.emplace_back(doc_id{id}, counts(gen));
+        id += gaps(gen);
+    }
+
+    pdata_t pdata{term_id{size}};
+    pdata.set_counts(counts_vec);
+    return pdata;
+}
+}
+
+int block_codec_tests()
+{
+    int num_failed = 0;
+
+    std::string filename{"meta-tmp-block.dat"};
+    std::mt19937_64 gen{47};
+
+    num_failed += testing::run_test("block-codec-pack-unpack", [&]()
+    {
+        uint64_t values[io::block::block_size];
+        uint64_t words[2 * 64];
+        uint64_t unpacked[io::block::block_size];
+        for (uint8_t width = 0; width <= 64; ++width)
+        {
+            uint64_t max = width == 64 ? std::numeric_limits<uint64_t>::max()
+                                       : (uint64_t{1} << width) - 1;
+            std::uniform_int_distribution<uint64_t> dist{0, max};
+            for (auto& v : values)
+                v = dist(gen);
+            values[0] = max; // make sure the full width is needed
+
+            ASSERT_EQUAL(io::block::bit_width(values), width);
+            io::block::pack(values, width, words);
+            io::block::unpack(words, width, unpacked);
+            for (uint64_t i = 0; i < io::block::block_size; ++i)
+                ASSERT_EQUAL(unpacked[i], values[i]);
+        }
+
+        // a block of zeros has no words, so none may be read
+        std::fill(unpacked, unpacked + io::block::block_size, 1);
+        io::block::unpack(nullptr, 0, unpacked);
+        for (uint64_t i = 0; i < io::block::block_size; ++i)
+            ASSERT_EQUAL(unpacked[i], uint64_t{0});
+    });
+
+    std::vector<uint64_t> singles{0, 1, 127, 128, 16383, 16384, 1ul << 35,
+                                  std::numeric_limits<uint64_t>::max()};
+    std::vector<uint64_t> block(io::block::block_size);
+    std::uniform_int_distribution<uint64_t> dist{0, 1 << 20};
+    for (auto& v : block)
+        v = dist(gen);
+
+    num_failed += testing::run_test("block-file-writer", [&]()
+    {
+        io::block_file_writer writer{filename};
+        for (auto& v : singles)
+            writer.write(v);
+        writer.write_block(block.data());
+        for (auto& v : singles)
+            writer.write(v);
+        writer.close();
+        ASSERT_EQUAL(filesystem::file_size(filename), writer.byte_location());
+    });
+
+    num_failed += testing::run_test("block-file-reader", [&]()
+    {
+        io::block_file_reader reader{filename};
+        for (auto& v : singles)
+            ASSERT_EQUAL(reader.next(), v);
+        std::vector<uint64_t> read(io::block::block_size);
+        reader.next_block(read.data());
+        for (uint64_t i = 0; i < io::block::block_size; ++i)
+            ASSERT_EQUAL(read[i], block[i]);
+        for (auto& v : singles)
+            ASSERT_EQUAL(reader.next(), v);
+        ASSERT(!reader.has_next());
+    });
+
+    // postings lists with no full blocks, exactly full blocks, and partial
+    // trailing blocks; the last one needs gaps wider than 32 bits
+    std::vector<pdata_t> postings;
+    for (uint64_t size : {0, 1, 127, 128, 129, 256, 1000})
+        postings.push_back(make_postings(size, 100, gen));
+    postings.push_back(make_postings(300, 1ul << 40, gen));
+
+    std::vector<uint64_t> offsets;
+    num_failed += testing::run_test("block-postings-write", [&]()
+    {
+        io::block_file_writer writer{filename};
+        for (auto& pdata : postings)
+        {
+            offsets.push_back(writer.byte_location());
+            pdata.write_packed(writer);
+        }
+    });
+
+    num_failed += testing::run_test("block-postings-read", [&]()
+    {
+        io::block_file_reader reader{filename};
+        // read in reverse to make sure seeking works
+        for (uint64_t i = postings.size(); i > 0; --i)
+        {
+            reader.seek(offsets[i - 1]);
+            pdata_t pdata{postings[i - 1].primary_key()};
+            pdata.read_packed(reader);
+
+            const auto& expected = postings[i - 1].counts();
+            const auto& actual = pdata.counts();
+            ASSERT_EQUAL(actual.size(), expected.size());
+            for (uint64_t j = 0; j < expected.size(); ++j)
+            {
+                ASSERT_EQUAL(actual[j].first, expected[j].first);
+                ASSERT_APPROX_EQUAL(actual[j].second, expected[j].second);
+            }
+        }
+    });
+
+    if (filesystem::file_exists(filename))
+        filesystem::delete_file(filename);
+
+    return num_failed;
+}
+}
+}
@@ -7,6 +7,7 @@
 
 #include "test/classifier_test.h"
 #include "classify/loss/all.h"
+#include "parallel/thread_pool.h"
 
 namespace meta
 {
@@ -23,7 +24,7 @@ void check_cv(Index& idx, Classifier& c, double min_accuracy)
 }
 
 template <class Index, class Classifier>
-void check_split(Index& idx, Classifier& c, double min_accuracy)
+double split_accuracy(Index& idx, Classifier& c)
 {
     // create splits
     std::vector<doc_id> docs = idx.docs();
@@ -36,8 +37,36 @@ void check_split(Index& idx, Classifier& c, double min_accuracy)
     // train and test
     c.train(train_docs);
     classify::confusion_matrix mtx = c.test(test_docs);
-    ASSERT_GREATER(mtx.accuracy(), min_accuracy);
-    ASSERT_LESS(mtx.accuracy(), 100.0);
+    return mtx.accuracy();
+}
+
+template <class Index>
+double binary_split_accuracy(Index& idx, classify::binary_classifier& c)
+{
+    std::vector<doc_id> docs = idx.docs();
+    std::mt19937 gen(47);
+    std::shuffle(docs.begin(), docs.end(), gen);
+    size_t split_idx = docs.size() / 8;
+    std::vector<doc_id> train_docs{docs.begin() + split_idx, docs.end()};
+    std::vector<doc_id> test_docs{docs.begin(), docs.begin() + split_idx};
+
+    // documents with any other label are negative examples
+    c.train(train_docs);
+    size_t correct = 0;
+    for (const auto& d_id : test_docs)
+    {
+        if ((c.predict(d_id) >= 0) == (idx.label(d_id) == c.positive_label()))
+            ++correct;
+    }
+    return static_cast<double>(correct) / test_docs.size();
+}
+
+template <class Index, class Classifier>
+void check_split(Index& idx, Classifier& c, double min_accuracy)
+{
+    auto accuracy = split_accuracy(idx, c);
+    ASSERT_GREATER(accuracy, min_accuracy);
+    ASSERT_LESS(accuracy, 100.0);
 }
 
 int run_tests(const std::string& type)
@@ -137,6 +166,50 @@ int run_tests(const std::string& type)
                 check_split(*f_idx, perceptron, 0.85);
             });
 
+        num_failed += testing::run_test(
+            "sgd-hogwild-" + type, [&]()
+            {
+                auto make_sgd = [&](const std::string& prefix, size_t threads)
+                {
+                    return [=](class_label positive)
+                    {
+                        return make_unique<sgd>(
+                            prefix, f_idx, positive, class_label{"negative"},
+                            make_unique<loss::hinge>(), sgd::default_alpha,
+                            sgd::default_gamma, sgd::default_bias,
+                            sgd::default_lambda, sgd::default_max_iter,
+                            threads);
+                    };
+                };
+
+                // trained outside of any pool, so the binary classifier's
+                // four threads really do train Hogwild-style
+                ASSERT(!parallel::thread_pool::in_worker());
+                auto positive = f_idx->class_labels().front();
+                auto serial_binary = make_sgd("sgd-model-test", 1)(positive);
+                auto hogwild_binary
+                    = make_sgd("sgd-hogwild-model-test", 4)(positive);
+                ASSERT_EQUAL(hogwild_binary->num_training_threads(), 4ul);
+                auto serial_accuracy
+                    = binary_split_accuracy(*f_idx, *serial_binary);
+                auto hogwild_accuracy
+                    = binary_split_accuracy(*f_idx, *hogwild_binary);
+                ASSERT_GREATER(hogwild_accuracy, 0.85);
+                ASSERT_LESS(std::abs(serial_accuracy - hogwild_accuracy),
+                            0.05);
+
+                // one_vs_all trains a label at a time when its classifiers
+                // have threads of their own, so they keep them
+                one_vs_all serial{f_idx, make_sgd("sgd-model-test", 1)};
+                one_vs_all hogwild{f_idx,
+                                   make_sgd("sgd-hogwild-model-test", 4)};
+                serial_accuracy = split_accuracy(*f_idx, serial);
+                hogwild_accuracy = split_accuracy(*f_idx, hogwild);
+                ASSERT_GREATER(hogwild_accuracy, 0.87);
+                ASSERT_LESS(std::abs(serial_accuracy - hogwild_accuracy),
+                            0.05);
+            });
+
         num_failed += testing::run_test(
             "log-reg-cv-" + type, [&]()
             {
@@ -4,6 +4,7 @@
  */
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
 #include <random>
 #include "util/filesystem.h"
@@ -48,6 +49,45 @@ int compression_tests()
         ASSERT_EQUAL(reader.next_string(), "some random string");
     });
 
+    num_failed += testing::run_test("compressed-file-buffer", [&]()
+    {
+        // values of every length, which span the words they are read in
+        std::vector<uint64_t> values;
+        for (uint64_t bits = 0; bits < 64; ++bits)
+        {
+            values.push_back(uint64_t{1} << bits);
+            values.push_back((uint64_t{1} << bits) - 1);
+        }
+        values.push_back(std::numeric_limits<uint64_t>::max() - 2);
+
+        std::vector<char> buffer;
+        std::vector<uint64_t> locations;
+        {
+            io::compressed_file_writer writer{
+                buffer, io::default_compression_writer_func};
+            for (auto& v : values)
+            {
+                locations.push_back(writer.bit_location());
+                writer.write(v);
+            }
+        }
+
+        io::compressed_file_reader reader{buffer.data(), buffer.size(),
+                                          io::default_compression_reader_func};
+        for (auto& v : values)
+        {
+            ASSERT(reader.has_next());
+            ASSERT_EQUAL(reader.next(), v);
+        }
+        ASSERT(!reader.has_next());
+
+        for (uint64_t i = values.size(); i-- > 0;)
+        {
+            reader.seek(locations[i]);
+            ASSERT_EQUAL(reader.next(), values[i]);
+        }
+    });
+
     if (filesystem::file_exists(filename))
         filesystem::delete_file(filename);
 
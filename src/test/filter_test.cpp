@@ -7,7 +7,11 @@
 #include <iostream>
 
 #include "analyzers/tokenizers/whitespace_tokenizer.h"
+#include "analyzers/filters/alpha_filter.h"
 #include "analyzers/filters/english_normalizer.h"
+#include "analyzers/filters/empty_sentence_filter.h"
+#include "analyzers/filters/length_filter.h"
+#include "analyzers/filters/lowercase_filter.h"
 #include "corpus/document.h"
 #include "util/shim.h"
 #include "test/filter_test.h"
@@ -28,6 +32,15 @@ void check_expected(analyzers::token_stream& filter,
         ASSERT(filter.next() == s);
     ASSERT(!filter);
 }
+
+void check_expected_views(analyzers::token_stream& filter,
+                          std::vector<std::string>& expected)
+{
+    ASSERT(filter);
+    for (const auto& s : expected)
+        ASSERT(filter.next_view() == s);
+    ASSERT(!filter);
+}
 }
 
 int filter_tests()
@@ -66,6 +79,33 @@ int filter_tests()
         check_expected(*norm, expected);
     });
 
+    num_failed += testing::run_test("filter_chain_views", []()
+    {
+        using namespace analyzers;
+        std::unique_ptr<token_stream> stream
+            = make_unique<tokenizers::whitespace_tokenizer>();
+        stream = make_unique<filters::lowercase_filter>(std::move(stream));
+        stream = make_unique<filters::alpha_filter>(std::move(stream));
+        stream = make_unique<filters::length_filter>(std::move(stream), 2, 10);
+        stream
+            = make_unique<filters::empty_sentence_filter>(std::move(stream));
+        stream->set_content("<s> </s> <s> The QUICK brown-fox's 42 Jumps! "
+                            "</s> <s> </s>");
+
+        std::vector<std::string> expected
+            = {"<s>", "the", "quick", "brownfox's", "jumps", "</s>"};
+
+        // clones pick up where the original stream was
+        auto copy = stream->clone();
+        check_expected(*stream, expected);
+        ASSERT(copy->next_view() == "<s>");
+        expected.erase(expected.begin());
+        ASSERT(*copy); // buffers the next token before cloning
+        auto second = copy->clone();
+        check_expected_views(*copy, expected);
+        check_expected(*second, expected);
+    });
+
     return num_failed;
 }
 }
@@ -4,6 +4,9 @@
  */
 
 #include "test/forward_index_test.h"
+#include "io/mmap_file.h"
+#include "util/disk_vector.h"
+#include "util/filesystem.h"
 
 namespace meta
 {
@@ -156,6 +159,31 @@ int forward_index_tests()
     num_failed += testing::run_test("forward-index-load-libsvm", [&]()
     {
         bcancer_forward_test();
+    });
+
+    num_failed += testing::run_test("forward-index-convert-libsvm", [&]()
+    {
+        // put the postings back in the libsvm format used by older
+        // indexes; loading the index should convert them
+        auto config = cpptoml::parse_file("test-config.toml");
+        auto prefix = *config.get_as<std::string>("prefix");
+        filesystem::copy_file(prefix + "/breast-cancer/breast-cancer.dat",
+                              "bcancer-fwd/postings.index");
+        {
+            io::mmap_file text{"bcancer-fwd/postings.index"};
+            util::disk_vector<uint64_t> locations{"bcancer-fwd/lexicon.index"};
+            doc_id d_id{0};
+            char last_byte = '\n';
+            for (uint64_t i = 0; i < text.size(); ++i)
+            {
+                if (last_byte == '\n')
+                    locations[d_id++] = i;
+                last_byte = text[i];
+            }
+        }
+
+        bcancer_forward_test(); // converts
+        bcancer_forward_test(); // loads the converted postings
         system("rm -rf bcancer-* test-config.toml");
     });
 
@@ -3,14 +3,21 @@
  * @author Sean Massung
  */
 
+#include <atomic>
+#include <limits>
+#include <thread>
+
 #include "test/inverted_index_test.h"
+#include "corpus/corpus.h"
+#include "util/filesystem.h"
 
 namespace meta
 {
 namespace testing
 {
 
-void create_config(const std::string& corpus_type)
+void create_config(const std::string& corpus_type, const std::string& codec,
+                   bool positions)
 {
     auto orig_config = cpptoml::parse_file("config.toml");
     std::string config_filename{"test-config.toml"};
@@ -54,6 +61,8 @@ void create_config(const std::string& corpus_type)
                 << "encoding = \"shift_jis\"\n"
                 << "forward-index = \"ceeaus-fwd\"\n"
                 << "inverted-index = \"ceeaus-inv\"\n"
+                << "postings-codec = \"" << codec << "\"\n"
+                << "positions = " << (positions ? "true" : "false") << "\n"
                 << "[[analyzers]]\n"
                 << "method = \"ngram-word\"\n"
                 << "ngram = 1\n"
@@ -102,6 +111,458 @@ void check_term_id(Index& idx)
     }
 }
 
+template <class Index>
+void check_postings_cursor(Index& idx)
+{
+    std::vector<index::postings_cursor::pair_t> postings;
+    index::postings_cursor::pair_t buffer[7];
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        const auto& expected = idx.search_primary(t_id)->counts();
+
+        idx.postings(t_id).read_all(postings);
+        ASSERT(postings == expected);
+
+        // odd-sized reads straddle the cursor's internal blocks
+        postings.clear();
+        auto cursor = idx.postings(t_id);
+        while (auto num = cursor.read(buffer, 7))
+            postings.insert(postings.end(), buffer, buffer + num);
+        ASSERT(postings == expected);
+
+        // skipping ahead lands on the first posting at or past the target
+        cursor = idx.postings(t_id);
+        uint64_t target = 0;
+        for (uint64_t i = 0; i < expected.size(); i += 37)
+        {
+            target = expected[i].first - (i % 2);
+            cursor.advance_to(doc_id{target});
+            auto it = std::lower_bound(
+                expected.begin(), expected.end(), doc_id{target},
+                [](const index::postings_cursor::pair_t& p, doc_id d)
+                { return p.first < d; });
+            ASSERT(cursor.has_next());
+            ASSERT(cursor.peek() == *it);
+        }
+        cursor.advance_to(doc_id{idx.num_docs()});
+        ASSERT(!cursor.has_next());
+
+        ASSERT_EQUAL(idx.doc_freq(t_id), expected.size());
+        if (!expected.empty())
+        {
+            auto& last = expected.back();
+            ASSERT_EQUAL(idx.term_freq(t_id, last.first),
+                         static_cast<uint64_t>(last.second));
+        }
+    }
+
+    ASSERT(!idx.postings(term_id{idx.unique_terms()}).has_next());
+}
+
+template <class Index>
+void check_stats(Index& idx)
+{
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        auto stats = idx.stats(t_id);
+        auto pdata = idx.search_primary(t_id);
+        uint64_t corpus_count = 0;
+        uint64_t max_count = 0;
+        for (const auto& count : pdata->counts())
+        {
+            corpus_count += static_cast<uint64_t>(count.second);
+            max_count = std::max(max_count,
+                                 static_cast<uint64_t>(count.second));
+        }
+        ASSERT_EQUAL(stats.doc_freq, pdata->counts().size());
+        ASSERT_EQUAL(stats.corpus_count, corpus_count);
+        ASSERT_EQUAL(stats.max_count, max_count);
+        ASSERT(stats.postings_bytes > 0);
+    }
+
+    auto missing = idx.stats(term_id{idx.unique_terms()});
+    ASSERT_EQUAL(missing.doc_freq, 0ul);
+    ASSERT_EQUAL(missing.postings_bytes, 0ul);
+
+    uint64_t total = 0;
+    uint64_t min_length = std::numeric_limits<uint64_t>::max();
+    for (const auto& d_id : idx.docs())
+    {
+        total += idx.doc_size(d_id);
+        if (idx.doc_size(d_id) > 0)
+            min_length = std::min(min_length, idx.doc_size(d_id));
+    }
+    ASSERT_EQUAL(idx.total_corpus_terms(), total);
+    ASSERT_EQUAL(idx.min_doc_length(), min_length);
+}
+
+template <class Index>
+void check_positions(Index& idx)
+{
+    ASSERT(idx.has_positions());
+
+    // the positions of every term in every document, by tokenizing again
+    std::vector<std::vector<term_id>> sequences;
+    std::vector<std::unordered_map<term_id, std::vector<uint64_t>>> expected;
+    auto docs = corpus::corpus::load("test-config.toml");
+    while (docs->has_next())
+    {
+        auto doc = docs->next();
+        sequences.push_back(index::ordered_terms(idx, doc));
+        expected.emplace_back();
+        for (uint64_t i = 0; i < sequences.back().size(); ++i)
+            expected.back()[sequences.back()[i]].push_back(i);
+    }
+    ASSERT_EQUAL(expected.size(), idx.num_docs());
+
+    std::vector<std::vector<uint64_t>> positions;
+    for (doc_id d_id{0}; d_id < expected.size(); ++d_id)
+    {
+        for (const auto& term : expected[d_id])
+        {
+            idx.positions(d_id, {term.first}, positions);
+            ASSERT(positions[0] == term.second);
+        }
+    }
+
+    // several terms at once, out of order and repeated, skipping the
+    // terms in between them
+    std::vector<term_id> wanted{sequences[5][12], sequences[5][3],
+                                sequences[5][12], sequences[5][0]};
+    idx.positions(doc_id{5}, wanted, positions);
+    ASSERT_EQUAL(positions.size(), wanted.size());
+    for (uint64_t i = 0; i < wanted.size(); ++i)
+        ASSERT(positions[i] == expected[5][wanted[i]]);
+
+    // a phrase taken from the middle of a document
+    std::vector<term_id> phrase{sequences[5].begin() + 10,
+                                sequences[5].begin() + 13};
+    ASSERT(phrase[0] != phrase[2]);
+
+    std::vector<index::positional_match> phrase_matches;
+    std::vector<index::positional_match> near_matches;
+    uint64_t window = 5;
+    for (doc_id d_id{0}; d_id < expected.size(); ++d_id)
+    {
+        auto& doc = expected[d_id];
+        uint64_t num_phrases = 0;
+        for (const auto& start : doc[phrase[0]])
+        {
+            num_phrases += std::binary_search(doc[phrase[1]].begin(),
+                                              doc[phrase[1]].end(), start + 1)
+                           && std::binary_search(doc[phrase[2]].begin(),
+                                                 doc[phrase[2]].end(),
+                                                 start + 2);
+        }
+        if (num_phrases > 0)
+            phrase_matches.emplace_back(d_id, num_phrases);
+
+        // with two terms, every minimal span pairs an occurrence of one
+        // with the next occurrence of the other
+        std::vector<std::pair<uint64_t, term_id>> merged;
+        for (const auto& t_id : {phrase[0], phrase[2]})
+        {
+            for (const auto& position : doc[t_id])
+                merged.emplace_back(position, t_id);
+        }
+        std::sort(merged.begin(), merged.end());
+        uint64_t num_near = 0;
+        for (uint64_t i = 1; i < merged.size(); ++i)
+        {
+            num_near += merged[i].second != merged[i - 1].second
+                        && merged[i].first - merged[i - 1].first < window;
+        }
+        if (num_near > 0)
+            near_matches.emplace_back(d_id, num_near);
+    }
+
+    ASSERT(!phrase_matches.empty());
+    ASSERT(index::match_phrase(idx, phrase) == phrase_matches);
+    ASSERT(index::match_proximity(idx, {phrase[0], phrase[2]}, window)
+           == near_matches);
+}
+
+template <class Index>
+void check_deletions(Index& idx)
+{
+    auto docs = idx.docs();
+    ASSERT_EQUAL(docs.size(), idx.num_docs() - idx.num_deleted());
+    for (const auto& d_id : docs)
+        ASSERT(!idx.is_deleted(d_id));
+
+    // the statistics kept as documents are deleted match the postings
+    // that are left
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        uint64_t corpus_count = 0;
+        auto counts = idx.search_primary(t_id)->counts();
+        for (const auto& count : counts)
+        {
+            ASSERT(!idx.is_deleted(count.first));
+            corpus_count += static_cast<uint64_t>(count.second);
+        }
+        auto stats = idx.live_stats(t_id);
+        ASSERT_EQUAL(stats.doc_freq, counts.size());
+        ASSERT_EQUAL(stats.corpus_count, corpus_count);
+    }
+
+    // the first document is deleted, so it can't be found by its own text
+    auto query = corpus::corpus::load("test-config.toml")->next();
+    index::okapi_bm25 ranker;
+    auto results = ranker.score(idx, query, 50);
+    ASSERT_EQUAL(results.size(), 50ul);
+    for (const auto& result : results)
+        ASSERT(!idx.is_deleted(result.first));
+}
+
+template <class Index>
+void check_warm(Index& idx)
+{
+    // the budget is spent on the metadata first
+    ASSERT_EQUAL(idx.warm(100), 100ul);
+    auto all = idx.warm(std::numeric_limits<uint64_t>::max());
+    ASSERT(all > idx.num_docs() * sizeof(double));
+    ASSERT_EQUAL(idx.warm(all + 1000), all);
+
+    // prefetching is only advice, so the postings read the same after it
+    for (term_id t_id{0}; t_id <= idx.unique_terms(); ++t_id)
+        idx.prefetch(t_id);
+    check_term_id(idx);
+}
+
+void check_segments(index::segmented_index& idx, uint64_t copies)
+{
+    ASSERT_EQUAL(idx.num_segments(), 2ul);
+    auto segments = idx.segments();
+    auto& merged = *segments[0].index;
+    auto& single = *segments[1].index;
+    ASSERT_EQUAL(merged.num_docs(), (copies - 1) * single.num_docs());
+    ASSERT_EQUAL(idx.num_docs(), copies * single.num_docs());
+    ASSERT_EQUAL(merged.unique_terms(), single.unique_terms());
+    check_stats(merged);
+
+    // every copy of a document keeps its metadata under its new doc_id
+    for (doc_id d_id{0}; d_id < idx.num_docs(); ++d_id)
+    {
+        doc_id orig{d_id % single.num_docs()};
+        ASSERT_EQUAL(idx.doc_path(d_id), single.doc_path(orig));
+        ASSERT_EQUAL(idx.doc_size(d_id), single.doc_size(orig));
+        ASSERT_EQUAL(idx.unique_terms(d_id), single.unique_terms(orig));
+        ASSERT_EQUAL(idx.label(d_id), single.label(orig));
+    }
+
+    std::vector<index::postings_cursor::pair_t> expected;
+    std::vector<index::postings_cursor::pair_t> postings;
+    std::vector<std::vector<uint64_t>> merged_positions;
+    std::vector<std::vector<uint64_t>> single_positions;
+    for (term_id t_id{0}; t_id < single.unique_terms(); ++t_id)
+    {
+        auto text = single.term_text(t_id);
+        ASSERT_EQUAL(merged.term_text(t_id), text);
+
+        single.postings(t_id).read_all(postings);
+        expected.clear();
+        for (uint64_t i = 0; i + 1 < copies; ++i)
+        {
+            for (const auto& posting : postings)
+                expected.emplace_back(
+                    doc_id{i * single.num_docs() + posting.first},
+                    posting.second);
+        }
+        merged.postings(t_id).read_all(postings);
+        ASSERT(postings == expected);
+
+        for (const auto& posting : expected)
+        {
+            doc_id orig{posting.first % single.num_docs()};
+            merged.positions(posting.first, {t_id}, merged_positions);
+            single.positions(orig, {t_id}, single_positions);
+            ASSERT(merged_positions == single_positions);
+        }
+    }
+}
+
+void check_shards(index::sharded_index& idx,
+                  const std::vector<corpus::document>& queries,
+                  const std::vector<index::sharded_index::ranking>& bm25,
+                  const std::vector<index::sharded_index::ranking>& dirichlet)
+{
+    ASSERT_EQUAL(idx.num_shards(), 3ul);
+
+    // the shards use document-at-a-time processing, which gives the same
+    // results as the term-at-a-time processing of the unsharded index
+    auto make_bm25 = []()
+    {
+        auto r = make_unique<index::okapi_bm25>();
+        r->strategy(index::query_strategy::wand);
+        return r;
+    };
+    auto make_dirichlet = []()
+    {
+        return make_unique<index::dirichlet_prior>();
+    };
+
+    for (uint64_t i = 0; i < queries.size(); ++i)
+    {
+        auto query = queries[i];
+        ASSERT(idx.score(make_bm25, query, 20) == bm25[i]);
+        ASSERT(idx.score(make_dirichlet, query, 20) == dirichlet[i]);
+    }
+}
+
+void check_clock_cache()
+{
+    // a single set, so that the order of evictions is known
+    caching::clock_cache<uint64_t, uint64_t> cache{8};
+    for (uint64_t key = 0; key < 8; ++key)
+        cache.insert(key, key * 2);
+    ASSERT_EQUAL(cache.size(), 8ul);
+    ASSERT_EQUAL(cache.bytes_used(), 8 * 2 * sizeof(uint64_t));
+
+    // the hand passes over the entries found since they were inserted
+    for (uint64_t key = 0; key < 4; ++key)
+        ASSERT_EQUAL(*cache.find(key), key * 2);
+    cache.insert(8, 16);
+    ASSERT_EQUAL(cache.size(), 8ul);
+    ASSERT(!cache.find(4));
+    for (uint64_t key : {0, 1, 2, 3, 5, 6, 7, 8})
+        ASSERT_EQUAL(*cache.find(key), key * 2);
+
+    cache.insert(8, 1);
+    ASSERT_EQUAL(*cache.find(8), 1ul);
+    ASSERT_EQUAL(cache.size(), 8ul);
+
+    cache.clear();
+    ASSERT_EQUAL(cache.size(), 0ul);
+    ASSERT_EQUAL(cache.bytes_used(), 0ul);
+    ASSERT(!cache.find(0));
+
+    // threads finding and inserting at once only ever see values that
+    // were inserted
+    caching::clock_cache<uint64_t, std::shared_ptr<uint64_t>> shared{64};
+    std::atomic<uint64_t> wrong{0};
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            for (uint64_t i = 0; i < 10000; ++i)
+            {
+                auto key = (i * 7 + t) % 200;
+                if (auto value = shared.find(key))
+                    wrong += (**value != key);
+                else
+                    shared.insert(key, std::make_shared<uint64_t>(key));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    ASSERT_EQUAL(wrong.load(), 0ul);
+    ASSERT(shared.size() <= 64);
+}
+
+void check_cache_budgets()
+{
+    using entry_size = caching::entry_size<std::string>;
+    std::string small(16, 's');
+    std::string large(4096, 'l');
+    auto small_bytes = sizeof(uint64_t) + entry_size{}(small);
+    auto large_bytes = sizeof(uint64_t) + entry_size{}(large);
+
+    // entries are evicted until the rest fit in the budget
+    caching::memory_budget budget{large_bytes + 8 * small_bytes};
+    caching::clock_cache<uint64_t, std::string> clock{64, budget};
+    caching::splay_cache<uint64_t, std::string> splay{64, budget};
+    for (uint64_t key = 0; key < 32; ++key)
+    {
+        clock.insert(key, key % 8 == 0 ? large : small);
+        splay.insert(key, key % 8 == 0 ? large : small);
+        ASSERT(clock.bytes_used() <= budget.max_bytes);
+        ASSERT(splay.bytes_used() <= budget.max_bytes);
+    }
+    ASSERT(clock.stats().evictions > 0);
+    ASSERT(splay.stats().evictions > 0);
+
+    // entries larger than the budget are turned away
+    caching::memory_budget tiny{small_bytes};
+    caching::clock_cache<uint64_t, std::string> tiny_clock{8, tiny};
+    caching::no_evict_cache<uint64_t, std::string> no_evict{tiny};
+    tiny_clock.insert(0, large);
+    no_evict.insert(0, large);
+    no_evict.insert(1, small);
+    no_evict.insert(2, small);
+    ASSERT(!tiny_clock.find(0));
+    ASSERT(!no_evict.find(0));
+    ASSERT(no_evict.find(1));
+    ASSERT(!no_evict.find(2));
+    ASSERT_EQUAL(no_evict.bytes_used(), small_bytes);
+    ASSERT_EQUAL(tiny_clock.stats().rejections, 1ul);
+    ASSERT_EQUAL(no_evict.stats().rejections, 2ul);
+
+    // the dblru_cache keeps each of its maps within half of the budget
+    caching::dblru_cache<uint64_t, std::string> dblru{1000,
+                                                      {4 * small_bytes}};
+    dblru.insert(0, large);
+    for (uint64_t key = 1; key <= 5; ++key)
+        dblru.insert(key, small);
+    ASSERT_EQUAL(dblru.stats().rejections, 1ul);
+    ASSERT_EQUAL(dblru.stats().evictions, 2ul);
+    ASSERT(!dblru.find(0));
+    ASSERT(!dblru.find(1));
+    ASSERT(dblru.find(4));
+    ASSERT(dblru.find(5));
+
+    // with admission, keys looked up once cannot flush hot keys
+    caching::memory_budget admit{8 * small_bytes, true};
+    caching::clock_cache<uint64_t, std::string> hot{8, admit};
+    caching::splay_cache<uint64_t, std::string> hot_splay{8, admit};
+    caching::dblru_cache<uint64_t, std::string> hot_dblru{4, admit};
+    for (uint64_t round = 0; round < 4; ++round)
+    {
+        for (uint64_t key = 0; key < 4; ++key)
+        {
+            if (!hot.find(key))
+                hot.insert(key, small);
+            if (!hot_splay.find(key))
+                hot_splay.insert(key, small);
+            if (!hot_dblru.find(key))
+                hot_dblru.insert(key, small);
+        }
+    }
+    for (uint64_t key = 100; key < 200; ++key)
+    {
+        if (!hot.find(key))
+            hot.insert(key, small);
+        if (!hot_splay.find(key))
+            hot_splay.insert(key, small);
+        if (!hot_dblru.find(key))
+            hot_dblru.insert(key, small);
+    }
+    for (uint64_t key = 0; key < 4; ++key)
+    {
+        ASSERT(hot.find(key));
+        ASSERT(hot_splay.find(key));
+        ASSERT(hot_dblru.find(key));
+    }
+    // the dblru_cache turns away the hot keys' first lookups, too
+    ASSERT_EQUAL(hot.stats().rejections, 96ul);
+    ASSERT_EQUAL(hot_splay.stats().rejections, 96ul);
+    ASSERT_EQUAL(hot_dblru.stats().rejections, 104ul);
+
+    // the shards' counts are added together
+    caching::splay_shard_cache<uint64_t, std::string> shards{4, uint64_t{8}};
+    for (uint64_t key = 0; key < 16; ++key)
+    {
+        shards.insert(key, small);
+        shards.find(key);
+        shards.find(key + 100);
+    }
+    ASSERT_EQUAL(shards.stats().hits, 16ul);
+    ASSERT_EQUAL(shards.stats().misses, 16ul);
+    ASSERT_APPROX_EQUAL(shards.stats().hit_rate(), 0.5);
+}
+
 int inverted_index_tests()
 {
     create_config("file");
@@ -124,6 +585,7 @@ int inverted_index_tests()
                 "test-config.toml", uint32_t{10000});
             check_ceeaus_expected(*idx);
             check_term_id(*idx);
+            check_warm(*idx);
         }
         system("rm -rf ceeaus-inv test-config.toml");
     });
@@ -147,6 +609,13 @@ int inverted_index_tests()
         check_ceeaus_expected(*idx);
         check_term_id(*idx);
         check_term_id(*idx); // twice to check splay_caching
+        check_postings_cursor(*idx);
+        check_stats(*idx);
+
+        // without a cache, cursors read the postings file itself
+        auto uncached
+            = index::make_index<index::inverted_index>("test-config.toml");
+        check_postings_cursor(*uncached);
     });
 
 #if META_HAS_ZLIB
@@ -180,6 +649,15 @@ int inverted_index_tests()
             "test-config.toml", uint64_t{1000});
         check_term_id(*idx);
         check_term_id(*idx);
+
+        // ranking reads its postings through the cache as well
+        auto query = corpus::corpus::load("test-config.toml")->next();
+        index::okapi_bm25 ranker;
+        auto first = ranker.score(*idx, query, 10);
+        auto hits = idx->cache_stats().hits;
+        auto second = ranker.score(*idx, query, 10);
+        ASSERT(first == second);
+        ASSERT_GREATER(idx->cache_stats().hits, hits);
     });
 
     num_failed += testing::run_test("inverted-index-no-evict-cache", [&]()
@@ -200,6 +678,237 @@ int inverted_index_tests()
         check_term_id(*idx);
     });
 
+    num_failed += testing::run_test("inverted-index-clock-cache", [&]()
+                                    {
+        // small enough that the cache has to evict
+        auto idx = index::make_index<index::inverted_index,
+                                     caching::clock_cache>("test-config.toml",
+                                                           uint64_t{16});
+        check_term_id(*idx);
+        check_term_id(*idx);
+        check_clock_cache();
+    });
+
+    num_failed += testing::run_test("inverted-index-cache-budget", [&]()
+                                    {
+        auto idx = index::make_index<index::inverted_index,
+                                     caching::clock_cache>(
+            "test-config.toml", uint64_t{16},
+            caching::memory_budget{uint64_t{1} << 20, true});
+        check_term_id(*idx);
+        check_term_id(*idx);
+        auto stats = idx->cache_stats();
+        ASSERT_EQUAL(stats.hits, 1ul);
+        ASSERT_EQUAL(stats.misses, 1ul);
+        check_cache_budgets();
+    });
+
+    create_config("line", "gamma", true);
+    system("rm -rf ceeaus-inv");
+
+    num_failed += testing::run_test("inverted-index-positions", [&]()
+                                    {
+        {
+            auto idx = index::make_index<index::inverted_index>(
+                "test-config.toml");
+            check_ceeaus_expected(*idx);
+            check_positions(*idx);
+        }
+        auto idx = index::make_index<index::inverted_index>(
+            "test-config.toml");
+        check_positions(*idx);
+    });
+
+    num_failed += testing::run_test("inverted-index-segments", [&]()
+                                    {
+        // with a merge factor of three, three copies of the corpus end up
+        // in a single inverted_index to compare rankings against
+        auto query = corpus::corpus::load("test-config.toml")->next();
+        index::okapi_bm25 ranker;
+        std::vector<std::pair<doc_id, double>> expected;
+        system("rm -rf ceeaus-inv");
+        {
+            index::segmented_index idx{"test-config.toml", 3};
+            for (uint64_t i = 0; i < 3; ++i)
+            {
+                auto docs = corpus::corpus::load("test-config.toml");
+                idx.add(*docs);
+            }
+            idx.wait_for_merges();
+            ASSERT_EQUAL(idx.num_segments(), 1ul);
+            expected = ranker.score(*idx.segments()[0].index, query, 20);
+        }
+
+        system("rm -rf ceeaus-inv");
+        {
+            // with a merge factor of two, the first two copies of the
+            // corpus are merged and the third is left on its own
+            index::segmented_index idx{"test-config.toml", 2};
+            for (uint64_t i = 0; i < 3; ++i)
+            {
+                auto docs = corpus::corpus::load("test-config.toml");
+                ASSERT_EQUAL(idx.add(*docs), doc_id{i * docs->size()});
+            }
+            idx.wait_for_merges();
+            check_segments(idx, 3);
+        }
+
+        // the first segment was merged away, so a directory by its name is
+        // what a crash while writing it would leave behind
+        filesystem::make_directory("ceeaus-inv/segment-0");
+        std::ofstream{"ceeaus-inv/segment-0/partial"} << "partial";
+        index::segmented_index idx{"test-config.toml", 2};
+        check_segments(idx, 3);
+        ASSERT(!filesystem::file_exists("ceeaus-inv/segment-0/partial"));
+
+        // every segment is scored with the statistics of the whole index,
+        // so the results match those of a single index
+        auto results = idx.score(ranker, query, 20);
+        ASSERT_EQUAL(results.size(), expected.size());
+        for (uint64_t i = 0; i < results.size(); ++i)
+        {
+            ASSERT_EQUAL(results[i].first, expected[i].first);
+            ASSERT_EQUAL(results[i].second, expected[i].second);
+        }
+
+        // deleted documents are hidden at once, and purged by compacting
+        auto num_docs = idx.num_docs();
+        for (uint64_t i = 0; i < num_docs; i += 3)
+            idx.delete_doc(doc_id{i});
+        ASSERT_EQUAL(idx.num_deleted(), (num_docs + 2) / 3);
+        for (const auto& result : idx.score(ranker, query, 20))
+            ASSERT(result.first % 3 != 0);
+
+        idx.compact();
+        idx.wait_for_merges();
+        ASSERT_EQUAL(idx.num_segments(), 2ul);
+        ASSERT_EQUAL(idx.num_docs(), num_docs);
+        ASSERT_EQUAL(idx.num_deleted(), (num_docs + 2) / 3);
+        ASSERT_EQUAL(idx.doc_size(doc_id{0}), 0ul);
+        for (const auto& seg : idx.segments())
+        {
+            check_stats(*seg.index);
+            std::vector<index::postings_cursor::pair_t> postings;
+            for (term_id t_id{0}; t_id < seg.index->unique_terms(); ++t_id)
+            {
+                seg.index->postings(t_id).read_all(postings);
+                ASSERT(!postings.empty());
+                for (const auto& posting : postings)
+                    ASSERT(!seg.index->is_deleted(posting.first));
+            }
+        }
+    });
+
+    num_failed += testing::run_test("inverted-index-shards", [&]()
+                                    {
+        std::vector<corpus::document> queries;
+        {
+            auto docs = corpus::corpus::load("test-config.toml");
+            for (uint64_t i = 0; i < 50 && docs->has_next(); ++i)
+            {
+                auto doc = docs->next();
+                if (i % 5 == 0)
+                    queries.push_back(doc);
+            }
+        }
+
+        std::vector<index::sharded_index::ranking> bm25;
+        std::vector<index::sharded_index::ranking> dirichlet;
+        std::vector<std::string> paths;
+        {
+            system("rm -rf ceeaus-inv");
+            auto idx = index::make_index<index::inverted_index>(
+                "test-config.toml");
+            index::okapi_bm25 bm25_ranker;
+            index::dirichlet_prior dirichlet_ranker;
+            for (const auto& query : queries)
+            {
+                auto bm25_query = query;
+                bm25.push_back(bm25_ranker.score(*idx, bm25_query, 20));
+                auto dirichlet_query = query;
+                dirichlet.push_back(
+                    dirichlet_ranker.score(*idx, dirichlet_query, 20));
+            }
+            for (doc_id d_id{0}; d_id < idx->num_docs(); ++d_id)
+                paths.push_back(idx->doc_path(d_id));
+        }
+
+        system("rm -rf ceeaus-inv");
+        {
+            index::sharded_index idx{"test-config.toml", 3, 2};
+            check_shards(idx, queries, bm25, dirichlet);
+        }
+
+        // the index keeps the shards it was built with
+        index::sharded_index idx{"test-config.toml", 5};
+        check_shards(idx, queries, bm25, dirichlet);
+        ASSERT_EQUAL(idx.num_docs(), paths.size());
+        for (doc_id d_id{0}; d_id < idx.num_docs(); ++d_id)
+            ASSERT_EQUAL(idx.doc_path(d_id), paths[d_id]);
+    });
+
+    num_failed += testing::run_test("inverted-index-delete", [&]()
+                                    {
+        system("rm -rf ceeaus-inv");
+        {
+            auto idx = index::make_index<index::inverted_index,
+                                         caching::splay_cache>(
+                "test-config.toml", uint32_t{10000});
+            auto total = idx->total_corpus_terms();
+
+            // fill the cache, which deleting must clear
+            check_term_id(*idx);
+            idx->delete_doc(doc_id{0});
+            idx->delete_doc(doc_id{5});
+            idx->delete_doc(doc_id{5});
+            ASSERT_EQUAL(idx->num_deleted(), 2ul);
+            ASSERT_EQUAL(idx->total_corpus_terms(),
+                         total - idx->doc_size(doc_id{0})
+                         - idx->doc_size(doc_id{5}));
+            check_deletions(*idx);
+        }
+
+        // deletions are saved with the index
+        auto idx = index::make_index<index::inverted_index,
+                                     caching::splay_cache>(
+            "test-config.toml", uint32_t{10000});
+        ASSERT_EQUAL(idx->num_deleted(), 2ul);
+        ASSERT(idx->is_deleted(doc_id{5}));
+        check_deletions(*idx);
+
+        // an index saved without the statistics of its deleted postings
+        // counts them again when it is loaded
+        idx = nullptr;
+        filesystem::delete_file("ceeaus-inv/deleted.termstats");
+        idx = index::make_index<index::inverted_index, caching::splay_cache>(
+            "test-config.toml", uint32_t{10000});
+        check_deletions(*idx);
+    });
+
+    create_config("line", "block");
+    system("rm -rf ceeaus-inv");
+
+    num_failed += testing::run_test("inverted-index-build-block-codec", [&]()
+                                    {
+        auto idx
+            = index::make_index<index::inverted_index, caching::splay_cache>(
+                "test-config.toml", uint32_t{10000});
+        check_ceeaus_expected(*idx);
+        check_term_id(*idx);
+    });
+
+    num_failed += testing::run_test("inverted-index-read-block-codec", [&]()
+                                    {
+        auto idx
+            = index::make_index<index::inverted_index, caching::splay_cache>(
+                "test-config.toml", uint32_t{10000});
+        check_ceeaus_expected(*idx);
+        check_term_id(*idx);
+        check_postings_cursor(*idx);
+        check_stats(*idx);
+        check_warm(*idx);
+    });
+
     system("rm -rf ceeaus-inv test-config.toml");
     return num_failed;
 }
@@ -75,6 +75,84 @@ int test_threadpool()
         }
 
         ASSERT_EQUAL(sum, size_t{16});
+
+        // tasks know they run on a pool's thread, so they can avoid
+        // starting more threads of their own
+        ASSERT(!parallel::thread_pool::in_worker());
+        ASSERT(pool.submit_task([]()
+                                {
+            return parallel::thread_pool::in_worker();
+        }).get());
+    });
+}
+
+int test_work_stealing()
+{
+    return testing::run_test("parallel-work-stealing", []()
+    {
+        parallel::thread_pool pool{4};
+        std::mutex mutex;
+        std::set<std::thread::id> ran_on;
+
+        // every task lands on the submitting worker's own deque, so the
+        // other workers only see them by stealing
+        auto outer = pool.submit_task([&]()
+        {
+            std::vector<std::future<void>> futures;
+            for (size_t i = 0; i < 64; ++i)
+            {
+                futures.emplace_back(pool.submit_task([&]()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    std::lock_guard<std::mutex> lock{mutex};
+                    ran_on.insert(std::this_thread::get_id());
+                }));
+            }
+            return futures;
+        });
+
+        for (auto& fut : outer.get())
+            fut.get();
+        ASSERT_GREATER(ran_on.size(), size_t{1});
+        ASSERT_EQUAL(pool.tasks(), size_t{0});
+    });
+}
+
+int test_skewed_parallel_for()
+{
+    return testing::run_test("parallel-for-skewed", []()
+    {
+        parallel::thread_pool pool{4};
+        auto ids = pool.thread_ids();
+
+        // a few elements are far more expensive than the rest
+        std::vector<size_t> touched(1000, 0);
+        auto range = util::range<size_t>(0, touched.size() - 1);
+        for (size_t grain : {size_t{1}, size_t{7}, size_t{5000}})
+        {
+            std::fill(touched.begin(), touched.end(), 0);
+            parallel::parallel_for(range.begin(), range.end(), pool, grain,
+                                   [&](size_t i)
+                                   {
+                ASSERT(std::find(ids.begin(), ids.end(),
+                                 std::this_thread::get_id()) != ids.end());
+                double x = i;
+                for (size_t j = 0; j < (i % 100 == 0 ? 20000 : 10); ++j)
+                    hard_func(x);
+                ++touched[i];
+            });
+            ASSERT(std::all_of(touched.begin(), touched.end(), [](size_t t)
+                               {
+                return t == 1;
+            }));
+        }
+
+        // empty ranges are a no-op
+        parallel::parallel_for(touched.begin(), touched.begin(), pool,
+                               [](size_t&)
+                               {
+            FAIL("function called on empty range");
+        });
     });
 }
 
@@ -90,6 +168,8 @@ int parallel_tests()
 
     num_failed += test_correctness(v);
     num_failed += test_threadpool();
+    num_failed += test_work_stealing();
+    num_failed += test_skewed_parallel_for();
     return num_failed;
 }
 }
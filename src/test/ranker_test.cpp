@@ -3,8 +3,16 @@
  * @author Sean Massung
  */
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 #include "test/ranker_test.h"
 #include "corpus/document.h"
+#include "index/query_cache.h"
+#include "index/query_engine.h"
+#include "index/score_data.h"
+#include "util/fixed_heap.h"
 
 namespace meta
 {
@@ -34,6 +42,239 @@ void test_rank(Ranker& r, Index& idx, const std::string& encoding)
     }
 }
 
+template <class Ranker, class Index>
+void test_strategies(Ranker& r, Index& idx, const std::string& encoding)
+{
+    auto even = [](doc_id d_id)
+    { return d_id % 2 == 0; };
+
+    for (size_t i = 0; i < idx.num_docs(); i += 7)
+    {
+        auto d_id = idx.docs()[i];
+        corpus::document query{idx.doc_path(d_id), doc_id{i}};
+        query.encoding(encoding);
+
+        for (uint64_t num_results : {1, 10, 100})
+        {
+            r.strategy(index::query_strategy::term_at_a_time);
+            auto expected = r.score(idx, query, num_results);
+            auto expected_even = r.score(idx, query, num_results, even);
+
+            for (auto strategy : {index::query_strategy::wand,
+                                  index::query_strategy::block_max_wand})
+            {
+                r.strategy(strategy);
+                auto ranking = r.score(idx, query, num_results);
+                ASSERT_EQUAL(ranking.size(), expected.size());
+                for (size_t j = 0; j < ranking.size(); ++j)
+                {
+                    ASSERT_EQUAL(ranking[j].first, expected[j].first);
+                    ASSERT_EQUAL(ranking[j].second, expected[j].second);
+                }
+
+                ranking = r.score(idx, query, num_results, even);
+                ASSERT_EQUAL(ranking.size(), expected_even.size());
+                for (size_t j = 0; j < ranking.size(); ++j)
+                {
+                    ASSERT_EQUAL(ranking[j].first, expected_even[j].first);
+                    ASSERT_EQUAL(ranking[j].second, expected_even[j].second);
+                }
+            }
+        }
+    }
+    r.strategy(index::query_strategy::term_at_a_time);
+}
+
+template <class Ranker, class Index>
+void test_query_engine(std::shared_ptr<Index> idx, const std::string& encoding)
+{
+    std::vector<corpus::document> queries;
+    for (size_t i = 0; i < idx->num_docs(); i += 5)
+    {
+        auto d_id = idx->docs()[i];
+        queries.emplace_back(idx->doc_path(d_id), doc_id{i});
+        queries.back().encoding(encoding);
+    }
+    auto serial_queries = queries;
+
+    index::query_engine engine{idx, []()
+                               {
+        return make_unique<Ranker>();
+    }, 4};
+    ASSERT_EQUAL(engine.num_threads(), size_t{4});
+    auto batch = engine.run(queries, 20);
+    ASSERT_EQUAL(batch.rankings.size(), queries.size());
+    ASSERT_EQUAL(batch.latencies.size(), queries.size());
+    ASSERT_GREATER(batch.qps(), 0.0);
+    ASSERT(batch.latency_percentile(0.5) <= batch.latency_percentile(0.99));
+
+    Ranker r;
+    for (size_t i = 0; i < serial_queries.size(); ++i)
+    {
+        auto expected = r.score(*idx, serial_queries[i], 20);
+        ASSERT_EQUAL(batch.rankings[i].size(), expected.size());
+        for (size_t j = 0; j < expected.size(); ++j)
+        {
+            ASSERT_EQUAL(batch.rankings[i][j].first, expected[j].first);
+            ASSERT_EQUAL(batch.rankings[i][j].second, expected[j].second);
+        }
+    }
+}
+
+template <class Index>
+void test_query_cache(Index& idx, const std::string& encoding)
+{
+    index::query_cache cache{100};
+    index::okapi_bm25 r;
+
+    std::vector<corpus::document> queries;
+    for (size_t i = 0; i < idx.num_docs(); i += 11)
+    {
+        auto d_id = idx.docs()[i];
+        queries.emplace_back(idx.doc_path(d_id), doc_id{i});
+        queries.back().encoding(encoding);
+    }
+
+    // queries are scored the first time they are seen, and a ranking
+    // answers later requests for as many results or fewer
+    for (auto& query : queries)
+    {
+        for (uint64_t num_results : {20, 5, 20})
+        {
+            auto ranking = cache.score(idx, r, query, num_results);
+            ASSERT(ranking == r.score(idx, query, num_results));
+        }
+    }
+    ASSERT_EQUAL(cache.misses(), queries.size());
+    ASSERT_EQUAL(cache.hits(), 2 * queries.size());
+
+    // asking for more results than were cached scores the query again
+    ASSERT(cache.score(idx, r, queries[0], 50)
+           == r.score(idx, queries[0], 50));
+    ASSERT_EQUAL(cache.misses(), queries.size() + 1);
+
+    // so does a ranker with different parameters
+    index::okapi_bm25 other{1.5};
+    ASSERT(cache.score(idx, other, queries[0], 20)
+           == other.score(idx, queries[0], 20));
+    ASSERT_EQUAL(cache.misses(), queries.size() + 2);
+
+    // deleting a document invalidates every cached ranking
+    auto ranking = cache.score(idx, r, queries[0], 20);
+    ASSERT_EQUAL(cache.misses(), queries.size() + 2);
+    idx.delete_doc(ranking[0].first);
+    auto after = cache.score(idx, r, queries[0], 20);
+    ASSERT_EQUAL(cache.misses(), queries.size() + 3);
+    ASSERT(after == r.score(idx, queries[0], 20));
+    for (const auto& result : after)
+        ASSERT(result.first != ranking[0].first);
+}
+
+template <class Index>
+void test_deleted_stats(Index& idx)
+{
+    // keeping only two of the documents holding the most common term
+    // leaves it in more documents on disk than are left in the index
+    term_id common{0};
+    for (term_id t_id{0}; t_id < idx.unique_terms(); ++t_id)
+    {
+        if (idx.doc_freq(t_id) > idx.doc_freq(common))
+            common = t_id;
+    }
+    auto counts = idx.search_primary(common)->counts();
+    ASSERT(counts.size() > 2);
+    for (doc_id d_id{0}; d_id < idx.num_docs(); ++d_id)
+    {
+        if (d_id != counts[0].first && d_id != counts[1].first)
+            idx.delete_doc(d_id);
+    }
+    ASSERT_GREATER(idx.doc_freq(common), idx.num_docs() - idx.num_deleted());
+
+    auto stats = idx.live_stats(common);
+    ASSERT_EQUAL(stats.doc_freq, 2ul);
+    ASSERT_EQUAL(stats.corpus_count,
+                 static_cast<uint64_t>(counts[0].second + counts[1].second));
+
+    // the term is scored as if the index held only the two documents left
+    corpus::document query;
+    query.increment(idx.term_text(common), 1);
+    index::score_data sd{idx, idx.avg_doc_length(), 2,
+                         idx.total_corpus_terms(), query};
+    sd.t_id = common;
+    sd.query_term_weight = 1;
+    sd.doc_count = stats.doc_freq;
+    sd.corpus_term_count = stats.corpus_count;
+
+    index::okapi_bm25 bm25;
+    for (auto strategy : {index::query_strategy::term_at_a_time,
+                          index::query_strategy::wand,
+                          index::query_strategy::block_max_wand})
+    {
+        bm25.strategy(strategy);
+        auto ranking = bm25.score(idx, query);
+        ASSERT_EQUAL(ranking.size(), 2ul);
+        ASSERT(ranking[0].second >= ranking[1].second);
+        for (const auto& result : ranking)
+        {
+            auto it = std::find_if(counts.begin(), counts.begin() + 2,
+                                   [&](const std::pair<doc_id, double>& p)
+                                   { return p.first == result.first; });
+            ASSERT(it != counts.begin() + 2);
+            sd.d_id = result.first;
+            sd.doc_term_count = static_cast<uint64_t>(it->second);
+            sd.doc_size = idx.doc_size(result.first);
+            sd.doc_unique_terms = idx.unique_terms(result.first);
+            ASSERT_GREATER(result.second, 0.0);
+            ASSERT_APPROX_EQUAL(result.second, bm25.score_one(sd));
+        }
+    }
+
+    index::dirichlet_prior dirichlet;
+    auto ranking = dirichlet.score(idx, query);
+    ASSERT_EQUAL(ranking.size(), 2ul);
+    for (const auto& result : ranking)
+        ASSERT(std::isfinite(result.second));
+}
+
+void test_fixed_heap()
+{
+    // few distinct scores, so that ties have to be broken by doc_id
+    std::mt19937 rng{47};
+    std::uniform_int_distribution<int> dist{0, 20};
+    std::vector<std::pair<doc_id, double>> results;
+    for (uint64_t id = 0; id < 1000; ++id)
+        results.emplace_back(doc_id{id}, dist(rng));
+
+    using doc_pair = std::pair<doc_id, double>;
+    auto comp = [](const doc_pair& a, const doc_pair& b)
+    {
+        if (a.second != b.second)
+            return a.second > b.second;
+        return a.first < b.first;
+    };
+
+    auto sorted = results;
+    std::sort(sorted.begin(), sorted.end(), comp);
+    for (uint64_t k : {0, 1, 10, 999, 1000, 2000})
+    {
+        util::fixed_heap<doc_pair, decltype(comp)> heap{k, comp};
+        for (const auto& result : results)
+        {
+            auto kept = heap.would_keep(result);
+            heap.push(result);
+            ASSERT_EQUAL(std::find(heap.begin(), heap.end(), result)
+                             != heap.end(),
+                         kept);
+        }
+        ASSERT_EQUAL(heap.full(), k <= results.size());
+
+        auto top = heap.extract_top();
+        ASSERT(heap.empty());
+        ASSERT_EQUAL(top.size(), std::min<uint64_t>(k, results.size()));
+        ASSERT(std::equal(top.begin(), top.end(), sorted.begin()));
+    }
+}
+
 int ranker_tests()
 {
     create_config("file");
@@ -77,6 +318,47 @@ int ranker_tests()
         test_rank(r, *idx, encoding);
     });
 
+    num_failed += testing::run_test("ranker-strategies", [&]()
+    {
+        index::absolute_discount absolute;
+        test_strategies(absolute, *idx, encoding);
+
+        index::dirichlet_prior dirichlet;
+        test_strategies(dirichlet, *idx, encoding);
+
+        index::jelinek_mercer jelinek;
+        test_strategies(jelinek, *idx, encoding);
+
+        index::okapi_bm25 bm25;
+        test_strategies(bm25, *idx, encoding);
+
+        index::pivoted_length pivoted;
+        test_strategies(pivoted, *idx, encoding);
+    });
+
+    num_failed += testing::run_test("ranker-query-engine", [&]()
+    {
+        test_query_engine<index::okapi_bm25>(idx, encoding);
+        test_query_engine<index::dirichlet_prior>(idx, encoding);
+    });
+
+    num_failed += testing::run_test("ranker-fixed-heap", [&]()
+    {
+        test_fixed_heap();
+    });
+
+    // deletes a document, so it runs near the end
+    num_failed += testing::run_test("ranker-query-cache", [&]()
+    {
+        test_query_cache(*idx, encoding);
+    });
+
+    // deletes nearly every document, so it runs after the query cache
+    num_failed += testing::run_test("ranker-deleted-stats", [&]()
+    {
+        test_deleted_stats(*idx);
+    });
+
     idx = nullptr;
 
     system("rm -rf ceeaus-inv test-config.toml");
@@ -20,6 +20,7 @@
 #include "test/ir_eval_test.h"
 #include "test/graph_test.h"
 #include "test/compression_test.h"
+#include "test/block_codec_test.h"
 #include "test/parser_test.h"
 #include "test/filesystem_test.h"
 #include "util/printing.h"
@@ -46,6 +47,7 @@ int main(int argc, char* argv[])
         std::cerr << " \"rankers\": runs ranker tests" << std::endl;
         std::cerr << " \"ir-eval\": runs IR evaluation tests" << std::endl;
         std::cerr << " \"compression\": runs compression reading and writing tests" << std::endl;
+        std::cerr << " \"block-codec\": runs block postings codec tests" << std::endl;
         std::cerr << " \"graph\": runs undirected and directed graph tests" << std::endl;
         std::cerr << " \"parser\": runs parser tests" << std::endl;
         std::cerr << " \"filesystem\": runs filesystem tests" << std::endl;
@@ -82,6 +84,8 @@ int main(int argc, char* argv[])
         num_failed += testing::ir_eval_tests();
     if (all || args.find("compression") != args.end())
         num_failed += testing::compression_tests();
+    if (all || args.find("block-codec") != args.end())
+        num_failed += testing::block_codec_tests();
     if (all || args.find("graph") != args.end())
         num_failed += testing::graph_tests();
     if (all || args.find("parser") != args.end())
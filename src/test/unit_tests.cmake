@@ -46,6 +46,10 @@ add_test(compression ${UNIT_TEST_EXE} compression)
 set_tests_properties(compression PROPERTIES TIMEOUT 10 WORKING_DIRECTORY
                          ${CMAKE_RUNTIME_OUTPUT_DIRECTORY})
 
+add_test(block-codec ${UNIT_TEST_EXE} block-codec)
+set_tests_properties(block-codec PROPERTIES TIMEOUT 10 WORKING_DIRECTORY
+                         ${CMAKE_RUNTIME_OUTPUT_DIRECTORY})
+
 add_test(graph ${UNIT_TEST_EXE} graph)
 set_tests_properties(graph PROPERTIES TIMEOUT 10 WORKING_DIRECTORY
                          ${CMAKE_RUNTIME_OUTPUT_DIRECTORY})
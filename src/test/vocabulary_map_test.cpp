@@ -3,6 +3,8 @@
  * @author Chase Geigle
  */
 
+#include <algorithm>
+
 #include "test/vocabulary_map_test.h"
 #include "util/optional.h"
 
@@ -125,6 +127,40 @@ void read_file(uint16_t size)
     ASSERT_EQUAL(map.size(), 14ul);
 }
 
+void check_compact_vocabulary(uint64_t num_terms)
+{
+    // sorted terms sharing prefixes of many lengths, as in an index
+    std::vector<std::string> terms;
+    for (uint64_t i = 0; i < num_terms; ++i)
+        terms.push_back("term" + std::to_string(i));
+    std::sort(terms.begin(), terms.end());
+
+    {
+        index::compact_vocabulary_writer writer{"meta-tmp-test.bin"};
+        for (const auto& term : terms)
+            writer.insert(term);
+    }
+    ASSERT(!filesystem::file_exists("meta-tmp-test.bin.tmp"));
+
+    {
+        index::compact_vocabulary vocab{"meta-tmp-test.bin"};
+        ASSERT_EQUAL(vocab.size(), num_terms);
+        for (uint64_t i = 0; i < num_terms; ++i)
+        {
+            auto elem = vocab.find(terms[i]);
+            ASSERT(elem);
+            ASSERT_EQUAL(*elem, i);
+            ASSERT_EQUAL(vocab.find_term(term_id{i}), terms[i]);
+        }
+        ASSERT(!vocab.find(""));
+        ASSERT(!vocab.find("term"));
+        ASSERT(!vocab.find("zabawe"));
+        ASSERT(!vocab.find("term" + std::to_string(num_terms)));
+    }
+
+    filesystem::delete_file("meta-tmp-test.bin");
+}
+
 int vocabulary_map_tests()
 {
     int num_failed = 0;
@@ -153,6 +189,14 @@ int vocabulary_map_tests()
         read_file(23);
     });
 
+    num_failed += testing::run_test("compact_vocabulary", [&]()
+    {
+        check_compact_vocabulary(0);
+        check_compact_vocabulary(1);
+        check_compact_vocabulary(100);
+        check_compact_vocabulary(20000);
+    });
+
     return num_failed;
 }
 }
@@ -0,0 +1,151 @@
+/**
+ * @file parallel_bench.cpp
+ * @author agent
+ *
+ * Measures the task throughput of parallel::thread_pool and how evenly
+ * parallel_for spreads a skewed workload across the pool's threads with
+ * static blocks versus dynamically claimed grains.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "parallel/parallel_for.h"
+#include "parallel/thread_pool.h"
+#include "util/time.h"
+
+using namespace meta;
+
+namespace
+{
+/**
+ * Burns CPU proportionally to cost.
+ */
+double work(uint64_t cost)
+{
+    double x = static_cast<double>(cost);
+    for (uint64_t i = 0; i < cost; ++i)
+        x = std::sin(x) + std::cos(x);
+    return x;
+}
+
+/**
+ * Times submitting and running many trivial tasks.
+ * @param pool The pool to use
+ * @param num_tasks The number of tasks to run
+ * @param nested Whether the tasks are submitted from within a worker
+ * @return the number of tasks completed per second
+ */
+double throughput(parallel::thread_pool& pool, uint64_t num_tasks,
+                  bool nested)
+{
+    auto submit_all = [&]()
+    {
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(num_tasks);
+        for (uint64_t i = 0; i < num_tasks; ++i)
+            futures.emplace_back(pool.submit_task([i]()
+                                                  {
+                return i;
+            }));
+        uint64_t sum = 0;
+        for (auto& fut : futures)
+            sum += fut.get();
+        return sum;
+    };
+
+    auto time = common::time<std::chrono::microseconds>([&]()
+                                                        {
+        if (nested)
+            pool.submit_task(submit_all).get();
+        else
+            submit_all();
+    });
+    return num_tasks / (std::max<double>(time.count(), 1) / 1e6);
+}
+
+/**
+ * Runs a skewed workload through parallel_for and reports the wall time
+ * and the imbalance between the busiest and the average thread.
+ * @param pool The pool to use
+ * @param costs The cost of each element
+ * @param grain_size The number of elements claimed at a time
+ * @return the sum of the work results, so that the work is not optimized
+ * away
+ */
+double balance(parallel::thread_pool& pool,
+               const std::vector<uint64_t>& costs, size_t grain_size)
+{
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, double> busy;
+    for (const auto& id : pool.thread_ids())
+        busy[id] = 0;
+
+    double sink = 0;
+    auto time = common::time([&]()
+                             {
+        parallel::parallel_for(costs.begin(), costs.end(), pool, grain_size,
+                               [&](uint64_t cost)
+                               {
+            auto start = std::chrono::steady_clock::now();
+            auto x = work(cost);
+            std::chrono::duration<double, std::milli> elapsed
+                = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard<std::mutex> lock{mutex};
+            busy[std::this_thread::get_id()] += elapsed.count();
+            sink += x;
+        });
+    });
+
+    double max = 0;
+    double total = 0;
+    for (const auto& b : busy)
+    {
+        max = std::max(max, b.second);
+        total += b.second;
+    }
+    auto mean = total / busy.size();
+
+    std::cout << grain_size << "\t" << time.count() << "\t"
+              << (mean > 0 ? max / mean : 1) << std::endl;
+    return sink;
+}
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_threads = argc > 1 ? std::stoul(argv[1])
+                                  : std::thread::hardware_concurrency();
+    uint64_t num_tasks = argc > 2 ? std::stoul(argv[2]) : 200000;
+
+    parallel::thread_pool pool{num_threads};
+    std::cout << "Threads: " << pool.size() << std::endl;
+
+    std::cout << "external submission: "
+              << throughput(pool, num_tasks, false) << " tasks/s" << std::endl;
+    std::cout << "worker submission:   " << throughput(pool, num_tasks, true)
+              << " tasks/s" << std::endl;
+
+    // document-length-like skew: most elements are cheap, but every 16th
+    // element of the first quarter is 100x as expensive, so static blocks
+    // hand nearly all of the work to one thread
+    std::vector<uint64_t> costs(20000);
+    for (size_t i = 0; i < costs.size(); ++i)
+        costs[i] = (i < costs.size() / 4 && i % 16 == 0) ? 20000 : 200;
+
+    std::cout << "\nskewed parallel_for over " << costs.size()
+              << " elements\ngrain\tms\tmax/mean busy" << std::endl;
+    auto static_grain = (costs.size() + pool.size() - 1) / pool.size();
+    auto sum = balance(pool, costs, static_grain);
+    sum += balance(pool, costs, costs.size() / (pool.size() * 8));
+    sum += balance(pool, costs, 1);
+
+    return std::isfinite(sum) ? 0 : 1;
+}
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "index/postings_data.h"
 #include "topics/lda_gibbs.h"
@@ -17,7 +18,10 @@ namespace topics
 
 lda_gibbs::lda_gibbs(std::shared_ptr<index::forward_index> idx,
                      uint64_t num_topics, double alpha, double beta)
-    : lda_model{std::move(idx), num_topics}
+    : lda_model{std::move(idx), num_topics},
+      sampler_{topic_sampler::full},
+      mh_steps_{2},
+      prior_proposal_mass_{0}
 {
     doc_word_topic_.resize(idx_->num_docs());
 
@@ -73,6 +77,26 @@ void lda_gibbs::run(uint64_t num_iters, double convergence /* = 1e-6 */)
     LOG(info) << "Finished maximum iterations, or found convergence!" << ENDLG;
 }
 
+void lda_gibbs::sampler(topic_sampler method, uint64_t mh_steps /* = 2 */)
+{
+    sampler_ = method;
+    // a chain with no steps would never leave the current assignment
+    mh_steps_ = std::max<uint64_t>(mh_steps, 1);
+}
+
+topic_sampler lda_gibbs::sampler() const
+{
+    return sampler_;
+}
+
+topic_id lda_gibbs::draw_topic(term_id term, doc_id doc, uint64_t position,
+                               bool init)
+{
+    if (sampler_ == topic_sampler::alias_mh)
+        return sample_topic_mh(term, doc, position, init);
+    return sample_topic(term, doc);
+}
+
 topic_id lda_gibbs::sample_topic(term_id term, doc_id doc)
 {
     stats::multinomial<topic_id> full_conditional;
@@ -84,6 +108,137 @@ topic_id lda_gibbs::sample_topic(term_id term, doc_id doc)
     return full_conditional(rng_);
 }
 
+topic_id lda_gibbs::sample_topic_mh(term_id term, doc_id doc,
+                                    uint64_t position, bool init)
+{
+    const auto& assigned = doc_word_topic_[doc];
+    // during the online initialization, only the tokens before this one
+    // have been assigned topics
+    uint64_t num_assigned = init ? position : assigned.size();
+    auto alpha_mass = theta_[doc].prior().pseudo_counts();
+    auto beta = phi_[topic_id{0}].prior().pseudo_counts(term);
+    auto smoothing_mass = beta * prior_proposal_mass_;
+    const auto& term_counts = term_topic_counts_[term];
+
+    std::uniform_real_distribution<> dist{0, 1};
+    std::uniform_int_distribution<uint64_t> uniform_topic{0, num_topics_ - 1};
+
+    // doc proposal: proportional to n_dk + \alpha, where n_dk still counts
+    // this token's old assignment. Picking the topic of a random token in
+    // the document covers the count part without touching all K topics.
+    auto doc_proposal = [&]()
+    {
+        auto u = dist(rng_) * (num_assigned + alpha_mass);
+        if (u < num_assigned)
+            return assigned[static_cast<uint64_t>(u)];
+        return topic_id{uniform_topic(rng_)};
+    };
+    auto doc_weight = [&](topic_id topic)
+    {
+        auto weight = theta_[doc].counts(topic);
+        if (!init && topic == assigned[position])
+            weight += 1;
+        return weight;
+    };
+
+    // word proposal: proportional to (n_wk + \beta) / (n_k + V\beta) as of
+    // the start of the iteration
+    auto word_proposal = [&]()
+    {
+        auto mass = term_proposal_mass_[term];
+        if (dist(rng_) * (mass + smoothing_mass) < mass)
+            return term_proposals_[term](rng_);
+        return prior_proposal_(rng_);
+    };
+    auto word_weight = [&](topic_id topic)
+    {
+        return (term_counts.at(topic) + beta) * proposal_norms_[topic];
+    };
+
+    auto current = init ? word_proposal() : assigned[position];
+    auto current_weight = compute_sampling_weight(term, doc, current);
+
+    // accepts the proposal with the Metropolis-Hastings ratio against the
+    // true full conditional
+    auto step = [&](topic_id proposal, double proposal_weight,
+                    double current_proposal_weight)
+    {
+        if (proposal == current)
+            return;
+        auto weight = compute_sampling_weight(term, doc, proposal);
+        auto ratio = (weight * current_proposal_weight)
+                     / (current_weight * proposal_weight);
+        if (ratio >= 1 || dist(rng_) < ratio)
+        {
+            current = proposal;
+            current_weight = weight;
+        }
+    };
+
+    for (uint64_t i = 0; i < mh_steps_; ++i)
+    {
+        auto proposal = doc_proposal();
+        step(proposal, doc_weight(proposal), doc_weight(current));
+
+        proposal = word_proposal();
+        step(proposal, word_weight(proposal), word_weight(current));
+    }
+    return current;
+}
+
+void lda_gibbs::build_proposals()
+{
+    std::vector<topic_id> topics;
+    topics.reserve(num_topics_);
+    proposal_norms_.resize(num_topics_);
+    for (topic_id topic{0}; topic < num_topics_; ++topic)
+    {
+        topics.push_back(topic);
+        proposal_norms_[topic] = 1.0 / phi_[topic].counts();
+    }
+    prior_proposal_ = {std::move(topics), proposal_norms_};
+    prior_proposal_mass_ = std::accumulate(proposal_norms_.begin(),
+                                           proposal_norms_.end(), 0.0);
+
+    // transpose the topic-term counts; topics are visited in order, so
+    // each insertion appends to the term's sparse vector
+    term_topic_counts_.assign(num_words_, {});
+    for (topic_id topic{0}; topic < num_topics_; ++topic)
+    {
+        const auto& phi = phi_[topic];
+        phi.each_seen_event([&](term_id term)
+                            {
+            auto count = phi.counts(term) - phi.prior().pseudo_counts(term);
+            if (count > 0.5)
+                term_topic_counts_[term][topic] = count;
+        });
+    }
+
+    term_proposals_.resize(num_words_);
+    term_proposal_mass_.assign(num_words_, 0.0);
+    std::vector<topic_id> events;
+    std::vector<double> weights;
+    for (term_id term{0}; term < num_words_; ++term)
+    {
+        events.clear();
+        weights.clear();
+        for (const auto& count : term_topic_counts_[term])
+        {
+            events.push_back(count.first);
+            weights.push_back(count.second * proposal_norms_[count.first]);
+        }
+
+        if (events.empty())
+        {
+            term_proposals_[term] = {};
+            continue;
+        }
+        term_proposal_mass_[term]
+            = std::accumulate(weights.begin(), weights.end(), 0.0);
+        term_proposals_[term] = {events, weights};
+    }
+}
+
 double lda_gibbs::compute_sampling_weight(term_id term, doc_id doc,
                                           topic_id topic) const
 {
@@ -115,6 +270,9 @@ void lda_gibbs::perform_iteration(uint64_t iter, bool init /* = false */)
         str = "Initialization: ";
     else
         str = "Iteration " + std::to_string(iter) + ": ";
+    if (sampler_ == topic_sampler::alias_mh)
+        build_proposals();
+
     printing::progress progress{str, idx_->num_docs()};
     progress.print_endline(false);
     for (const auto& i : idx_->docs())
@@ -134,7 +292,7 @@ void lda_gibbs::perform_iteration(uint64_t iter, bool init /* = false */)
                     decrease_counts(old_topic, freq.first, i);
 
                 // sample a new topic assignment
-                auto topic = sample_topic(freq.first, i);
+                auto topic = draw_topic(freq.first, i, n, init);
                 doc_word_topic_[i][n] = topic;
 
                 // increase counts
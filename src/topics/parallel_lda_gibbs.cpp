@@ -38,6 +38,10 @@ void parallel_lda_gibbs::perform_iteration(uint64_t iter,
         for (auto& phi : phis.second)
             phi.clear();
 
+    // every thread proposes from the counts as of the last reduction
+    if (sampler_ == topic_sampler::alias_mh)
+        build_proposals();
+
     std::mutex mutex;
     uint64_t assigned = 0;
     parallel::parallel_for(range.begin(), range.end(), pool_, [&](doc_id i)
@@ -60,7 +64,7 @@ void parallel_lda_gibbs::perform_iteration(uint64_t iter,
                     decrease_counts(old_topic, freq.first, i);
 
                 // sample a new topic assignment
-                auto topic = sample_topic(freq.first, i);
+                auto topic = draw_topic(freq.first, i, n, init);
                 doc_word_topic_[i][n] = topic;
 
                 // increase counts
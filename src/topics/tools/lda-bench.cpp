@@ -0,0 +1,112 @@
+/**
+ * @file lda-bench.cpp
+ * @author agent
+ *
+ * Times the full and alias-table Metropolis-Hastings Gibbs samplers for
+ * LDA, serial and parallel, reporting tokens sampled per second for each
+ * number of topics.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "topics/lda_gibbs.h"
+#include "topics/parallel_lda_gibbs.h"
+
+#include "caching/no_evict_cache.h"
+#include "index/forward_index.h"
+#include "logging/logger.h"
+#include "util/time.h"
+
+using namespace meta;
+
+/**
+ * Exposes the sampling iterations of a Gibbs model so that they can be
+ * timed without the per-iteration likelihood computation done by run().
+ */
+template <class Model>
+class timed_model : public Model
+{
+  public:
+    using Model::Model;
+
+    /**
+     * Runs the sampler and reports its throughput.
+     * @param num_iters The number of iterations to time
+     * @param num_tokens The number of tokens in the corpus
+     * @return the number of tokens sampled per second
+     */
+    double tokens_per_second(uint64_t num_iters, uint64_t num_tokens)
+    {
+        this->initialize();
+        auto time = common::time<std::chrono::milliseconds>([&]()
+                                                            {
+            for (uint64_t i = 0; i < num_iters; ++i)
+                this->perform_iteration(i + 1);
+        });
+        auto secs = std::max<double>(time.count(), 1) / 1000;
+        return num_tokens * num_iters / secs;
+    }
+};
+
+template <class Model>
+double bench(std::shared_ptr<index::forward_index> idx, uint64_t topics,
+             topics::topic_sampler sampler, uint64_t num_iters,
+             uint64_t num_tokens)
+{
+    timed_model<Model> model{std::move(idx), topics, 0.1, 0.01};
+    model.sampler(sampler);
+    return model.tokens_per_second(num_iters, num_tokens);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage:\t" << argv[0]
+                  << " configFile [iterations] [topics...]\n"
+                     "\tTimes the full and alias-mh Gibbs samplers (serial "
+                     "and parallel) on the\n\tconfigured forward index. "
+                     "Topics defaults to 100 1000 5000." << std::endl;
+        return 1;
+    }
+
+    logging::set_cerr_logging(logging::logger::severity_level::warning);
+
+    uint64_t num_iters = argc > 2 ? std::stoul(argv[2]) : 5;
+    std::vector<uint64_t> num_topics;
+    for (int i = 3; i < argc; ++i)
+        num_topics.push_back(std::stoul(argv[i]));
+    if (num_topics.empty())
+        num_topics = {100, 1000, 5000};
+
+    auto idx = index::make_index<index::forward_index, caching::no_evict_cache>(
+        argv[1]);
+    uint64_t num_tokens = 0;
+    for (const auto& doc : idx->docs())
+        num_tokens += idx->doc_size(doc);
+
+    std::cout << "Documents: " << idx->num_docs()
+              << ", tokens: " << num_tokens << ", iterations: " << num_iters
+              << std::endl;
+    std::cout << "topics\tsampler\tserial tok/s\tparallel tok/s" << std::endl;
+
+    for (const auto& k : num_topics)
+    {
+        for (const auto& sampler :
+             {topics::topic_sampler::full, topics::topic_sampler::alias_mh})
+        {
+            auto serial = bench<topics::lda_gibbs>(idx, k, sampler, num_iters,
+                                                   num_tokens);
+            auto parallel = bench<topics::parallel_lda_gibbs>(
+                idx, k, sampler, num_iters, num_tokens);
+            std::cout << k << "\t"
+                      << (sampler == topics::topic_sampler::full ? "full"
+                                                                 : "alias-mh")
+                      << "\t" << serial << "\t" << parallel << std::endl;
+        }
+    }
+    return 0;
+}
@@ -25,6 +25,18 @@ int run_lda(Index& idx, uint64_t num_iters, uint64_t topics, double alpha,
     return 0;
 }
 
+template <class Model, class Index>
+int run_gibbs(Index& idx, uint64_t num_iters, uint64_t topics, double alpha,
+              double beta, topics::topic_sampler sampler, uint64_t mh_steps,
+              const std::string& save_prefix)
+{
+    Model model{idx, topics, alpha, beta};
+    model.sampler(sampler, mh_steps);
+    model.run(num_iters);
+    model.save(save_prefix);
+    return 0;
+}
+
 bool check_parameter(const std::string& file, const cpptoml::table& group,
                      const std::string& param)
 {
@@ -66,6 +78,22 @@ int run_lda(const std::string& config_file)
     uint64_t topics = *lda_group->get_as<int64_t>("topics");
     auto save_prefix = *lda_group->get_as<std::string>("model-prefix");
 
+    auto sampler = topic_sampler::full;
+    if (auto method = lda_group->get_as<std::string>("sampler"))
+    {
+        if (*method == "alias-mh")
+            sampler = topic_sampler::alias_mh;
+        else if (*method != "full")
+        {
+            std::cerr << "Incorrect sampler selected: must be full or alias-mh"
+                      << std::endl;
+            return 1;
+        }
+    }
+    uint64_t mh_steps = 2;
+    if (auto steps = lda_group->get_as<int64_t>("mh-steps"))
+        mh_steps = static_cast<uint64_t>(*steps);
+
     auto f_idx
         = index::make_index<index::forward_index, caching::no_evict_cache>(
             config_file);
@@ -73,15 +101,15 @@ int run_lda(const std::string& config_file)
     {
         std::cout << "Beginning LDA using serial Gibbs sampling..."
                   << std::endl;
-        return run_lda<lda_gibbs>(f_idx, iters, topics, alpha, beta,
-                                  save_prefix);
+        return run_gibbs<lda_gibbs>(f_idx, iters, topics, alpha, beta, sampler,
+                                    mh_steps, save_prefix);
     }
     else if (type == "pargibbs")
     {
         std::cout << "Beginning LDA using parallel Gibbs sampling..."
                   << std::endl;
-        return run_lda<parallel_lda_gibbs>(f_idx, iters, topics, alpha, beta,
-                                           save_prefix);
+        return run_gibbs<parallel_lda_gibbs>(f_idx, iters, topics, alpha, beta,
+                                             sampler, mh_steps, save_prefix);
     }
     else if (type == "cvb")
     {
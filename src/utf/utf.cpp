@@ -89,10 +89,10 @@ std::string toupper(const std::string& str)
     return result;
 }
 
-std::string foldcase(const std::string& str)
+std::string foldcase(util::string_view str)
 {
 
-    const char* s = str.c_str();
+    const char* s = str.data();
     std::string result;
     result.reserve(str.length());
     int32_t length = str.length();
@@ -106,11 +106,16 @@ std::string foldcase(const std::string& str)
     return result;
 }
 
-std::string remove_if(const std::string& str,
+std::string foldcase(const std::string& str)
+{
+    return foldcase(util::string_view{str});
+}
+
+std::string remove_if(util::string_view str,
                       std::function<bool(uint32_t)> pred)
 {
     std::string result;
-    const char* s = str.c_str();
+    const char* s = str.data();
     int32_t length = str.length();
     for (int32_t i = 0; i < length;)
     {
@@ -133,9 +138,9 @@ bool isblank(uint32_t codepoint)
     return u_isblank(codepoint);
 }
 
-uint64_t length(const std::string& str)
+uint64_t length(util::string_view str)
 {
-    const char* s = str.c_str();
+    const char* s = str.data();
     int32_t length = str.length();
     uint64_t count = 0;
     for (int32_t i = 0; i < length;)